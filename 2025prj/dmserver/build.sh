@@ -16,11 +16,15 @@ INC_DIR="./inc"
 INC="$(find $LIBS_DIR/dmlogger -name '*.h') $(find $INC_DIR -name '*.h')"
 LIB_SRC=$(find $SRC_DIR -name '*.c')
 TEST_SRC="$LIB_SRC ./dmserver_test.c"
+REPLAY_SRC="$LIB_SRC ./dmserver_replay.c"
+BENCH_SRC="$LIB_SRC ./dmserver_bench.c"
 
 LIB_DIR=dmserver
 LIB_HDR=$(find $INC_DIR -name '*.h')
 
 TEST_PROG=test.elf
+REPLAY_PROG=replay.elf
+BENCH_PROG=bench.elf
 LIB_PROG=libdmserver.so
 # -------------------------------- #
 
@@ -57,10 +61,30 @@ elif [ "$1" == "lib" ]; then
     fi
     echo
 
+elif [ "$1" == "replay" ]; then
+    echo
+    echo "[BUILD-REPLAY]: Compiling replay program..."
+    if $CC -I$LIBS_DIR -I$INC_DIR $REPLAY_SRC $CFLAGS_TEST -o $REPLAY_PROG; then
+        echo "[BUILD-REPLAY]: Replay program compiled! (use: ./$REPLAY_PROG <capture file> <host|unix path> <port> [speed] [udp])"
+    else
+        echo "[BUILD-REPLAY ERR]: Compilation error, replay program not generated."
+    fi
+    echo
+
+elif [ "$1" == "bench" ]; then
+    echo
+    echo "[BUILD-BENCH]: Compiling benchmark program..."
+    if $CC -O2 -I$LIBS_DIR -I$INC_DIR $BENCH_SRC $CFLAGS_TEST -o $BENCH_PROG; then
+        echo "[BUILD-BENCH]: Benchmark program compiled! (use: ./$BENCH_PROG <mode> [args], modes listed without arguments)"
+    else
+        echo "[BUILD-BENCH ERR]: Compilation error, benchmark program not generated."
+    fi
+    echo
+
 elif [ "$1" == "clean" ]; then
     echo
     echo "[BUILD-CLEAN]: Cleaning workspace..."
-    rm -f $LIBS_DIR/$LIB_DIR/* $LOGS_DIR/* ./$TEST_PROG
+    rm -f $LIBS_DIR/$LIB_DIR/* $LOGS_DIR/* ./$TEST_PROG ./$REPLAY_PROG ./$BENCH_PROG
     echo "[BUILD-CLEAN]: Workspace completly clean!"
     echo
 
@@ -70,6 +94,8 @@ else
     echo -e "\n\t[Use]:"
     echo -e "\t\t-> ./build.sh test: \tCompile and execute the test program (.elf) under the ./ folder."
     echo -e "\t\t-> ./build.sh lib: \tCompile and generate the shared library (.so) under the ./lib/ folder."
+    echo -e "\t\t-> ./build.sh replay: \tCompile the capture replay program (.elf) under the ./ folder."
+    echo -e "\t\t-> ./build.sh bench: \tCompile the benchmarks program (.elf) under the ./ folder."
     echo -e "\t\t-> ./build.sh clean: \tClean the workspace deleting generated files (including logs under ./logs/)."
     echo
     exit 1
@@ -0,0 +1,607 @@
+#include "./inc/dmserver.h"
+#include <dlfcn.h>
+#include <netinet/tcp.h>
+
+// ---- Benchmark parameters:
+#define BENCH_PORT 7895
+#define BENCH_UPPORT 7896
+#define BENCH_TOPIC "bench"
+#define BENCH_WINDOW 8
+#define BENCH_RUNBYTES ((size_t)1 << 30)
+#define BENCH_MSG "0123456789abcdef0123456789abcdef"
+#define BENCH_MSGS 20000
+#define BENCH_WARMUP 1000
+#define BENCH_SPINUSEC 200
+#define BENCH_PROXYMB 512
+#define BENCH_CHUNK 65536
+#define BENCH_INJCONNS 64
+#define BENCH_CLOCK 1000000
+#define BENCH_TIMEOUT 60
+
+// ---- Syscalls counted (server threads, interposed below):
+enum bench_syscall{
+    BENCH_SC_READ,
+    BENCH_SC_WRITE,
+    BENCH_SC_READV,
+    BENCH_SC_WRITEV,
+    BENCH_SC_RECVMSG,
+    BENCH_SC_SENDMSG,
+    BENCH_SC_EPOLLWAIT,
+    BENCH_SC_EPOLLCTL,
+    BENCH_SC_EVFDREAD,
+    BENCH_SC_EVFDWRITE,
+    BENCH_SC_COUNT
+};
+const char * bench_scnames[BENCH_SC_COUNT] = {"read", "write", "readv", "writev", "recvmsg", "sendmsg", "epoll_wait", "epoll_ctl", "eventfd_read", "eventfd_write"};
+
+// ---- Global variables (server, first client connected, clients counters & syscalls counters):
+dmserver_pt serv;
+dmserver_cliconn_pt bench_cli = NULL;
+size_t bench_conns = 0;
+size_t bench_timeouts = 0;
+size_t bench_orders = 0;
+size_t bench_notional = 0;
+volatile bool bench_stop = false;
+bool bench_counting = false;
+size_t bench_sc[BENCH_SC_COUNT];
+__thread bool bench_uncounted = false;
+
+// ---- Benchmark modes prototypes:
+int bench_zerocopy(int argc, char ** argv);
+int bench_syscalls(int argc, char ** argv);
+int bench_pingpong(int argc, char ** argv);
+int bench_proxy(int argc, char ** argv);
+int bench_inject(int argc, char ** argv);
+
+// ---- Callback & helper functions prototypes:
+void conn_fn(dmserver_cliconn_pt cli);
+void echo_fn(dmserver_cliconn_pt cli);
+void order_fn(dmserver_cliconn_pt cli);
+void timeout_fn(dmserver_cliconn_pt cli);
+void * reader_fn(void * arg);
+void * upecho_fn(void * arg);
+void * upecho_conn_fn(void * arg);
+void * bulk_writer_fn(void * arg);
+bool bench_open(dmserver_servconn_conf_pt sconf, dmserver_worker_conf_pt wconf, dmserver_callback_conf_pt cbconf, dmserver_proxy_conf_pt pconf);
+void bench_close(void);
+int bench_connect(int port);
+bool bench_roundtrip(int fd, const char * msg, size_t len, bool send);
+bool bench_readline(int fd);
+size_t cli_written(void);
+double now_sec(void);
+int cmp_double(const void * a, const void * b);
+
+// ---- Benchmark modes:
+struct bench_mode{
+    const char * mname;
+    const char * margs;
+    int (*mfn)(int, char **);
+};
+const struct bench_mode bench_modes[] = {
+    {"zerocopy", "[remote]", bench_zerocopy},
+    {"syscalls", "[messages]", bench_syscalls},
+    {"pingpong", "[round trips] [spin usec] [cpu]", bench_pingpong},
+    {"proxy", "[round trips] [MB]", bench_proxy},
+    {"inject", "[connections] [messages]", bench_inject}
+};
+
+// ---- Main program:
+int main(int argc, char ** argv){
+    // Benchmark mode (its own arguments after it):
+    size_t nmodes = sizeof(bench_modes) / sizeof(bench_modes[0]);
+    for (size_t i = 0; (argc > 1) && (i < nmodes); i++){
+        if (!strcmp(argv[1], bench_modes[i].mname)) return bench_modes[i].mfn(argc - 2, argv + 2);
+    }
+
+    fprintf(stderr, "Use:\n");
+    for (size_t i = 0; i < nmodes; i++) fprintf(stderr, "\t%s %s %s\n", argv[0], bench_modes[i].mname, bench_modes[i].margs);
+    return 1;
+}
+
+// ---- Zero copy sends: publish throughput & sender cpu, copy vs MSG_ZEROCOPY:
+int bench_zerocopy(int argc, char ** argv){
+    // Arguments (external subscriber instead of the local reader, e.g. 'nc <server> 7895 > /dev/null'):
+    bool remote = (argc > 0) && !strcmp(argv[0], "remote");
+    if ((argc > 1) || ((argc > 0) && !remote)) {
+        fprintf(stderr, "Use: zerocopy [remote]\n");
+        return 1;
+    }
+    const size_t sizes[] = {4096, 65536, 262144, 1048576, 4194304};
+    const size_t nsizes = sizeof(sizes) / sizeof(sizes[0]);
+    char * payload = malloc(sizes[nsizes - 1]);
+    if (!payload) return 1;
+    memset(payload, 'z', sizes[nsizes - 1]);
+
+    printf("%-9s %10s %10s %12s %12s %10s %10s\n", "mode", "size", "MB/s", "cpu ms", "cpu us/MB", "zc sends", "zc copied");
+    for (int zc = 0; zc < 2; zc++){
+        // Server (single subthread, the sender measured), zero copy for the payloads tested:
+        if (!bench_open(&(dmserver_servconn_conf_t){.sport=BENCH_PORT, .ssa_family=AF_INET, .stcp_zerocopy_min=zc ? sizes[0] : 0},
+            &(dmserver_worker_conf_t){.wth_subthreads=1, .wth_clispersth=8, .wth_clistimeout=600},
+            &(dmserver_callback_conf_t){.on_client_connect = conn_fn}, NULL)) return 1;
+
+        // Subscriber (local reader thread or external connection):
+        pthread_t reader;
+        if (!remote && pthread_create(&reader, NULL, reader_fn, NULL)) return 1;
+        if (remote) printf("Waiting for the subscriber on port %d...\n", BENCH_PORT);
+        while (!__atomic_load_n(&bench_cli, __ATOMIC_ACQUIRE)) usleep(1000);
+        if (!dmserver_subscribe(serv, &bench_cli->cloc, BENCH_TOPIC)) return 1;
+
+        clockid_t cpuclk;
+        if (pthread_getcpuclockid(serv->sworker.wsubth[0], &cpuclk)) return 1;
+        for (size_t s = 0; s < nsizes; s++){
+            // Windowed publish (never more than BENCH_WINDOW messages pending, nothing dropped):
+            size_t count = BENCH_RUNBYTES / sizes[s];
+            size_t base = cli_written();
+            dmserver_zerocopy_stats_t zs0, zs1;
+            dmserver_get_zcstats(serv, &zs0);
+            struct timespec cpu0, cpu1;
+            clock_gettime(cpuclk, &cpu0);
+            double t0 = now_sec();
+            for (size_t i = 0; i < count; i++){
+                while ((i - (cli_written() - base) / sizes[s]) >= BENCH_WINDOW) sched_yield();
+                if (!dmserver_publish(serv, BENCH_TOPIC, payload, sizes[s])) return 1;
+            }
+            while (cli_written() - base < count * sizes[s]) sched_yield();
+            double t1 = now_sec();
+            clock_gettime(cpuclk, &cpu1);
+            dmserver_get_zcstats(serv, &zs1);
+
+            // Throughput & sender subthread cpu time:
+            double mb = (double)(count * sizes[s]) / (1 << 20);
+            double cpums = (cpu1.tv_sec - cpu0.tv_sec) * 1e3 + (cpu1.tv_nsec - cpu0.tv_nsec) / 1e6;
+            printf("%-9s %10lu %10.1f %12.1f %12.1f %10lu %10lu\n", zc ? "zerocopy" : "copy", sizes[s], mb / (t1 - t0), cpums, cpums * 1e3 / mb,
+                zs1.zsends - zs0.zsends, zs1.zcopied - zs0.zcopied);
+        }
+
+        // Server & reader shutdown:
+        bench_stop = true;
+        dmserver_stop(serv);
+        if (!remote) pthread_join(reader, NULL);
+        bench_close();
+    }
+
+    printf("Loopback connections are always completed as copied (zc copied), run with 'remote' for the real path.\n");
+    free(payload);
+    return 0;
+}
+
+// ---- Syscalls per message: server threads syscalls of unicast round trips (reception callback echo
+// flushed at the end of the round & unicast from a foreign thread waking the subthread):
+int bench_syscalls(int argc, char ** argv){
+    size_t n = (argc > 0) ? strtoul(argv[0], NULL, 10) : BENCH_MSGS;
+    if (n == 0) {
+        fprintf(stderr, "Use: syscalls [messages]\n");
+        return 1;
+    }
+
+    // Server (single subthread, echo of every message) & client driven from this thread (uncounted):
+    bench_uncounted = true;
+    if (!bench_open(&(dmserver_servconn_conf_t){.sport=BENCH_PORT, .ssa_family=AF_INET},
+        &(dmserver_worker_conf_t){.wth_subthreads=1, .wth_clispersth=8, .wth_clistimeout=600},
+        &(dmserver_callback_conf_t){.on_client_connect = conn_fn, .on_client_rcv = echo_fn}, NULL)) return 1;
+    int fd = bench_connect(BENCH_PORT);
+    if (fd < 0) return 1;
+    while (!__atomic_load_n(&bench_cli, __ATOMIC_ACQUIRE)) usleep(1000);
+
+    printf("%-9s %10s", "path", "messages");
+    for (size_t s = 0; s < BENCH_SC_COUNT; s++) printf(" %13s", bench_scnames[s]);
+    printf(" %9s\n", "total/msg");
+    size_t len = strlen(BENCH_MSG);
+    for (int foreign = 0; foreign < 2; foreign++){
+        memset(bench_sc, 0, sizeof(bench_sc));
+        __atomic_store_n(&bench_counting, true, __ATOMIC_RELEASE);
+        for (size_t i = 0; i < n; i++){
+            // Foreign unicast counted (subthread wake up), the client side never:
+            if (foreign) {
+                bench_uncounted = false;
+                bool ok = dmserver_unicast(serv, &bench_cli->cloc, BENCH_MSG);
+                bench_uncounted = true;
+                if (!ok) return 1;
+            }
+            if (!bench_roundtrip(fd, BENCH_MSG, len, !foreign)) return 1;
+        }
+        __atomic_store_n(&bench_counting, false, __ATOMIC_RELEASE);
+
+        size_t total = 0;
+        printf("%-9s %10lu", foreign ? "foreign" : "callback", n);
+        for (size_t s = 0; s < BENCH_SC_COUNT; s++){
+            size_t c = __atomic_load_n(&bench_sc[s], __ATOMIC_RELAXED);
+            printf(" %13lu", c);
+            total += c;
+        }
+        printf(" %9.2f\n", (double)total / n);
+    }
+
+    close(fd);
+    dmserver_stop(serv);
+    bench_close();
+    return 0;
+}
+
+// ---- Ping-pong latency: loopback unicast echo round trips with the subthread blocking in epoll_wait
+// and busy polling (spin budget), optionally pinned to a cpu:
+int bench_pingpong(int argc, char ** argv){
+    size_t n = (argc > 0) ? strtoul(argv[0], NULL, 10) : BENCH_MSGS;
+    size_t spin = (argc > 1) ? strtoul(argv[1], NULL, 10) : BENCH_SPINUSEC;
+    int cpu = (argc > 2) ? atoi(argv[2]) : -1;
+    if ((n == 0) || (spin == 0) || (argc > 3)) {
+        fprintf(stderr, "Use: pingpong [round trips] [spin usec] [cpu]\n");
+        return 1;
+    }
+    double * rtt = malloc(n * sizeof(double));
+    if (!rtt) return 1;
+
+    printf("%-9s %10s %10s %10s %10s %10s\n", "mode", "trips", "avg us", "p50 us", "p99 us", "max us");
+    size_t len = strlen(BENCH_MSG);
+    for (int busy = 0; busy < 2; busy++){
+        // Server (single subthread, echo of every message), blocking or spinning:
+        if (!bench_open(&(dmserver_servconn_conf_t){.sport=BENCH_PORT, .ssa_family=AF_INET, .stcp_nodelay=true},
+            &(dmserver_worker_conf_t){.wth_subthreads=1, .wth_clispersth=8, .wth_clistimeout=600, .wth_busypoll_usec=busy ? spin : 0,
+                .wth_cpus=(cpu >= 0) ? &cpu : NULL, .wth_ncpus=(cpu >= 0) ? 1 : 0},
+            &(dmserver_callback_conf_t){.on_client_connect = conn_fn, .on_client_rcv = echo_fn}, NULL)) return 1;
+        int fd = bench_connect(BENCH_PORT);
+        if (fd < 0) return 1;
+        while (!__atomic_load_n(&bench_cli, __ATOMIC_ACQUIRE)) usleep(1000);
+
+        // Round trips (warm up discarded), latency sorted for the percentiles:
+        for (size_t i = 0; i < BENCH_WARMUP; i++) if (!bench_roundtrip(fd, BENCH_MSG, len, true)) return 1;
+        double sum = 0;
+        for (size_t i = 0; i < n; i++){
+            double t0 = now_sec();
+            if (!bench_roundtrip(fd, BENCH_MSG, len, true)) return 1;
+            rtt[i] = (now_sec() - t0) * 1e6;
+            sum += rtt[i];
+        }
+        qsort(rtt, n, sizeof(double), cmp_double);
+        printf("%-9s %10lu %10.1f %10.1f %10.1f %10.1f\n", busy ? "busypoll" : "blocking", n, sum / n, rtt[n / 2], rtt[(n * 99) / 100], rtt[n - 1]);
+
+        close(fd);
+        dmserver_stop(serv);
+        bench_close();
+    }
+
+    free(rtt);
+    return 0;
+}
+
+// ---- Proxy mode: round trips & bulk echo (both ways at once) against a local upstream echo server,
+// straight to it and through the proxy listener (splice pairs):
+int bench_proxy(int argc, char ** argv){
+    size_t n = (argc > 0) ? strtoul(argv[0], NULL, 10) : BENCH_MSGS;
+    size_t mb = (argc > 1) ? strtoul(argv[1], NULL, 10) : BENCH_PROXYMB;
+    if ((n == 0) || (mb == 0) || (argc > 2)) {
+        fprintf(stderr, "Use: proxy [round trips] [MB]\n");
+        return 1;
+    }
+
+    // Upstream echo server (thread per connection):
+    int upfd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in sa = {.sin_family=AF_INET, .sin_port=htons(BENCH_UPPORT), .sin_addr.s_addr=htonl(INADDR_LOOPBACK)};
+    setsockopt(upfd, SOL_SOCKET, SO_REUSEADDR, &(int){1}, sizeof(int));
+    if ((upfd < 0) || (bind(upfd, (struct sockaddr *)&sa, sizeof(sa)) < 0) || (listen(upfd, 16) < 0)) return 1;
+    pthread_t upth;
+    if (pthread_create(&upth, NULL, upecho_fn, &upfd)) return 1;
+    pthread_detach(upth);
+
+    // Proxy listener (single subthread) to the upstream:
+    if (!bench_open(&(dmserver_servconn_conf_t){.sport=BENCH_PORT, .ssa_family=AF_INET, .stcp_nodelay=true},
+        &(dmserver_worker_conf_t){.wth_subthreads=1, .wth_clispersth=8, .wth_clistimeout=600},
+        &(dmserver_callback_conf_t){.on_client_connect = conn_fn},
+        &(dmserver_proxy_conf_t){.phost="127.0.0.1", .pport=BENCH_UPPORT})) return 1;
+    clockid_t cpuclk;
+    if (pthread_getcpuclockid(serv->sworker.wsubth[0], &cpuclk)) return 1;
+
+    printf("%-9s %10s %10s %10s %12s\n", "path", "trips", "avg us", "MB/s", "proxy cpu ms");
+    size_t len = strlen(BENCH_MSG);
+    size_t total = mb << 20;
+    char * buf = malloc(BENCH_CHUNK);
+    if (!buf) return 1;
+    for (int proxied = 0; proxied < 2; proxied++){
+        int fd = bench_connect(proxied ? BENCH_PORT : BENCH_UPPORT);
+        if (fd < 0) return 1;
+
+        // Round trips (warm up discarded):
+        for (size_t i = 0; i < BENCH_WARMUP; i++) if (!bench_roundtrip(fd, BENCH_MSG, len, true)) return 1;
+        double t0 = now_sec();
+        for (size_t i = 0; i < n; i++) if (!bench_roundtrip(fd, BENCH_MSG, len, true)) return 1;
+        double rtt = (now_sec() - t0) * 1e6 / n;
+
+        // Bulk echo, written by another thread & read back here:
+        struct timespec cpu0, cpu1;
+        clock_gettime(cpuclk, &cpu0);
+        t0 = now_sec();
+        pthread_t wth;
+        size_t wargs[2] = {(size_t)fd, total};
+        if (pthread_create(&wth, NULL, bulk_writer_fn, wargs)) return 1;
+        for (size_t rb = 0; rb < total; ){
+            ssize_t r = read(fd, buf, BENCH_CHUNK);
+            if (r <= 0) return 1;
+            rb += r;
+        }
+        double t1 = now_sec();
+        clock_gettime(cpuclk, &cpu1);
+        pthread_join(wth, NULL);
+
+        double cpums = (cpu1.tv_sec - cpu0.tv_sec) * 1e3 + (cpu1.tv_nsec - cpu0.tv_nsec) / 1e6;
+        if (proxied) printf("%-9s %10lu %10.1f %10.1f %12.1f\n", "proxy", n, rtt, mb / (t1 - t0), cpums);
+        else printf("%-9s %10lu %10.1f %10.1f %12s\n", "direct", n, rtt, mb / (t1 - t0), "-");
+        close(fd);
+    }
+
+    // Bytes relayed by the pairs (once stopped):
+    free(buf);
+    dmserver_stop(serv);
+    dmserver_proxy_stats_t ps;
+    dmserver_get_proxystats(serv, &ps);
+    printf("Pairs: %lu (failed %lu), relayed: %lu bytes to the upstream, %lu bytes back.\n", ps.ppairs, ps.pfailed, ps.pbytes_c2u, ps.pbytes_u2c);
+    bench_close();
+    close(upfd);
+    return 0;
+}
+
+// ---- Injected clients: socketpairs injected into the subthread (no listener / network), orders pushed
+// through a sample reception callback with the virtual clock set, then all timed out by advancing it:
+int bench_inject(int argc, char ** argv){
+    size_t nconns = (argc > 0) ? strtoul(argv[0], NULL, 10) : BENCH_INJCONNS;
+    size_t n = (argc > 1) ? strtoul(argv[1], NULL, 10) : BENCH_MSGS;
+    if ((nconns == 0) || (n < nconns) || (argc > 2)) {
+        fprintf(stderr, "Use: inject [connections] [messages] (messages >= connections)\n");
+        return 1;
+    }
+    int * fds = malloc(nconns * sizeof(int));
+    if (!fds) return 1;
+
+    // Server (single subthread, sample order handler) on the virtual clock, pairs injected:
+    if (!bench_open(&(dmserver_servconn_conf_t){.sport=BENCH_PORT, .ssa_family=AF_INET},
+        &(dmserver_worker_conf_t){.wth_subthreads=1, .wth_clispersth=nconns, .wth_clistimeout=BENCH_TIMEOUT},
+        &(dmserver_callback_conf_t){.on_client_connect = conn_fn, .on_client_rcv = order_fn, .on_client_timeout = timeout_fn}, NULL)) return 1;
+    if (!dmserver_set_clock(serv, BENCH_CLOCK)) return 1;
+    for (size_t i = 0; i < nconns; i++) if (!dmserver_inject(serv, 0, &fds[i])) return 1;
+    while (__atomic_load_n(&bench_conns, __ATOMIC_ACQUIRE) < nconns) usleep(1000);
+
+    // Orders written to every connection, then every acknowledgement read (one in flight each):
+    size_t rounds = n / nconns, sent = 0;
+    char msg[64];
+    double t0 = now_sec();
+    for (size_t r = 0; r < rounds; r++){
+        for (size_t i = 0; i < nconns; i++, sent++){
+            int len = snprintf(msg, sizeof(msg), "id=%lu qty=%lu px=%lu\n", sent, 1 + (sent % 100), 100 + (sent % 7));
+            if (write(fds[i], msg, len) != len) return 1;
+        }
+        for (size_t i = 0; i < nconns; i++) if (!bench_readline(fds[i])) return 1;
+    }
+    double elapsed = now_sec() - t0;
+
+    // Virtual clock advanced past the timeout, every client timed out by its subthread:
+    double t1 = now_sec();
+    if (!dmserver_set_clock(serv, BENCH_CLOCK + BENCH_TIMEOUT + 1)) return 1;
+    while ((__atomic_load_n(&bench_timeouts, __ATOMIC_ACQUIRE) < nconns) && (now_sec() - t1 < 5)) usleep(100);
+    double toelapsed = now_sec() - t1;
+
+    printf("%-11s %10s %10s %10s %12s %12s %12s\n", "connections", "messages", "us/msg", "msgs/s", "orders", "timeouts", "timeouts ms");
+    printf("%-11lu %10lu %10.2f %10.0f %12lu %12lu %12.2f\n", nconns, sent, (elapsed * 1e6) / sent, sent / elapsed,
+        __atomic_load_n(&bench_orders, __ATOMIC_RELAXED), __atomic_load_n(&bench_timeouts, __ATOMIC_RELAXED), toelapsed * 1e3);
+
+    for (size_t i = 0; i < nconns; i++) close(fds[i]);
+    free(fds);
+    dmserver_stop(serv);
+    bench_close();
+    return (bench_timeouts == nconns) ? 0 : 1;
+}
+
+// ---- Callback & helper functions:
+void conn_fn(dmserver_cliconn_pt cli){
+    // First client connected kept as the benchmark one, all counted:
+    dmserver_cliconn_pt none = NULL;
+    __atomic_compare_exchange_n(&bench_cli, &none, cli, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&bench_conns, 1, __ATOMIC_RELEASE);
+}
+
+void echo_fn(dmserver_cliconn_pt cli){
+    dmserver_unicast(serv, &cli->cloc, cli->crbuffer);
+}
+
+void order_fn(dmserver_cliconn_pt cli){
+    // Sample handler: order parsed ('id=<n> qty=<n> px=<n>'), its notional added & acknowledged:
+    size_t id, qty, px;
+    if (sscanf(cli->crbuffer, "id=%lu qty=%lu px=%lu", &id, &qty, &px) != 3) return;
+    __atomic_add_fetch(&bench_orders, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&bench_notional, qty * px, __ATOMIC_RELAXED);
+    char ack[32];
+    snprintf(ack, sizeof(ack), "ack %lu\n", id);
+    dmserver_unicast(serv, &cli->cloc, ack);
+}
+
+void timeout_fn(dmserver_cliconn_pt cli){
+    (void)cli;
+    __atomic_add_fetch(&bench_timeouts, 1, __ATOMIC_RELEASE);
+}
+
+void * reader_fn(void * arg){
+    (void)arg;
+    int fd = bench_connect(BENCH_PORT);
+    if (fd < 0) exit(1);
+
+    // Drain everything until the benchmark is over:
+    struct timeval tv = {.tv_sec=0, .tv_usec=100000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    static char buf[1 << 20];
+    while (!bench_stop){
+        if ((read(fd, buf, sizeof(buf)) == 0)) break;
+    }
+    close(fd);
+    return NULL;
+}
+
+void * upecho_fn(void * arg){
+    // Upstream echo server connections (each one echoed by its own thread):
+    int upfd = *(int *)arg;
+    for (int cfd; (cfd = accept(upfd, NULL, NULL)) >= 0; ){
+        pthread_t th;
+        if (pthread_create(&th, NULL, upecho_conn_fn, (void *)(intptr_t)cfd)) close(cfd);
+        else pthread_detach(th);
+    }
+    return NULL;
+}
+
+void * upecho_conn_fn(void * arg){
+    int cfd = (int)(intptr_t)arg;
+    char * buf = malloc(BENCH_CHUNK);
+    setsockopt(cfd, IPPROTO_TCP, TCP_NODELAY, &(int){1}, sizeof(int));
+    for (ssize_t r; buf && ((r = read(cfd, buf, BENCH_CHUNK)) > 0); ){
+        for (ssize_t wb = 0, w; wb < r; wb += w) if ((w = write(cfd, buf + wb, r - wb)) <= 0) r = 0;
+    }
+    free(buf);
+    close(cfd);
+    return NULL;
+}
+
+void * bulk_writer_fn(void * arg){
+    // Bulk of bytes written in chunks (fd & length):
+    size_t * wargs = arg;
+    static char chunk[BENCH_CHUNK];
+    memset(chunk, 'p', sizeof(chunk));
+    for (size_t wb = 0; wb < wargs[1]; ){
+        size_t len = (wargs[1] - wb < sizeof(chunk)) ? wargs[1] - wb : sizeof(chunk);
+        ssize_t w = write((int)wargs[0], chunk, len);
+        if (w <= 0) break;
+        wb += w;
+    }
+    return NULL;
+}
+
+bool bench_open(dmserver_servconn_conf_pt sconf, dmserver_worker_conf_pt wconf, dmserver_callback_conf_pt cbconf, dmserver_proxy_conf_pt pconf){
+    // Server initialization (errors only logged), configuration (proxy listener optional), open & run:
+    bench_cli = NULL;
+    bench_stop = false;
+    bench_conns = bench_timeouts = bench_orders = bench_notional = 0;
+    dmserver_init(&serv);
+    if (serv == NULL) return false;
+    if (!dmlogger_conf_logger_minlvl(serv->slogger, DMLOGGER_LEVEL_ERROR)) return false;
+    if (!dmserver_conf_sconn(serv, sconf) || !dmserver_conf_worker(serv, wconf) || !dmserver_set_cb(serv, cbconf)) return false;
+    if (pconf && !dmserver_conf_proxy(serv, 0, pconf)) return false;
+    return dmserver_open(serv) && dmserver_run(serv);
+}
+
+void bench_close(void){
+    dmserver_close(serv);
+    dmserver_deinit(&serv);
+}
+
+int bench_connect(int port){
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in sa = {.sin_family=AF_INET, .sin_port=htons(port), .sin_addr.s_addr=htonl(INADDR_LOOPBACK)};
+    if ((fd >= 0) && (connect(fd, (struct sockaddr *)&sa, sizeof(sa)) < 0)) {
+        close(fd);
+        return -1;
+    }
+    if (fd >= 0) setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &(int){1}, sizeof(int));
+    return fd;
+}
+
+bool bench_roundtrip(int fd, const char * msg, size_t len, bool send){
+    // Message sent (optional) & the same length read back:
+    char buf[256];
+    if (send && (write(fd, msg, len) != (ssize_t)len)) return false;
+    for (size_t rb = 0; rb < len; ){
+        ssize_t r = read(fd, buf, sizeof(buf));
+        if (r <= 0) return false;
+        rb += r;
+    }
+    return true;
+}
+
+bool bench_readline(int fd){
+    // Reply read up to its end of line:
+    char buf[256];
+    for (ssize_t r = 0; (r == 0) || (buf[r - 1] != '\n'); ){
+        ssize_t rr = read(fd, buf + r, sizeof(buf) - r);
+        if ((rr <= 0) || ((size_t)(r + rr) >= sizeof(buf))) return false;
+        r += rr;
+    }
+    return true;
+}
+
+size_t cli_written(void){
+    return __atomic_load_n(&bench_cli->cwbytes, __ATOMIC_RELAXED);
+}
+
+double now_sec(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int cmp_double(const void * a, const void * b){
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// ---- Syscalls interposed (the library is linked in, its calls resolve here first):
+#define BENCH_REAL(ret, name, ...) \
+    static ret (*real)(__VA_ARGS__); \
+    if (!real) real = (ret (*)(__VA_ARGS__))dlsym(RTLD_NEXT, name)
+
+static void bench_count(enum bench_syscall sc){
+    if (__atomic_load_n(&bench_counting, __ATOMIC_ACQUIRE) && !bench_uncounted) __atomic_add_fetch(&bench_sc[sc], 1, __ATOMIC_RELAXED);
+}
+
+ssize_t read(int fd, void * buf, size_t len){
+    BENCH_REAL(ssize_t, "read", int, void *, size_t);
+    bench_count(BENCH_SC_READ);
+    return real(fd, buf, len);
+}
+
+ssize_t write(int fd, const void * buf, size_t len){
+    BENCH_REAL(ssize_t, "write", int, const void *, size_t);
+    bench_count(BENCH_SC_WRITE);
+    return real(fd, buf, len);
+}
+
+ssize_t readv(int fd, const struct iovec * iov, int iovcnt){
+    BENCH_REAL(ssize_t, "readv", int, const struct iovec *, int);
+    bench_count(BENCH_SC_READV);
+    return real(fd, iov, iovcnt);
+}
+
+ssize_t writev(int fd, const struct iovec * iov, int iovcnt){
+    BENCH_REAL(ssize_t, "writev", int, const struct iovec *, int);
+    bench_count(BENCH_SC_WRITEV);
+    return real(fd, iov, iovcnt);
+}
+
+ssize_t recvmsg(int fd, struct msghdr * msg, int flags){
+    BENCH_REAL(ssize_t, "recvmsg", int, struct msghdr *, int);
+    bench_count(BENCH_SC_RECVMSG);
+    return real(fd, msg, flags);
+}
+
+ssize_t sendmsg(int fd, const struct msghdr * msg, int flags){
+    BENCH_REAL(ssize_t, "sendmsg", int, const struct msghdr *, int);
+    bench_count(BENCH_SC_SENDMSG);
+    return real(fd, msg, flags);
+}
+
+int epoll_wait(int epfd, struct epoll_event * evs, int maxevs, int timeout){
+    BENCH_REAL(int, "epoll_wait", int, struct epoll_event *, int, int);
+    bench_count(BENCH_SC_EPOLLWAIT);
+    return real(epfd, evs, maxevs, timeout);
+}
+
+int epoll_ctl(int epfd, int op, int fd, struct epoll_event * ev){
+    BENCH_REAL(int, "epoll_ctl", int, int, int, struct epoll_event *);
+    bench_count(BENCH_SC_EPOLLCTL);
+    return real(epfd, op, fd, ev);
+}
+
+int eventfd_read(int fd, eventfd_t * value){
+    BENCH_REAL(int, "eventfd_read", int, eventfd_t *);
+    bench_count(BENCH_SC_EVFDREAD);
+    return real(fd, value);
+}
+
+int eventfd_write(int fd, eventfd_t value){
+    BENCH_REAL(int, "eventfd_write", int, eventfd_t);
+    bench_count(BENCH_SC_EVFDWRITE);
+    return real(fd, value);
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#include "./inc/dmserver.h"
+
+// ---- Main program:
+int main(int argc, char ** argv){
+    // Arguments (capture file, target server & optional time scale / datagram sessions):
+    if ((argc < 4) || (argc > 6)) {
+        fprintf(stderr, "Use: %s <capture file> <host|unix path> <port> [speed] [udp]\n", argv[0]);
+        exit(1);
+    }
+    dmserver_replay_conf_t conf = {
+        .rpath=argv[1],
+        .rhost=argv[2],
+        .rport=(uint16_t)atoi(argv[3]),
+        .rsocktype=((argc > 5) && (strcmp(argv[5], "udp") == 0)) ? SOCK_DGRAM : SOCK_STREAM,
+        .rspeed=(argc > 4) ? atof(argv[4]) : 1.0
+    };
+
+    // Capture replay against the server:
+    dmserver_replay_stats_t stats = {0};
+    bool ok = dmserver_replay(&conf, &stats);
+    printf("Sessions: %lu, records: %lu, sent: %lu bytes, received: %lu bytes, max lag: %lu usec.\n",
+        stats.rsessions, stats.rrecords, stats.rbytes_sent, stats.rbytes_rcvd, stats.rmax_lag_usec);
+
+    return ok ? 0 : 1;
+}
\ No newline at end of file
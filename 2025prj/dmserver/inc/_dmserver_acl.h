@@ -0,0 +1,68 @@
+/*
+
+*/
+
+/* ---- Header guard ---------------------------------------------- */
+#ifndef _DMSERVER_ACL_HEADER
+#define _DMSERVER_ACL_HEADER
+
+/* ---- Libraries ------------------------------------------------- */
+#include "_dmserver_hdrs.h"
+
+/* ---- Defines  -------------------------------------------------- */
+#define DEFAULT_ACL_CIDRLEN (INET6_ADDRSTRLEN + 4)
+
+/* ---- Enumerations: Access action ------------------------------- */
+enum dmserver_acl_action{
+    DMSERVER_ACL_ALLOW,
+    DMSERVER_ACL_DENY
+};
+
+/* ---- Data structures ------------------------------------------- */
+// Access rule, a prefix in CIDR notation ("10.0.0.0/8", "2001:db8::/32", address alone for a host):
+struct dmserver_acl_rule{
+    const char * acidr;
+    enum dmserver_acl_action aaction;
+};
+
+// Prefix trie node (children by the next address bit, 0 none; action -1 on nodes without rule):
+struct dmserver_aclnode{
+    uint32_t nchild[2];
+    int8_t naction;
+};
+
+// Prefixes table, binary trie (node 0 IPv4 root, node 1 IPv6 root) with the action for the
+// addresses without matching prefix:
+struct dmserver_acltable{
+    struct dmserver_aclnode * tnodes;
+    size_t tnodes_count;
+    size_t tnodes_size;
+    enum dmserver_acl_action tdefault;
+};
+
+// Access control list (longest prefix match), the table is replaced as a whole on reload:
+struct dmserver_acl{
+    struct dmserver_acltable * atable;
+    pthread_rwlock_t alock;
+    size_t adenied;
+};
+
+/* ---- Data types ------------------------------------------------ */
+typedef struct dmserver_acl dmserver_acl_t;
+typedef dmserver_acl_t * dmserver_acl_pt;
+
+typedef struct dmserver_acl_rule dmserver_acl_rule_t;
+typedef dmserver_acl_rule_t * dmserver_acl_rule_pt;
+
+/* ---- INTERNAL - Static functions prototypes -------------------- */
+// Access control list:
+bool _dmserver_acl_init(dmserver_acl_pt a);
+bool _dmserver_acl_deinit(dmserver_acl_pt a);
+
+// Access control list reload (new table built aside, swapped under the write lock):
+bool _dmserver_acl_load(dmserver_acl_pt a, const dmserver_acl_rule_t * rules, size_t nrules, enum dmserver_acl_action adefault);
+
+// Access control list check of a source address (allowed without table or non IP addresses):
+bool _dmserver_acl_check(dmserver_acl_pt a, struct sockaddr_storage * caddr);
+
+#endif
\ No newline at end of file
@@ -11,6 +11,16 @@
 #include "_dmserver_cliconn.h"
 
 /* ---- Data structures ------------------------------------------- */
+// Received message view (client + read data) for batched reception:
+struct dmserver_rcvmsg{
+    dmserver_cliconn_pt cli;
+    const char * data;
+    size_t len;
+
+    // Client slot generation at the read (entries of slots reset meanwhile are dropped):
+    size_t gen;
+};
+
 // DMServer callbacks reference data structure:
 struct dmserver_callback{
     // Callbacks available:
@@ -19,9 +29,19 @@ struct dmserver_callback{
     void (*on_client_timeout)(dmserver_cliconn_pt cli);
     void (*on_client_rcv)(dmserver_cliconn_pt cli);
     void (*on_client_snd)(dmserver_cliconn_pt cli);
+
+    // Batched reception (replaces on_client_rcv when set):
+    void (*on_client_rcv_batch)(struct dmserver_rcvmsg * msgs, size_t nmsgs);
+
+    // Overload state change of a subordinate thread (called from that subthread):
+    void (*on_overload)(size_t subthread, bool overloaded);
 };
 
 /* ---- Data types ------------------------------------------------ */
+// Received message view for batched reception:
+typedef struct dmserver_rcvmsg dmserver_rcvmsg_t;
+typedef dmserver_rcvmsg_t * dmserver_rcvmsg_pt;
+
 // Callback structure & callback configuration structure:
 typedef struct dmserver_callback dmserver_callback_t;
 typedef dmserver_callback_t * dmserver_callback_pt;
@@ -36,5 +56,7 @@ void __dmserver_setcb_onclientdisconnect(dmserver_callback_pt cb, void (*on_clie
 void __dmserver_setcb_onclienttimeout(dmserver_callback_pt cb, void (*on_client_timeout)(dmserver_cliconn_pt));
 void __dmserver_setcb_onclientrcv(dmserver_callback_pt cb, void (*on_client_rcv)(dmserver_cliconn_pt));
 void __dmserver_setcb_onclientsnd(dmserver_callback_pt cb, void (*on_client_snd)(dmserver_cliconn_pt));
+void __dmserver_setcb_onclientrcvbatch(dmserver_callback_pt cb, void (*on_client_rcv_batch)(dmserver_rcvmsg_pt, size_t));
+void __dmserver_setcb_onoverload(dmserver_callback_pt cb, void (*on_overload)(size_t, bool));
 
 #endif
\ No newline at end of file
@@ -0,0 +1,137 @@
+/*
+
+*/
+
+/* ---- Header guard ---------------------------------------------- */
+#ifndef _DMSERVER_CAPTURE_HEADER
+#define _DMSERVER_CAPTURE_HEADER
+
+/* ---- Libraries ------------------------------------------------- */
+#include "_dmserver_hdrs.h"
+#include "_dmserver_cliconn.h"
+
+/* ---- Defines  -------------------------------------------------- */
+#define DEFAULT_CAPTURE_BUFLEN (1 << 20)
+#define DEFAULT_CAPTURE_BUFMINLEN 4096
+#define DEFAULT_CAPTURE_FLUSHMS 100
+#define DEFAULT_CAPTURE_MAGIC 0x50434d44u
+#define DEFAULT_CAPTURE_VERSION 1
+#define DEFAULT_CAPTURE_REPLAYEVS 64
+
+/* ---- Enumerations: Capture record type ------------------------- */
+enum dmserver_capture_dir{
+    DMSERVER_CAPTURE_IN,
+    DMSERVER_CAPTURE_OUT,
+    DMSERVER_CAPTURE_CONNECT,
+    DMSERVER_CAPTURE_DISCONNECT
+};
+
+/* ---- Data structures ------------------------------------------- */
+// Capture file header (the records follow it):
+struct dmserver_caphdr{
+    uint32_t hmagic;
+    uint32_t hversion;
+    int64_t hstart_ns;
+};
+
+// Capture record (payload of rlen bytes after it, next record 8 bytes aligned): time since the start
+// of the capture in ns, connection slot & its transport, record type. Records of different threads
+// are not in time order in the file:
+struct dmserver_caprec{
+    uint64_t rts_ns;
+    uint32_t rth;
+    uint32_t rslot;
+    uint32_t rlen;
+    uint8_t rdir;
+    uint8_t rtransport;
+    uint16_t rpad;
+};
+
+// Capture buffer of a recording thread: the active block takes its records, a full block is written
+// by the capture writer thread that gives it back as spare (records dropped if the active block fills
+// up meanwhile). Kept until the capture is deinitialized, blocks detached when it stops:
+struct dmserver_capbuf{
+    struct dmserver_capbuf * bnext;
+    pthread_t bowner;
+    pthread_mutex_t block;
+    char * bactive;
+    size_t bactive_len;
+    char * bfull;
+    size_t bfull_len;
+    char * bspare;
+};
+
+// Capture counters (records & payload bytes taken, records dropped, bytes written to the file):
+struct dmserver_capture_stats{
+    size_t crecords;
+    size_t cbytes;
+    size_t cdropped;
+    size_t cwritten;
+};
+
+// Traffic capture of the worker read/write paths (payloads before encryption) to a binary file: a
+// buffer per recording thread flushed by a writer thread, the recording threads never block on it:
+struct dmserver_capture{
+    bool cenabled;
+    uint64_t cid;
+    int cfd;
+    long cstart_ns;
+    size_t cbuf_size;
+
+    // Buffers of the recording threads (appended under lock) & writer thread:
+    struct dmserver_capbuf * cbufs;
+    pthread_mutex_t clock;
+    pthread_cond_t ccond;
+    pthread_t cwriter;
+    bool cwriter_run;
+
+    struct dmserver_capture_stats cstats;
+};
+
+// Replay counters (sessions opened, records & bytes sent, bytes received, highest lag behind the
+// original timing in usec):
+struct dmserver_replay_stats{
+    size_t rsessions;
+    size_t rrecords;
+    size_t rbytes_sent;
+    size_t rbytes_rcvd;
+    size_t rmax_lag_usec;
+};
+
+// Replay configuration: capture file, target server (host & port, or unix domain path starting with
+// '/'), socket type of every session & time scale (1 original timing, 2 twice as fast, 0 no waits):
+struct dmserver_replay_conf{
+    const char * rpath;
+    const char * rhost;
+    uint16_t rport;
+    int rsocktype;
+    double rspeed;
+};
+
+/* ---- Data types ------------------------------------------------ */
+typedef struct dmserver_capture dmserver_capture_t;
+typedef dmserver_capture_t * dmserver_capture_pt;
+
+typedef struct dmserver_capture_stats dmserver_capture_stats_t;
+typedef dmserver_capture_stats_t * dmserver_capture_stats_pt;
+
+typedef struct dmserver_replay_conf dmserver_replay_conf_t;
+typedef dmserver_replay_conf_t * dmserver_replay_conf_pt;
+
+typedef struct dmserver_replay_stats dmserver_replay_stats_t;
+typedef dmserver_replay_stats_t * dmserver_replay_stats_pt;
+
+/* ---- INTERNAL - Static functions prototypes -------------------- */
+// Capture:
+bool _dmserver_capture_init(dmserver_capture_pt cap);
+void _dmserver_capture_deinit(dmserver_capture_pt cap);
+bool _dmserver_capture_start(dmserver_capture_pt cap, const char * path, size_t buf_size);
+bool _dmserver_capture_stop(dmserver_capture_pt cap);
+
+// Capture records (any thread, nothing recorded while stopped):
+void _dmserver_capture_record(dmserver_capture_pt cap, enum dmserver_capture_dir dir, dmserver_cliconn_pt c, const char * data, size_t len);
+
+// Replay of a capture file (client side, inbound records sent to a test server):
+bool _dmserver_capture_replay(dmserver_replay_conf_pt conf, dmserver_replay_stats_pt stats);
+
+#endif
\ No newline at end of file
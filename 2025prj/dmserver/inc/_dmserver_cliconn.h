@@ -8,10 +8,18 @@
 
 /* ---- Libraries ------------------------------------------------- */
 #include "_dmserver_hdrs.h"
+#include "_dmserver_limits.h"
+#include "_dmserver_evsrc.h"
 
 /* ---- Defines  -------------------------------------------------- */
 #define DEFAULT_CCONN_RBUFFERLEN 4096
 #define DEFAULT_CCONN_WBUFFERLEN 4096
+#define DEFAULT_CCONN_WQUEUELEN 64
+#define DEFAULT_CCONN_MAXFDS 8
+#define DEFAULT_CCONN_ADDRSTRLEN (INET6_ADDRSTRLEN + 8)
+#define DEFAULT_CCONN_ARENALEN 0
+#define DEFAULT_CCONN_ARENAALIGN 16
+#define DEFAULT_CCONN_INFORETRIES 64
 
 /* ---- Enumerations: Cli state ----------------------------------- */
 enum dmserver_cconn_state{
@@ -22,7 +30,66 @@ enum dmserver_cconn_state{
     DMSERVER_CLIENT_CLOSED
 };
 
+/* ---- Enumerations: Cli transport ------------------------------- */
+enum dmserver_cconn_transport{
+    DMSERVER_TRANSPORT_STREAM,
+    DMSERVER_TRANSPORT_DGRAM,
+    DMSERVER_TRANSPORT_SHM
+};
+
 /* ---- Data structures ------------------------------------------- */
+// Listener connection & callbacks set (the client only keeps references to the ones of its listener):
+struct dmserver_servconn;
+struct dmserver_callback;
+struct dmserver_upstream;
+struct dmserver_proxytarget;
+
+// Shared output message (one payload referenced by all its recipients, freed with the last one):
+struct dmserver_cmsg{
+    size_t mrefs;
+
+    // Coalescing key, publish time & output memory counter (released with the message):
+    uint64_t mkey;
+    time_t mtime;
+    size_t * mbudget;
+
+    size_t mlen;
+    char mdata[];
+};
+
+// Shared message pinned by a zero copy send until the kernel completes it (send sequence number of
+// the socket, counted from 0 on every connection):
+struct dmserver_zcpin{
+    uint32_t pseq;
+    struct dmserver_cmsg * pmsg;
+};
+
+// Zero copy sends counters (sends & bytes, completions notified & the ones the kernel copied anyway):
+struct dmserver_zerocopy_stats{
+    size_t zsends;
+    size_t zbytes;
+    size_t zcompleted;
+    size_t zcopied;
+};
+
+// Arena chunk taken from the heap once the arena block is exhausted (freed on reset):
+struct dmserver_arenachunk{
+    struct dmserver_arenachunk * cnext;
+    size_t csize;
+    size_t cused;
+    char cdata[] __attribute__((aligned(DEFAULT_CCONN_ARENAALIGN)));
+};
+
+// Per connection bump arena: a block allocated with the slot buffers (0 length no arena), allocations
+// taken from its start & extended with heap chunks once exhausted. Reset as a whole with the slot
+// (block offset back to zero, chunks freed), nothing is freed on its own:
+struct dmserver_arena{
+    char * ablock;
+    size_t asize;
+    size_t aused;
+    struct dmserver_arenachunk * achunks;
+};
+
 // Client location data structure for dmserver:
 struct dmserver_cliloc{
     size_t th_pos;
@@ -31,11 +98,18 @@ struct dmserver_cliloc{
 
 // Client connection data structure for dmserver:
 struct dmserver_cliconn{
-    // Location of client:
+    // Subthread epoll event source (client socket):
+    struct dmserver_evsrc cevsrc;
+
+    // Location of client & generation of its slot (incremented on every reset, tells a reused slot
+    // apart from the client it had):
     struct dmserver_cliloc cloc;
+    size_t cgen;
 
-    // Connection data of a client:
+    // Connection data of a client (datagram sessions share the subthread socket, shared memory clients
+    // keep their unix domain socket only to detect the disconnection):
     int cfd;
+    enum dmserver_cconn_transport ctransport;
 
     sa_family_t caddr_family;
     union{
@@ -43,6 +117,9 @@ struct dmserver_cliconn{
         struct sockaddr_in6 c6;
     }caddr;
 
+    // Unix domain peer credentials (SO_PEERCRED, only for AF_UNIX clients):
+    struct ucred cpeercred;
+
     // Connection data of TLS of a client:
     SSL * cssl;
     BIO * cbio;
@@ -53,11 +130,91 @@ struct dmserver_cliconn{
     pthread_mutex_t crlock;
     size_t crlen;
 
+    // Kernel receive timestamp of the data in the read buffer (realtime clock, zero when the listener
+    // has no receive timestamps or the read carried none):
+    struct timespec crts;
+
+    // File descriptors received with the read data (AF_UNIX, closed after the reception callback 
+    // unless taken by setting them to -1):
+    int crfds[DEFAULT_CCONN_MAXFDS];
+    size_t crfdslen;
+
     size_t cwbuffer_size;
     char * cwbuffer;
     pthread_mutex_t cwlock;
     size_t cwlen;
 
+    // File descriptors to send with the write data (AF_UNIX, closed once sent):
+    int cwfds[DEFAULT_CCONN_MAXFDS];
+    size_t cwfdslen;
+
+    // Shared messages pending to write after the write buffer (ring of references, offset of the
+    // head message already written):
+    struct dmserver_cmsg ** cwq;
+    size_t cwq_size;
+    size_t cwq_head;
+    size_t cwq_count;
+    size_t cwq_off;
+    size_t cwq_bytes;
+
+    // Zero copy sends (MSG_ZEROCOPY) of the queued messages of at least czc_min bytes (0 disabled):
+    // messages pinned until their completion notification (ring of the queue length, send order) &
+    // sequence number of the next send:
+    size_t czc_min;
+    struct dmserver_zcpin * czc_pins;
+    size_t czc_head;
+    size_t czc_count;
+    uint32_t czc_seq;
+
+    // Slow consumer disconnection requested & disconnection requested by a foreign thread (both
+    // done by the client subthread):
+    bool cwkick;
+    bool cdisreq;
+
+    // Topics subscribed in the pub/sub index of the client subthread:
+    size_t csubs;
+
+    // Reception limits (source IP entry & own buckets arrival times), reads paused (input event
+    // removed) and pending in the deferred reads list of the subthread until the resume time:
+    struct dmserver_ipentry * cipentry;
+    int64_t cmsgs_tat;
+    int64_t cbytes_tat;
+    bool crpaused;
+    bool crdeferred;
+    long crresume;
+
+    // Bytes read recently (decayed on every overload shedding, the heaviest client is paused):
+    size_t crload;
+
+    // Write flush ctl (queued for end of round flush / output event armed on EAGAIN):
+    bool cwqueued;
+    bool cwarmed;
+
+    // Listener that accepted the client (connection data, TLS context & callbacks set):
+    struct dmserver_servconn * csconn;
+    struct dmserver_callback * ccallback;
+
+    // Outbound connection of an upstream pool member (NULL for accepted clients), connection in progress:
+    struct dmserver_upstream * cupstream;
+    size_t cupmember;
+    bool cconnecting;
+
+    // Proxy target of the listener that accepted the client (NULL not proxied, bytes relayed to it):
+    struct dmserver_proxytarget * cproxy;
+
+    // User context of the connection (NULL on accept, kept until the disconnection callback returns)
+    // & bump arena for its parsing and session state (reset with the slot):
+    void * cuser;
+    struct dmserver_arena carena;
+
+    // Registry record of the connection for inspection snapshots: sequence odd while its identity
+    // (location, socket, transport, address & connection time) is rewritten on connect/reset, and
+    // traffic counters (relaxed, only the slot owner adds):
+    uint32_t cseq;
+    time_t cconnt;
+    size_t crbytes;
+    size_t cwbytes;
+
     // Client state:
     enum dmserver_cconn_state cstate;
 
@@ -65,10 +222,39 @@ struct dmserver_cliconn{
     time_t clastt;
 };
 
+// Client connection metadata (inspection snapshot of a slot, consistent on its own):
+struct dmserver_cliinfo{
+    struct dmserver_cliloc iloc;
+    int ifd;
+    enum dmserver_cconn_state istate;
+    enum dmserver_cconn_transport itransport;
+
+    sa_family_t iaddr_family;
+    union{
+        struct sockaddr_in c4;
+        struct sockaddr_in6 c6;
+    }iaddr;
+
+    // Outbound connection of an upstream pool & proxied connection:
+    bool iupstream;
+    bool iproxied;
+
+    // Connection & last reception time, bytes read/written & output queued:
+    time_t iconnt;
+    time_t ilastt;
+    size_t irbytes;
+    size_t iwbytes;
+    size_t iwq_bytes;
+};
+
 // Client buffers length configuration:
 struct dmserver_cliconn_conf{
     size_t cread_buffer_size;
     size_t cwrite_buffer_size;
+    size_t cwrite_queue_size;
+
+    // Per connection arena block length (0 no arena):
+    size_t carena_size;
 };
 
 
@@ -77,20 +263,64 @@ struct dmserver_cliconn_conf{
 typedef struct dmserver_cliconn dmserver_cliconn_t;
 typedef dmserver_cliconn_t * dmserver_cliconn_pt;
 
+typedef struct dmserver_cmsg dmserver_cmsg_t;
+typedef dmserver_cmsg_t * dmserver_cmsg_pt;
+
 typedef struct dmserver_cliloc dmserver_cliloc_t;
 typedef dmserver_cliloc_t * dmserver_cliloc_pt;
 
+typedef struct dmserver_arena dmserver_arena_t;
+typedef dmserver_arena_t * dmserver_arena_pt;
+
+typedef struct dmserver_cliinfo dmserver_cliinfo_t;
+typedef dmserver_cliinfo_t * dmserver_cliinfo_pt;
+
 // DMServer client buffers configuration structure:
 typedef struct dmserver_cliconn_conf dmserver_cliconn_conf_t;
 typedef dmserver_cliconn_conf_t * dmserver_cliconn_conf_pt;
 
+typedef struct dmserver_zerocopy_stats dmserver_zerocopy_stats_t;
+typedef dmserver_zerocopy_stats_t * dmserver_zerocopy_stats_pt;
+
 /* ---- INTERNAL - Static functions prototypes -------------------- */
 // Client connection:
 bool _dmserver_cconn_init(dmserver_cliconn_pt c);
 bool _dmserver_cconn_deinit(dmserver_cliconn_pt c);
-bool _dmserver_cconn_set(dmserver_cliconn_pt c, dmserver_cliloc_pt cloc, int cfd, struct sockaddr_storage * caddr, SSL * cssl);
+bool _dmserver_cconn_set(dmserver_cliconn_pt c, dmserver_cliloc_pt cloc, int cfd, struct sockaddr_storage * caddr, SSL * cssl, time_t now);
 bool _dmserver_cconn_reset(dmserver_cliconn_pt c);
-bool _dmserver_cconn_checktimeout(dmserver_cliconn_pt c, time_t timeout_sec);
+bool _dmserver_cconn_checktimeout(dmserver_cliconn_pt c, time_t timeout_sec, time_t now);
+void _dmserver_cconn_closefds(dmserver_cliconn_pt c, bool crfds, bool cwfds);
+void _dmserver_cconn_addrstr(dmserver_cliconn_pt c, char * str, size_t len);
+
+// Client connection registry record (identity rewritten by the slot owner, read lock-free):
+void _dmserver_cconn_settransport(dmserver_cliconn_pt c, enum dmserver_cconn_transport t);
+bool _dmserver_cconn_info(dmserver_cliconn_pt c, dmserver_cliinfo_pt info);
+
+// Client shared output messages queue:
+dmserver_cmsg_pt _dmserver_cmsg_new(const char * mdata, size_t mlen);
+void _dmserver_cmsg_ref(dmserver_cmsg_pt m);
+void _dmserver_cmsg_unref(dmserver_cmsg_pt m);
+bool _dmserver_cconn_wqpush(dmserver_cliconn_pt c, dmserver_cmsg_pt m);
+void _dmserver_cconn_wqconsume(dmserver_cliconn_pt c, size_t n);
+void _dmserver_cconn_wqclear(dmserver_cliconn_pt c);
+bool _dmserver_cconn_wqdropold(dmserver_cliconn_pt c);
+bool _dmserver_cconn_wqreplace(dmserver_cliconn_pt c, dmserver_cmsg_pt m);
+
+// Client zero copy sends (messages pinned until the kernel completes them):
+bool _dmserver_cconn_zcpin(dmserver_cliconn_pt c, dmserver_cmsg_pt m);
+size_t _dmserver_cconn_zcdone(dmserver_cliconn_pt c, uint32_t lo, uint32_t hi);
+size_t _dmserver_cconn_zcreap(dmserver_cliconn_pt c, dmserver_zerocopy_stats_pt zs);
+void _dmserver_cconn_zcclear(dmserver_cliconn_pt c);
+
+// Client connection ancillary data (passed file descriptors, kernel receive timestamps):
+int _dmserver_cconn_recvfds(dmserver_cliconn_pt c);
+int _dmserver_cconn_recvts(dmserver_cliconn_pt c);
+int _dmserver_cconn_sendfds(dmserver_cliconn_pt c);
+void _dmserver_cconn_rxlat(dmserver_cliconn_pt c, size_t * hist, size_t nbuckets);
+
+// Client connection arena (allocations aligned to DEFAULT_CCONN_ARENAALIGN, reset with the slot):
+void * _dmserver_cconn_arena_alloc(dmserver_cliconn_pt c, size_t len);
+void _dmserver_cconn_arena_reset(dmserver_cliconn_pt c);
 
 // Client connection configuration:
 bool __dmserver_cconn_buf_alloc(dmserver_cliconn_pt c);
@@ -98,5 +328,7 @@ bool __dmserver_cconn_buf_dealloc(dmserver_cliconn_pt c);
 void __dmserver_cconn_set_defaults(dmserver_cliconn_pt c);
 void __dmserver_cconn_set_creadbuffer(dmserver_cliconn_pt c, size_t crbuf);
 void __dmserver_cconn_set_cwritebuffer(dmserver_cliconn_pt c, size_t cwbuf);
+void __dmserver_cconn_set_cwritequeue(dmserver_cliconn_pt c, size_t cwqueue);
+void __dmserver_cconn_set_carena(dmserver_cliconn_pt c, size_t carena);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,78 @@
+/*
+
+*/
+
+/* ---- Header guard ---------------------------------------------- */
+#ifndef _DMSERVER_DGRAM_HEADER
+#define _DMSERVER_DGRAM_HEADER
+
+/* ---- Libraries ------------------------------------------------- */
+#include "_dmserver_hdrs.h"
+#include "_dmserver_cliconn.h"
+#include "_dmserver_evsrc.h"
+
+/* ---- Defines  -------------------------------------------------- */
+#define DEFAULT_DGRAM_BATCH 16
+#define DEFAULT_DGRAM_BUFFERLEN 65536
+#define DEFAULT_DGRAM_CTRLLEN 128
+
+/* ---- Data structures ------------------------------------------- */
+// Datagram peer key (normalized address, v4-mapped addresses as v4):
+struct dmserver_dgram_key{
+    sa_family_t kfamily;
+    uint16_t kport;
+    uint8_t kaddr[16];
+};
+
+// Datagram transport data structure for each subordinate thread:
+struct dmserver_dgram{
+    // Subthread epoll event source (datagram socket):
+    struct dmserver_evsrc devsrc;
+
+    // Datagram socket of the subthread (SO_REUSEPORT group member):
+    int dfd;
+    sa_family_t dfamily;
+
+    // Peers session table (open addressing, linear probing):
+    size_t dsessions_size;
+    struct dmserver_cliconn ** dsessions;
+    pthread_mutex_t dsessions_lock;
+
+    // Receive batch (recvmmsg):
+    struct mmsghdr * drmsgs;
+    struct iovec * driovs;
+    struct sockaddr_storage * draddrs;
+    char * drbufs;
+    char * drctrls;
+
+    // Send batch (sendmmsg, payloads copied to the batch buffers):
+    struct mmsghdr * dsmsgs;
+    struct iovec * dsiovs;
+    struct sockaddr_in6 * dsaddrs;
+    char * dsbufs;
+    struct dmserver_cliconn ** dsclis;
+    size_t dscount;
+};
+
+/* ---- Data types ------------------------------------------------ */
+typedef struct dmserver_dgram dmserver_dgram_t;
+typedef dmserver_dgram_t * dmserver_dgram_pt;
+
+/* ---- INTERNAL - Static functions prototypes -------------------- */
+// Datagram transport:
+bool _dmserver_dgram_init(dmserver_dgram_pt d, int dfd, size_t dslots);
+bool _dmserver_dgram_deinit(dmserver_dgram_pt d);
+int _dmserver_dgram_recv(dmserver_dgram_pt d);
+bool _dmserver_dgram_msg(dmserver_dgram_pt d, int index, struct sockaddr_storage ** maddr, char ** mdata, size_t * mlen, size_t * msegsize, struct timespec * mts);
+
+// Datagram sessions table:
+dmserver_cliconn_pt _dmserver_dgram_lookup(dmserver_dgram_pt d, struct sockaddr_storage * addr);
+bool _dmserver_dgram_insert(dmserver_dgram_pt d, dmserver_cliconn_pt c);
+bool _dmserver_dgram_remove(dmserver_dgram_pt d, dmserver_cliconn_pt c);
+
+// Datagram send batch:
+bool _dmserver_dgram_sendq(dmserver_dgram_pt d, dmserver_cliconn_pt c, const char * data, size_t len);
+bool _dmserver_dgram_sendcli(dmserver_dgram_pt d, dmserver_cliconn_pt c);
+int _dmserver_dgram_sendflush(dmserver_dgram_pt d);
+
+#endif
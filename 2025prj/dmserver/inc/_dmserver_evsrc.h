@@ -0,0 +1,32 @@
+/*
+
+*/
+
+/* ---- Header guard ---------------------------------------------- */
+#ifndef _DMSERVER_EVSRC_HEADER
+#define _DMSERVER_EVSRC_HEADER
+
+/* ---- Libraries ------------------------------------------------- */
+#include "_dmserver_hdrs.h"
+
+/* ---- Enumerations: Subthread epoll event source type ----------- */
+enum dmserver_evsrc_type{
+    DMSERVER_EVSRC_CLIENT,
+    DMSERVER_EVSRC_DGRAM,
+    DMSERVER_EVSRC_USEREV,
+    DMSERVER_EVSRC_PROXY,
+    DMSERVER_EVSRC_SHM
+};
+
+/* ---- Data structures ------------------------------------------- */
+// Source of the events registered by pointer in a subthread epoll, first member of every struct
+// registered (set once on init, the subthread dispatches each event on it):
+struct dmserver_evsrc{
+    enum dmserver_evsrc_type etype;
+};
+
+/* ---- Data types ------------------------------------------------ */
+typedef struct dmserver_evsrc dmserver_evsrc_t;
+typedef dmserver_evsrc_t * dmserver_evsrc_pt;
+
+#endif
\ No newline at end of file
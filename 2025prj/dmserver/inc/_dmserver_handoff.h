@@ -0,0 +1,33 @@
+/*
+
+*/
+
+/* ---- Header guard ---------------------------------------------- */
+#ifndef _DMSERVER_HANDOFF_HEADER
+#define _DMSERVER_HANDOFF_HEADER
+
+/* ---- Libraries ------------------------------------------------- */
+#include "_dmserver_hdrs.h"
+
+/* ---- Defines  -------------------------------------------------- */
+#define DEFAULT_HANDOFF_MAXFDS 16
+#define DEFAULT_HANDOFF_MAGIC 0x48534d44u
+#define DEFAULT_HANDOFF_RETRYMS 20
+
+/* ---- Data structures ------------------------------------------- */
+// Handoff message header, sent with the listening sockets (SCM_RIGHTS) from the running process to
+// the next one, which acknowledges with a single byte once it holds them:
+struct dmserver_handoff_hdr{
+    uint32_t hmagic;
+    uint32_t hnfds;
+};
+
+/* ---- Data types ------------------------------------------------ */
+typedef struct dmserver_handoff_hdr dmserver_handoff_hdr_t;
+
+/* ---- INTERNAL - Static functions prototypes -------------------- */
+// Listening sockets handoff over a unix domain socket (sender listens on the path, receiver connects):
+bool _dmserver_handoff_send(const char * path, const int * fds, size_t nfds, size_t wait_ms);
+bool _dmserver_handoff_recv(const char * path, int * fds, size_t nfds, size_t wait_ms);
+
+#endif
\ No newline at end of file
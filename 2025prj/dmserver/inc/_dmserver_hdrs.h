@@ -18,6 +18,7 @@
 
 // Unix:
 #include <unistd.h>
+#include <fcntl.h>
 
 // Character strings manipulation:
 #include <string.h>
@@ -25,16 +26,27 @@
 // Error codes to identify error conditions:
 #include <errno.h>
 
-// Threads:
+// Threads (and cpu affinity):
 #include <pthread.h>
+#include <sched.h>
 
 // Network:
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h> 
+#include <sys/un.h>
+#include <netdb.h>
 
 // Events I/O:
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <sys/uio.h>
+
+// Kernel receive timestamps (SO_TIMESTAMPING):
+#include <linux/net_tstamp.h>
+#include <linux/errqueue.h>
 
 // OpenSSL (TLS):
 #include <openssl/ssl.h>
@@ -0,0 +1,113 @@
+/*
+
+*/
+
+/* ---- Header guard ---------------------------------------------- */
+#ifndef _DMSERVER_LIMITS_HEADER
+#define _DMSERVER_LIMITS_HEADER
+
+/* ---- Libraries ------------------------------------------------- */
+#include "_dmserver_hdrs.h"
+
+/* ---- Defines  -------------------------------------------------- */
+#define DEFAULT_LIMITS_IPTABLELEN 4096
+
+/* ---- Data structures ------------------------------------------- */
+// Client connection (the limits only use its address and its own rate state):
+struct dmserver_cliconn;
+
+// Rate of a token bucket (0 unlimited), kept as a theoretical arrival time (GCRA): every unit
+// moves the arrival time 1/rrate seconds forward, and the bucket is empty when it gets ahead of
+// now by more than the burst tolerance:
+struct dmserver_rate{
+    size_t rrate;
+    int64_t rtol_ns;
+};
+
+// Per source IP entry (entries are never emptied, only recycled once without connections):
+struct dmserver_ipentry{
+    sa_family_t ifamily;
+    uint8_t iaddr[16];
+    size_t iconns;
+    int64_t imsgs_tat;
+    int64_t ibytes_tat;
+};
+
+// Reception limits & access control actions counters:
+struct dmserver_limits_stats{
+    size_t lpaused_cli;
+    size_t lpaused_ip;
+    size_t liptable_full;
+    size_t ldenied_acl;
+    size_t ldenied_conns;
+};
+
+// Reception limits (per connection & per source IP) and concurrent connections per source IP (0
+// unlimited, changed at runtime), the IP table is only allocated with IP limits:
+struct dmserver_limits{
+    bool lenabled;
+    struct dmserver_rate lcli_msgs;
+    struct dmserver_rate lcli_bytes;
+    struct dmserver_rate lip_msgs;
+    struct dmserver_rate lip_bytes;
+    size_t lip_max_conns;
+
+    // Source IP table (open addressing, linear probing, inserts under lock, reads lock-free):
+    struct dmserver_ipentry * liptable;
+    size_t liptable_size;
+    size_t liptable_wanted;
+    pthread_mutex_t llock;
+
+    struct dmserver_limits_stats lstats;
+};
+
+// Reception limits configuration (messages are reads delivered to the reception callbacks, rates
+// per second with 0 unlimited, bursts with 0 one second of rate):
+struct dmserver_limits_conf{
+    size_t lcli_msgs_sec;
+    size_t lcli_msgs_burst;
+    size_t lcli_bytes_sec;
+    size_t lcli_bytes_burst;
+
+    size_t lip_msgs_sec;
+    size_t lip_msgs_burst;
+    size_t lip_bytes_sec;
+    size_t lip_bytes_burst;
+
+    // Concurrent connections per source IP (0 unlimited):
+    size_t lip_max_conns;
+
+    // Source IP table entries (0 default):
+    size_t lip_table_size;
+};
+
+/* ---- Data types ------------------------------------------------ */
+typedef struct dmserver_limits dmserver_limits_t;
+typedef dmserver_limits_t * dmserver_limits_pt;
+
+typedef struct dmserver_ipentry dmserver_ipentry_t;
+typedef dmserver_ipentry_t * dmserver_ipentry_pt;
+
+typedef struct dmserver_limits_conf dmserver_limits_conf_t;
+typedef dmserver_limits_conf_t * dmserver_limits_conf_pt;
+
+typedef struct dmserver_limits_stats dmserver_limits_stats_t;
+typedef dmserver_limits_stats_t * dmserver_limits_stats_pt;
+
+/* ---- INTERNAL - Static functions prototypes -------------------- */
+// Limits:
+bool _dmserver_limits_init(dmserver_limits_pt l);
+bool _dmserver_limits_deinit(dmserver_limits_pt l);
+
+// Limits source IP entries (acquired on accept, released on client reset):
+bool _dmserver_limits_ipacquire(dmserver_limits_pt l, struct sockaddr_storage * caddr, dmserver_ipentry_pt * e);
+void _dmserver_limits_iprelease(dmserver_ipentry_pt e);
+
+// Limits accounting of a read (pause time in ns, 0 within limits):
+long _dmserver_limits_charge(dmserver_limits_pt l, struct dmserver_cliconn * c, size_t nbytes, long now);
+
+// Limits configuration:
+bool __dmserver_limits_set(dmserver_limits_pt l, dmserver_limits_conf_pt conf);
+bool __dmserver_limits_set_maxconns(dmserver_limits_pt l, size_t lip_max_conns);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,58 @@
+/*
+
+*/
+
+/* ---- Header guard ---------------------------------------------- */
+#ifndef _DMSERVER_OVERLOAD_HEADER
+#define _DMSERVER_OVERLOAD_HEADER
+
+/* ---- Libraries ------------------------------------------------- */
+#include "_dmserver_hdrs.h"
+
+/* ---- Defines  -------------------------------------------------- */
+#define DEFAULT_OVERLOAD_TARGET 0
+#define DEFAULT_OVERLOAD_INTERVAL 100000
+
+/* ---- Enumerations: Overload controller action ------------------ */
+enum dmserver_overload_action{
+    DMSERVER_OVERLOAD_NONE,
+    DMSERVER_OVERLOAD_ENTER,
+    DMSERVER_OVERLOAD_SHED,
+    DMSERVER_OVERLOAD_LEAVE
+};
+
+/* ---- Data structures ------------------------------------------- */
+// Overload controller of a subordinate thread (CoDel): the subthread gets overloaded when its
+// sojourn time (round lag & flush queue wait) stays above the target for a whole interval, and 
+// sheds load at a rate growing with the square root of the sheds until it gets back under target:
+struct dmserver_codel{
+    long cfirst_above;
+    long cshed_next;
+    size_t ccount;
+    bool coverloaded;
+    long csojourn;
+};
+
+// Overload controller state & actions counters:
+struct dmserver_overload_stats{
+    size_t ooverloaded;
+    size_t oentered;
+    size_t osheds;
+    size_t orejected;
+    size_t osojourn_usec;
+};
+
+/* ---- Data types ------------------------------------------------ */
+typedef struct dmserver_codel dmserver_codel_t;
+typedef dmserver_codel_t * dmserver_codel_pt;
+
+typedef struct dmserver_overload_stats dmserver_overload_stats_t;
+typedef dmserver_overload_stats_t * dmserver_overload_stats_pt;
+
+/* ---- INTERNAL - Static functions prototypes -------------------- */
+// Overload controller:
+void _dmserver_overload_reset(dmserver_codel_pt c);
+enum dmserver_overload_action _dmserver_overload_sample(dmserver_codel_pt c, long sojourn, long now, long target, long interval);
+bool _dmserver_overload_state(dmserver_codel_pt c);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,42 @@
+/*
+
+*/
+
+/* ---- Header guard ---------------------------------------------- */
+#ifndef _DMSERVER_PROBES_HEADER
+#define _DMSERVER_PROBES_HEADER
+
+/* ---- Libraries ------------------------------------------------- */
+#include "_dmserver_hdrs.h"
+
+// Static tracepoints (USDT) when the systemtap headers are available, unless built with
+// -DDMSERVER_NO_PROBES:
+#if !defined(DMSERVER_NO_PROBES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define DMSERVER_PROBES_ENABLED
+#endif
+#endif
+
+/* ---- Defines  -------------------------------------------------- */
+// Tracepoints of the "dmserver" provider (perf probe sdt_dmserver:<name>, bpftrace usdt:<lib>:dmserver:<name>):
+//  - accept(fd, family): connection accepted by the main thread.
+//  - slot(fd, th, slot): connection (or datagram session) assigned to a subthread slot.
+//  - tls_start(fd) / tls_done(fd, ok): TLS handshake of an accepted connection.
+//  - read(fd, bytes) / write(fd, bytes): payload read from or written to a client.
+//  - cb_entry(name, fd) / cb_exit(name, fd): user callback ("connect", "rcv", "rcv_batch", "timeout",
+//    "disconnect", fd -1 for the batches).
+//  - timeout(fd, th, slot) / disconnect(fd, th, slot): connection closed.
+// A single nop in place when built with them (arguments read only by an attached tracer), nothing
+// at all otherwise:
+#ifdef DMSERVER_PROBES_ENABLED
+#define DMSERVER_PROBE1(name, a) DTRACE_PROBE1(dmserver, name, a)
+#define DMSERVER_PROBE2(name, a, b) DTRACE_PROBE2(dmserver, name, a, b)
+#define DMSERVER_PROBE3(name, a, b, c) DTRACE_PROBE3(dmserver, name, a, b, c)
+#else
+#define DMSERVER_PROBE1(name, a) do {} while (0)
+#define DMSERVER_PROBE2(name, a, b) do {} while (0)
+#define DMSERVER_PROBE3(name, a, b, c) do {} while (0)
+#endif
+
+#endif
\ No newline at end of file
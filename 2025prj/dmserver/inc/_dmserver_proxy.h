@@ -0,0 +1,108 @@
+/*
+
+*/
+
+/* ---- Header guard ---------------------------------------------- */
+#ifndef _DMSERVER_PROXY_HEADER
+#define _DMSERVER_PROXY_HEADER
+
+/* ---- Libraries ------------------------------------------------- */
+#include "_dmserver_hdrs.h"
+#include "_dmserver_cliconn.h"
+#include "_dmserver_evsrc.h"
+#include "_dmserver_servconn.h"
+#include "_dmserver_upstream.h"
+
+/* ---- Defines  -------------------------------------------------- */
+#define DEFAULT_PROXY_PIPESIZE 0
+#define DEFAULT_PROXY_COPYBUFLEN 16384
+#define DEFAULT_PROXY_SPLICELEN (1 << 20)
+
+/* ---- Enumerations: Proxy pump result --------------------------- */
+enum dmserver_proxy_result{
+    DMSERVER_PROXY_AGAIN,
+    DMSERVER_PROXY_DONE,
+    DMSERVER_PROXY_ERROR
+};
+
+/* ---- Data structures ------------------------------------------- */
+// Proxy target of a listener (stream endpoint resolved once, pipes size 0 for the system default):
+struct dmserver_proxytarget{
+    bool tenabled;
+    char thost[DEFAULT_UPSTREAM_HOSTLEN];
+    dmserver_servconn_t tconn;
+    size_t tpipe_size;
+};
+
+// Proxy flow (one direction of a pair): bytes in flight in its pipe (splice between sockets) or in 
+// its copy buffer (TLS without kernel offload on the client side), source end of stream & 
+// destination write side shut down (half-close), bytes moved:
+struct dmserver_proxyflow{
+    int fpipe[2];
+    char * fbuf;
+    size_t fpending;
+    size_t foff;
+    bool feof;
+    bool fshut;
+    size_t fbytes;
+};
+
+// Proxy pair of an accepted client (one per client slot, used by its subthread only): epoll event
+// source of the upstream socket, upstream socket (connecting until its first event) & both flows,
+// client to upstream and back:
+struct dmserver_proxy{
+    struct dmserver_evsrc pevsrc;
+    struct dmserver_cliconn * pcli;
+    int pfd;
+    bool pconnecting;
+    bool pktls;
+    struct dmserver_proxyflow pc2u;
+    struct dmserver_proxyflow pu2c;
+};
+
+// Proxy configuration of a listener:
+struct dmserver_proxy_conf{
+    // Target endpoint (host name or address, resolved once when configured):
+    const char * phost;
+    int pport;
+
+    // Pipes size of every pair flow in bytes (0 system default):
+    size_t ppipe_size;
+};
+
+// Proxy counters (pairs opened, upstream connections failed, pairs with kernel TLS, bytes moved):
+struct dmserver_proxy_stats{
+    size_t ppairs;
+    size_t pfailed;
+    size_t pktls;
+    size_t pbytes_c2u;
+    size_t pbytes_u2c;
+};
+
+/* ---- Data types ------------------------------------------------ */
+typedef struct dmserver_proxy dmserver_proxy_t;
+typedef dmserver_proxy_t * dmserver_proxy_pt;
+
+typedef struct dmserver_proxytarget dmserver_proxytarget_t;
+typedef dmserver_proxytarget_t * dmserver_proxytarget_pt;
+
+typedef struct dmserver_proxy_conf dmserver_proxy_conf_t;
+typedef dmserver_proxy_conf_t * dmserver_proxy_conf_pt;
+
+typedef struct dmserver_proxy_stats dmserver_proxy_stats_t;
+typedef dmserver_proxy_stats_t * dmserver_proxy_stats_pt;
+
+/* ---- INTERNAL - Static functions prototypes -------------------- */
+// Proxy pairs (upstream connection started once the client is established, closed with the client):
+void _dmserver_proxy_init(dmserver_proxy_pt p);
+bool _dmserver_proxy_open(dmserver_proxy_pt p, dmserver_cliconn_pt c, dmserver_proxytarget_pt t, int epfd);
+bool _dmserver_proxy_connected(dmserver_proxy_pt p);
+void _dmserver_proxy_close(dmserver_proxy_pt p);
+
+// Proxy pair bytes moving (both flows until blocked, done once both ends are shut down):
+enum dmserver_proxy_result _dmserver_proxy_pump(dmserver_proxy_pt p, size_t * moved_c2u, size_t * moved_u2c);
+
+// Proxy targets configuration:
+bool __dmserver_proxy_set_target(dmserver_proxytarget_pt t, dmserver_proxy_conf_pt conf);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,99 @@
+/*
+
+*/
+
+/* ---- Header guard ---------------------------------------------- */
+#ifndef _DMSERVER_PUBSUB_HEADER
+#define _DMSERVER_PUBSUB_HEADER
+
+/* ---- Libraries ------------------------------------------------- */
+#include "_dmserver_hdrs.h"
+#include "_dmserver_cliconn.h"
+
+/* ---- Defines  -------------------------------------------------- */
+#define DEFAULT_PUBSUB_TOPICLEN 64
+#define DEFAULT_PUBSUB_TOPICSLEN 64
+#define DEFAULT_PUBSUB_SUBSLEN 8
+
+/* ---- Enumerations: Slow consumers policy ----------------------- */
+enum dmserver_slow_policy{
+    DMSERVER_SLOW_DROP_NEWEST,
+    DMSERVER_SLOW_DROP_OLDEST,
+    DMSERVER_SLOW_COALESCE,
+    DMSERVER_SLOW_DISCONNECT
+};
+
+/* ---- Data structures ------------------------------------------- */
+// Slow consumers policy (a subscriber is behind when its messages queue is full, has more than
+// smax_bytes pending, its oldest pending message is older than smax_sec (0 disabled), or it has
+// pending messages while the output memory budget is exceeded):
+struct dmserver_slow_conf{
+    enum dmserver_slow_policy spolicy;
+    size_t smax_bytes;
+    size_t smax_sec;
+};
+
+// Slow consumers policy of a specific topic:
+struct dmserver_topic_slow{
+    char tname[DEFAULT_PUBSUB_TOPICLEN];
+    struct dmserver_slow_conf tslow;
+};
+
+// Slow consumers policy actions counters, messages rejected over the largest frame of their client
+// transport (shared memory) & pending output memory:
+struct dmserver_slow_stats{
+    size_t sdropped_newest;
+    size_t sdropped_oldest;
+    size_t scoalesced;
+    size_t sdisconnected;
+    size_t sbudget_exceeded;
+    size_t soversized;
+    size_t sout_bytes;
+};
+
+// Topic entry (subscribers of the subthread, empty name on free entries):
+struct dmserver_topic{
+    char tname[DEFAULT_PUBSUB_TOPICLEN];
+    struct dmserver_cliconn ** tsubs;
+    size_t tsubs_count;
+    size_t tsubs_size;
+};
+
+// Topic -> subscribers index for each subordinate thread (open addressing, linear probing):
+struct dmserver_pubsub{
+    struct dmserver_topic * ptopics;
+    size_t ptopics_size;
+    size_t ptopics_count;
+    pthread_rwlock_t plock;
+};
+
+/* ---- Data types ------------------------------------------------ */
+typedef struct dmserver_topic dmserver_topic_t;
+typedef dmserver_topic_t * dmserver_topic_pt;
+
+typedef struct dmserver_pubsub dmserver_pubsub_t;
+typedef dmserver_pubsub_t * dmserver_pubsub_pt;
+
+typedef struct dmserver_slow_conf dmserver_slow_conf_t;
+typedef dmserver_slow_conf_t * dmserver_slow_conf_pt;
+
+typedef struct dmserver_slow_stats dmserver_slow_stats_t;
+typedef dmserver_slow_stats_t * dmserver_slow_stats_pt;
+
+/* ---- INTERNAL - Static functions prototypes -------------------- */
+// Pub/Sub index:
+bool _dmserver_pubsub_init(dmserver_pubsub_pt p);
+bool _dmserver_pubsub_deinit(dmserver_pubsub_pt p);
+
+// Pub/Sub subscriptions (index write lock taken inside):
+bool _dmserver_pubsub_subscribe(dmserver_pubsub_pt p, dmserver_cliconn_pt c, const char * topic);
+bool _dmserver_pubsub_unsubscribe(dmserver_pubsub_pt p, dmserver_cliconn_pt c, const char * topic);
+void _dmserver_pubsub_unsubscribe_all(dmserver_pubsub_pt p, dmserver_cliconn_pt c);
+
+// Pub/Sub lookup (index read lock must be held by the caller):
+dmserver_topic_pt _dmserver_pubsub_lookup(dmserver_pubsub_pt p, const char * topic);
+
+// Pub/Sub coalescing key:
+uint64_t _dmserver_pubsub_key(const char * key);
+
+#endif
\ No newline at end of file
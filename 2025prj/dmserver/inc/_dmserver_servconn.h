@@ -12,11 +12,20 @@
 /* ---- Defines  -------------------------------------------------- */
 #define DEFAULT_SCONN_SPORT 8080
 #define DEFAULT_SCONN_SFAMILY AF_INET
+#define DEFAULT_SCONN_SOCKTYPE SOCK_STREAM
 #define DEFAULT_SCONN_SSLENABLE false
 #define DEFAULT_SCONN_CERTPATHLEN 128
 #define DEFAULT_SCONN_CERTPATHVAL "./certs/server.crt"
 #define DEFAULT_SCONN_KEYPATHLEN 128
 #define DEFAULT_SCONN_KEYPATHVAL "./certs/server.key"
+#define DEFAULT_SCONN_BACKLOG SOMAXCONN
+#define DEFAULT_SCONN_UNIXPATHLEN 108
+#define DEFAULT_SCONN_UNIXPATHVAL "./dmserver.sock"
+#define DEFAULT_SCONN_UNIXPASSFD false
+#define DEFAULT_SCONN_UNIXSHM false
+#define DEFAULT_SCONN_UNIXSHMRINGMIN 4096
+#define DEFAULT_SCONN_ADDRSTRLEN (DEFAULT_SCONN_UNIXPATHLEN + 8)
+#define DEFAULT_SCONN_RXTSTAMPFLAGS (SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE)
 
 /* ---- Data structures ------------------------------------------- */
 // Server connection data structre for dmserver:
@@ -25,28 +34,93 @@ struct dmserver_servconn{
     int sfd;
     int sport;
     sa_family_t ssafamily;
+    int ssocktype;
     bool ss6only;
     union{
         struct sockaddr_in s4;
         struct sockaddr_in6 s6;
+        struct sockaddr_un su;
     }saddr;
 
+    // Listening socket received from a previous process (used by the next open instead of a new
+    // socket, -1 none) & listening socket handed off to a next process (its socket file kept at close):
+    int sinherit_fd;
+    bool shandedoff;
+
+    // Unix domain socket data of the server (path, file descriptors passing & shared memory rings
+    // transport with the length of each ring, 0 default):
+    char sunixpath[DEFAULT_SCONN_UNIXPATHLEN];
+    bool sunixpassfd;
+    bool sunixshm;
+    size_t sunixshm_ring;
+
     // Secure connection data of the server (including certificate and key paths):
     bool sssl_enable;
     const SSL_METHOD * sssl_method;
     SSL_CTX * sssl_ctx;
+    SSL_CTX * sssl_ctx_next;
     char sssl_certpath[DEFAULT_SCONN_CERTPATHLEN];
     char sssl_keypath[DEFAULT_SCONN_KEYPATHLEN];
+
+    // Listener and accepted connections socket tuning (0/false for system defaults):
+    int sbacklog;
+    bool snodelay;
+    bool squickack;
+    int ssndbuf;
+    int srcvbuf;
+    int snotsent_lowat;
+    int sbusy_poll;
+    unsigned int suser_timeout;
+    int skeepidle;
+    int skeepintvl;
+    int skeepcnt;
+
+    // Kernel software receive timestamps of the accepted connections & datagram sockets (reads
+    // with their timestamp, queueing delay accounted until the reception callback):
+    bool srxtstamp;
+
+    // Zero copy sends (MSG_ZEROCOPY) of the queued messages of at least this length to the accepted
+    // TCP connections without TLS (0 disabled):
+    size_t szerocopy;
 };
 
 // Server connection data structure for configuration:
 struct dmserver_servconn_conf{
     int sport;
     sa_family_t ssa_family;
+    int ssock_type;
     bool sipv6_only;
     bool stls_enable;
     char * scert_path;
     char * skey_path;
+
+    // Unix domain socket (ssa_family AF_UNIX), shared memory transport without TLS (ring bytes per
+    // direction as a power of two, 0 default):
+    char * sunix_path;
+    bool sunix_passfd;
+    bool sunix_shm;
+    size_t sunix_shm_ring;
+
+    // Socket tuning (0/false for system defaults):
+    int sbacklog;
+    bool stcp_nodelay;
+    bool stcp_quickack;
+    int ssndbuf_size;
+    int srcvbuf_size;
+    int stcp_notsent_lowat;
+    int sbusy_poll_usec;
+    unsigned int stcp_user_timeout_ms;
+    int skeepalive_idle_sec;
+    int skeepalive_intvl_sec;
+    int skeepalive_cnt;
+
+    // Kernel receive timestamps of every read (TCP without TLS & UDP), time spent in the socket
+    // buffer until the reception callback accounted:
+    bool srx_timestamps;
+
+    // Published/broadcast payloads of at least this length sent without copy (TCP without TLS,
+    // 0 disabled, smaller ones copied as usual):
+    size_t stcp_zerocopy_min;
 };
 
 /* ---- Data types ------------------------------------------------ */
@@ -62,15 +136,40 @@ bool _dmserver_sconn_init(dmserver_servconn_pt s);
 bool _dmserver_sconn_deinit(dmserver_servconn_pt s);
 bool _dmserver_sconn_sslinit(dmserver_servconn_pt s);
 bool _dmserver_sconn_ssldeinit(dmserver_servconn_pt s);
+bool _dmserver_sconn_sslreload(dmserver_servconn_pt s, const char * scert_path, const char * skey_path);
+void _dmserver_sconn_sslswap(dmserver_servconn_pt s);
 bool _dmserver_sconn_listen(dmserver_servconn_pt s);
+int _dmserver_sconn_dgramsocket(dmserver_servconn_pt s);
+bool _dmserver_sconn_ccsetopts(dmserver_servconn_pt s, int cfd);
+size_t _dmserver_sconn_cczerocopy(dmserver_servconn_pt s, int cfd);
+
+// Server connection as a stream listener (socket, TLS context & listen):
+bool _dmserver_sconn_open(dmserver_servconn_pt s);
+bool _dmserver_sconn_close(dmserver_servconn_pt s);
+bool _dmserver_sconn_addrstr(dmserver_servconn_pt s, char * str, size_t len);
 
 // Server connection configuration:
 void __dmserver_sconn_set_defaults(dmserver_servconn_pt s);
+void __dmserver_sconn_set_conf(dmserver_servconn_pt s, dmserver_servconn_conf_pt conf);
 void __dmserver_sconn_set_port(dmserver_servconn_pt s, int sport);
 void __dmserver_sconn_set_safamily(dmserver_servconn_pt s, sa_family_t sa_family);
+void __dmserver_sconn_set_unixpath(dmserver_servconn_pt s, const char * sunix_path);
+void __dmserver_sconn_set_unixpassfd(dmserver_servconn_pt s, bool sunix_passfd);
+void __dmserver_sconn_set_unixshm(dmserver_servconn_pt s, bool sunix_shm, size_t sunix_shm_ring);
+void __dmserver_sconn_set_socktype(dmserver_servconn_pt s, int socktype);
 void __dmserver_sconn_set_ipv6only(dmserver_servconn_pt s, bool sipv6_only);
 void __dmserver_sconn_set_tls(dmserver_servconn_pt s, bool stls_enable);
 void __dmserver_sconn_set_certpath(dmserver_servconn_pt s, const char * scert_path);
 void __dmserver_sconn_set_keypath(dmserver_servconn_pt s, const char * skey_path);
+void __dmserver_sconn_set_backlog(dmserver_servconn_pt s, int sbacklog);
+void __dmserver_sconn_set_nodelay(dmserver_servconn_pt s, bool snodelay);
+void __dmserver_sconn_set_quickack(dmserver_servconn_pt s, bool squickack);
+void __dmserver_sconn_set_sockbufs(dmserver_servconn_pt s, int ssndbuf, int srcvbuf);
+void __dmserver_sconn_set_notsentlowat(dmserver_servconn_pt s, int snotsent_lowat);
+void __dmserver_sconn_set_busypoll(dmserver_servconn_pt s, int sbusy_poll);
+void __dmserver_sconn_set_usertimeout(dmserver_servconn_pt s, unsigned int suser_timeout);
+void __dmserver_sconn_set_keepalive(dmserver_servconn_pt s, int skeepidle, int skeepintvl, int skeepcnt);
+void __dmserver_sconn_set_rxtstamp(dmserver_servconn_pt s, bool srxtstamp);
+void __dmserver_sconn_set_zerocopy(dmserver_servconn_pt s, size_t szerocopy);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,114 @@
+/*
+
+*/
+
+/* ---- Header guard ---------------------------------------------- */
+#ifndef _DMSERVER_SHARDS_HEADER
+#define _DMSERVER_SHARDS_HEADER
+
+/* ---- Libraries ------------------------------------------------- */
+#include "_dmserver_hdrs.h"
+#include "_dmserver_cliconn.h"
+
+/* ---- Defines  -------------------------------------------------- */
+#define DEFAULT_SHARDS_MAX 64
+#define DEFAULT_SHARDS_RINGSLOTS 1024
+#define DEFAULT_SHARDS_MSGLEN 4096
+#define DEFAULT_SHARDS_CACHELINE 64
+
+/* ---- Enumerations: Bus message type ---------------------------- */
+enum dmserver_shardmsg_type{
+    DMSERVER_SHARDMSG_BROADCAST,
+    DMSERVER_SHARDMSG_UNICAST
+};
+
+/* ---- Data structures ------------------------------------------- */
+// Bus message slot, its sequence number tells the ring position it is ready for (written when equal
+// to the enqueue position, read when one ahead of the dequeue position), payload NUL terminated:
+struct dmserver_shardmsg{
+    size_t mseq;
+    enum dmserver_shardmsg_type mtype;
+    size_t msrc;
+    struct dmserver_cliloc mloc;
+    size_t mlen;
+    char mdata[];
+};
+
+// Inbox ring of a shard in shared memory (bounded lock-free queue, many producer shards & the shard
+// main thread consuming), positions on their own cache lines. The consumer is woken up through the
+// eventfd (inherited by every shard) only when the pending count leaves zero:
+struct dmserver_shardring{
+    size_t rhead __attribute__((aligned(DEFAULT_SHARDS_CACHELINE)));
+    size_t rtail __attribute__((aligned(DEFAULT_SHARDS_CACHELINE)));
+    size_t rpending __attribute__((aligned(DEFAULT_SHARDS_CACHELINE)));
+    int revfd;
+};
+
+// Shards of a prefork server (every process with its own copy): bus shared memory (one inbox ring
+// per shard followed by the slots of every ring), own shard & counters:
+struct dmserver_shards{
+    void * sbus;
+    size_t sbus_len;
+    struct dmserver_shardring * srings;
+    char * sslots;
+    size_t snshards;
+    size_t sshard;
+    size_t sring_slots;
+    size_t smsg_len;
+    size_t sstride;
+    pid_t spids[DEFAULT_SHARDS_MAX];
+
+    size_t ssent;
+    size_t sdropped;
+    size_t sreceived;
+};
+
+// Shards configuration (prefork processes, ring slots per shard as a power of two & message length,
+// 0 defaults):
+struct dmserver_shards_conf{
+    size_t snshards;
+    size_t sring_slots;
+    size_t smsg_len;
+};
+
+// Shards bus counters of a process:
+struct dmserver_shards_stats{
+    size_t sshard;
+    size_t snshards;
+    size_t ssent;
+    size_t sdropped;
+    size_t sreceived;
+};
+
+/* ---- Data types ------------------------------------------------ */
+typedef struct dmserver_shards dmserver_shards_t;
+typedef dmserver_shards_t * dmserver_shards_pt;
+
+typedef struct dmserver_shardmsg dmserver_shardmsg_t;
+typedef dmserver_shardmsg_t * dmserver_shardmsg_pt;
+
+typedef struct dmserver_shards_conf dmserver_shards_conf_t;
+typedef dmserver_shards_conf_t * dmserver_shards_conf_pt;
+
+typedef struct dmserver_shards_stats dmserver_shards_stats_t;
+typedef dmserver_shards_stats_t * dmserver_shards_stats_pt;
+
+/* ---- INTERNAL - Static functions prototypes -------------------- */
+// Shards bus (created before the fork, mapped by every shard):
+bool _dmserver_shards_create(dmserver_shards_pt s, dmserver_shards_conf_pt conf);
+bool _dmserver_shards_destroy(dmserver_shards_pt s);
+
+// Shards processes (the caller becomes shard 0, its children shards 1..n-1):
+bool _dmserver_shards_fork(dmserver_shards_pt s);
+
+// Shards bus producers (to another shard or every other shard):
+bool _dmserver_shards_push(dmserver_shards_pt s, size_t shard, enum dmserver_shardmsg_type type, dmserver_cliloc_pt loc, const char * data, size_t len);
+bool _dmserver_shards_broadcast(dmserver_shards_pt s, const char * data, size_t len);
+
+// Shards bus consumer (own inbox, from the main thread):
+int _dmserver_shards_evfd(dmserver_shards_pt s);
+void _dmserver_shards_ack(dmserver_shards_pt s);
+dmserver_shardmsg_pt _dmserver_shards_peek(dmserver_shards_pt s);
+void _dmserver_shards_release(dmserver_shards_pt s, dmserver_shardmsg_pt m);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,86 @@
+/*
+
+*/
+
+/* ---- Header guard ---------------------------------------------- */
+#ifndef _DMSERVER_SHM_HEADER
+#define _DMSERVER_SHM_HEADER
+
+/* ---- Libraries ------------------------------------------------- */
+#include "_dmserver_hdrs.h"
+#include "_dmserver_evsrc.h"
+
+/* ---- Defines  -------------------------------------------------- */
+#define DEFAULT_SHM_RINGLEN (1 << 20)
+#define DEFAULT_SHM_RINGMINLEN 4096
+#define DEFAULT_SHM_CACHELINE 64
+#define DEFAULT_SHM_MAGIC 0x4d48534du
+#define DEFAULT_SHM_SKIP SIZE_MAX
+
+/* ---- Data structures ------------------------------------------- */
+// Ring of one direction in shared memory (single producer & single consumer), byte positions that
+// only grow on their own cache lines. Frames are a length header followed by the payload (8 bytes
+// aligned) and never split at the end of the data area (skip header instead). The consumer flags
+// rwait before sleeping and the producer flags rspace_wait when the ring is full, the other end
+// signals through the eventfd of the sleeping one only when flagged:
+struct dmserver_shmring{
+    size_t rhead __attribute__((aligned(DEFAULT_SHM_CACHELINE)));
+    size_t rtail __attribute__((aligned(DEFAULT_SHM_CACHELINE)));
+    uint32_t rwait __attribute__((aligned(DEFAULT_SHM_CACHELINE)));
+    uint32_t rspace_wait;
+};
+
+// Shared memory segment (memfd mapped by the server & its client): header with the rings (client
+// to server & back), followed by the data area of each ring:
+struct dmserver_shmseg{
+    uint32_t smagic;
+    size_t sring_len;
+    struct dmserver_shmring sc2s;
+    struct dmserver_shmring ss2c;
+};
+
+// Shared memory connection, one end of it (a server client slot or a client process): epoll event
+// source of its server eventfd, segment mapping & its rings length (own copy, the segment is writable
+// by the other end), eventfd each end sleeps on & unix domain socket the rings were offered through
+// (kept open by the client as liveness channel, closed when either end leaves):
+struct dmserver_shmconn{
+    struct dmserver_evsrc sevsrc;
+    struct dmserver_shmseg * sseg;
+    size_t sseg_len;
+    size_t sring_len;
+    bool sserver;
+    int smemfd;
+    int sevfd_srv;
+    int sevfd_cli;
+    int ssock;
+};
+
+/* ---- Data types ------------------------------------------------ */
+typedef struct dmserver_shmconn dmserver_shmconn_t;
+typedef dmserver_shmconn_t * dmserver_shmconn_pt;
+
+typedef struct dmserver_shmring dmserver_shmring_t;
+typedef dmserver_shmring_t * dmserver_shmring_pt;
+
+/* ---- INTERNAL - Static functions prototypes -------------------- */
+// Shared memory connection (server end created & offered on accept, client end attached):
+void _dmserver_shm_init(dmserver_shmconn_pt c);
+bool _dmserver_shm_create(dmserver_shmconn_pt c, size_t ring_len);
+bool _dmserver_shm_offer(dmserver_shmconn_pt c, int sock);
+bool _dmserver_shm_serve(dmserver_shmconn_pt c, int sock, size_t ring_len, int epfd);
+bool _dmserver_shm_attach(dmserver_shmconn_pt c, const char * path, size_t wait_ms);
+void _dmserver_shm_close(dmserver_shmconn_pt c);
+
+// Shared memory frames (own output ring producer, own input ring consumer, no syscalls):
+size_t _dmserver_shm_maxlen(dmserver_shmconn_pt c);
+bool _dmserver_shm_send(dmserver_shmconn_pt c, const char * data, size_t len);
+const char * _dmserver_shm_peek(dmserver_shmconn_pt c, size_t * len);
+void _dmserver_shm_release(dmserver_shmconn_pt c);
+
+// Shared memory wake ups (flag before sleeping, signal the other end after a batch if flagged):
+bool _dmserver_shm_sleep(dmserver_shmconn_pt c);
+void _dmserver_shm_notify(dmserver_shmconn_pt c);
+int _dmserver_shm_evfd(dmserver_shmconn_pt c);
+int _dmserver_shm_wait(dmserver_shmconn_pt c, int timeout_ms);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,116 @@
+/*
+
+*/
+
+/* ---- Header guard ---------------------------------------------- */
+#ifndef _DMSERVER_UPSTREAM_HEADER
+#define _DMSERVER_UPSTREAM_HEADER
+
+/* ---- Libraries ------------------------------------------------- */
+#include "_dmserver_hdrs.h"
+#include "_dmserver_cliconn.h"
+#include "_dmserver_callback.h"
+#include "_dmserver_servconn.h"
+
+/* ---- Defines  -------------------------------------------------- */
+#define DEFAULT_UPSTREAM_HOSTLEN 256
+#define DEFAULT_UPSTREAM_BACKOFFMIN 100
+#define DEFAULT_UPSTREAM_BACKOFFMAX 30000
+#define DEFAULT_UPSTREAM_LISTLEN 16
+
+/* ---- Data structures ------------------------------------------- */
+// Pool member of an upstream: client slot while connecting or connected (NULL while down), next
+// connection attempt time (monotonic ns) & current reconnection backoff (ms):
+struct dmserver_upmember{
+    struct dmserver_cliconn * mcli;
+    long mretry;
+    size_t mbackoff;
+};
+
+// Upstream (outbound endpoint) with its pool of connections, handled by the worker subthreads as
+// any accepted client. The connection data (resolved address & TLS client context) is referenced
+// by its clients as their listener:
+struct dmserver_upstream{
+    size_t uid;
+    char uhost[DEFAULT_UPSTREAM_HOSTLEN];
+    dmserver_servconn_t uconn;
+    bool uverify;
+
+    // Callbacks set (the server callbacks when it has no own set):
+    dmserver_callback_t ucallback;
+    bool ucallback_own;
+
+    // Pool of connections (round robin pick over the connected ones) & reconnection backoff:
+    struct dmserver_upmember * umembers;
+    size_t upool;
+    size_t unext;
+    size_t ubackoff_min;
+    size_t ubackoff_max;
+    bool uclosed;
+
+    // Close requested while running (pool members disconnected by the main thread, the only one
+    // connecting them):
+    bool uclosing;
+    pthread_mutex_t ulock;
+};
+
+// Upstreams of the server (ids are positions, closed upstreams are kept until deinitialization):
+struct dmserver_upstreams{
+    struct dmserver_upstream ** uups;
+    size_t uups_count;
+    size_t uups_size;
+    pthread_mutex_t ulock;
+};
+
+// Upstream configuration:
+struct dmserver_upstream_conf{
+    // Endpoint (host name or address, resolved once when added) & TLS (peer certificate and host
+    // name verified against the system CAs if requested):
+    const char * uhost;
+    int uport;
+    bool utls;
+    bool utls_verify;
+
+    // Connections of the pool (0 one) & reconnection backoff in ms (0 defaults, doubled on every
+    // failed attempt up to the maximum):
+    size_t upool;
+    size_t ubackoff_min_ms;
+    size_t ubackoff_max_ms;
+
+    // Callbacks set of the connections (NULL for the server callbacks):
+    dmserver_callback_conf_pt ucallback;
+};
+
+/* ---- Data types ------------------------------------------------ */
+typedef struct dmserver_upstream dmserver_upstream_t;
+typedef dmserver_upstream_t * dmserver_upstream_pt;
+
+typedef struct dmserver_upstreams dmserver_upstreams_t;
+typedef dmserver_upstreams_t * dmserver_upstreams_pt;
+
+typedef struct dmserver_upstream_conf dmserver_upstream_conf_t;
+typedef dmserver_upstream_conf_t * dmserver_upstream_conf_pt;
+
+/* ---- INTERNAL - Static functions prototypes -------------------- */
+// Upstreams list:
+bool _dmserver_upstreams_init(dmserver_upstreams_pt ups);
+bool _dmserver_upstreams_deinit(dmserver_upstreams_pt ups);
+bool _dmserver_upstreams_add(dmserver_upstreams_pt ups, dmserver_upstream_conf_pt conf, size_t * upid);
+dmserver_upstream_pt _dmserver_upstreams_get(dmserver_upstreams_pt ups, size_t upid);
+void _dmserver_upstreams_rearm(dmserver_upstreams_pt ups);
+int _dmserver_upstreams_timeout(dmserver_upstreams_pt ups, long now, int ep_timeout);
+
+// Endpoints resolution (upstreams & proxy targets):
+bool _dmserver_upstream_resolve(dmserver_servconn_pt s, const char * host, int port);
+
+// Upstream pool members (connection attempt, lost & established), pick & close:
+bool _dmserver_upstream_due(dmserver_upstream_pt u, long now, size_t * member);
+bool _dmserver_upstream_attach(dmserver_upstream_pt u, size_t member, dmserver_cliconn_pt c);
+void _dmserver_upstream_lost(dmserver_cliconn_pt c, int wakefd);
+void _dmserver_upstream_up(dmserver_cliconn_pt c);
+bool _dmserver_upstream_pick(dmserver_upstream_pt u, dmserver_cliloc_pt loc);
+size_t _dmserver_upstream_close(dmserver_upstream_pt u, dmserver_cliloc_pt locs);
+bool _dmserver_upstream_qclose(dmserver_upstream_pt u);
+bool _dmserver_upstream_closing(dmserver_upstream_pt u);
+
+#endif
\ No newline at end of file
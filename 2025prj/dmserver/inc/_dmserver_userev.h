@@ -0,0 +1,69 @@
+/*
+
+*/
+
+/* ---- Header guard ---------------------------------------------- */
+#ifndef _DMSERVER_USEREV_HEADER
+#define _DMSERVER_USEREV_HEADER
+
+/* ---- Libraries ------------------------------------------------- */
+#include "_dmserver_hdrs.h"
+#include "_dmserver_evsrc.h"
+
+/* ---- Defines  -------------------------------------------------- */
+#define DEFAULT_USEREV_PERSUBTH 32
+
+/* ---- Enumerations: User event source type ---------------------- */
+enum dmserver_userev_type{
+    DMSERVER_USEREV_FREE,
+    DMSERVER_USEREV_TIMER,
+    DMSERVER_USEREV_FD
+};
+
+/* ---- Data structures ------------------------------------------- */
+// User event source registered in a subthread epoll, a periodic timer (own timerfd) or a user fd
+// (not owned), its callback called from that subthread. A removed source is only ignored until
+// the end of the subthread round, when its slot is freed:
+struct dmserver_userev{
+    struct dmserver_evsrc uevsrc;
+    enum dmserver_userev_type utype;
+    int ufd;
+    bool udeleted;
+    void (*utimer_cb)(void * arg, uint64_t expirations);
+    void (*ufd_cb)(void * arg, int fd, uint32_t events);
+    void * uarg;
+};
+
+// User event sources of a subthread (slots taken & removed under lock from any thread) & callbacks
+// in progress (held by the subthread across every callback, recursive for the removals from the
+// callbacks, the removals from foreign threads wait for the callback to return):
+struct dmserver_userevs{
+    struct dmserver_userev uevs[DEFAULT_USEREV_PERSUBTH];
+    bool ureap;
+    bool uready;
+    pthread_mutex_t ulock;
+    pthread_mutex_t udispatch;
+};
+
+/* ---- Data types ------------------------------------------------ */
+typedef struct dmserver_userev dmserver_userev_t;
+typedef dmserver_userev_t * dmserver_userev_pt;
+
+typedef struct dmserver_userevs dmserver_userevs_t;
+typedef dmserver_userevs_t * dmserver_userevs_pt;
+
+/* ---- INTERNAL - Static functions prototypes -------------------- */
+// User event sources of a subthread:
+bool _dmserver_userevs_init(dmserver_userevs_pt s);
+bool _dmserver_userevs_deinit(dmserver_userevs_pt s);
+
+// User event sources add & remove (registered in / removed from the subthread epoll):
+bool _dmserver_userevs_timer(dmserver_userevs_pt s, int epfd, size_t interval_ms, void (*cb)(void *, uint64_t), void * arg, size_t * id);
+bool _dmserver_userevs_fd(dmserver_userevs_pt s, int epfd, int fd, uint32_t events, void (*cb)(void *, int, uint32_t), void * arg, size_t * id);
+bool _dmserver_userevs_del(dmserver_userevs_pt s, int epfd, size_t id);
+
+// User event sources dispatch (from the subthread: callback & slots freed):
+void _dmserver_userev_dispatch(dmserver_userevs_pt s, dmserver_userev_pt u, uint32_t events);
+void _dmserver_userevs_reap(dmserver_userevs_pt s);
+
+#endif
\ No newline at end of file
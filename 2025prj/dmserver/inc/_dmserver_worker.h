@@ -9,11 +9,29 @@
 /* ---- Libraries ------------------------------------------------- */
 #include "_dmserver_hdrs.h"
 #include "_dmserver_cliconn.h"
+#include "_dmserver_callback.h"
+#include "_dmserver_servconn.h"
+#include "_dmserver_dgram.h"
+#include "_dmserver_pubsub.h"
+#include "_dmserver_overload.h"
+#include "_dmserver_upstream.h"
+#include "_dmserver_proxy.h"
+#include "_dmserver_userev.h"
+#include "_dmserver_shm.h"
+#include "_dmserver_probes.h"
 
 /* ---- Defines  -------------------------------------------------- */
 #define DEFAULT_WORKER_SUBTHREADS 8
 #define DEFAULT_WORKER_CLISPERSTH 200
 #define DEFAULT_WORKER_CLITIMEOUT 120
+#define DEFAULT_WORKER_BUSYPOLL 0
+#define DEFAULT_WORKER_CPUSLEN 64
+#define DEFAULT_WORKER_WRITEIOVS 16
+#define DEFAULT_WORKER_TOPICSLOWLEN 32
+#define DEFAULT_WORKER_OUTBUDGET 0
+#define DEFAULT_WORKER_READSPERROUND 16
+#define DEFAULT_WORKER_INJECTLEN 64
+#define DEFAULT_WORKER_RXLATBUCKETS 32
 
 /* ---- Data structures ------------------------------------------- */
 // Worker suthreads argument struct:
@@ -22,23 +40,107 @@ struct dmserver_subthreads_args{
     size_t subthindex;
 };
 
+// Injected connection pending (server end of a socketpair & subthread wanted, SIZE_MAX any):
+struct dmserver_inject{
+    int ifd;
+    size_t ith;
+};
+
 // Workers data structure for dmserver:
 struct dmserver_worker{
     // Threads (workers) data:
     pthread_t wmainth;
     int wmainepfd;
+    int wmainevfd;
 
     size_t wth_subthreads;
     pthread_t * wsubth;
     int * wsubepfd;
+    int * wsubevfd;
 
-    // Clients placeholder for each sub-thread:
+    // Clients placeholder for each sub-thread & number of clients of each one (relaxed, the main thread
+    // adds & the subthread removes):
     size_t wth_clispersth;
     struct dmserver_cliconn ** wcclis;
     size_t * wccount;
 
+    // Clients pending to flush at the end of each sub-thread round (one per client slot):
+    struct dmserver_cliconn *** wflushq;
+    size_t * wflushcount;
+    pthread_mutex_t * wflushlock;
+
+    // Datagram transport for each sub-thread (only in datagram mode):
+    struct dmserver_dgram * wsubdgram;
+
+    // Topics -> subscribers index for each sub-thread:
+    struct dmserver_pubsub * wsubtopics;
+
+    // Slow consumers policy (server default & specific topics), pending output memory budget (bytes,
+    // 0 unlimited) & policy actions counters:
+    struct dmserver_slow_conf wslow;
+    struct dmserver_topic_slow wtopicslow[DEFAULT_WORKER_TOPICSLOWLEN];
+    size_t wtopicslow_count;
+    size_t wout_budget;
+    struct dmserver_slow_stats wslowstats;
+
+    // Clients with reads deferred to a later round for each sub-thread (one per client slot, only
+    // touched by its subthread): paused by the reception limits or not drained in their round:
+    struct dmserver_cliconn *** wrdeferq;
+    size_t * wrdefercount;
+
+    // Overload control of each sub-thread (round lag & flush queue sojourn against the target in usec,
+    // 0 disabled), first enqueue time of the flush queue, shedding actions & actions counters:
+    struct dmserver_codel * wsubcodel;
+    long * wflushts;
+    size_t wovl_target;
+    size_t wovl_interval;
+    bool wovl_shed;
+    bool wovl_reject;
+    struct dmserver_overload_stats wovlstats;
+
+    // Proxy pairs for each sub-thread (one per client slot, only touched by its subthread) & counters:
+    struct dmserver_proxy ** wproxy;
+    struct dmserver_proxy_stats wproxystats;
+
+    // User event sources (timers & user fds) for each sub-thread:
+    struct dmserver_userevs * wsubuserevs;
+
+    // Shared memory connections for each sub-thread (one per client slot, created by the main thread
+    // on accept & closed by the subthread) & number of them open (rings swept every round while any):
+    struct dmserver_shmconn ** wshm;
+    size_t * wshmcount;
+
+    // Batched reception messages for each sub-thread (one per client slot):
+    struct dmserver_rcvmsg ** wrcvbatch;
+    size_t * wrcvcount;
+
+    // Receive latency histogram of each sub-thread (kernel receive timestamp to reception callback,
+    // bucket i from 2^(i-1) to 2^i usec, the first under 1 usec & the last the rest; relaxed, only its
+    // subthread adds):
+    size_t (* wrxlat)[DEFAULT_WORKER_RXLATBUCKETS];
+
+    // Zero copy sends counters (all the subthreads, relaxed):
+    struct dmserver_zerocopy_stats wzcstats;
+
+    // Clients timeouts check requested to each sub-thread (run at the start of its next round, the
+    // clients are only disconnected by their own subthread):
+    bool * wtocheck;
+
     size_t wth_clistimeout;
     time_t wctimeout;
+
+    // Test transport: injected connections pending (set up by the main thread as plain clients of
+    // their own connection data) & virtual clock of the clients activity and timeouts (0 wall clock):
+    struct dmserver_inject winject[DEFAULT_WORKER_INJECTLEN];
+    size_t winjectcount;
+    pthread_mutex_t winjectlock;
+    struct dmserver_servconn winjconn;
+    time_t wvclock;
+
+    // Low latency mode (spin budget in usec, 0 disabled) & subthreads cpu pinning:
+    size_t wth_busypoll;
+    int wth_cpus[DEFAULT_WORKER_CPUSLEN];
+    size_t wth_ncpus;
 };
 
 // Worker configuration data structure:
@@ -46,6 +148,29 @@ struct dmserver_worker_conf{
     size_t wth_subthreads;
     size_t wth_clispersth;
     size_t wth_clistimeout;
+
+    // Low latency mode: maximum spin time in usec after the last event (0 disabled):
+    size_t wth_busypoll_usec;
+
+    // Cpus to pin the subthreads to (subthread i runs on wth_cpus[i % wth_ncpus]):
+    int * wth_cpus;
+    size_t wth_ncpus;
+
+    // Slow consumers default policy (broadcast & topics without specific policy):
+    enum dmserver_slow_policy wslow_policy;
+    size_t wslow_max_bytes;
+    size_t wslow_max_sec;
+
+    // Pending output memory budget in bytes (0 unlimited):
+    size_t wout_budget_bytes;
+
+    // Overload control: sojourn target in usec (0 disabled), interval in usec above target to get
+    // overloaded (0 default), reads of the heaviest clients paused and new connections rejected
+    // when every subthread is overloaded (otherwise routed to the subthreads not overloaded):
+    size_t wovl_target_usec;
+    size_t wovl_interval_usec;
+    bool wovl_shed_reads;
+    bool wovl_reject;
 };
 
 /* ---- Data types ------------------------------------------------ */
@@ -66,14 +191,45 @@ void * _dmserver_worker_main(void * args);
 void * _dmserver_worker_sub(void * args);
 void * _dmserver_subworker_timeout(void * args);
 
+// Worker write flush queue (writes & disconnections requested to the client subthread):
+bool _dmserver_worker_qflush(dmserver_worker_pt w, dmserver_cliconn_pt c);
+bool _dmserver_worker_qdisconnect(dmserver_worker_pt w, dmserver_cliconn_pt c);
+
+// Worker clients timeouts (checked by each subthread when requested, by its timeout thread or the
+// virtual clock):
+void _dmserver_worker_qtimeouts(dmserver_worker_pt w, size_t th);
+void _dmserver_worker_timeouts(void * args, size_t dmthindex);
+
+// Worker shared memory connections (closed with their client, payloads over the largest frame rejected):
+void _dmserver_worker_shmclose(dmserver_worker_pt w, dmserver_cliconn_pt c);
+bool _dmserver_worker_shmfits(dmserver_worker_pt w, dmserver_cliconn_pt c, size_t len);
+
+// Worker test transport (injected connections & virtual clock):
+bool _dmserver_worker_inject(dmserver_worker_pt w, int fd, size_t th);
+time_t _dmserver_worker_now(dmserver_worker_pt w);
+
+// Worker shared messages output (slow consumers policy & output budget):
+dmserver_cmsg_pt _dmserver_worker_msgnew(dmserver_worker_pt w, const char * mdata, size_t mlen, const char * mkey);
+bool _dmserver_worker_qpush(dmserver_worker_pt w, dmserver_cliconn_pt c, dmserver_cmsg_pt m, dmserver_slow_conf_pt sc);
+dmserver_slow_conf_pt _dmserver_worker_slowconf(dmserver_worker_pt w, const char * topic);
+long _dmserver_worker_bcast(dmserver_worker_pt w, dmserver_cliloc_pt bexclude, const char * bcdata, size_t bclen);
+
 // Worker allocators:
 bool __dmserver_worker_alloc(dmserver_worker_pt w);
 bool __dmserver_worker_dealloc(dmserver_worker_pt w);
+bool __dmserver_worker_dgram_alloc(dmserver_worker_pt w, dmserver_servconn_pt s);
+bool __dmserver_worker_dgram_dealloc(dmserver_worker_pt w);
 
 // Worker configurations:
 void __dmserver_worker_set_defaults(dmserver_worker_pt w);
 void __dmserver_worker_set_subthreads(dmserver_worker_pt w, size_t wth_subthreads);
 void __dmserver_worker_set_clispersth(dmserver_worker_pt w, size_t wth_clispersth);
 void __dmserver_worker_set_clistimeout(dmserver_worker_pt w, size_t wth_clistimeout);
+void __dmserver_worker_set_busypoll(dmserver_worker_pt w, size_t wth_busypoll);
+void __dmserver_worker_set_cpus(dmserver_worker_pt w, const int * wth_cpus, size_t wth_ncpus);
+void __dmserver_worker_set_slow(dmserver_worker_pt w, enum dmserver_slow_policy policy, size_t max_bytes, size_t max_sec);
+void __dmserver_worker_set_outbudget(dmserver_worker_pt w, size_t wout_budget);
+void __dmserver_worker_set_overload(dmserver_worker_pt w, size_t target, size_t interval, bool shed, bool reject);
+bool __dmserver_worker_set_topicslow(dmserver_worker_pt w, const char * topic, dmserver_slow_conf_pt sc);
 
 #endif
\ No newline at end of file
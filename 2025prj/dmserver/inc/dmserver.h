@@ -30,6 +30,16 @@
 #include "_dmserver_callback.h"
 #include "_dmserver_servconn.h"
 #include "_dmserver_worker.h"
+#include "_dmserver_limits.h"
+#include "_dmserver_acl.h"
+#include "_dmserver_upstream.h"
+#include "_dmserver_proxy.h"
+#include "_dmserver_handoff.h"
+#include "_dmserver_shards.h"
+#include "_dmserver_capture.h"
+
+/* ---- Defines  -------------------------------------------------- */
+#define DEFAULT_DMSERVER_LISTENERS 8
 
 /* ---- Enumerations ---------------------------------------------- */
 // Server state:
@@ -43,13 +53,33 @@ enum dmserver_state{
 };
 
 /* ---- Data structures ------------------------------------------- */
+// Additional stream listener sharing the worker, with its own connection, TLS context and callbacks
+// set (the server callbacks when it has no own set) and proxy target:
+struct dmserver_listener{
+    dmserver_servconn_t lconn;
+    dmserver_callback_t lcallback;
+    bool lcallback_own;
+    dmserver_proxytarget_t lproxy;
+};
+
 // DMServer data structure:
 struct dmserver{
     dmserver_servconn_t sconn;
+    dmserver_proxytarget_t sproxy;
+    struct dmserver_listener slisteners[DEFAULT_DMSERVER_LISTENERS];
+    size_t slisteners_count;
     dmserver_worker_t sworker;
+    dmserver_limits_t slimits;
+    dmserver_acl_t sacl;
+    dmserver_upstreams_t supstreams;
+    dmserver_shards_t sshards;
+    dmserver_capture_t scapture;
     dmserver_callback_t scallback;
     dmlogger_pt slogger;
 
+    // Listeners no longer accepting (handed off or draining, until the next open):
+    bool sdraining;
+
     enum dmserver_state sstate;
 };
 
@@ -67,6 +97,10 @@ void dmserver_deinit(dmserver_pt * dmserver);
 bool dmserver_conf_sconn(dmserver_pt dmserver, dmserver_servconn_conf_pt sconn_conf);
 bool dmserver_conf_worker(dmserver_pt dmserver, dmserver_worker_conf_pt worker_conf);
 bool dmserver_conf_cconn(dmserver_pt dmserver, dmserver_cliconn_conf_pt cconn_conf);
+bool dmserver_conf_topic(dmserver_pt dmserver, const char * topic, dmserver_slow_conf_pt slow_conf);
+bool dmserver_conf_limits(dmserver_pt dmserver, dmserver_limits_conf_pt limits_conf);
+bool dmserver_conf_listener(dmserver_pt dmserver, dmserver_servconn_conf_pt sconn_conf, dmserver_callback_conf_pt callback_conf);
+bool dmserver_conf_proxy(dmserver_pt dmserver, size_t listener, dmserver_proxy_conf_pt proxy_conf);
 
 // Configuration - Set callbacks:
 bool dmserver_set_cb(dmserver_pt dmserver, dmserver_callback_conf_pt callback_conf);
@@ -82,4 +116,80 @@ bool dmserver_broadcast(dmserver_pt dmserver, dmserver_cliloc_pt bexclude, const
 bool dmserver_unicast(dmserver_pt dmserver, dmserver_cliloc_pt dmcliloc, const char * ucdata);
 bool dmserver_disconnect(dmserver_pt dmserver, dmserver_cliloc_pt dmcliloc);
 
+// Pub/Sub (topics of shared payloads):
+bool dmserver_subscribe(dmserver_pt dmserver, dmserver_cliloc_pt dmcliloc, const char * topic);
+bool dmserver_unsubscribe(dmserver_pt dmserver, dmserver_cliloc_pt dmcliloc, const char * topic);
+bool dmserver_publish(dmserver_pt dmserver, const char * topic, const char * pbdata, size_t pblen);
+bool dmserver_publish_key(dmserver_pt dmserver, const char * topic, const char * pbkey, const char * pbdata, size_t pblen);
+
+// Slow consumers policy actions counters:
+bool dmserver_get_slowstats(dmserver_pt dmserver, dmserver_slow_stats_pt stats);
+
+// Access control (reloadable at runtime) & reception limits actions counters:
+bool dmserver_set_acl(dmserver_pt dmserver, const dmserver_acl_rule_t * rules, size_t nrules, enum dmserver_acl_action adefault);
+bool dmserver_set_ipconns(dmserver_pt dmserver, size_t max_conns);
+bool dmserver_get_limitstats(dmserver_pt dmserver, dmserver_limits_stats_pt stats);
+
+// Overload control state & actions counters:
+bool dmserver_get_overload(dmserver_pt dmserver, dmserver_overload_stats_pt stats);
+
+// Connections registry snapshot (lock-free, filtered & paged by slot cursor):
+size_t dmserver_get_clients(dmserver_pt dmserver, dmserver_cliinfo_pt infos, size_t ninfos, bool (*filter)(const dmserver_cliinfo_t *, void *), void * arg, size_t * cursor);
+
+// Unix domain file descriptors passing:
+bool dmserver_unicast_fd(dmserver_pt dmserver, dmserver_cliloc_pt dmcliloc, const char * ucdata, int ucfd);
+
+// Upstreams (outbound connections pools handled by the worker as clients):
+bool dmserver_connect(dmserver_pt dmserver, dmserver_upstream_conf_pt upstream_conf, size_t * upid);
+bool dmserver_upstream_pick(dmserver_pt dmserver, size_t upid, dmserver_cliloc_pt dmcliloc);
+bool dmserver_upstream_close(dmserver_pt dmserver, size_t upid);
+
+// Proxy mode counters (all the pairs & a single pair):
+bool dmserver_get_proxystats(dmserver_pt dmserver, dmserver_proxy_stats_pt stats);
+bool dmserver_proxy_pairstats(dmserver_pt dmserver, dmserver_cliloc_pt dmcliloc, size_t * bytes_c2u, size_t * bytes_u2c);
+
+// User event sources on the subthreads event loops (timers & user file descriptors):
+bool dmserver_add_timer(dmserver_pt dmserver, size_t subthread, size_t interval_ms, void (*timer_cb)(void *, uint64_t), void * arg, size_t * id);
+bool dmserver_add_fd(dmserver_pt dmserver, size_t subthread, int fd, uint32_t events, void (*fd_cb)(void *, int, uint32_t), void * arg, size_t * id);
+bool dmserver_del_userev(dmserver_pt dmserver, size_t subthread, size_t id);
+
+// Graceful upgrade (listening sockets handoff, connections drain) & TLS certificates hot reload:
+bool dmserver_handoff_send(dmserver_pt dmserver, const char * path, size_t wait_ms);
+bool dmserver_handoff_recv(dmserver_pt dmserver, const char * path, size_t wait_ms);
+bool dmserver_drain(dmserver_pt dmserver, size_t deadline_ms);
+bool dmserver_reload_tls(dmserver_pt dmserver, size_t listener, const char * cert_path, const char * key_path);
+
+// Prefork shards (processes sharing the listeners, broadcasts & cross-shard unicasts over a shared memory bus):
+bool dmserver_prefork(dmserver_pt dmserver, dmserver_shards_conf_pt shards_conf, size_t * shard);
+bool dmserver_unicast_shard(dmserver_pt dmserver, size_t shard, dmserver_cliloc_pt dmcliloc, const char * ucdata);
+bool dmserver_get_shardstats(dmserver_pt dmserver, dmserver_shards_stats_pt stats);
+
+// Shared memory transport client (local processes, unix domain listeners with shared memory rings):
+bool dmserver_shmcli_connect(dmserver_shmconn_pt * shmcli, const char * path, size_t wait_ms);
+bool dmserver_shmcli_send(dmserver_shmconn_pt shmcli, const char * data, size_t len);
+long dmserver_shmcli_recv(dmserver_shmconn_pt shmcli, char * buf, size_t len, int timeout_ms);
+void dmserver_shmcli_close(dmserver_shmconn_pt * shmcli);
+
+// Per connection user context & arena (session state, released with the client slot):
+bool dmserver_set_ctx(dmserver_cliconn_pt dmclient, void * ctx);
+void * dmserver_get_ctx(dmserver_cliconn_pt dmclient);
+void * dmserver_arena_alloc(dmserver_cliconn_pt dmclient, size_t len);
+
+// Test transport (in-process connections into a subthread & virtual clock of the timeouts):
+bool dmserver_inject(dmserver_pt dmserver, size_t subthread, int * peerfd);
+bool dmserver_set_clock(dmserver_pt dmserver, time_t now);
+
+// Traffic capture (worker read/write paths to a binary file) & replay against a test server:
+bool dmserver_capture_start(dmserver_pt dmserver, const char * path, size_t buf_size);
+bool dmserver_capture_stop(dmserver_pt dmserver);
+bool dmserver_get_capturestats(dmserver_pt dmserver, dmserver_capture_stats_pt stats);
+bool dmserver_replay(dmserver_replay_conf_pt replay_conf, dmserver_replay_stats_pt stats);
+
+// Receive latency (kernel receive timestamp of the data being delivered & histogram of all the subthreads):
+bool dmserver_get_rcvts(dmserver_cliconn_pt dmclient, struct timespec * ts);
+bool dmserver_get_rxlatency(dmserver_pt dmserver, size_t * hist, size_t nbuckets);
+
+// Zero copy sends of the large queued messages (published/broadcast, TCP without TLS):
+bool dmserver_get_zcstats(dmserver_pt dmserver, dmserver_zerocopy_stats_pt stats);
+
 #endif
\ No newline at end of file
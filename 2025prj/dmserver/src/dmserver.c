@@ -39,6 +39,12 @@ void dmserver_init(dmserver_pt * dmserver){
     // Dmserver-cconn (worker) initialization to defaults:
     __dmserver_worker_set_defaults(&(*dmserver)->sworker);
     __dmserver_worker_alloc(&(*dmserver)->sworker);
+
+    // Dmserver-limits, access control, upstreams & capture initialization (disabled, everything allowed, none, stopped):
+    if (!_dmserver_limits_init(&(*dmserver)->slimits) || !_dmserver_acl_init(&(*dmserver)->sacl) || !_dmserver_upstreams_init(&(*dmserver)->supstreams) || !_dmserver_capture_init(&(*dmserver)->scapture)) {
+        dmserver_deinit(dmserver);
+        return;
+    }
     
     // Ignore sigpipe signal to avoid SSL exceptions:
     signal(SIGPIPE, SIG_IGN);
@@ -63,6 +69,15 @@ void dmserver_deinit(dmserver_pt * dmserver){
     // Dmserver-cconn deinitialization:
     __dmserver_worker_dealloc(&(*dmserver)->sworker);
 
+    // Dmserver-limits, access control, upstreams & capture (stopped, file completed) deinitialization:
+    _dmserver_limits_deinit(&(*dmserver)->slimits);
+    _dmserver_acl_deinit(&(*dmserver)->sacl);
+    _dmserver_upstreams_deinit(&(*dmserver)->supstreams);
+    _dmserver_capture_deinit(&(*dmserver)->scapture);
+
+    // Dmserver-shards bus unmapped (prefork mode):
+    _dmserver_shards_destroy(&(*dmserver)->sshards);
+
     // Dmserver-logger deinitialization (internally flush and dealloc):
     if ((*dmserver)->slogger) {
         dmlogger_log((*dmserver)->slogger, DMLOGGER_LEVEL_INFO, "-------- DMServer at (%p) deinitialized.\n", (*dmserver));
@@ -92,8 +107,9 @@ bool dmserver_open(dmserver_pt dmserver){
     if (!dmserver) return false;
     if ((dmserver->sstate != DMSERVER_STATE_INITIALIZED) && (dmserver->sstate != DMSERVER_STATE_CLOSED)) return false;
 
-    // Initialize server connection data and ssl:
+    // Initialize server connection data and ssl (no TLS over datagrams):
     dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "DMServer opening...");
+    if ((dmserver->sconn.ssocktype == SOCK_DGRAM) && (dmserver->sconn.sssl_enable || (dmserver->sconn.ssafamily == AF_UNIX))) return false;
     if (!_dmserver_sconn_init(&dmserver->sconn)) return false;
     dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "dmserver_open() - server connection data initialized.");
 
@@ -105,22 +121,45 @@ bool dmserver_open(dmserver_pt dmserver){
         dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "dmserver_open() - server ssl data initialized.");
     }
 
-    // Start listening on server socket:
-    if (!_dmserver_sconn_listen(&dmserver->sconn)) {
-        _dmserver_sconn_ssldeinit(&dmserver->sconn);
-        _dmserver_sconn_deinit(&dmserver->sconn);
-        return false;
+    if (dmserver->sconn.ssocktype == SOCK_DGRAM){
+        // Open the subordinate threads datagram sockets (no listen):
+        if (!__dmserver_worker_dgram_alloc(&dmserver->sworker, &dmserver->sconn)) {
+            _dmserver_sconn_deinit(&dmserver->sconn);
+            return false;
+        }
+        dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "dmserver_open() - server datagram sockets opened, one per subordinate thread.");
+    } else {
+        // Start listening on server socket:
+        if (!_dmserver_sconn_listen(&dmserver->sconn)) {
+            _dmserver_sconn_ssldeinit(&dmserver->sconn);
+            _dmserver_sconn_deinit(&dmserver->sconn);
+            return false;
+        }
+        dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "dmserver_open() - server listening, with a backlog of size %d.", dmserver->sconn.sbacklog);
     }
-    dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "dmserver_open() - server listening, with a backlog of size %d.", SOMAXCONN);
 
-    // Server state update:
+    // Additional listeners (all closed if any of them fails):
+    for (size_t i = 0; i < dmserver->slisteners_count; i++){
+        if (!_dmserver_sconn_open(&dmserver->slisteners[i].lconn)) {
+            for (size_t j = 0; j < i; j++) _dmserver_sconn_close(&dmserver->slisteners[j].lconn);
+            __dmserver_worker_dgram_dealloc(&dmserver->sworker);
+            _dmserver_sconn_close(&dmserver->sconn);
+            return false;
+        }
+        dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "dmserver_open() - listener %lu listening, with a backlog of size %d.", i + 1, dmserver->slisteners[i].lconn.sbacklog);
+    }
+
+    // Server state update (accepting again):
+    dmserver->sdraining = false;
     dmserver->sstate = DMSERVER_STATE_OPENED;
 
-    char sip_str[INET6_ADDRSTRLEN];
-    const void * addr = (dmserver->sconn.ssafamily == AF_INET) ? (void*)&dmserver->sconn.saddr.s4.sin_addr : (void*)&dmserver->sconn.saddr.s6.sin6_addr;
-    inet_ntop(dmserver->sconn.ssafamily, addr, sip_str, sizeof(sip_str));
-    int sport_num = dmserver->sconn.sport;
-    dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "DMServer open with address %s:%d.\n", sip_str, sport_num);
+    char saddr_str[DEFAULT_SCONN_ADDRSTRLEN];
+    _dmserver_sconn_addrstr(&dmserver->sconn, saddr_str, sizeof(saddr_str));
+    dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "DMServer open with %s %s.\n", (dmserver->sconn.ssafamily == AF_UNIX) ? "unix socket" : "address", saddr_str);
+    for (size_t i = 0; i < dmserver->slisteners_count; i++){
+        _dmserver_sconn_addrstr(&dmserver->slisteners[i].lconn, saddr_str, sizeof(saddr_str));
+        dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "DMServer listener %lu open with %s %s%s.\n", i + 1, (dmserver->slisteners[i].lconn.ssafamily == AF_UNIX) ? "unix socket" : "address", saddr_str, dmserver->slisteners[i].lconn.sssl_enable ? " (TLS)" : "");
+    }
 
     return true;
 }
@@ -140,6 +179,7 @@ bool dmserver_close(dmserver_pt dmserver){
 
     // Close (in order) all connection data within the server:
     dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "DMServer closing...");
+    __dmserver_worker_dgram_dealloc(&dmserver->sworker);
     _dmserver_sconn_deinit(&dmserver->sconn);
     dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "dmserver_close() - server connection data deinitialized.");
 
@@ -148,6 +188,9 @@ bool dmserver_close(dmserver_pt dmserver){
         dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "dmserver_close() - server ssl data deinitialized.");
     }
 
+    // Close the additional listeners:
+    for (size_t i = 0; i < dmserver->slisteners_count; i++) _dmserver_sconn_close(&dmserver->slisteners[i].lconn);
+
     // Server state update:
     dmserver->sstate = DMSERVER_STATE_CLOSED;
     dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "DMServer closed.\n");
@@ -172,6 +215,9 @@ bool dmserver_run(dmserver_pt dmserver){
     dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "DMServer starting run...");
     dmserver->sstate = DMSERVER_STATE_RUNNING;
 
+    // Upstreams connections due right away (reconnection backoff restarted):
+    _dmserver_upstreams_rearm(&dmserver->supstreams);
+
     // Subordinate threads launch (args freed inside the subordinate thread):
     for (size_t i = 0; i < dmserver->sworker.wth_subthreads; i++){
         dmserver_subthargs_t * args = calloc(1, sizeof(dmserver_subthargs_t));
@@ -214,7 +260,9 @@ bool dmserver_stop(dmserver_pt dmserver){
     dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "DMServer stopping...");
     dmserver->sstate = DMSERVER_STATE_STOPPING;
 
-    // Force threads to finish by signaling wthctl and block-wait:
+    // Wake every thread up (no epoll timeout waited) and block-wait:
+    eventfd_write(dmserver->sworker.wmainevfd, 1);
+    for (size_t i = 0; i < dmserver->sworker.wth_subthreads; i++) eventfd_write(dmserver->sworker.wsubevfd[i], 1);
     pthread_join(dmserver->sworker.wmainth, NULL);
     dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "dmserver_stop() - Stopped main thread %d.", dmserver->sworker.wmainth);
 
@@ -235,10 +283,14 @@ bool dmserver_stop(dmserver_pt dmserver){
 
 // ======== Broadcast / Unicast / Disconnect:
 /*
-    @brief Function to broadcast data through all the connected clients.
+    @brief Function to broadcast data through all the connected clients. The data is copied once and
+    shared by all the clients (queued after their write buffer data).
     @note: This function only works if the server is running.
     @note: If an error happens when writting to a single client, that client will be 
-    ignored.
+    ignored. Clients behind get the server default slow consumers policy applied. Upstream
+    connections are not clients and proxied clients only get their upstream bytes, both skipped.
+    @note: In prefork mode the other shards deliver it to their own clients as well (through the
+    shards bus, payloads up to the bus message length).
 
     @param dmserver_pt dmserver: Reference to dmserver struct.
     @param const char * bcdata: Pointer to broadcast data to sent.
@@ -250,31 +302,18 @@ bool dmserver_broadcast(dmserver_pt dmserver, dmserver_cliloc_pt bexclude, const
     // References & state check:
     if (!dmserver || !bcdata) return false;
     if (dmserver->sstate != DMSERVER_STATE_RUNNING) return false;
+    if (!bcdata[0]) return true;
 
-    // Broadcast write to every connected client:
+    // Broadcast write to every connected client (shared payload copied once):
     dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "Starting broadcast...");
-    for (size_t i = 0; i < dmserver->sworker.wth_subthreads; i++){for (size_t j = 0; j < dmserver->sworker.wth_clispersth; j++){
-        // Check client broadcast condition:
-        dmserver_cliconn_pt dmclient = &dmserver->sworker.wcclis[i][j];
-        if (dmclient->cstate != DMSERVER_CLIENT_ESTABLISHED) continue;
-        if (bexclude && (dmclient->cloc.th_pos == bexclude->th_pos) && (dmclient->cloc.wc_pos == bexclude->wc_pos)) continue;
-
-        // Copy broadcast data to the client write buffer:
-        pthread_mutex_lock(&dmclient->cwlock);
-
-        strncpy(dmclient->cwbuffer, bcdata, dmclient->cwbuffer_size - 1);
-        dmclient->cwbuffer[dmclient->cwbuffer_size - 1] = '\0';
-        dmclient->cwlen = strlen(dmclient->cwbuffer);
-
-        pthread_mutex_unlock(&dmclient->cwlock);
-
-        // Enable the output event on his epoll file descriptor:
-        if (epoll_ctl(dmserver->sworker.wsubepfd[i], EPOLL_CTL_MOD, dmclient->cfd, &(struct epoll_event){.events=EPOLLIN|EPOLLOUT|EPOLLET, .data.ptr=dmclient}) < 0) {
-            dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "Broadcast not queued to client %d.", dmclient->cfd);
-            continue;
-        }
-        dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "Broadcast queued to client %d.", dmclient->cfd);
-    }}
+    size_t bclen = strlen(bcdata);
+    long queued = _dmserver_worker_bcast(&dmserver->sworker, bexclude, bcdata, bclen);
+    if (queued < 0) return false;
+    dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "Broadcast queued to %ld clients.", queued);
+
+    // Prefork shards, the other processes deliver it to their own clients:
+    if (dmserver->sshards.sbus && !_dmserver_shards_broadcast(&dmserver->sshards, bcdata, bclen))
+        dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_WARNING, "Broadcast not pushed to every shard.");
     dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "Broadcast finalized.\n");
 
     return true;
@@ -282,7 +321,9 @@ bool dmserver_broadcast(dmserver_pt dmserver, dmserver_cliloc_pt bexclude, const
 
 /*
     @brief Function to unicast data through the selected client.
-    @note: This function only works if the server is running.
+    @note: This function only works if the server is running. Datagram sessions get one datagram per
+    unicast (queued as a message, subject to the server slow consumers policy). Shared memory clients
+    reject data over their largest frame (counted in the slow consumers counters as oversized).
 
     @param dmserver_pt dmserver: Reference to dmserver struct.
     @param dmserver_cliloc_pt dmcliloc: Client location coordenates.
@@ -301,6 +342,24 @@ bool dmserver_unicast(dmserver_pt dmserver, dmserver_cliloc_pt dmcliloc, const c
     dmserver_cliconn_pt dmclient = &dmserver->sworker.wcclis[dmcliloc->th_pos][dmcliloc->wc_pos];
     if (dmclient->cstate != DMSERVER_CLIENT_ESTABLISHED) return false;
 
+    // Datagram sessions, unicast data queued as a message (the write buffer would be overwritten by
+    // the next unicast before being sent):
+    if (dmclient->ctransport == DMSERVER_TRANSPORT_DGRAM) {
+        dmserver_cmsg_pt m = _dmserver_worker_msgnew(&dmserver->sworker, ucdata, strlen(ucdata), NULL);
+        if (!m) return false;
+        bool queued = _dmserver_worker_qpush(&dmserver->sworker, dmclient, m, &dmserver->sworker.wslow);
+        _dmserver_cmsg_unref(m);
+        dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, queued ? "Unicast queued." : "Unicast not queued.");
+        return queued;
+    }
+
+    // Shared memory clients, unicast data over the largest frame rejected (never written):
+    size_t uclen = strnlen(ucdata, dmclient->cwbuffer_size - 1);
+    if (!_dmserver_worker_shmfits(&dmserver->sworker, dmclient, uclen)) {
+        dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "Unicast of %lu bytes over the shared memory frame of client %d.", uclen, dmclient->cfd);
+        return false;
+    }
+
     // Copy unicast data to the client write buffer:
     dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "Starting unicast to client %d...", dmclient->cfd);
     pthread_mutex_lock(&dmclient->cwlock);
@@ -311,8 +370,8 @@ bool dmserver_unicast(dmserver_pt dmserver, dmserver_cliloc_pt dmcliloc, const c
 
     pthread_mutex_unlock(&dmclient->cwlock);
 
-    // Enable the output event on his epoll file descriptor:
-    if (epoll_ctl(dmserver->sworker.wsubepfd[dmcliloc->th_pos], EPOLL_CTL_MOD, dmclient->cfd, &(struct epoll_event){.events=EPOLLIN|EPOLLOUT|EPOLLET, .data.ptr=dmclient}) < 0) {
+    // Queue the client to be written at the end of its subordinate thread round:
+    if (!_dmserver_worker_qflush(&dmserver->sworker, dmclient)) {
         dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "Unicast not queued.");
         return false;
     }
@@ -324,155 +383,1520 @@ bool dmserver_unicast(dmserver_pt dmserver, dmserver_cliloc_pt dmcliloc, const c
 
 /*
     @brief Function to force a client to disconnect from the server.
+    @note: Clients disconnected from a foreign thread while running are disconnected by their subthread
+    at the end of its round (requested here), the disconnection callback called there.
 
     @param dmserver_pt dmserver: Reference to dmserver struct.
     @param dmserver_cliloc_pt dmcliloc: Client location coordenates.
 
-    @retval true: Client disconnected correctly.
+    @retval true: Client disconnected correctly (or disconnection requested to its subthread).
     @retval false: Client disconnection failed.
 */
 bool dmserver_disconnect(dmserver_pt dmserver, dmserver_cliloc_pt dmcliloc){
-    // References, & client state check:
-    if (!dmserver) return false;
+    // References, bounds & client state check:
+    if (!dmserver || !dmcliloc || !dmserver->sworker.wcclis) return false;
+    if ((dmcliloc->th_pos >= dmserver->sworker.wth_subthreads) || (dmcliloc->wc_pos >= dmserver->sworker.wth_clispersth)) return false;
     dmserver_cliconn_pt cli = &dmserver->sworker.wcclis[dmcliloc->th_pos][dmcliloc->wc_pos];
     if ((cli->cstate != DMSERVER_CLIENT_ESTABLISHED) && (cli->cstate != DMSERVER_CLIENT_ESTABLISHING)) return false;
 
-    // Client socket file descriptor deletion from epoll:
-    epoll_ctl(dmserver->sworker.wsubepfd[dmcliloc->th_pos], EPOLL_CTL_DEL, cli->cfd, NULL);
+    // Clients from a foreign thread, disconnection requested to the client subthread (the only one
+    // touching its socket, TLS session, datagram session, pair pipes, rings, buffers & arena):
+    bool foreign = !pthread_equal(pthread_self(), dmserver->sworker.wsubth[dmcliloc->th_pos]);
+    if (foreign && (dmserver->sstate == DMSERVER_STATE_RUNNING)) return _dmserver_worker_qdisconnect(&dmserver->sworker, cli);
 
-    // Disconnection proccess:
-    if (dmserver->sconn.sssl_enable){
-        SSL_shutdown(cli->cssl);
-        SSL_free(cli->cssl);
+    if (cli->ctransport == DMSERVER_TRANSPORT_DGRAM){
+        // Datagram session, the subthread socket is shared (only the session is removed):
+        _dmserver_dgram_remove(&dmserver->sworker.wsubdgram[dmcliloc->th_pos], cli);
+    } else {
+        // Client socket file descriptor deletion from epoll:
+        epoll_ctl(dmserver->sworker.wsubepfd[dmcliloc->th_pos], EPOLL_CTL_DEL, cli->cfd, NULL);
+
+        // Proxy pair of the client closed (upstream socket & pipes):
+        if (cli->cproxy) _dmserver_proxy_close(&dmserver->sworker.wproxy[dmcliloc->th_pos][dmcliloc->wc_pos]);
+
+        // Shared memory connection of the client closed (rings & wake up event):
+        _dmserver_worker_shmclose(&dmserver->sworker, cli);
+
+        // Disconnection proccess:
+        if (cli->csconn->sssl_enable){
+            SSL_shutdown(cli->cssl);
+            SSL_free(cli->cssl);
+        }
+        close(cli->cfd);
     }
-    close(cli->cfd);
+
+    // Client subscriptions removal (no more messages published to it):
+    _dmserver_pubsub_unsubscribe_all(&dmserver->sworker.wsubtopics[dmcliloc->th_pos], cli);
 
     // Client state to closed:
     cli->cstate = DMSERVER_CLIENT_CLOSED;
     dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "Disconnected client %d.\n", cli->cfd);
 
+    // Upstream pool member down (reconnection scheduled by the main thread):
+    _dmserver_upstream_lost(cli, dmserver->sworker.wmainevfd);
+
+    // Disconnection traced & captured (before the reset, its location still valid):
+    DMSERVER_PROBE3(disconnect, cli->cfd, (int)dmcliloc->th_pos, (int)dmcliloc->wc_pos);
+    _dmserver_capture_record(&dmserver->scapture, DMSERVER_CAPTURE_DISCONNECT, cli, NULL, 0);
+
+    // User specific data processing of disconnected client (before the reset, its location, user
+    // context & arena still valid):
+    DMSERVER_PROBE2(cb_entry, "disconnect", cli->cfd);
+    if (cli->ccallback->on_client_disconnect) cli->ccallback->on_client_disconnect(cli);
+    DMSERVER_PROBE2(cb_exit, "disconnect", cli->cfd);
+
     // Client structure reset:
     _dmserver_cconn_reset(cli);
-    dmserver->sworker.wccount[dmcliloc->th_pos]--;
+    __atomic_sub_fetch(&dmserver->sworker.wccount[dmcliloc->th_pos], 1, __ATOMIC_RELAXED);
+
+    return true;
+}
+
+
+
+
+// ======== Pub/Sub:
+/*
+    @brief Function to subscribe a client to a topic, so it receives the data published on it.
+    @note: This function only works if the server is running. Subscriptions are removed on disconnection.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param dmserver_cliloc_pt dmcliloc: Client location coordenates.
+    @param const char * topic: Topic name (DEFAULT_PUBSUB_TOPICLEN - 1 characters max).
+
+    @retval false: Subscription failed.
+    @retval true: Subscription succeeded.
+*/
+bool dmserver_subscribe(dmserver_pt dmserver, dmserver_cliloc_pt dmcliloc, const char * topic){
+    // References, state & bounds check:
+    if (!dmserver || !dmcliloc || !topic) return false;
+    if (dmserver->sstate != DMSERVER_STATE_RUNNING) return false;
+    if ((dmcliloc->th_pos >= dmserver->sworker.wth_subthreads) || (dmcliloc->wc_pos >= dmserver->sworker.wth_clispersth)) return false;
 
-    // User specific data processing of disconnected client:
-    if (dmserver->scallback.on_client_disconnect) dmserver->scallback.on_client_disconnect(cli);
+    // Client established check:
+    dmserver_cliconn_pt dmclient = &dmserver->sworker.wcclis[dmcliloc->th_pos][dmcliloc->wc_pos];
+    if (dmclient->cstate != DMSERVER_CLIENT_ESTABLISHED) return false;
 
+    // Subscription in the topics index of the client subthread:
+    if (!_dmserver_pubsub_subscribe(&dmserver->sworker.wsubtopics[dmcliloc->th_pos], dmclient, topic)) return false;
+    dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "Client %d subscribed to topic %s.", dmclient->cfd, topic);
     return true;
 }
 
+/*
+    @brief Function to unsubscribe a client from a topic.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param dmserver_cliloc_pt dmcliloc: Client location coordenates.
+    @param const char * topic: Topic name.
 
+    @retval false: Client was not subscribed.
+    @retval true: Unsubscription succeeded.
+*/
+bool dmserver_unsubscribe(dmserver_pt dmserver, dmserver_cliloc_pt dmcliloc, const char * topic){
+    // References & bounds check:
+    if (!dmserver || !dmcliloc || !topic) return false;
+    if ((dmcliloc->th_pos >= dmserver->sworker.wth_subthreads) || (dmcliloc->wc_pos >= dmserver->sworker.wth_clispersth)) return false;
 
+    // Removal from the topics index of the client subthread:
+    dmserver_cliconn_pt dmclient = &dmserver->sworker.wcclis[dmcliloc->th_pos][dmcliloc->wc_pos];
+    if (!_dmserver_pubsub_unsubscribe(&dmserver->sworker.wsubtopics[dmcliloc->th_pos], dmclient, topic)) return false;
+    dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "Client %d unsubscribed from topic %s.", dmclient->cfd, topic);
+    return true;
+}
 
-// ======== Configuration - General:
 /*
-    @brief Function to configure the server connection data.
-    @note: This function must be called after initialization OR after closing the server.
+    @brief Function to publish data to all the clients subscribed to a topic. The cost only depends on
+    the subscribers (per subthread topics index), and the payload is copied once and shared by all of
+    them (queued after their write buffer data).
+    @note: This function only works if the server is running.
+    @note: Subscribers behind get the slow consumers policy of the topic applied (server default if 
+    not specific), coalescing by topic.
 
-    @param dmserver_pt dmserver: Reference to server struct.
-    @param dmserver_servconn_conf_pt: Reference to server connection configuration struct.
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param const char * topic: Topic name.
+    @param const char * pbdata: Pointer to the data to publish.
+    @param size_t pblen: Data length.
 
-    @retval true: Configuration succeeded.
-    @retval false: Configuration failed.
+    @retval false: Publish failed (or rejected by a shared memory subscriber, over its largest frame).
+    @retval true: Publish succeeded (even without subscribers).
 */
-bool dmserver_conf_sconn(dmserver_pt dmserver, dmserver_servconn_conf_pt sconn_conf){
-    // Reference & state check:
-    if (!dmserver) return false;
-    if ((dmserver->sstate != DMSERVER_STATE_INITIALIZED) && (dmserver->sstate != DMSERVER_STATE_CLOSED)) return false;
+bool dmserver_publish(dmserver_pt dmserver, const char * topic, const char * pbdata, size_t pblen){
+    return dmserver_publish_key(dmserver, topic, topic, pbdata, pblen);
+}
 
+/*
+    @brief Function to publish data to all the clients subscribed to a topic, with a specific coalescing
+    key (pending messages of the same key are replaced by the newest under the coalesce policy).
+    @note: This function only works if the server is running.
 
-    // If there is no configuration structure, set to defaults:
-    if (!sconn_conf) {
-        __dmserver_sconn_set_defaults(&dmserver->sconn);
-        return true;
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param const char * topic: Topic name.
+    @param const char * pbkey: Coalescing key.
+    @param const char * pbdata: Pointer to the data to publish.
+    @param size_t pblen: Data length.
+
+    @retval false: Publish failed (or rejected by a shared memory subscriber, over its largest frame).
+    @retval true: Publish succeeded (even without subscribers).
+*/
+bool dmserver_publish_key(dmserver_pt dmserver, const char * topic, const char * pbkey, const char * pbdata, size_t pblen){
+    // References & state check:
+    if (!dmserver || !topic || !pbdata || (pblen == 0)) return false;
+    if (dmserver->sstate != DMSERVER_STATE_RUNNING) return false;
+
+    // Shared payload (publisher reference released at the end) & topic slow consumers policy:
+    dmserver_cmsg_pt m = _dmserver_worker_msgnew(&dmserver->sworker, pbdata, pblen, pbkey);
+    if (!m) return false;
+    dmserver_slow_conf_pt sc = _dmserver_worker_slowconf(&dmserver->sworker, topic);
+
+    // Subscribers of every subthread index:
+    size_t nsubs = 0;
+    bool oversized = false;
+    for (size_t i = 0; i < dmserver->sworker.wth_subthreads; i++){
+        dmserver_pubsub_pt p = &dmserver->sworker.wsubtopics[i];
+        pthread_rwlock_rdlock(&p->plock);
+        dmserver_topic_pt t = _dmserver_pubsub_lookup(p, topic);
+        for (size_t j = 0; t && (j < t->tsubs_count); j++){
+            // Shared memory subscribers with the payload over their largest frame (rejected & counted):
+            if (!_dmserver_worker_shmfits(&dmserver->sworker, t->tsubs[j], pblen)) {
+                dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "Publish on topic %s over the shared memory frame of client %d.", topic, t->tsubs[j]->cfd);
+                oversized = true;
+                continue;
+            }
+
+            // Queue the shared payload & the client to be written at the end of its subordinate thread round:
+            if (!_dmserver_worker_qpush(&dmserver->sworker, t->tsubs[j], m, sc)) {
+                dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "Publish on topic %s not queued to client %d.", topic, t->tsubs[j]->cfd);
+                continue;
+            }
+            nsubs++;
+        }
+        pthread_rwlock_unlock(&p->plock);
     }
+    _dmserver_cmsg_unref(m);
 
-    // Server connection port configuration:
-    if (sconn_conf->sport && (sconn_conf->sport >= 1024) && (sconn_conf->sport <= 65535)) __dmserver_sconn_set_port(&dmserver->sconn, sconn_conf->sport);
+    dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "Published %zu bytes on topic %s to %zu subscribers.", pblen, topic, nsubs);
+    return !oversized;
+}
 
-    // Server connection socket address configuration:
-    if (sconn_conf->ssa_family && ((sconn_conf->ssa_family == AF_INET) || (sconn_conf->ssa_family == AF_INET6))) __dmserver_sconn_set_safamily(&dmserver->sconn, sconn_conf->ssa_family);
+/*
+    @brief Function to get the slow consumers policy actions counters, the messages rejected over the
+    largest frame of their client (shared memory clients) and the pending output memory.
 
-    // Server connection ipv6 only flag configuration:
-    __dmserver_sconn_set_ipv6only(&dmserver->sconn, sconn_conf->sipv6_only);
-    
-    // Server secure socket layer encryption flag:
-    __dmserver_sconn_set_tls(&dmserver->sconn, sconn_conf->stls_enable);
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param dmserver_slow_stats_pt stats: Output counters.
+
+    @retval false: Invalid references.
+    @retval true: Counters copied.
+*/
+bool dmserver_get_slowstats(dmserver_pt dmserver, dmserver_slow_stats_pt stats){
+    // References check:
+    if (!dmserver || !stats) return false;
+
+    // Counters snapshot:
+    dmserver_slow_stats_pt ws = &dmserver->sworker.wslowstats;
+    stats->sdropped_newest = __atomic_load_n(&ws->sdropped_newest, __ATOMIC_RELAXED);
+    stats->sdropped_oldest = __atomic_load_n(&ws->sdropped_oldest, __ATOMIC_RELAXED);
+    stats->scoalesced = __atomic_load_n(&ws->scoalesced, __ATOMIC_RELAXED);
+    stats->sdisconnected = __atomic_load_n(&ws->sdisconnected, __ATOMIC_RELAXED);
+    stats->sbudget_exceeded = __atomic_load_n(&ws->sbudget_exceeded, __ATOMIC_RELAXED);
+    stats->soversized = __atomic_load_n(&ws->soversized, __ATOMIC_RELAXED);
+    stats->sout_bytes = __atomic_load_n(&ws->sout_bytes, __ATOMIC_RELAXED);
+    return true;
+}
+
+
+
+
+// ======== Access control / Reception limits / Overload control:
+/*
+    @brief Function to load the access rules checked on every accepted connection, before any
+    allocation for it (longest prefix match of the source address, IPv4 and IPv6).
+    @note: This function can be called at any moment, also with the server running (the new rules
+    replace the previous ones as a whole). Datagram and unix domain clients are not checked.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param const dmserver_acl_rule_t * rules: Access rules (prefixes in CIDR notation).
+    @param size_t nrules: Number of rules (0 with allow by default removes the access control).
+    @param enum dmserver_acl_action adefault: Action for the addresses without matching prefix.
 
-    // Server ssl certification and key path:
-    if (sconn_conf->scert_path && (strlen(sconn_conf->scert_path) < DEFAULT_SCONN_CERTPATHLEN)) __dmserver_sconn_set_certpath(&dmserver->sconn, sconn_conf->scert_path);
-    if (sconn_conf->skey_path && (strlen(sconn_conf->skey_path) < DEFAULT_SCONN_KEYPATHLEN)) __dmserver_sconn_set_keypath(&dmserver->sconn, sconn_conf->skey_path);
+    @retval false: Invalid rule or allocation failed (previous rules kept).
+    @retval true: Rules loaded.
+*/
+bool dmserver_set_acl(dmserver_pt dmserver, const dmserver_acl_rule_t * rules, size_t nrules, enum dmserver_acl_action adefault){
+    // Reference check:
+    if (!dmserver) return false;
 
+    // Rules load:
+    if (!_dmserver_acl_load(&dmserver->sacl, rules, nrules, adefault)) return false;
+    dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "Access control loaded with %zu rules.\n", nrules);
     return true;
 }
 
 /*
-    @brief Function to configure workers parameters before launching.
-    @note: This function must be called after initialization OR after closing the server.
+    @brief Function to set the concurrent connections limit per source IP, checked on every accepted
+    connection before any allocation for it.
+    @note: This function can be called at any moment, also with the server running. Connections
+    accepted before the first limit (without IP limits) are not counted.
 
-    @param dmserver_pt dmserver: Reference to server struct.
-    @param dmserver_servconn_conf_pt worker_conf: Reference to worker connection configuration struct.
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param size_t max_conns: Connections per source IP (0 unlimited).
 
-    @retval true: Configuration succeeded.
-    @retval false: Configuration failed.
+    @retval false: Allocation failed.
+    @retval true: Limit set.
 */
-bool dmserver_conf_worker(dmserver_pt dmserver, dmserver_worker_conf_pt worker_conf){
-    // Reference & state check:
+bool dmserver_set_ipconns(dmserver_pt dmserver, size_t max_conns){
+    // Reference check:
     if (!dmserver) return false;
-    if ((dmserver->sstate != DMSERVER_STATE_INITIALIZED) && (dmserver->sstate != DMSERVER_STATE_CLOSED)) return false;
 
-    // Deallocate previous worker configuraiton and memory:
-    if (!__dmserver_worker_dealloc(&dmserver->sworker)) return false;
+    // Limit set:
+    return __dmserver_limits_set_maxconns(&dmserver->slimits, max_conns);
+}
 
-    // If there is no configuration given, set to defaults and exit:
-    if (!worker_conf) {
-        __dmserver_worker_set_defaults(&dmserver->sworker);
-        __dmserver_worker_alloc(&dmserver->sworker);
-        return true;
+/*
+    @brief Function to get the reception limits and access control actions counters.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param dmserver_limits_stats_pt stats: Output counters.
+
+    @retval false: Invalid references.
+    @retval true: Counters copied.
+*/
+bool dmserver_get_limitstats(dmserver_pt dmserver, dmserver_limits_stats_pt stats){
+    // References check:
+    if (!dmserver || !stats) return false;
+
+    // Counters snapshot:
+    dmserver_limits_stats_pt ls = &dmserver->slimits.lstats;
+    stats->lpaused_cli = __atomic_load_n(&ls->lpaused_cli, __ATOMIC_RELAXED);
+    stats->lpaused_ip = __atomic_load_n(&ls->lpaused_ip, __ATOMIC_RELAXED);
+    stats->liptable_full = __atomic_load_n(&ls->liptable_full, __ATOMIC_RELAXED);
+    stats->ldenied_acl = __atomic_load_n(&dmserver->sacl.adenied, __ATOMIC_RELAXED);
+    stats->ldenied_conns = __atomic_load_n(&ls->ldenied_conns, __ATOMIC_RELAXED);
+    return true;
+}
+
+/*
+    @brief Function to get the overload control state (subthreads overloaded now & highest sojourn
+    of their last rounds) and actions counters.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param dmserver_overload_stats_pt stats: Reference to the stats struct to fill.
+
+    @retval false: Invalid references.
+    @retval true: Stats filled.
+*/
+bool dmserver_get_overload(dmserver_pt dmserver, dmserver_overload_stats_pt stats){
+    // References check:
+    if (!dmserver || !stats) return false;
+
+    // State of the subthreads controllers:
+    stats->ooverloaded = 0;
+    stats->osojourn_usec = 0;
+    for (size_t i = 0; dmserver->sworker.wsubcodel && (i < dmserver->sworker.wth_subthreads); i++){
+        if (_dmserver_overload_state(&dmserver->sworker.wsubcodel[i])) stats->ooverloaded++;
+        long sojourn = __atomic_load_n(&dmserver->sworker.wsubcodel[i].csojourn, __ATOMIC_RELAXED) / 1000;
+        if ((size_t)sojourn > stats->osojourn_usec) stats->osojourn_usec = (size_t)sojourn;
     }
 
-    // Configure subordinate threads number, clients per subordinate thread and timeout per client:
-    if (worker_conf->wth_subthreads) __dmserver_worker_set_subthreads(&dmserver->sworker, worker_conf->wth_subthreads);
-    if (worker_conf->wth_clispersth) __dmserver_worker_set_clispersth(&dmserver->sworker, worker_conf->wth_clispersth);
-    if (worker_conf->wth_clistimeout) __dmserver_worker_set_clistimeout(&dmserver->sworker, worker_conf->wth_clistimeout);
+    // Counters snapshot:
+    dmserver_overload_stats_pt os = &dmserver->sworker.wovlstats;
+    stats->oentered = __atomic_load_n(&os->oentered, __ATOMIC_RELAXED);
+    stats->osheds = __atomic_load_n(&os->osheds, __ATOMIC_RELAXED);
+    stats->orejected = __atomic_load_n(&os->orejected, __ATOMIC_RELAXED);
+    return true;
+}
 
-    if (!__dmserver_worker_alloc(&dmserver->sworker)) return false;
+
+
+
+// ======== Connections registry:
+/*
+    @brief Function to take a snapshot of the connected clients metadata (location, socket, transport,
+    address, connection & last reception time, traffic counters), all of them or the ones accepted by
+    a filter, from any thread and without blocking the subthreads (slots read lock-free, each record 
+    consistent on its own).
+    @note: Large registries can be taken in pages, the cursor keeps the next slot to read (the whole
+    registry read once it reaches the slots count).
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param dmserver_cliinfo_pt infos: Metadata records to fill.
+    @param size_t ninfos: Number of records.
+    @param bool (*filter)(const dmserver_cliinfo_t *, void *): Filter of the clients (NULL all).
+    @param void * arg: Filter argument.
+    @param size_t * cursor: First slot to read, next slot to read on return (NULL whole registry from
+    the first slot).
+
+    @retval Number of records filled.
+*/
+size_t dmserver_get_clients(dmserver_pt dmserver, dmserver_cliinfo_pt infos, size_t ninfos, bool (*filter)(const dmserver_cliinfo_t *, void *), void * arg, size_t * cursor){
+    // References check:
+    if (!dmserver || !infos || !dmserver->sworker.wcclis) return 0;
+
+    // Slots from the cursor (subthread major) until the records are full:
+    size_t nslots = dmserver->sworker.wth_subthreads * dmserver->sworker.wth_clispersth;
+    size_t slot = (cursor) ? *cursor : 0;
+    size_t n = 0;
+    for (; (slot < nslots) && (n < ninfos); slot++){
+        dmserver_cliconn_pt c = &dmserver->sworker.wcclis[slot / dmserver->sworker.wth_clispersth][slot % dmserver->sworker.wth_clispersth];
+        if (!_dmserver_cconn_info(c, &infos[n])) continue;
+        if (filter && !filter(&infos[n], arg)) continue;
+        n++;
+    }
+    if (cursor) *cursor = slot;
+    return n;
+}
+
+
+
+
+// ======== Unix domain file descriptors passing:
+/*
+    @brief Function to unicast data together with a file descriptor (SCM_RIGHTS) through the
+    selected unix domain client, for zero-copy handoff of files, pipes or sockets.
+    @note: This function only works if the server is running on a unix domain socket without TLS and 
+    with file descriptors passing enabled. The descriptor is duplicated, the caller keeps its own.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param dmserver_cliloc_pt dmcliloc: Client location coordenates.
+    @param const char * ucdata: Pointer to unicast data to sent (at least one byte).
+    @param int ucfd: File descriptor to pass.
+
+    @retval false: Unicast failed.
+    @retval true: Unicast succeeded.
+*/
+bool dmserver_unicast_fd(dmserver_pt dmserver, dmserver_cliloc_pt dmcliloc, const char * ucdata, int ucfd){
+    // References, state, transport & bounds check:
+    if (!dmserver || !dmcliloc || !ucdata || !ucdata[0] || (ucfd < 0)) return false;
+    if (dmserver->sstate != DMSERVER_STATE_RUNNING) return false;
+    if ((dmcliloc->th_pos >= dmserver->sworker.wth_subthreads) || (dmcliloc->wc_pos >= dmserver->sworker.wth_clispersth)) return false;
+
+    // Client established check (accepted by a unix domain listener with file descriptors passing):
+    dmserver_cliconn_pt dmclient = &dmserver->sworker.wcclis[dmcliloc->th_pos][dmcliloc->wc_pos];
+    if (dmclient->cstate != DMSERVER_CLIENT_ESTABLISHED) return false;
+    if ((dmclient->csconn->ssafamily != AF_UNIX) || !dmclient->csconn->sunixpassfd || dmclient->csconn->sssl_enable) return false;
+
+    // Copy unicast data and the file descriptor to the client write buffer:
+    pthread_mutex_lock(&dmclient->cwlock);
+    if (dmclient->cwfdslen >= DEFAULT_CCONN_MAXFDS) {
+        pthread_mutex_unlock(&dmclient->cwlock);
+        return false;
+    }
+    int dfd = fcntl(ucfd, F_DUPFD_CLOEXEC, 0);
+    if (dfd < 0) {
+        pthread_mutex_unlock(&dmclient->cwlock);
+        return false;
+    }
+    dmclient->cwfds[dmclient->cwfdslen++] = dfd;
+
+    strncpy(dmclient->cwbuffer, ucdata, dmclient->cwbuffer_size - 1);
+    dmclient->cwbuffer[dmclient->cwbuffer_size - 1] = '\0';
+    dmclient->cwlen = strlen(dmclient->cwbuffer);
+
+    pthread_mutex_unlock(&dmclient->cwlock);
+
+    // Queue the client to be written at the end of its subordinate thread round:
+    if (!_dmserver_worker_qflush(&dmserver->sworker, dmclient)) return false;
+    dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "Unicast with file descriptor queued to client %d.", dmclient->cfd);
     return true;
 }
 
+
+
+
+// ======== Upstreams / Proxy:
 /*
-    @brief Function to configure the clients buffers length.
-    @note: This function must be called after initialization OR after closing the server.
+    @brief Function to add an upstream, a pool of outbound connections to a remote endpoint handled by
+    the worker subthreads as any accepted client (same callbacks, unicast, pub/sub, write queues and
+    timeouts). Every pool member connects without blocking (TLS handshake as client if enabled) and
+    reconnects with exponential backoff once lost, while the server runs.
+    @note: This function can be called at any moment (the connections start once the server runs). The
+    host name is resolved once, here (blocking). Upstream connections are skipped by broadcasts and the
+    reception limits.
 
-    @param dmserver_pt dmserver: Reference to server struct.
-    @param dmserver_cliconn_conf_pt cconn_conf: Reference to client connection (buffers only) configuration struct.
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param dmserver_upstream_conf_pt upstream_conf: Upstream configuration (endpoint, TLS, pool, backoff & callbacks).
+    @param size_t * upid: Output upstream id (NULL ignored).
 
-    @retval true: Configuration succeeded.
-    @retval false: Configuration failed.
+    @retval false: Invalid configuration, resolution or allocation failed.
+    @retval true: Upstream added.
 */
-bool dmserver_conf_cconn(dmserver_pt dmserver, dmserver_cliconn_conf_pt cconn_conf){
-    // Reference & state check:
+bool dmserver_connect(dmserver_pt dmserver, dmserver_upstream_conf_pt upstream_conf, size_t * upid){
+    // References check:
+    if (!dmserver || !upstream_conf) return false;
+
+    // Upstream add & main thread wake up (first connection attempts):
+    size_t id;
+    if (!_dmserver_upstreams_add(&dmserver->supstreams, upstream_conf, &id)) {
+        dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_ERROR, "Upstream %s:%d could not be added.\n", upstream_conf->uhost ? upstream_conf->uhost : "(null)", upstream_conf->uport);
+        return false;
+    }
+    if (dmserver->sstate == DMSERVER_STATE_RUNNING) eventfd_write(dmserver->sworker.wmainevfd, 1);
+    dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "Upstream %lu added (%s:%d, %s, pool of %lu).\n", id, upstream_conf->uhost, upstream_conf->uport, upstream_conf->utls ? "TLS" : "plain", _dmserver_upstreams_get(&dmserver->supstreams, id)->upool);
+
+    if (upid) *upid = id;
+    return true;
+}
+
+/*
+    @brief Function to pick a connected member of an upstream pool (round robin), to unicast through it.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param size_t upid: Upstream id.
+    @param dmserver_cliloc_pt dmcliloc: Output client location of the member picked.
+
+    @retval false: Unknown upstream or no member connected.
+    @retval true: Member picked.
+*/
+bool dmserver_upstream_pick(dmserver_pt dmserver, size_t upid, dmserver_cliloc_pt dmcliloc){
+    // References check:
+    if (!dmserver || !dmcliloc) return false;
+
+    // Member pick:
+    return _dmserver_upstream_pick(_dmserver_upstreams_get(&dmserver->supstreams, upid), dmcliloc);
+}
+
+/*
+    @brief Function to close an upstream: no more connection attempts and its pool members connecting
+    or connected are disconnected (disconnection callbacks called). The id is not reused.
+    @note: While running, the close is requested to the main thread (the one connecting the pool
+    members), which requests their disconnection to their subthreads (callbacks called there).
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param size_t upid: Upstream id.
+
+    @retval false: Unknown upstream or allocation failed.
+    @retval true: Upstream closed.
+*/
+bool dmserver_upstream_close(dmserver_pt dmserver, size_t upid){
+    // Reference check:
     if (!dmserver) return false;
-    if ((dmserver->sstate != DMSERVER_STATE_INITIALIZED) && (dmserver->sstate != DMSERVER_STATE_CLOSED)) return false;
+    dmserver_upstream_pt u = _dmserver_upstreams_get(&dmserver->supstreams, upid);
+    if (!u) return false;
 
-    // Iterate over all the clients slots on the server:
-    for (size_t i = 0; i < dmserver->sworker.wth_subthreads; i++){for (size_t j = 0; j < dmserver->sworker.wth_clispersth; j++){
-        // Client:
-        dmserver_cliconn_pt dmclient = &dmserver->sworker.wcclis[i][j];
+    // Server running, close requested to the main thread (no pool member half handed to its subthread):
+    if (dmserver->sstate == DMSERVER_STATE_RUNNING) {
+        if (_dmserver_upstream_qclose(u)) eventfd_write(dmserver->sworker.wmainevfd, 1);
+        dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "Upstream %lu close requested.\n", upid);
+        return true;
+    }
 
-        // Deallocate previous read/write buffers:
-        if (!__dmserver_cconn_buf_dealloc(dmclient)) continue;
+    // Pool members disconnection:
+    dmserver_cliloc_pt locs = calloc(u->upool, sizeof(dmserver_cliloc_t));
+    if (!locs) return false;
+    size_t n = _dmserver_upstream_close(u, locs);
+    for (size_t i = 0; i < n; i++) dmserver_disconnect(dmserver, &locs[i]);
+    free(locs);
 
-        // In case that the configuration structure is null, set the default buffers length:
-        if (!cconn_conf) __dmserver_cconn_set_defaults(dmclient);
+    dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "Upstream %lu closed.\n", upid);
+    return true;
+}
 
-        // Read/Write buffers length set:
-        if (cconn_conf->cread_buffer_size) __dmserver_cconn_set_creadbuffer(dmclient, cconn_conf->cread_buffer_size);
-        if (cconn_conf->cwrite_buffer_size) __dmserver_cconn_set_cwritebuffer(dmclient, cconn_conf->cwrite_buffer_size);
+/*
+    @brief Function to get the proxy mode counters (pairs opened, upstream connections failed, pairs
+    relayed with kernel TLS and bytes relayed both ways).
 
-        // Allocate new read/write buffers:
-        if (!__dmserver_cconn_buf_alloc(dmclient)) continue;
-    }}
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param dmserver_proxy_stats_pt stats: Output counters.
+
+    @retval false: Invalid references.
+    @retval true: Counters copied.
+*/
+bool dmserver_get_proxystats(dmserver_pt dmserver, dmserver_proxy_stats_pt stats){
+    // References check:
+    if (!dmserver || !stats) return false;
+
+    // Counters snapshot:
+    dmserver_proxy_stats_pt ps = &dmserver->sworker.wproxystats;
+    stats->ppairs = __atomic_load_n(&ps->ppairs, __ATOMIC_RELAXED);
+    stats->pfailed = __atomic_load_n(&ps->pfailed, __ATOMIC_RELAXED);
+    stats->pktls = __atomic_load_n(&ps->pktls, __ATOMIC_RELAXED);
+    stats->pbytes_c2u = __atomic_load_n(&ps->pbytes_c2u, __ATOMIC_RELAXED);
+    stats->pbytes_u2c = __atomic_load_n(&ps->pbytes_u2c, __ATOMIC_RELAXED);
+    return true;
+}
+
+/*
+    @brief Function to get the bytes relayed by the proxy pair of a client.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param dmserver_cliloc_pt dmcliloc: Client location coordenates.
+    @param size_t * bytes_c2u: Output bytes relayed from the client to the upstream.
+    @param size_t * bytes_u2c: Output bytes relayed from the upstream to the client.
+
+    @retval false: Invalid references or client without proxy pair.
+    @retval true: Counters copied.
+*/
+bool dmserver_proxy_pairstats(dmserver_pt dmserver, dmserver_cliloc_pt dmcliloc, size_t * bytes_c2u, size_t * bytes_u2c){
+    // References & bounds check:
+    if (!dmserver || !dmcliloc || !bytes_c2u || !bytes_u2c) return false;
+    if ((dmcliloc->th_pos >= dmserver->sworker.wth_subthreads) || (dmcliloc->wc_pos >= dmserver->sworker.wth_clispersth)) return false;
+
+    // Pair of the client slot:
+    dmserver_proxy_pt p = &dmserver->sworker.wproxy[dmcliloc->th_pos][dmcliloc->wc_pos];
+    if (p->pfd < 0) return false;
+    *bytes_c2u = __atomic_load_n(&p->pc2u.fbytes, __ATOMIC_RELAXED);
+    *bytes_u2c = __atomic_load_n(&p->pu2c.fbytes, __ATOMIC_RELAXED);
+    return true;
+}
+
+
+
+
+// ======== User event sources (timers & file descriptors):
+/*
+    @brief Function to add a periodic timer to the event loop of a subthread, its callback called from
+    that subthread (same core as its clients, no cross-thread handoff), first after one interval.
+    @note: This function can be called at any moment, also from the callbacks. The timer only fires
+    while the server runs (expirations meanwhile reported at once). The worker configuration drops
+    every source.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param size_t subthread: Subthread index.
+    @param size_t interval_ms: Timer period in msec.
+    @param void (*timer_cb)(void *, uint64_t): Callback (user argument & expirations since the last call).
+    @param void * arg: User argument of the callback.
+    @param size_t * id: Output source id (in its subthread).
+
+    @retval false: Invalid arguments, no free source in the subthread or timer creation failed.
+    @retval true: Timer added.
+*/
+bool dmserver_add_timer(dmserver_pt dmserver, size_t subthread, size_t interval_ms, void (*timer_cb)(void *, uint64_t), void * arg, size_t * id){
+    // References & bounds check:
+    if (!dmserver || !id || (subthread >= dmserver->sworker.wth_subthreads)) return false;
+
+    if (!_dmserver_userevs_timer(&dmserver->sworker.wsubuserevs[subthread], dmserver->sworker.wsubepfd[subthread], interval_ms, timer_cb, arg, id)) {
+        dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_ERROR, "Timer of %lu ms could not be added to subthread %lu.\n", interval_ms, subthread);
+        return false;
+    }
+    return true;
+}
+
+/*
+    @brief Function to add a user file descriptor (eventfd, inotify, pipe, socket...) to the event
+    loop of a subthread, its callback called from that subthread with the events ready.
+    @note: This function can be called at any moment, also from the callbacks. The file descriptor is
+    not owned by the server: remove it before closing it. The events are registered as given (level
+    triggered unless EPOLLET). The worker configuration drops every source.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param size_t subthread: Subthread index.
+    @param int fd: User file descriptor.
+    @param uint32_t events: Epoll events of interest (EPOLLIN, EPOLLOUT, EPOLLET...).
+    @param void (*fd_cb)(void *, int, uint32_t): Callback (user argument, file descriptor & events ready).
+    @param void * arg: User argument of the callback.
+    @param size_t * id: Output source id (in its subthread).
+
+    @retval false: Invalid arguments, no free source in the subthread or registration failed.
+    @retval true: File descriptor added.
+*/
+bool dmserver_add_fd(dmserver_pt dmserver, size_t subthread, int fd, uint32_t events, void (*fd_cb)(void *, int, uint32_t), void * arg, size_t * id){
+    // References & bounds check:
+    if (!dmserver || !id || (subthread >= dmserver->sworker.wth_subthreads)) return false;
+
+    if (!_dmserver_userevs_fd(&dmserver->sworker.wsubuserevs[subthread], dmserver->sworker.wsubepfd[subthread], fd, events, fd_cb, arg, id)) {
+        dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_ERROR, "File descriptor %d could not be added to subthread %lu.\n", fd, subthread);
+        return false;
+    }
+    return true;
+}
+
+/*
+    @brief Function to remove a timer or user file descriptor from the event loop of its subthread. No
+    callback of the source is called once removed (the timer closed, a user fd left open).
+    @note: From another thread, a callback of that subthread in progress is waited for: do not call it
+    holding a lock that callback takes.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param size_t subthread: Subthread index.
+    @param size_t id: Source id.
+
+    @retval false: Invalid arguments or unknown source.
+    @retval true: Source removed.
+*/
+bool dmserver_del_userev(dmserver_pt dmserver, size_t subthread, size_t id){
+    // References & bounds check:
+    if (!dmserver || (subthread >= dmserver->sworker.wth_subthreads)) return false;
+
+    dmserver_userevs_pt us = &dmserver->sworker.wsubuserevs[subthread];
+    if (!_dmserver_userevs_del(us, dmserver->sworker.wsubepfd[subthread], id)) return false;
+
+    // Slot freed here when no subthread round will do it:
+    if (dmserver->sstate != DMSERVER_STATE_RUNNING) _dmserver_userevs_reap(us);
+    return true;
+}
+
+
+
+
+// ======== Graceful upgrade / TLS reload:
+/*
+    @brief Function to hand the listening sockets (server & additional listeners) off to the next
+    process of a graceful upgrade: the handoff socket path is listened here until the next process
+    takes them over with dmserver_handoff_recv (blocking). Once acknowledged, this server stops
+    accepting (the connections keep being served, see dmserver_drain) and the next process accepts
+    on the same sockets, no connection attempt refused meanwhile.
+    @note: Only with the server running in stream mode. The unix socket files of the listeners are
+    kept at close (owned by the next process).
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param const char * path: Handoff unix socket path.
+    @param size_t wait_ms: Maximum time waiting for the next process.
+
+    @retval false: Invalid state, timeout or transfer failed (still accepting).
+    @retval true: Listening sockets handed off.
+*/
+bool dmserver_handoff_send(dmserver_pt dmserver, const char * path, size_t wait_ms){
+    // Reference & state check:
+    if (!dmserver || !path) return false;
+    if ((dmserver->sstate != DMSERVER_STATE_RUNNING) || (dmserver->sconn.ssocktype != SOCK_STREAM)) return false;
+
+    // Listening sockets (server first, then the additional listeners in configuration order):
+    int fds[DEFAULT_DMSERVER_LISTENERS + 1];
+    fds[0] = dmserver->sconn.sfd;
+    for (size_t i = 0; i < dmserver->slisteners_count; i++) fds[i + 1] = dmserver->slisteners[i].lconn.sfd;
+    dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "DMServer handing off %lu listening sockets at %s...", dmserver->slisteners_count + 1, path);
+    if (!_dmserver_handoff_send(path, fds, dmserver->slisteners_count + 1, wait_ms)) {
+        dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_ERROR, "DMServer handoff at %s failed, still accepting.\n", path);
+        return false;
+    }
+
+    // No more accepts here (main thread woken up):
+    dmserver->sconn.shandedoff = true;
+    for (size_t i = 0; i < dmserver->slisteners_count; i++) dmserver->slisteners[i].lconn.shandedoff = true;
+    __atomic_store_n(&dmserver->sdraining, true, __ATOMIC_RELEASE);
+    eventfd_write(dmserver->sworker.wmainevfd, 1);
+    dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "DMServer listening sockets handed off.\n");
+    return true;
+}
+
+/*
+    @brief Function to take over the listening sockets of the running process of a graceful upgrade
+    (dmserver_handoff_send), used by the next open instead of new sockets (blocking, connection to
+    the handoff socket path retried until it listens).
+    @note: This function must be called after the configuration (same listeners, in the same order
+    and families) and before opening.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param const char * path: Handoff unix socket path.
+    @param size_t wait_ms: Maximum time waiting for the running process.
+
+    @retval false: Invalid state, timeout or listeners not matching.
+    @retval true: Listening sockets taken over.
+*/
+bool dmserver_handoff_recv(dmserver_pt dmserver, const char * path, size_t wait_ms){
+    // Reference & state check:
+    if (!dmserver || !path) return false;
+    if ((dmserver->sstate != DMSERVER_STATE_INITIALIZED) && (dmserver->sstate != DMSERVER_STATE_CLOSED)) return false;
+    if (dmserver->sconn.ssocktype != SOCK_STREAM) return false;
+
+    // Listening sockets (server first, then the additional listeners in configuration order):
+    int fds[DEFAULT_DMSERVER_LISTENERS + 1];
+    if (!_dmserver_handoff_recv(path, fds, dmserver->slisteners_count + 1, wait_ms)) {
+        dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_ERROR, "DMServer handoff at %s not received.\n", path);
+        return false;
+    }
+    if (dmserver->sconn.sinherit_fd >= 0) close(dmserver->sconn.sinherit_fd);
+    dmserver->sconn.sinherit_fd = fds[0];
+    for (size_t i = 0; i < dmserver->slisteners_count; i++){
+        if (dmserver->slisteners[i].lconn.sinherit_fd >= 0) close(dmserver->slisteners[i].lconn.sinherit_fd);
+        dmserver->slisteners[i].lconn.sinherit_fd = fds[i + 1];
+    }
+    dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "DMServer took over %lu listening sockets from %s.\n", dmserver->slisteners_count + 1, path);
+    return true;
+}
+
+/*
+    @brief Function to drain the server: stop accepting (if not handed off yet) and wait for the
+    accepted clients to leave, up to a deadline. The clients left are disconnected by the stop.
+    @note: Upstream connections are not waited for.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param size_t deadline_ms: Maximum time waiting for the clients.
+
+    @retval false: Invalid state or clients still connected at the deadline.
+    @retval true: Every accepted client left.
+*/
+bool dmserver_drain(dmserver_pt dmserver, size_t deadline_ms){
+    // Reference & state check:
+    if (!dmserver || (dmserver->sstate != DMSERVER_STATE_RUNNING)) return false;
+
+    // No more accepts (main thread woken up):
+    if (!__atomic_exchange_n(&dmserver->sdraining, true, __ATOMIC_ACQ_REL)) eventfd_write(dmserver->sworker.wmainevfd, 1);
+
+    // Accepted clients polled until none or the deadline:
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    long deadline = (long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000 + (long)deadline_ms;
+    while (true){
+        size_t left = 0;
+        for (size_t i = 0; i < dmserver->sworker.wth_subthreads; i++){
+            for (size_t j = 0; j < dmserver->sworker.wth_clispersth; j++){
+                dmserver_cliconn_pt c = &dmserver->sworker.wcclis[i][j];
+                enum dmserver_cconn_state st = __atomic_load_n(&c->cstate, __ATOMIC_RELAXED);
+                if (((st == DMSERVER_CLIENT_ESTABLISHING) || (st == DMSERVER_CLIENT_ESTABLISHED)) && !c->cupstream) left++;
+            }
+        }
+        if (!left) break;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        if ((long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000 >= deadline) {
+            dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "DMServer drain deadline reached, %lu clients left.\n", left);
+            return false;
+        }
+        usleep(10000);
+    }
+    dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "DMServer drained.\n");
+    return true;
+}
+
+/*
+    @brief Function to reload the TLS certificate and key of a listener into a fresh context, without
+    restart: the new connections use it and the established ones keep the previous context.
+    @note: This function can be called at any moment. With the server closed the new paths are only
+    checked and kept for the next open.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param size_t listener: Listener index (0 the server connection, 1.. the additional listeners).
+    @param const char * cert_path: Certificate path (NULL keeps the current one).
+    @param const char * key_path: Key path (NULL keeps the current one).
+
+    @retval false: Unknown listener, TLS disabled or certificate/key load failed (current one kept).
+    @retval true: Certificate and key reloaded.
+*/
+bool dmserver_reload_tls(dmserver_pt dmserver, size_t listener, const char * cert_path, const char * key_path){
+    // Reference & listener check:
+    if (!dmserver || (listener > dmserver->slisteners_count)) return false;
+    dmserver_servconn_pt s = (listener == 0) ? &dmserver->sconn : &dmserver->slisteners[listener - 1].lconn;
+
+    // Fresh context, installed by the main thread when running (woken up, or at the next run while
+    // stopping), here when open & not running, dropped when closed (paths checked only):
+    if (!_dmserver_sconn_sslreload(s, cert_path, key_path)) {
+        dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_ERROR, "DMServer listener %lu TLS reload failed.\n", listener);
+        return false;
+    }
+    if (dmserver->sstate == DMSERVER_STATE_RUNNING) eventfd_write(dmserver->sworker.wmainevfd, 1);
+    else if ((dmserver->sstate == DMSERVER_STATE_OPENED) || (dmserver->sstate == DMSERVER_STATE_STOPPED)) _dmserver_sconn_sslswap(s);
+    else if ((dmserver->sstate == DMSERVER_STATE_INITIALIZED) || (dmserver->sstate == DMSERVER_STATE_CLOSED)) _dmserver_sconn_ssldeinit(s);
+    dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "DMServer listener %lu TLS certificate reloaded (%s).\n", listener, s->sssl_certpath);
+    return true;
+}
+
+
+
+
+// ======== Prefork shards:
+/*
+    @brief Function to switch to prefork mode: the process forks into N shards (the caller becomes
+    shard 0, its children shards 1..N-1, terminated with it), every one of them returning from here
+    with the same configuration. Each shard opens its own listeners on the same addresses (the kernel
+    balances the connections through SO_REUSEPORT) and serves its own clients. A shared memory bus
+    carries the broadcasts and the cross-shard unicasts, every shard delivering them to its clients.
+    @note: This function must be called after the configuration (before opening) and with no other
+    thread than the caller's (the logger thread is started again in the children, with the same
+    minimum level and stdout output). Unix domain stream listeners cannot be shared.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param dmserver_shards_conf_pt shards_conf: Shards configuration (number of shards & bus sizes).
+    @param size_t * shard: Output shard index of the calling process.
+
+    @retval false: Invalid state or configuration, bus allocation or fork failed (not sharded).
+    @retval true: Shards forked.
+*/
+bool dmserver_prefork(dmserver_pt dmserver, dmserver_shards_conf_pt shards_conf, size_t * shard){
+    // References & state check:
+    if (!dmserver || !shards_conf || !shard) return false;
+    if ((dmserver->sstate != DMSERVER_STATE_INITIALIZED) && (dmserver->sstate != DMSERVER_STATE_CLOSED)) return false;
+    if (dmserver->sshards.sbus) return false;
+
+    // Listeners shareable through SO_REUSEPORT only:
+    if ((dmserver->sconn.ssafamily == AF_UNIX) && (dmserver->sconn.ssocktype == SOCK_STREAM)) return false;
+    for (size_t i = 0; i < dmserver->slisteners_count; i++){
+        if (dmserver->slisteners[i].lconn.ssafamily == AF_UNIX) return false;
+    }
+
+    // Bus & processes:
+    if (!_dmserver_shards_create(&dmserver->sshards, shards_conf)) {
+        dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_ERROR, "Shards bus could not be created.\n");
+        return false;
+    }
+    dmlogger_flush(dmserver->slogger);
+    if (!_dmserver_shards_fork(&dmserver->sshards)) {
+        _dmserver_shards_destroy(&dmserver->sshards);
+        dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_ERROR, "Shards could not be forked.\n");
+        return false;
+    }
+
+    // Children: own logger thread & worker (epolls and eventfds not shared with the parent):
+    if (dmserver->sshards.sshard != 0) {
+        enum dmlogger_level minlvl = dmserver->slogger->min_level;
+        dmserver->slogger = NULL;
+        dmlogger_init(&dmserver->slogger);
+        if (!dmserver->slogger || !dmlogger_run(dmserver->slogger)) _exit(1);
+        dmlogger_conf_logger_minlvl(dmserver->slogger, minlvl);
+        if (!__dmserver_worker_dealloc(&dmserver->sworker) || !__dmserver_worker_alloc(&dmserver->sworker)) _exit(1);
+    }
+
+    *shard = dmserver->sshards.sshard;
+    dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "DMServer shard %lu of %lu (pid %d).\n", dmserver->sshards.sshard, dmserver->sshards.snshards, getpid());
+    return true;
+}
+
+/*
+    @brief Function to unicast data to a client of any shard (through the shards bus when the client
+    belongs to another shard).
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param size_t shard: Shard of the client.
+    @param dmserver_cliloc_pt dmcliloc: Client location coordenates (in its shard).
+    @param const char * ucdata: Pointer to unicast data to sent.
+
+    @retval false: Unicast failed (locally or bus ring full).
+    @retval true: Unicast queued.
+*/
+bool dmserver_unicast_shard(dmserver_pt dmserver, size_t shard, dmserver_cliloc_pt dmcliloc, const char * ucdata){
+    // References check:
+    if (!dmserver || !dmcliloc || !ucdata) return false;
+
+    // Own client (or not sharded), otherwise delivered by its shard:
+    if (!dmserver->sshards.sbus || (shard == dmserver->sshards.sshard)) return dmserver_unicast(dmserver, dmcliloc, ucdata);
+    return _dmserver_shards_push(&dmserver->sshards, shard, DMSERVER_SHARDMSG_UNICAST, dmcliloc, ucdata, strlen(ucdata));
+}
+
+/*
+    @brief Function to get the shards bus counters of this process (shard index, number of shards,
+    messages pushed to other shards, dropped on full rings and received).
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param dmserver_shards_stats_pt stats: Output counters.
+
+    @retval false: Invalid references or not sharded.
+    @retval true: Counters copied.
+*/
+bool dmserver_get_shardstats(dmserver_pt dmserver, dmserver_shards_stats_pt stats){
+    // References check:
+    if (!dmserver || !stats || !dmserver->sshards.sbus) return false;
+
+    stats->sshard = dmserver->sshards.sshard;
+    stats->snshards = dmserver->sshards.snshards;
+    stats->ssent = __atomic_load_n(&dmserver->sshards.ssent, __ATOMIC_RELAXED);
+    stats->sdropped = __atomic_load_n(&dmserver->sshards.sdropped, __ATOMIC_RELAXED);
+    stats->sreceived = __atomic_load_n(&dmserver->sshards.sreceived, __ATOMIC_RELAXED);
+    return true;
+}
+
+
+
+
+// ======== Shared memory transport client:
+/*
+    @brief Function to connect a local client process to a unix domain listener with the shared
+    memory transport enabled: the server maps a pair of rings (client to server & back) and hands
+    them to the client, which exchanges frames with it without syscalls while both ends are busy
+    (the server subthread sees the client as any other, same reception callbacks & send functions).
+    @note: The client end is not thread safe (one producer & one consumer thread at most).
+
+    @param dmserver_shmconn_pt * shmcli: Output reference to the new client end.
+    @param const char * path: Unix domain socket path of the listener.
+    @param size_t wait_ms: Maximum time waiting for the rings.
+
+    @retval false: Connection refused, timeout or not a shared memory listener.
+    @retval true: Client connected.
+*/
+bool dmserver_shmcli_connect(dmserver_shmconn_pt * shmcli, const char * path, size_t wait_ms){
+    // References check:
+    if (!shmcli || !path) return false;
+
+    dmserver_shmconn_pt c = malloc(sizeof(dmserver_shmconn_t));
+    if (!c) return false;
+    _dmserver_shm_init(c);
+    if (!_dmserver_shm_attach(c, path, wait_ms)) {
+        free(c);
+        return false;
+    }
+    *shmcli = c;
+    return true;
+}
+
+/*
+    @brief Function to send a frame to the server (delivered as a single read), the server signalled
+    only when its subthread is sleeping.
+
+    @param dmserver_shmconn_pt shmcli: Reference to the client end.
+    @param const char * data: Frame data.
+    @param size_t len: Frame length (up to half of the ring).
+
+    @retval false: Ring full (retry once the server reads) or frame too long.
+    @retval true: Frame sent.
+*/
+bool dmserver_shmcli_send(dmserver_shmconn_pt shmcli, const char * data, size_t len){
+    // References check:
+    if (!shmcli || !data) return false;
+
+    if (!_dmserver_shm_send(shmcli, data, len)) return false;
+    _dmserver_shm_notify(shmcli);
+    return true;
+}
+
+/*
+    @brief Function to receive the next frame from the server (a unicast, broadcast or published
+    message each), polling the ring and only sleeping once it is empty.
+    @note: With timeout 0 nothing but memory accesses (spin on it for the lowest latency).
+
+    @param dmserver_shmconn_pt shmcli: Reference to the client end.
+    @param char * buf: Output buffer (frames longer than it are truncated).
+    @param size_t len: Output buffer length.
+    @param int timeout_ms: Maximum time waiting for a frame (0 none, -1 no limit).
+
+    @retval Frame bytes copied, 0 if none before the timeout, -1 if the server is gone.
+*/
+long dmserver_shmcli_recv(dmserver_shmconn_pt shmcli, char * buf, size_t len, int timeout_ms){
+    // References check:
+    if (!shmcli || !buf) return -1;
+
+    while (true){
+        // Next frame copied & released (the server signalled if waiting for space):
+        size_t flen = 0;
+        const char * data = _dmserver_shm_peek(shmcli, &flen);
+        if (data) {
+            size_t n = (flen < len) ? flen : len;
+            memcpy(buf, data, n);
+            _dmserver_shm_release(shmcli);
+            _dmserver_shm_notify(shmcli);
+            return (long)n;
+        }
+        if (timeout_ms == 0) return 0;
+
+        // Ring empty, flagged & sleep until signalled:
+        if (!_dmserver_shm_sleep(shmcli)) continue;
+        int w = _dmserver_shm_wait(shmcli, timeout_ms);
+        if (w < 0) return -1;
+        if (w == 0) return 0;
+    }
+}
+
+/*
+    @brief Function to disconnect a shared memory client from the server and free it.
+
+    @param dmserver_shmconn_pt * shmcli: Reference to the client end (NULL afterwards).
+*/
+void dmserver_shmcli_close(dmserver_shmconn_pt * shmcli){
+    // References check:
+    if (!shmcli || !*shmcli) return;
+
+    _dmserver_shm_close(*shmcli);
+    free(*shmcli);
+    *shmcli = NULL;
+}
+
+
+
+
+// ======== Per connection user context / Arena:
+/*
+    @brief Function to attach a user context to a client (session state of the application).
+    @note: Meant for the client callbacks (its subthread). The context is cleared, not freed, once
+    the disconnection callback returns (free there whatever it owns outside the arena).
+
+    @param dmserver_cliconn_pt dmclient: Reference to client.
+    @param void * ctx: User context (NULL clears it).
+
+    @retval true: Context set.
+    @retval false: Invalid client.
+*/
+bool dmserver_set_ctx(dmserver_cliconn_pt dmclient, void * ctx){
+    // References check:
+    if (!dmclient) return false;
+
+    dmclient->cuser = ctx;
+    return true;
+}
+
+/*
+    @brief Function to get the user context of a client.
+
+    @param dmserver_cliconn_pt dmclient: Reference to client.
+
+    @retval User context (NULL if none).
+*/
+void * dmserver_get_ctx(dmserver_cliconn_pt dmclient){
+    // References check:
+    if (!dmclient) return NULL;
+
+    return dmclient->cuser;
+}
+
+/*
+    @brief Function to allocate memory from the arena of a client (parsing & session state), released
+    at once when the client slot is reset (after the disconnection callback), never freed on its own.
+    @note: The arena block length is set with dmserver_conf_cconn (carena_size, 0 no arena), once
+    exhausted the arena grows with heap chunks. Meant for the client callbacks (its subthread).
+
+    @param dmserver_cliconn_pt dmclient: Reference to client.
+    @param size_t len: Bytes to allocate.
+
+    @retval Reference to the memory (16 bytes aligned), NULL without arena or on failure.
+*/
+void * dmserver_arena_alloc(dmserver_cliconn_pt dmclient, size_t len){
+    return _dmserver_cconn_arena_alloc(dmclient, len);
+}
+
+
+
+
+// ======== Test transport (injected connections / virtual clock):
+/*
+    @brief Function to inject an in-process connection (socketpair) into a subthread: the server end
+    becomes a plain client of the server callbacks (read, dispatch & write paths of any client, no TLS
+    nor network stack) and the other end is given to the caller to drive it.
+    @note: This function only works if the server is running. The client is set up asynchronously by
+    the main thread (connection callback), the data written meanwhile waits in the socketpair.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param size_t subthread: Subthread of the client (SIZE_MAX the less populated).
+    @param int * peerfd: Output, caller end of the connection (blocking, closed by the caller).
+
+    @retval true: Connection injected.
+    @retval false: Server not running, invalid subthread or too many injections pending.
+*/
+bool dmserver_inject(dmserver_pt dmserver, size_t subthread, int * peerfd){
+    // References, state & subthread check:
+    if (!dmserver || !peerfd || (dmserver->sstate != DMSERVER_STATE_RUNNING)) return false;
+    if ((subthread != SIZE_MAX) && (subthread >= dmserver->sworker.wth_subthreads)) return false;
+
+    // Connected pair, server end non-blocking (as the accepted sockets):
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) < 0) return false;
+    if ((fcntl(sv[0], F_SETFL, fcntl(sv[0], F_GETFL) | O_NONBLOCK) < 0) || !_dmserver_worker_inject(&dmserver->sworker, sv[0], subthread)) {
+        close(sv[0]);
+        close(sv[1]);
+        return false;
+    }
+
+    *peerfd = sv[1];
+    return true;
+}
+
+/*
+    @brief Function to set the virtual clock of the clients activity and timeouts (wall clock otherwise),
+    the clients timeouts checked against it by each subthread at the start of its next round.
+    @note: Set it before opening the server, the activity times kept are the ones of the clock in use.
+    The timed out clients are disconnected (timeout callbacks called) by their own subthread, not here.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param time_t now: Virtual time in seconds (0 back to the wall clock).
+
+    @retval true: Clock set.
+    @retval false: Invalid references.
+*/
+bool dmserver_set_clock(dmserver_pt dmserver, time_t now){
+    // Reference check:
+    if (!dmserver) return false;
+
+    __atomic_store_n(&dmserver->sworker.wvclock, now, __ATOMIC_RELAXED);
+    if (dmserver->sstate != DMSERVER_STATE_RUNNING) return true;
+
+    // Clients timeouts check requested to every subthread (subthreads woken up):
+    for (size_t i = 0; i < dmserver->sworker.wth_subthreads; i++) _dmserver_worker_qtimeouts(&dmserver->sworker, i);
+    return true;
+}
+
+
+
+
+// ======== Traffic capture / Replay:
+/*
+    @brief Function to start capturing the traffic of the clients into a binary file: connections,
+    disconnections and the data read/written by the worker (before encryption) with its time.
+    @note: Each recording thread fills its own blocks, written by a writer thread. Records are dropped
+    (counted) rather than blocking the subthreads when the file can not keep up.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param const char * path: Capture file path (truncated).
+    @param size_t buf_size: Block length of each recording thread, two per thread (0 default).
+
+    @retval true: Capture started.
+    @retval false: Capture running already, file or allocation failed.
+*/
+bool dmserver_capture_start(dmserver_pt dmserver, const char * path, size_t buf_size){
+    // References check:
+    if (!dmserver || !path) return false;
+
+    if (!_dmserver_capture_start(&dmserver->scapture, path, buf_size)) {
+        dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_ERROR, "Traffic capture to %s could not be started.\n", path);
+        return false;
+    }
+    dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "Traffic capture to %s started.\n", path);
+    return true;
+}
+
+/*
+    @brief Function to stop the traffic capture, every record taken written to the file.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+
+    @retval true: Capture stopped.
+    @retval false: Capture not running.
+*/
+bool dmserver_capture_stop(dmserver_pt dmserver){
+    // Reference check:
+    if (!dmserver) return false;
+
+    if (!_dmserver_capture_stop(&dmserver->scapture)) return false;
+    dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "Traffic capture stopped.\n");
+    return true;
+}
+
+/*
+    @brief Function to get the traffic capture counters (records & payload bytes taken, records dropped,
+    bytes written to the file).
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param dmserver_capture_stats_pt stats: Reference to the stats struct to fill.
+
+    @retval false: Invalid references.
+    @retval true: Stats filled.
+*/
+bool dmserver_get_capturestats(dmserver_pt dmserver, dmserver_capture_stats_pt stats){
+    // References check:
+    if (!dmserver || !stats) return false;
+
+    dmserver_capture_stats_pt cs = &dmserver->scapture.cstats;
+    stats->crecords = __atomic_load_n(&cs->crecords, __ATOMIC_RELAXED);
+    stats->cbytes = __atomic_load_n(&cs->cbytes, __ATOMIC_RELAXED);
+    stats->cdropped = __atomic_load_n(&cs->cdropped, __ATOMIC_RELAXED);
+    stats->cwritten = __atomic_load_n(&cs->cwritten, __ATOMIC_RELAXED);
+    return true;
+}
+
+/*
+    @brief Function to replay a capture file against a test server (no server struct needed): every
+    captured session opened as a connection and the data the server read sent again with the original
+    timing, or scaled (rspeed 2 twice as fast, 0 no waits). The responses are read and discarded.
+    @note: Blocks until the whole capture is replayed. Sessions are replayed in plain text.
+
+    @param dmserver_replay_conf_pt replay_conf: Reference to replay configuration struct.
+    @param dmserver_replay_stats_pt stats: Reference to the stats struct to fill (NULL ignored).
+
+    @retval true: Capture replayed.
+    @retval false: Invalid capture file or allocation failed.
+*/
+bool dmserver_replay(dmserver_replay_conf_pt replay_conf, dmserver_replay_stats_pt stats){
+    return _dmserver_capture_replay(replay_conf, stats);
+}
+
+
+
+
+// ======== Receive latency:
+/*
+    @brief Function to get the kernel receive timestamp of the data being delivered to a client (read
+    buffer in on_client_rcv, or a message of on_client_rcv_batch), on the realtime clock.
+    @note: Only listeners configured with srx_timestamps, TCP without TLS & UDP.
+
+    @param dmserver_cliconn_pt dmclient: Reference to client.
+    @param struct timespec * ts: Output timestamp.
+
+    @retval true: Timestamp copied.
+    @retval false: Invalid references or no timestamp for the data.
+*/
+bool dmserver_get_rcvts(dmserver_cliconn_pt dmclient, struct timespec * ts){
+    // References check:
+    if (!dmclient || !ts) return false;
+    if (!dmclient->crts.tv_sec && !dmclient->crts.tv_nsec) return false;
+
+    *ts = dmclient->crts;
+    return true;
+}
+
+/*
+    @brief Function to get the receive latency histogram of the server (time from the kernel receive
+    timestamp to the reception callback, every subthread added): bucket i counts the deliveries from
+    2^(i-1) to 2^i usec, the first one under 1 usec and the last one the rest.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param size_t * hist: Output histogram.
+    @param size_t nbuckets: Histogram buckets (up to DEFAULT_WORKER_RXLATBUCKETS, the rest zeroed).
+
+    @retval false: Invalid references or worker not allocated.
+    @retval true: Histogram filled.
+*/
+bool dmserver_get_rxlatency(dmserver_pt dmserver, size_t * hist, size_t nbuckets){
+    // References check:
+    if (!dmserver || !hist || !dmserver->sworker.wrxlat) return false;
+
+    memset(hist, 0, nbuckets * sizeof(size_t));
+    if (nbuckets > DEFAULT_WORKER_RXLATBUCKETS) nbuckets = DEFAULT_WORKER_RXLATBUCKETS;
+    for (size_t i = 0; i < dmserver->sworker.wth_subthreads; i++){
+        for (size_t b = 0; b < nbuckets; b++) hist[b] += __atomic_load_n(&dmserver->sworker.wrxlat[i][b], __ATOMIC_RELAXED);
+    }
+    return true;
+}
+
+// ======== Zero copy sends:
+/*
+    @brief Function to get the zero copy sends counters (MSG_ZEROCOPY sends & bytes of the queued
+    messages, completions notified and the ones the kernel sent with copy anyway, e.g. loopback).
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param dmserver_zerocopy_stats_pt stats: Output counters.
+
+    @retval false: Invalid references.
+    @retval true: Counters copied.
+*/
+bool dmserver_get_zcstats(dmserver_pt dmserver, dmserver_zerocopy_stats_pt stats){
+    // References check:
+    if (!dmserver || !stats) return false;
+
+    // Counters snapshot:
+    dmserver_zerocopy_stats_pt zs = &dmserver->sworker.wzcstats;
+    stats->zsends = __atomic_load_n(&zs->zsends, __ATOMIC_RELAXED);
+    stats->zbytes = __atomic_load_n(&zs->zbytes, __ATOMIC_RELAXED);
+    stats->zcompleted = __atomic_load_n(&zs->zcompleted, __ATOMIC_RELAXED);
+    stats->zcopied = __atomic_load_n(&zs->zcopied, __ATOMIC_RELAXED);
+    return true;
+}
+
+
+
+
+// ======== Configuration - General:
+/*
+    @brief Function to configure the server connection data.
+    @note: This function must be called after initialization OR after closing the server.
+
+    @param dmserver_pt dmserver: Reference to server struct.
+    @param dmserver_servconn_conf_pt: Reference to server connection configuration struct.
+
+    @retval true: Configuration succeeded.
+    @retval false: Configuration failed.
+*/
+bool dmserver_conf_sconn(dmserver_pt dmserver, dmserver_servconn_conf_pt sconn_conf){
+    // Reference & state check:
+    if (!dmserver) return false;
+    if ((dmserver->sstate != DMSERVER_STATE_INITIALIZED) && (dmserver->sstate != DMSERVER_STATE_CLOSED)) return false;
+
+
+    // If there is no configuration structure, set to defaults:
+    if (!sconn_conf) {
+        __dmserver_sconn_set_defaults(&dmserver->sconn);
+        return true;
+    }
+
+    // Server connection configuration (invalid values ignored):
+    __dmserver_sconn_set_conf(&dmserver->sconn, sconn_conf);
+
+    return true;
+}
+
+/*
+    @brief Function to configure workers parameters before launching.
+    @note: This function must be called after initialization OR after closing the server.
+
+    @param dmserver_pt dmserver: Reference to server struct.
+    @param dmserver_servconn_conf_pt worker_conf: Reference to worker connection configuration struct.
+
+    @retval true: Configuration succeeded.
+    @retval false: Configuration failed.
+*/
+bool dmserver_conf_worker(dmserver_pt dmserver, dmserver_worker_conf_pt worker_conf){
+    // Reference & state check:
+    if (!dmserver) return false;
+    if ((dmserver->sstate != DMSERVER_STATE_INITIALIZED) && (dmserver->sstate != DMSERVER_STATE_CLOSED)) return false;
+
+    // Deallocate previous worker configuraiton and memory:
+    if (!__dmserver_worker_dealloc(&dmserver->sworker)) return false;
+
+    // If there is no configuration given, set to defaults and exit:
+    if (!worker_conf) {
+        __dmserver_worker_set_defaults(&dmserver->sworker);
+        __dmserver_worker_alloc(&dmserver->sworker);
+        return true;
+    }
+
+    // Configure subordinate threads number, clients per subordinate thread and timeout per client:
+    if (worker_conf->wth_subthreads) __dmserver_worker_set_subthreads(&dmserver->sworker, worker_conf->wth_subthreads);
+    if (worker_conf->wth_clispersth) __dmserver_worker_set_clispersth(&dmserver->sworker, worker_conf->wth_clispersth);
+    if (worker_conf->wth_clistimeout) __dmserver_worker_set_clistimeout(&dmserver->sworker, worker_conf->wth_clistimeout);
+
+    // Configure low latency mode (busy poll) and subthreads cpu pinning:
+    __dmserver_worker_set_busypoll(&dmserver->sworker, worker_conf->wth_busypoll_usec);
+    __dmserver_worker_set_cpus(&dmserver->sworker, worker_conf->wth_cpus, worker_conf->wth_ncpus);
+
+    // Configure slow consumers default policy and pending output memory budget:
+    __dmserver_worker_set_slow(&dmserver->sworker, worker_conf->wslow_policy, worker_conf->wslow_max_bytes, worker_conf->wslow_max_sec);
+    __dmserver_worker_set_outbudget(&dmserver->sworker, worker_conf->wout_budget_bytes);
+
+    // Configure overload control:
+    __dmserver_worker_set_overload(&dmserver->sworker, worker_conf->wovl_target_usec, worker_conf->wovl_interval_usec, worker_conf->wovl_shed_reads, worker_conf->wovl_reject);
+
+    if (!__dmserver_worker_alloc(&dmserver->sworker)) return false;
+    return true;
+}
+
+/*
+    @brief Function to configure the clients buffers & arena length.
+    @note: This function must be called after initialization OR after closing the server.
+
+    @param dmserver_pt dmserver: Reference to server struct.
+    @param dmserver_cliconn_conf_pt cconn_conf: Reference to client connection (buffers & arena) configuration struct.
+
+    @retval true: Configuration succeeded.
+    @retval false: Configuration failed.
+*/
+bool dmserver_conf_cconn(dmserver_pt dmserver, dmserver_cliconn_conf_pt cconn_conf){
+    // Reference & state check:
+    if (!dmserver) return false;
+    if ((dmserver->sstate != DMSERVER_STATE_INITIALIZED) && (dmserver->sstate != DMSERVER_STATE_CLOSED)) return false;
+
+    // Iterate over all the clients slots on the server:
+    for (size_t i = 0; i < dmserver->sworker.wth_subthreads; i++){for (size_t j = 0; j < dmserver->sworker.wth_clispersth; j++){
+        // Client:
+        dmserver_cliconn_pt dmclient = &dmserver->sworker.wcclis[i][j];
+
+        // Deallocate previous read/write buffers:
+        if (!__dmserver_cconn_buf_dealloc(dmclient)) continue;
+
+        // In case that the configuration structure is null, set the default buffers length:
+        if (!cconn_conf) __dmserver_cconn_set_defaults(dmclient);
+
+        // Otherwise, read/write buffers, write queue & arena length set:
+        else {
+            if (cconn_conf->cread_buffer_size) __dmserver_cconn_set_creadbuffer(dmclient, cconn_conf->cread_buffer_size);
+            if (cconn_conf->cwrite_buffer_size) __dmserver_cconn_set_cwritebuffer(dmclient, cconn_conf->cwrite_buffer_size);
+            if (cconn_conf->cwrite_queue_size) __dmserver_cconn_set_cwritequeue(dmclient, cconn_conf->cwrite_queue_size);
+            __dmserver_cconn_set_carena(dmclient, cconn_conf->carena_size);
+        }
+
+        // Allocate new read/write buffers:
+        if (!__dmserver_cconn_buf_alloc(dmclient)) continue;
+    }}
+    return true;
+}
+
+
+/*
+    @brief Function to configure the slow consumers policy of a specific topic (overrides the server
+    default policy of dmserver_conf_worker for it).
+    @note: This function must be called after initialization OR after closing the server.
+
+    @param dmserver_pt dmserver: Reference to server struct.
+    @param const char * topic: Topic name.
+    @param dmserver_slow_conf_pt slow_conf: Reference to slow consumers policy configuration struct.
+
+    @retval true: Configuration succeeded.
+    @retval false: Configuration failed.
+*/
+bool dmserver_conf_topic(dmserver_pt dmserver, const char * topic, dmserver_slow_conf_pt slow_conf){
+    // Reference & state check:
+    if (!dmserver || !slow_conf) return false;
+    if ((dmserver->sstate != DMSERVER_STATE_INITIALIZED) && (dmserver->sstate != DMSERVER_STATE_CLOSED)) return false;
+
+    // Topic policy set:
+    return __dmserver_worker_set_topicslow(&dmserver->sworker, topic, slow_conf);
+}
+
+/*
+    @brief Function to configure the reception limits, messages and bytes per second (token buckets)
+    for every connection and for every source IP. Clients over their limits get their reads paused
+    until their buckets refill, no data is dropped.
+    @note: This function must be called after initialization OR after closing the server.
+    Datagram sessions share the subthread socket and are not limited. The connections limit per
+    source IP can also be changed later with dmserver_set_ipconns.
+
+    @param dmserver_pt dmserver: Reference to server struct.
+    @param dmserver_limits_conf_pt limits_conf: Reference to limits configuration struct (NULL disables them).
+
+    @retval true: Configuration succeeded.
+    @retval false: Configuration failed.
+*/
+bool dmserver_conf_limits(dmserver_pt dmserver, dmserver_limits_conf_pt limits_conf){
+    // Reference & state check:
+    if (!dmserver) return false;
+    if ((dmserver->sstate != DMSERVER_STATE_INITIALIZED) && (dmserver->sstate != DMSERVER_STATE_CLOSED)) return false;
+
+    // Limits set:
+    return __dmserver_limits_set(&dmserver->slimits, limits_conf);
+}
+
+/*
+    @brief Function to add a stream listener (TCP IPv4/IPv6 or unix domain, TLS on or off) to the
+    server, sharing the worker subthreads with the server connection. Each listener has its own TLS
+    context and, optionally, its own callbacks set.
+    @note: This function must be called after initialization OR after closing the server.
+    The overload callback is always the server one.
+
+    @param dmserver_pt dmserver: Reference to server struct.
+    @param dmserver_servconn_conf_pt sconn_conf: Reference to listener connection configuration struct (NULL removes all the listeners added).
+    @param dmserver_callback_conf_pt callback_conf: Reference to listener callbacks configuration struct (NULL for the server callbacks).
+
+    @retval true: Configuration succeeded.
+    @retval false: Configuration failed (datagram listener or no room for more listeners).
+*/
+bool dmserver_conf_listener(dmserver_pt dmserver, dmserver_servconn_conf_pt sconn_conf, dmserver_callback_conf_pt callback_conf){
+    // Reference & state check:
+    if (!dmserver) return false;
+    if ((dmserver->sstate != DMSERVER_STATE_INITIALIZED) && (dmserver->sstate != DMSERVER_STATE_CLOSED)) return false;
+
+    // If there is no configuration structure, remove the listeners:
+    if (!sconn_conf) {
+        dmserver->slisteners_count = 0;
+        return true;
+    }
+    if ((sconn_conf->ssock_type == SOCK_DGRAM) || (dmserver->slisteners_count >= DEFAULT_DMSERVER_LISTENERS)) return false;
+
+    // Listener connection configuration (defaults for the invalid values):
+    struct dmserver_listener * l = &dmserver->slisteners[dmserver->slisteners_count];
+    __dmserver_sconn_set_defaults(&l->lconn);
+    __dmserver_sconn_set_conf(&l->lconn, sconn_conf);
+    __dmserver_sconn_set_socktype(&l->lconn, SOCK_STREAM);
+
+    // Listener callbacks set (own or the server ones) & no proxy target:
+    l->lproxy.tenabled = false;
+    memset(&l->lcallback, 0, sizeof(dmserver_callback_t));
+    l->lcallback_own = (callback_conf != NULL);
+    if (callback_conf) {
+        __dmserver_setcb_onclientconnect(&l->lcallback, callback_conf->on_client_connect);
+        __dmserver_setcb_onclientdisconnect(&l->lcallback, callback_conf->on_client_disconnect);
+        __dmserver_setcb_onclienttimeout(&l->lcallback, callback_conf->on_client_timeout);
+        __dmserver_setcb_onclientrcv(&l->lcallback, callback_conf->on_client_rcv);
+        __dmserver_setcb_onclientsnd(&l->lcallback, callback_conf->on_client_snd);
+        __dmserver_setcb_onclientrcvbatch(&l->lcallback, callback_conf->on_client_rcv_batch);
+    }
+
+    dmserver->slisteners_count++;
+    return true;
+}
+
+/*
+    @brief Function to turn a stream listener into a proxy: every client it accepts is paired with a new
+    connection to the target once established (after the TLS handshake on TLS listeners), and the bytes
+    are relayed both ways without reception callbacks. Plain clients are relayed with splice through a
+    pipe per direction (no user space copy), TLS clients too when the kernel TLS offload gets enabled,
+    otherwise through a copy buffer. Each direction is half-closed on its own and the pair is closed
+    once both are.
+    @note: This function must be called after initialization OR after closing the server, after adding
+    the listener. The target host name is resolved here (blocking). Connect/disconnect/timeout callbacks
+    are still called.
+
+    @param dmserver_pt dmserver: Reference to server struct.
+    @param size_t listener: Listener (0 the server connection, i the additional listener added i-th).
+    @param dmserver_proxy_conf_pt proxy_conf: Reference to proxy configuration struct (NULL disables the proxy).
+
+    @retval true: Configuration succeeded.
+    @retval false: Configuration failed (proxy disabled).
+*/
+bool dmserver_conf_proxy(dmserver_pt dmserver, size_t listener, dmserver_proxy_conf_pt proxy_conf){
+    // Reference, state & listener check:
+    if (!dmserver) return false;
+    if ((dmserver->sstate != DMSERVER_STATE_INITIALIZED) && (dmserver->sstate != DMSERVER_STATE_CLOSED)) return false;
+    if (listener > dmserver->slisteners_count) return false;
+    if ((listener == 0) && (dmserver->sconn.ssocktype != SOCK_STREAM)) return false;
+
+    // Proxy target set:
+    dmserver_proxytarget_pt t = (listener == 0) ? &dmserver->sproxy : &dmserver->slisteners[listener - 1].lproxy;
+    if (!__dmserver_proxy_set_target(t, proxy_conf)) return false;
+    if (proxy_conf) dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "Listener %lu proxied to %s:%d.\n", listener, proxy_conf->phost, proxy_conf->pport);
     return true;
 }
 
@@ -502,6 +1926,8 @@ bool dmserver_set_cb(dmserver_pt dmserver, dmserver_callback_conf_pt callback_co
     if (callback_conf->on_client_timeout) __dmserver_setcb_onclienttimeout(&dmserver->scallback, callback_conf->on_client_timeout);
     if (callback_conf->on_client_rcv) __dmserver_setcb_onclientrcv(&dmserver->scallback, callback_conf->on_client_rcv);
     if (callback_conf->on_client_snd) __dmserver_setcb_onclientsnd(&dmserver->scallback, callback_conf->on_client_snd);
+    if (callback_conf->on_client_rcv_batch) __dmserver_setcb_onclientrcvbatch(&dmserver->scallback, callback_conf->on_client_rcv_batch);
+    if (callback_conf->on_overload) __dmserver_setcb_onoverload(&dmserver->scallback, callback_conf->on_overload);
 
 
     return true;
@@ -0,0 +1,232 @@
+/*
+
+*/
+
+/* ---- Library --------------------------------------------------- */
+#include "../inc/_dmserver_acl.h"
+
+/* ---- Helper functions implementation prototypes ---------------- */
+static void _dmserver_acl_helper_free(struct dmserver_acltable * t);
+static bool _dmserver_acl_helper_insert(struct dmserver_acltable * t, const char * cidr, enum dmserver_acl_action action);
+static size_t _dmserver_acl_helper_addr(struct sockaddr_storage * caddr, uint8_t * addr);
+
+
+
+
+/* ---- INTERNAL - Functions implementation ----------------------- */
+// ======== General use:
+/*
+    @brief Function to initialize the access control list (no table, everything allowed).
+
+    @param dmserver_acl_pt a: Reference to access control list.
+
+    @retval true: Initialization succeeded.
+    @retval false: Initialization failed.
+*/
+bool _dmserver_acl_init(dmserver_acl_pt a){
+    // Reference check:
+    if (!a) return false;
+    memset(a, 0, sizeof(dmserver_acl_t));
+
+    if (pthread_rwlock_init(&a->alock, NULL)) return false;
+    return true;
+}
+
+/*
+    @brief Function to deinitialize the access control list.
+
+    @param dmserver_acl_pt a: Reference to access control list.
+
+    @retval true: Deinitialization succeeded.
+    @retval false: Deinitialization failed.
+*/
+bool _dmserver_acl_deinit(dmserver_acl_pt a){
+    // Reference check:
+    if (!a) return false;
+
+    _dmserver_acl_helper_free(a->atable);
+    a->atable = NULL;
+    pthread_rwlock_destroy(&a->alock);
+    return true;
+}
+
+// ======== Reload:
+/*
+    @brief Function to load a new set of access rules, replacing the previous one (at any moment, the
+    connections accepted meanwhile are checked against the previous or the new set, never a mix).
+
+    @param dmserver_acl_pt a: Reference to access control list.
+    @param const dmserver_acl_rule_t * rules: Access rules (the longest prefix of an address decides).
+    @param size_t nrules: Number of rules (0 with allow by default removes the table).
+    @param enum dmserver_acl_action adefault: Action for the addresses without matching prefix.
+
+    @retval true: Rules loaded.
+    @retval false: Invalid rule or allocation failed (previous rules kept).
+*/
+bool _dmserver_acl_load(dmserver_acl_pt a, const dmserver_acl_rule_t * rules, size_t nrules, enum dmserver_acl_action adefault){
+    // References check:
+    if (!a || (!rules && nrules)) return false;
+
+    // New table (both roots) and rules insertion:
+    struct dmserver_acltable * t = NULL;
+    if (nrules || (adefault != DMSERVER_ACL_ALLOW)) {
+        t = calloc(1, sizeof(struct dmserver_acltable));
+        if (!t) return false;
+        t->tdefault = adefault;
+        t->tnodes_size = 64;
+        t->tnodes = calloc(t->tnodes_size, sizeof(struct dmserver_aclnode));
+        if (!t->tnodes) {
+            free(t);
+            return false;
+        }
+        t->tnodes[0].naction = -1;
+        t->tnodes[1].naction = -1;
+        t->tnodes_count = 2;
+
+        for (size_t i = 0; i < nrules; i++){
+            if (!_dmserver_acl_helper_insert(t, rules[i].acidr, rules[i].aaction)) {
+                _dmserver_acl_helper_free(t);
+                return false;
+            }
+        }
+    }
+
+    // Swap the tables, the previous one freed once no accept is reading it:
+    pthread_rwlock_wrlock(&a->alock);
+    struct dmserver_acltable * old = a->atable;
+    a->atable = t;
+    pthread_rwlock_unlock(&a->alock);
+    _dmserver_acl_helper_free(old);
+    return true;
+}
+
+// ======== Check:
+/*
+    @brief Function to check a source address against the access rules (longest prefix match).
+
+    @param dmserver_acl_pt a: Reference to access control list.
+    @param struct sockaddr_storage * caddr: Source address (IPv4-mapped IPv6 taken as IPv4).
+
+    @retval true: Address allowed.
+    @retval false: Address denied.
+*/
+bool _dmserver_acl_check(dmserver_acl_pt a, struct sockaddr_storage * caddr){
+    // References check:
+    if (!a || !caddr) return true;
+    uint8_t addr[16];
+    size_t alen = _dmserver_acl_helper_addr(caddr, addr);
+    if (!alen) return true;
+
+    pthread_rwlock_rdlock(&a->alock);
+    struct dmserver_acltable * t = a->atable;
+    if (!t) {
+        pthread_rwlock_unlock(&a->alock);
+        return true;
+    }
+
+    // Walk the address bits down the trie, the deepest rule found decides:
+    uint32_t node = (alen == 4) ? 0 : 1;
+    int action = (t->tnodes[node].naction >= 0) ? t->tnodes[node].naction : (int)t->tdefault;
+    for (size_t bit = 0; bit < alen * 8; bit++){
+        node = t->tnodes[node].nchild[(addr[bit / 8] >> (7 - (bit % 8))) & 1];
+        if (!node) break;
+        if (t->tnodes[node].naction >= 0) action = t->tnodes[node].naction;
+    }
+    pthread_rwlock_unlock(&a->alock);
+
+    if (action == DMSERVER_ACL_ALLOW) return true;
+    __atomic_add_fetch(&a->adenied, 1, __ATOMIC_RELAXED);
+    return false;
+}
+
+
+
+
+/* ---- STATIC INTERNAL - Helper functions implementation --------- */
+/*
+    @brief Helper function to free a prefixes table.
+
+    @param struct dmserver_acltable * t: Table (NULL ignored).
+*/
+static void _dmserver_acl_helper_free(struct dmserver_acltable * t){
+    if (!t) return;
+    if (t->tnodes) free(t->tnodes);
+    free(t);
+}
+
+/*
+    @brief Helper function to insert a prefix into a table (a repeated prefix takes the last action).
+
+    @param struct dmserver_acltable * t: Table.
+    @param const char * cidr: Prefix in CIDR notation.
+    @param enum dmserver_acl_action action: Action of the prefix.
+
+    @retval true: Prefix inserted.
+    @retval false: Invalid prefix or allocation failed.
+*/
+static bool _dmserver_acl_helper_insert(struct dmserver_acltable * t, const char * cidr, enum dmserver_acl_action action){
+    // Prefix parse (address and optional length):
+    if (!cidr || (strlen(cidr) >= DEFAULT_ACL_CIDRLEN)) return false;
+    char str[DEFAULT_ACL_CIDRLEN];
+    strcpy(str, cidr);
+    char * slash = strchr(str, '/');
+    if (slash) *slash = '\0';
+
+    uint8_t addr[16];
+    size_t alen = 0;
+    if (inet_pton(AF_INET, str, addr) == 1) alen = 4;
+    else if (inet_pton(AF_INET6, str, addr) == 1) alen = 16;
+    else return false;
+
+    size_t plen = alen * 8;
+    if (slash) {
+        char * end = NULL;
+        unsigned long l = strtoul(slash + 1, &end, 10);
+        if ((end == slash + 1) || *end || (l > plen)) return false;
+        plen = l;
+    }
+
+    // Path of the prefix bits (nodes created as needed):
+    uint32_t node = (alen == 4) ? 0 : 1;
+    for (size_t bit = 0; bit < plen; bit++){
+        int b = (addr[bit / 8] >> (7 - (bit % 8))) & 1;
+        if (!t->tnodes[node].nchild[b]) {
+            if (t->tnodes_count == t->tnodes_size) {
+                struct dmserver_aclnode * nodes = realloc(t->tnodes, 2 * t->tnodes_size * sizeof(struct dmserver_aclnode));
+                if (!nodes) return false;
+                t->tnodes = nodes;
+                t->tnodes_size *= 2;
+            }
+            t->tnodes[t->tnodes_count] = (struct dmserver_aclnode){.nchild={0, 0}, .naction=-1};
+            t->tnodes[node].nchild[b] = (uint32_t)t->tnodes_count++;
+        }
+        node = t->tnodes[node].nchild[b];
+    }
+    t->tnodes[node].naction = (int8_t)action;
+    return true;
+}
+
+/*
+    @brief Helper function that extracts the IP address bytes of a socket address.
+
+    @param struct sockaddr_storage * caddr: Socket address.
+    @param uint8_t * addr: Output address (16 bytes max).
+
+    @retval Address length (4 IPv4 & IPv4-mapped IPv6, 16 IPv6, 0 non IP).
+*/
+static size_t _dmserver_acl_helper_addr(struct sockaddr_storage * caddr, uint8_t * addr){
+    if (caddr->ss_family == AF_INET) {
+        memcpy(addr, &((struct sockaddr_in *)caddr)->sin_addr, 4);
+        return 4;
+    }
+    if (caddr->ss_family == AF_INET6) {
+        struct in6_addr * a6 = &((struct sockaddr_in6 *)caddr)->sin6_addr;
+        if (IN6_IS_ADDR_V4MAPPED(a6)) {
+            memcpy(addr, &a6->s6_addr[12], 4);
+            return 4;
+        }
+        memcpy(addr, a6, 16);
+        return 16;
+    }
+    return 0;
+}
\ No newline at end of file
@@ -61,4 +61,31 @@ void __dmserver_setcb_onclientrcv(dmserver_callback_pt cb, void (*on_client_rcv)
 void __dmserver_setcb_onclientsnd(dmserver_callback_pt cb, void (*on_client_snd)(dmserver_cliconn_pt)){
     // Callback assignation:
     cb->on_client_snd = on_client_snd;
+}
+
+/*
+    @brief Function to set a callback function when received data from a group of clients (batched
+    reception), delivered once per subordinate thread event round.
+    @note: When this callback is set, on_client_rcv is not called. The data views are only valid
+    inside the callback.
+
+    @param dmserver_callback_pt cb: Reference to callbacks struct.
+    @param void (*on_client_rcv_batch)(dmserver_rcvmsg_pt, size_t): Reference to callback function.
+*/
+void __dmserver_setcb_onclientrcvbatch(dmserver_callback_pt cb, void (*on_client_rcv_batch)(dmserver_rcvmsg_pt, size_t)){
+    // Callback assignation:
+    cb->on_client_rcv_batch = on_client_rcv_batch;
+}
+
+/*
+    @brief Function to set a callback function when a subordinate thread enters or leaves overload,
+    so the application can shed work too.
+    @note: Called from the overloaded subthread itself, it must return quickly.
+
+    @param dmserver_callback_pt cb: Reference to callbacks struct.
+    @param void (*on_overload)(size_t, bool): Reference to callback function.
+*/
+void __dmserver_setcb_onoverload(dmserver_callback_pt cb, void (*on_overload)(size_t, bool)){
+    // Callback assignation:
+    cb->on_overload = on_overload;
 }
\ No newline at end of file
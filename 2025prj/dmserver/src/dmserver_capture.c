@@ -0,0 +1,611 @@
+/*
+
+*/
+
+/* ---- Library --------------------------------------------------- */
+#include "../inc/_dmserver_capture.h"
+
+/* ---- Helper functions implementation prototypes ---------------- */
+static struct dmserver_capbuf * _dmserver_capture_helper_buf(dmserver_capture_pt cap);
+static bool _dmserver_capture_helper_blocks(dmserver_capture_pt cap, struct dmserver_capbuf * b);
+static void * _dmserver_capture_helper_writer(void * args);
+static void _dmserver_capture_helper_flush(dmserver_capture_pt cap, bool all, bool detach);
+static void _dmserver_capture_helper_write(dmserver_capture_pt cap, const char * data, size_t len);
+static long _dmserver_capture_helper_nowns(void);
+static int _dmserver_capture_helper_cmp(const void * a, const void * b);
+static int _dmserver_capture_helper_connect(dmserver_replay_conf_pt conf, int epfd);
+static void _dmserver_capture_helper_drain(int epfd, int timeout_ms, dmserver_replay_stats_pt stats);
+
+// Captures ids & buffer cached by each recording thread (captures told apart by id, not by address):
+static uint64_t _dmserver_capture_ids = 0;
+static __thread uint64_t _dmserver_capture_tid = 0;
+static __thread struct dmserver_capbuf * _dmserver_capture_tbuf = NULL;
+
+
+
+
+/* ---- INTERNAL - Functions implementation ----------------------- */
+// ======== General use:
+/*
+    @brief Function to initialize a traffic capture (stopped, no buffers).
+
+    @param dmserver_capture_pt cap: Reference to capture.
+
+    @retval true: Initialization succeeded.
+    @retval false: Initialization failed.
+*/
+bool _dmserver_capture_init(dmserver_capture_pt cap){
+    // Reference check:
+    if (!cap) return false;
+    memset(cap, 0, sizeof(dmserver_capture_t));
+    cap->cfd = -1;
+    cap->cid = __atomic_add_fetch(&_dmserver_capture_ids, 1, __ATOMIC_RELAXED);
+
+    // Writer thread wake ups on the monotonic clock (full blocks or flush interval):
+    pthread_condattr_t attr;
+    if (pthread_condattr_init(&attr)) return false;
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    if (pthread_mutex_init(&cap->clock, NULL) || pthread_cond_init(&cap->ccond, &attr)) {
+        pthread_condattr_destroy(&attr);
+        return false;
+    }
+    pthread_condattr_destroy(&attr);
+    return true;
+}
+
+/*
+    @brief Function to deinitialize a traffic capture (stopped first, buffers of every recording
+    thread freed).
+    @note: No thread may record anymore.
+
+    @param dmserver_capture_pt cap: Reference to capture.
+*/
+void _dmserver_capture_deinit(dmserver_capture_pt cap){
+    // Reference & initialization check:
+    if (!cap || !cap->cid) return;
+
+    _dmserver_capture_stop(cap);
+    while (cap->cbufs){
+        struct dmserver_capbuf * b = cap->cbufs;
+        cap->cbufs = b->bnext;
+        pthread_mutex_destroy(&b->block);
+        free(b);
+    }
+    pthread_cond_destroy(&cap->ccond);
+    pthread_mutex_destroy(&cap->clock);
+}
+
+// ======== Start / Stop:
+/*
+    @brief Function to start a traffic capture into a file (truncated), the recording threads from now
+    on take blocks of the given length (two per thread).
+
+    @param dmserver_capture_pt cap: Reference to capture.
+    @param const char * path: Capture file path.
+    @param size_t buf_size: Block length of each recording thread (0 default).
+
+    @retval true: Capture started.
+    @retval false: Capture running already, file or allocation failed.
+*/
+bool _dmserver_capture_start(dmserver_capture_pt cap, const char * path, size_t buf_size){
+    // References check:
+    if (!cap || !path) return false;
+    if (buf_size == 0) buf_size = DEFAULT_CAPTURE_BUFLEN;
+    if (buf_size < DEFAULT_CAPTURE_BUFMINLEN) buf_size = DEFAULT_CAPTURE_BUFMINLEN;
+
+    pthread_mutex_lock(&cap->clock);
+    if (cap->cwriter_run) {
+        pthread_mutex_unlock(&cap->clock);
+        return false;
+    }
+
+    // Capture file & its header (wall clock start):
+    cap->cfd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (cap->cfd < 0) {
+        pthread_mutex_unlock(&cap->clock);
+        return false;
+    }
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    struct dmserver_caphdr h = {.hmagic=DEFAULT_CAPTURE_MAGIC, .hversion=DEFAULT_CAPTURE_VERSION, .hstart_ns=(int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec};
+    _dmserver_capture_helper_write(cap, (const char *)&h, sizeof(h));
+    cap->cstart_ns = _dmserver_capture_helper_nowns();
+    cap->cbuf_size = buf_size;
+    memset(&cap->cstats, 0, sizeof(cap->cstats));
+
+    // Blocks of the threads recorded before & writer thread:
+    bool ok = true;
+    for (struct dmserver_capbuf * b = cap->cbufs; ok && b; b = b->bnext) ok = _dmserver_capture_helper_blocks(cap, b);
+    cap->cwriter_run = ok;
+    if (ok && pthread_create(&cap->cwriter, NULL, _dmserver_capture_helper_writer, cap)) {
+        cap->cwriter_run = false;
+        ok = false;
+    }
+    if (!ok) {
+        _dmserver_capture_helper_flush(cap, true, true);
+        close(cap->cfd);
+        cap->cfd = -1;
+        pthread_mutex_unlock(&cap->clock);
+        return false;
+    }
+    __atomic_store_n(&cap->cenabled, true, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&cap->clock);
+    return true;
+}
+
+/*
+    @brief Function to stop a traffic capture: every record taken is written to the file and the
+    blocks of the recording threads are freed (the records in flight meanwhile are dropped).
+
+    @param dmserver_capture_pt cap: Reference to capture.
+
+    @retval true: Capture stopped.
+    @retval false: Capture not running.
+*/
+bool _dmserver_capture_stop(dmserver_capture_pt cap){
+    // Reference check:
+    if (!cap) return false;
+
+    pthread_mutex_lock(&cap->clock);
+    if (!cap->cwriter_run) {
+        pthread_mutex_unlock(&cap->clock);
+        return false;
+    }
+    __atomic_store_n(&cap->cenabled, false, __ATOMIC_RELAXED);
+    cap->cwriter_run = false;
+    pthread_cond_signal(&cap->ccond);
+    pthread_mutex_unlock(&cap->clock);
+
+    // Writer thread last flush (blocks detached):
+    pthread_join(cap->cwriter, NULL);
+    close(cap->cfd);
+    cap->cfd = -1;
+    return true;
+}
+
+// ======== Records:
+/*
+    @brief Function to record an event of a client connection (data read or written before encryption,
+    connection or disconnection) into the buffer of the calling thread. Nothing is recorded while the
+    capture is stopped nor for the upstream connections (outbound, not client traffic).
+    @note: Never blocks on the file, the record is dropped when the thread blocks are both full.
+
+    @param dmserver_capture_pt cap: Reference to capture.
+    @param enum dmserver_capture_dir dir: Record type.
+    @param dmserver_cliconn_pt c: Client of the record.
+    @param const char * data: Payload (NULL without payload).
+    @param size_t len: Payload length (truncated to the block length).
+*/
+void _dmserver_capture_record(dmserver_capture_pt cap, enum dmserver_capture_dir dir, dmserver_cliconn_pt c, const char * data, size_t len){
+    // References & capture state check:
+    if (!cap || !c || !__atomic_load_n(&cap->cenabled, __ATOMIC_ACQUIRE) || c->cupstream) return;
+    if (!data) len = 0;
+    struct dmserver_capbuf * b = _dmserver_capture_helper_buf(cap);
+    if (!b) {
+        __atomic_add_fetch(&cap->cstats.cdropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    // Record length (8 bytes aligned, payload truncated to fit a block):
+    size_t maxlen = cap->cbuf_size - sizeof(struct dmserver_caprec);
+    if (len > maxlen) len = maxlen;
+    if (len > UINT32_MAX) len = UINT32_MAX & ~(size_t)7;
+    size_t rlen = (sizeof(struct dmserver_caprec) + len + 7) & ~(size_t)7;
+
+    pthread_mutex_lock(&b->block);
+    if (!b->bactive) {
+        pthread_mutex_unlock(&b->block);
+        __atomic_add_fetch(&cap->cstats.cdropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    // Active block full, handed to the writer if it gave the spare one back (dropped otherwise):
+    bool handed = false;
+    if (b->bactive_len + rlen > cap->cbuf_size) {
+        if (b->bfull || !b->bspare) {
+            pthread_mutex_unlock(&b->block);
+            __atomic_add_fetch(&cap->cstats.cdropped, 1, __ATOMIC_RELAXED);
+            return;
+        }
+        b->bfull = b->bactive;
+        b->bfull_len = b->bactive_len;
+        b->bactive = b->bspare;
+        b->bactive_len = 0;
+        b->bspare = NULL;
+        handed = true;
+    }
+
+    // Record & payload:
+    struct dmserver_caprec * r = (struct dmserver_caprec *)(b->bactive + b->bactive_len);
+    *r = (struct dmserver_caprec){
+        .rts_ns=(uint64_t)(_dmserver_capture_helper_nowns() - cap->cstart_ns),
+        .rth=(uint32_t)c->cloc.th_pos, .rslot=(uint32_t)c->cloc.wc_pos, .rlen=(uint32_t)len,
+        .rdir=(uint8_t)dir, .rtransport=(uint8_t)c->ctransport
+    };
+    if (len) memcpy(r + 1, data, len);
+    memset((char *)(r + 1) + len, 0, rlen - sizeof(struct dmserver_caprec) - len);
+    b->bactive_len += rlen;
+    pthread_mutex_unlock(&b->block);
+
+    // Writer woken up (a missed wake up only delays the block to the next flush interval):
+    if (handed) pthread_cond_signal(&cap->ccond);
+    __atomic_add_fetch(&cap->cstats.crecords, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&cap->cstats.cbytes, len, __ATOMIC_RELAXED);
+}
+
+// ======== Replay:
+/*
+    @brief Function to replay a capture file against a test server: a connection per captured session,
+    opened on its connection record (or first read), the data read by the server sent with the original
+    timing (scaled) and closed on its disconnection record. The server responses are read and discarded.
+    @note: Sessions are replayed in plain text over the socket type given (TLS not replayed).
+
+    @param dmserver_replay_conf_pt conf: Reference to replay configuration.
+    @param dmserver_replay_stats_pt stats: Reference to the stats struct to fill (NULL ignored).
+
+    @retval true: Capture replayed.
+    @retval false: Invalid capture file or allocation failed.
+*/
+bool _dmserver_capture_replay(dmserver_replay_conf_pt conf, dmserver_replay_stats_pt stats){
+    // References check:
+    if (!conf || !conf->rpath || !conf->rhost) return false;
+    dmserver_replay_stats_t temp_stats;
+    if (!stats) stats = &temp_stats;
+    memset(stats, 0, sizeof(dmserver_replay_stats_t));
+
+    // Capture file loaded (header checked):
+    int fd = open(conf->rpath, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    off_t flen = lseek(fd, 0, SEEK_END);
+    char * file = (flen >= (off_t)sizeof(struct dmserver_caphdr)) ? malloc(flen) : NULL;
+    if (!file || (pread(fd, file, flen, 0) != flen)) {
+        if (file) free(file);
+        close(fd);
+        return false;
+    }
+    close(fd);
+    struct dmserver_caphdr * h = (struct dmserver_caphdr *)file;
+    if ((h->hmagic != DEFAULT_CAPTURE_MAGIC) || (h->hversion != DEFAULT_CAPTURE_VERSION)) {
+        free(file);
+        return false;
+    }
+
+    // Records index (time order, file order for the same time) & sessions table size:
+    size_t nrecs = 0;
+    size_t recs_size = 1024;
+    struct dmserver_caprec ** recs = malloc(recs_size * sizeof(struct dmserver_caprec *));
+    uint32_t maxth = 0, maxslot = 0;
+    for (size_t off = sizeof(struct dmserver_caphdr); recs && (off + sizeof(struct dmserver_caprec) <= (size_t)flen); ){
+        struct dmserver_caprec * r = (struct dmserver_caprec *)(file + off);
+        size_t rlen = (sizeof(struct dmserver_caprec) + r->rlen + 7) & ~(size_t)7;
+        if (off + sizeof(struct dmserver_caprec) + r->rlen > (size_t)flen) break;
+        if (nrecs == recs_size) {
+            struct dmserver_caprec ** nr = realloc(recs, 2 * recs_size * sizeof(struct dmserver_caprec *));
+            if (!nr) {
+                free(recs);
+                recs = NULL;
+                break;
+            }
+            recs = nr;
+            recs_size *= 2;
+        }
+        recs[nrecs++] = r;
+        if (r->rth > maxth) maxth = r->rth;
+        if (r->rslot > maxslot) maxslot = r->rslot;
+        off += rlen;
+    }
+    size_t nsess = ((size_t)maxth + 1) * ((size_t)maxslot + 1);
+    int * sess = (recs) ? malloc(nsess * sizeof(int)) : NULL;
+    int epfd = (sess) ? epoll_create1(EPOLL_CLOEXEC) : -1;
+    if (epfd < 0) {
+        if (sess) free(sess);
+        if (recs) free(recs);
+        free(file);
+        return false;
+    }
+    qsort(recs, nrecs, sizeof(struct dmserver_caprec *), _dmserver_capture_helper_cmp);
+    for (size_t i = 0; i < nsess; i++) sess[i] = -1;
+
+    // Records in time order (the responses read while waiting):
+    long start = _dmserver_capture_helper_nowns();
+    for (size_t i = 0; i < nrecs; i++){
+        struct dmserver_caprec * r = recs[i];
+        if (r->rdir == DMSERVER_CAPTURE_OUT) continue;
+
+        if (conf->rspeed > 0) {
+            long due = start + (long)((double)r->rts_ns / conf->rspeed);
+            long now = _dmserver_capture_helper_nowns();
+            while (now < due){
+                _dmserver_capture_helper_drain(epfd, (int)((due - now) / 1000000), stats);
+                now = _dmserver_capture_helper_nowns();
+            }
+            if ((size_t)((now - due) / 1000) > stats->rmax_lag_usec) stats->rmax_lag_usec = (now - due) / 1000;
+        } else _dmserver_capture_helper_drain(epfd, 0, stats);
+
+        int * s = &sess[(size_t)r->rth * ((size_t)maxslot + 1) + r->rslot];
+        if (r->rdir == DMSERVER_CAPTURE_DISCONNECT) {
+            if (*s >= 0) close(*s);
+            *s = -1;
+            continue;
+        }
+
+        // Session connection (connection record, or first read of a session open before the capture or
+        // recorded by its subthread before the main thread recorded the connection):
+        if (*s < 0) {
+            *s = _dmserver_capture_helper_connect(conf, epfd);
+            if (*s < 0) continue;
+            stats->rsessions++;
+        }
+        if ((r->rdir != DMSERVER_CAPTURE_IN) || (r->rlen == 0)) continue;
+
+        // Data read by the server sent again (whole record, blocking):
+        const char * data = (const char *)(r + 1);
+        size_t sent = 0;
+        while (sent < r->rlen){
+            ssize_t n = send(*s, data + sent, r->rlen - sent, MSG_NOSIGNAL);
+            if ((n < 0) && (errno == EINTR)) continue;
+            if (n <= 0) break;
+            sent += n;
+        }
+        stats->rrecords++;
+        stats->rbytes_sent += sent;
+    }
+
+    // Last responses read & sessions closed:
+    _dmserver_capture_helper_drain(epfd, DEFAULT_CAPTURE_FLUSHMS, stats);
+    for (size_t i = 0; i < nsess; i++) if (sess[i] >= 0) close(sess[i]);
+    close(epfd);
+    free(sess);
+    free(recs);
+    free(file);
+    return true;
+}
+
+
+
+
+/* ---- STATIC INTERNAL - Helper functions implementation --------- */
+/*
+    @brief Helper function that gets the buffer of the calling thread (cached per thread, created on its
+    first record, with its blocks if the capture is running).
+
+    @param dmserver_capture_pt cap: Reference to capture.
+
+    @retval Buffer of the thread, NULL on allocation failure.
+*/
+static struct dmserver_capbuf * _dmserver_capture_helper_buf(dmserver_capture_pt cap){
+    // Buffer cached by the thread:
+    if (_dmserver_capture_tid == cap->cid) return _dmserver_capture_tbuf;
+
+    // Buffer of the thread in the capture, or a new one:
+    pthread_t self = pthread_self();
+    pthread_mutex_lock(&cap->clock);
+    struct dmserver_capbuf * b = cap->cbufs;
+    while (b && !pthread_equal(b->bowner, self)) b = b->bnext;
+    if (!b) {
+        b = calloc(1, sizeof(struct dmserver_capbuf));
+        if (!b || pthread_mutex_init(&b->block, NULL)) {
+            if (b) free(b);
+            pthread_mutex_unlock(&cap->clock);
+            return NULL;
+        }
+        b->bowner = self;
+        if (cap->cwriter_run) _dmserver_capture_helper_blocks(cap, b);
+        b->bnext = cap->cbufs;
+        cap->cbufs = b;
+    }
+    pthread_mutex_unlock(&cap->clock);
+
+    _dmserver_capture_tid = cap->cid;
+    _dmserver_capture_tbuf = b;
+    return b;
+}
+
+/*
+    @brief Helper function that allocates the blocks of a thread buffer (active & spare).
+    @note: The capture lock must be held by the caller.
+
+    @param dmserver_capture_pt cap: Reference to capture.
+    @param struct dmserver_capbuf * b: Thread buffer.
+
+    @retval true: Blocks allocated.
+    @retval false: Allocation failed.
+*/
+static bool _dmserver_capture_helper_blocks(dmserver_capture_pt cap, struct dmserver_capbuf * b){
+    pthread_mutex_lock(&b->block);
+    if (!b->bactive) b->bactive = malloc(cap->cbuf_size);
+    if (!b->bspare) b->bspare = malloc(cap->cbuf_size);
+    b->bactive_len = 0;
+    bool ok = b->bactive && b->bspare;
+    pthread_mutex_unlock(&b->block);
+    return ok;
+}
+
+/*
+    @brief Helper function that implements the capture writer thread: the full blocks are written when
+    handed over, every block with records once per flush interval, and every block once stopped.
+
+    @param void * args: Reference to capture.
+
+    @retval NULL. (always)
+*/
+static void * _dmserver_capture_helper_writer(void * args){
+    dmserver_capture_pt cap = (dmserver_capture_pt)args;
+
+    pthread_mutex_lock(&cap->clock);
+    while (cap->cwriter_run){
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        ts.tv_nsec += DEFAULT_CAPTURE_FLUSHMS * 1000000L;
+        ts.tv_sec += ts.tv_nsec / 1000000000L;
+        ts.tv_nsec %= 1000000000L;
+        bool interval = (pthread_cond_timedwait(&cap->ccond, &cap->clock, &ts) == ETIMEDOUT);
+        if (cap->cwriter_run) _dmserver_capture_helper_flush(cap, interval, false);
+    }
+    _dmserver_capture_helper_flush(cap, true, true);
+    pthread_mutex_unlock(&cap->clock);
+    return NULL;
+}
+
+/*
+    @brief Helper function that writes the blocks of the recording threads to the capture file: the
+    full ones, the active ones with records as well (all) and frees them afterwards (detach).
+    @note: The capture lock must be held by the caller.
+
+    @param dmserver_capture_pt cap: Reference to capture.
+    @param bool all: Active blocks with records written too (swapped with the spare one).
+    @param bool detach: Every block written & freed (capture stopping).
+*/
+static void _dmserver_capture_helper_flush(dmserver_capture_pt cap, bool all, bool detach){
+    for (struct dmserver_capbuf * b = cap->cbufs; b; b = b->bnext){
+        // Blocks taken from the thread (under its lock, written without it):
+        pthread_mutex_lock(&b->block);
+        char * full = b->bfull;
+        size_t full_len = b->bfull_len;
+        b->bfull = NULL;
+        b->bfull_len = 0;
+        char * active = NULL;
+        size_t active_len = 0;
+        char * spare = NULL;
+        if (detach) {
+            active = b->bactive;
+            active_len = b->bactive_len;
+            spare = b->bspare;
+            b->bactive = NULL;
+            b->bactive_len = 0;
+            b->bspare = NULL;
+        } else if (all && (b->bactive_len > 0) && b->bspare && !full) {
+            active = b->bactive;
+            active_len = b->bactive_len;
+            b->bactive = b->bspare;
+            b->bactive_len = 0;
+            b->bspare = NULL;
+        }
+        pthread_mutex_unlock(&b->block);
+
+        // Older block first:
+        if (full) _dmserver_capture_helper_write(cap, full, full_len);
+        if (active) _dmserver_capture_helper_write(cap, active, active_len);
+        if (detach) {
+            if (full) free(full);
+            if (active) free(active);
+            if (spare) free(spare);
+            continue;
+        }
+
+        // Written block given back as spare (nothing taken, spare kept):
+        if (!full && !active) continue;
+        pthread_mutex_lock(&b->block);
+        b->bspare = (full) ? full : active;
+        pthread_mutex_unlock(&b->block);
+    }
+}
+
+/*
+    @brief Helper function that writes data to the capture file (whole or until an error, accounted).
+
+    @param dmserver_capture_pt cap: Reference to capture.
+    @param const char * data: Data.
+    @param size_t len: Data length.
+*/
+static void _dmserver_capture_helper_write(dmserver_capture_pt cap, const char * data, size_t len){
+    size_t off = 0;
+    while (off < len){
+        ssize_t n = write(cap->cfd, data + off, len - off);
+        if ((n < 0) && (errno == EINTR)) continue;
+        if (n <= 0) break;
+        off += n;
+    }
+    __atomic_add_fetch(&cap->cstats.cwritten, off, __ATOMIC_RELAXED);
+}
+
+/*
+    @brief Helper function to get the monotonic time in ns.
+
+    @retval Monotonic time in ns.
+*/
+static long _dmserver_capture_helper_nowns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+/*
+    @brief Helper function that orders the replay records by time (file order for the same time).
+
+    @param const void * a: Record reference.
+    @param const void * b: Record reference.
+
+    @retval Order of the records.
+*/
+static int _dmserver_capture_helper_cmp(const void * a, const void * b){
+    const struct dmserver_caprec * ra = *(const struct dmserver_caprec * const *)a;
+    const struct dmserver_caprec * rb = *(const struct dmserver_caprec * const *)b;
+    if (ra->rts_ns != rb->rts_ns) return (ra->rts_ns < rb->rts_ns) ? -1 : 1;
+    return (ra < rb) ? -1 : (ra > rb);
+}
+
+/*
+    @brief Helper function that opens a replay session to the test server (host & port, or unix domain
+    path), its responses watched by the replay epoll.
+
+    @param dmserver_replay_conf_pt conf: Reference to replay configuration.
+    @param int epfd: Replay epoll.
+
+    @retval Session socket, -1 on failure.
+*/
+static int _dmserver_capture_helper_connect(dmserver_replay_conf_pt conf, int epfd){
+    int socktype = (conf->rsocktype) ? conf->rsocktype : SOCK_STREAM;
+    int fd = -1;
+
+    if (conf->rhost[0] == '/') {
+        // Unix domain test server:
+        struct sockaddr_un addr = {.sun_family=AF_UNIX};
+        if (strlen(conf->rhost) >= sizeof(addr.sun_path)) return -1;
+        strcpy(addr.sun_path, conf->rhost);
+        fd = socket(AF_UNIX, socktype | SOCK_CLOEXEC, 0);
+        if ((fd >= 0) && (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)) {
+            close(fd);
+            fd = -1;
+        }
+    } else {
+        // Network test server (first address that connects):
+        char port[8];
+        snprintf(port, sizeof(port), "%u", conf->rport);
+        struct addrinfo * res = NULL;
+        if (getaddrinfo(conf->rhost, port, &(struct addrinfo){.ai_socktype=socktype}, &res)) return -1;
+        for (struct addrinfo * ai = res; ai && (fd < 0); ai = ai->ai_next){
+            fd = socket(ai->ai_family, socktype | SOCK_CLOEXEC, 0);
+            if ((fd >= 0) && (connect(fd, ai->ai_addr, ai->ai_addrlen) < 0)) {
+                close(fd);
+                fd = -1;
+            }
+        }
+        freeaddrinfo(res);
+    }
+
+    if ((fd >= 0) && (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &(struct epoll_event){.events=EPOLLIN, .data.fd=fd}) < 0)) {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+/*
+    @brief Helper function that reads and discards the responses of the replay sessions (sessions closed
+    by the server are no longer watched).
+
+    @param int epfd: Replay epoll.
+    @param int timeout_ms: Wait for the first response in ms.
+    @param dmserver_replay_stats_pt stats: Replay counters.
+*/
+static void _dmserver_capture_helper_drain(int epfd, int timeout_ms, dmserver_replay_stats_pt stats){
+    struct epoll_event evs[DEFAULT_CAPTURE_REPLAYEVS];
+    char buf[16384];
+    int nfds = epoll_wait(epfd, evs, DEFAULT_CAPTURE_REPLAYEVS, timeout_ms);
+    for (int i = 0; i < nfds; i++){
+        ssize_t n;
+        while ((n = recv(evs[i].data.fd, buf, sizeof(buf), MSG_DONTWAIT)) > 0) stats->rbytes_rcvd += n;
+        if ((n == 0) || ((n < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))) epoll_ctl(epfd, EPOLL_CTL_DEL, evs[i].data.fd, NULL);
+    }
+}
\ No newline at end of file
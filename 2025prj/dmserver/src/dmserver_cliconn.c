@@ -5,6 +5,10 @@
 /* ---- Library --------------------------------------------------- */
 #include "../inc/_dmserver_cliconn.h"
 
+/* ---- Helper functions implementation prototypes ---------------- */
+static void _dmserver_cconn_helper_seqbegin(dmserver_cliconn_pt c);
+static void _dmserver_cconn_helper_seqend(dmserver_cliconn_pt c);
+
 
 /* ---- INTERNAL - Functions implementation ----------------------- */
 // ======== General use:
@@ -24,6 +28,7 @@ bool _dmserver_cconn_init(struct dmserver_cliconn * c){
     if (c->cstate != DMSERVER_CLIENT_UNABLE) return false;
 
     // Initialize conection data:
+    c->cevsrc.etype = DMSERVER_EVSRC_CLIENT;
     c->cfd = -1;
     c->caddr_family = AF_UNSPEC;
 
@@ -87,14 +92,16 @@ bool _dmserver_cconn_deinit(struct dmserver_cliconn * c){
     @param int cfd: client-socket file descriptor.
     @param struct sockaddr_storage *caddr: Client connection address.
     @param SSL * cssl: Reference to client secure socket layer.
+    @param time_t now: Connection time (worker clock).
 
     @retval true: Set succeeded.
     @retval false: Set failed.
 */
-bool _dmserver_cconn_set(struct dmserver_cliconn * c, dmserver_cliloc_pt cloc, int cfd, struct sockaddr_storage * caddr, SSL * cssl){
+bool _dmserver_cconn_set(struct dmserver_cliconn * c, dmserver_cliloc_pt cloc, int cfd, struct sockaddr_storage * caddr, SSL * cssl, time_t now){
     // References & values & state checks:
     if (!c || (cfd < 0) || !caddr) return false;
     if (c->cstate != DMSERVER_CLIENT_STANDBY) return false;
+    _dmserver_cconn_helper_seqbegin(c);
 
     // Set the client location:
     c->cloc.th_pos = cloc->th_pos;
@@ -108,9 +115,17 @@ bool _dmserver_cconn_set(struct dmserver_cliconn * c, dmserver_cliloc_pt cloc, i
     if (caddr->ss_family == AF_INET){
         struct sockaddr_in * addr4 = (struct sockaddr_in *)caddr;
         c->caddr.c4 = *addr4;
+    } else if (caddr->ss_family == AF_UNIX){
+        // Unix domain peer identity from the kernel credentials:
+        socklen_t credlen = sizeof(c->cpeercred);
+        if (getsockopt(cfd, SOL_SOCKET, SO_PEERCRED, &c->cpeercred, &credlen) < 0) {
+            _dmserver_cconn_helper_seqend(c);
+            return false;
+        }
     } else if (caddr->ss_family == AF_INET6){
         struct sockaddr_in6 * addr6 = (struct sockaddr_in6 *)caddr;
         if (IN6_IS_ADDR_V4MAPPED(&addr6->sin6_addr)) {
+            c->caddr_family = AF_INET;
             c->caddr.c4.sin_family = AF_INET;
             c->caddr.c4.sin_port = addr6->sin6_port;
             memcpy(&c->caddr.c4.sin_addr, &addr6->sin6_addr.s6_addr[12], 4);
@@ -121,8 +136,10 @@ bool _dmserver_cconn_set(struct dmserver_cliconn * c, dmserver_cliloc_pt cloc, i
     // Set ssl session reference:
     c->cssl = cssl;
 
-    // Set last time timeout to now:
-    c->clastt = time(NULL);
+    // Set connection & last time timeout to now:
+    c->clastt = now;
+    c->cconnt = now;
+    _dmserver_cconn_helper_seqend(c);
 
     // Set established state:
     c->cstate = DMSERVER_CLIENT_ESTABLISHED;
@@ -143,6 +160,7 @@ bool _dmserver_cconn_reset(struct dmserver_cliconn * c){
     // Reference & state check:
     if (!c) return false;
     if (c->cstate != DMSERVER_CLIENT_CLOSED) return false;
+    _dmserver_cconn_helper_seqbegin(c);
 
     // Reset location data:
     c->cloc.th_pos = 0;
@@ -151,17 +169,53 @@ bool _dmserver_cconn_reset(struct dmserver_cliconn * c){
     // Reset connection data:
     c->cssl = NULL;
     c->cfd = -1;
+    c->ctransport = DMSERVER_TRANSPORT_STREAM;
     
     c->caddr_family = AF_UNSPEC;
     memset(&c->caddr, 0, sizeof(c->caddr));
+    memset(&c->cpeercred, 0, sizeof(c->cpeercred));
     c->clastt = 0;
+    c->cupstream = NULL;
+    c->cupmember = 0;
+    c->cconnecting = false;
+    c->cproxy = NULL;
+    c->cconnt = 0;
+    __atomic_store_n(&c->crbytes, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&c->cwbytes, 0, __ATOMIC_RELAXED);
+    _dmserver_cconn_helper_seqend(c);
+
+    // Close passed file descriptors not taken/sent:
+    _dmserver_cconn_closefds(c, true, true);
+
+    // Release the source IP entry and reset the reception limits (the deferred reads list belongs to
+    // the subthread, which drops the slot once it finds it closed or reused):
+    _dmserver_limits_iprelease(c->cipentry);
+    c->cipentry = NULL;
+    c->cmsgs_tat = 0;
+    c->cbytes_tat = 0;
+    c->crpaused = false;
+    c->crload = 0;
 
     // Reset read/write buffers:
     memset(c->crbuffer, 0, c->crbuffer_size);
     c->crlen = 0;
+    c->crts = (struct timespec){0};
 
     memset(c->cwbuffer, '\0', c->cwbuffer_size);
     c->cwlen = 0;
+    c->cwarmed = false;
+    c->cwkick = false;
+    c->cdisreq = false;
+    _dmserver_cconn_wqclear(c);
+    _dmserver_cconn_zcclear(c);
+    c->csubs = 0;
+
+    // Reset the user context & arena (all its allocations at once):
+    c->cuser = NULL;
+    _dmserver_cconn_arena_reset(c);
+
+    // Slot generation (references taken before the reset no longer match):
+    c->cgen++;
 
     // Reset state:
     c->cstate = DMSERVER_CLIENT_STANDBY;
@@ -173,19 +227,612 @@ bool _dmserver_cconn_reset(struct dmserver_cliconn * c){
     @brief Function to check the client timeout field.
 
     @param struct dmserver_cliconn * c: Reference to client to check.
+    @param time_t timeout_sec: Timeout in seconds.
+    @param time_t now: Current time (worker clock).
 
     @retval true: No timeout nor fail occured.
     @retval false: Error or timeout occured.
 */
-bool _dmserver_cconn_checktimeout(struct dmserver_cliconn * c, time_t timeout_sec){
+bool _dmserver_cconn_checktimeout(struct dmserver_cliconn * c, time_t timeout_sec, time_t now){
     // Reference check:
     if (!c || (timeout_sec == 0)) return false;
 
     // Timeout check: 
-    if ((time(NULL) - c->clastt) > timeout_sec) return false;
+    if ((now - c->clastt) > timeout_sec) return false;
+    return true;
+}
+
+/*
+    @brief Function to close the file descriptors received/pending to send of a client (received ones
+    set to -1 by the application are considered taken and not closed).
+
+    @param struct dmserver_cliconn * c: Reference to client.
+    @param bool crfds: Close the received file descriptors.
+    @param bool cwfds: Close the file descriptors pending to send.
+*/
+void _dmserver_cconn_closefds(struct dmserver_cliconn * c, bool crfds, bool cwfds){
+    // Reference check:
+    if (!c) return;
+
+    // Received file descriptors:
+    if (crfds) {
+        for (size_t i = 0; i < c->crfdslen; i++) if (c->crfds[i] >= 0) close(c->crfds[i]);
+        c->crfdslen = 0;
+    }
+
+    // Pending to send file descriptors:
+    if (cwfds) {
+        for (size_t i = 0; i < c->cwfdslen; i++) if (c->cwfds[i] >= 0) close(c->cwfds[i]);
+        c->cwfdslen = 0;
+    }
+}
+
+/*
+    @brief Function to format the client address as a printable string (ip:port or unix peer pid/uid).
+
+    @param struct dmserver_cliconn * c: Reference to client.
+    @param char * str: Output string.
+    @param size_t len: Output string length (DEFAULT_CCONN_ADDRSTRLEN recommended).
+*/
+void _dmserver_cconn_addrstr(struct dmserver_cliconn * c, char * str, size_t len){
+    // References check:
+    if (!c || !str || (len == 0)) return;
+    str[0] = '\0';
+
+    // Address by family:
+    char cip_str[INET6_ADDRSTRLEN] = "";
+    if (c->caddr_family == AF_INET){
+        inet_ntop(AF_INET, &c->caddr.c4.sin_addr, cip_str, sizeof(cip_str));
+        snprintf(str, len, "%s:%d", cip_str, ntohs(c->caddr.c4.sin_port));
+    } else if (c->caddr_family == AF_INET6){
+        inet_ntop(AF_INET6, &c->caddr.c6.sin6_addr, cip_str, sizeof(cip_str));
+        snprintf(str, len, "[%s]:%d", cip_str, ntohs(c->caddr.c6.sin6_port));
+    } else if (c->caddr_family == AF_UNIX){
+        snprintf(str, len, "unix:pid=%d,uid=%d", (int)c->cpeercred.pid, (int)c->cpeercred.uid);
+    }
+}
+
+// ======== Registry record:
+/*
+    @brief Function to change the transport of a client (datagram session or shared memory rings set
+    up after the connection data), published in its registry record.
+
+    @param dmserver_cliconn_pt c: Reference to client.
+    @param enum dmserver_cconn_transport t: Transport of the client.
+*/
+void _dmserver_cconn_settransport(dmserver_cliconn_pt c, enum dmserver_cconn_transport t){
+    // Reference check:
+    if (!c) return;
+
+    _dmserver_cconn_helper_seqbegin(c);
+    c->ctransport = t;
+    _dmserver_cconn_helper_seqend(c);
+}
+
+/*
+    @brief Function to read the registry record of a client slot from any thread, without locks nor
+    stores to the slot (the read is retried while the slot owner rewrites its identity).
+    @note: Counters and state are the ones of the moment of the read (relaxed), the identity fields 
+    always belong to the same connection.
+
+    @param dmserver_cliconn_pt c: Reference to client.
+    @param dmserver_cliinfo_pt info: Reference to the metadata struct to fill.
+
+    @retval true: Slot connected (establishing or established), metadata filled.
+    @retval false: Slot free or rewritten during every retry.
+*/
+bool _dmserver_cconn_info(dmserver_cliconn_pt c, dmserver_cliinfo_pt info){
+    // References check:
+    if (!c || !info) return false;
+
+    for (size_t r = 0; r < DEFAULT_CCONN_INFORETRIES; r++){
+        // Sequence even (identity stable) before the copy:
+        uint32_t seq = __atomic_load_n(&c->cseq, __ATOMIC_ACQUIRE);
+        if (seq & 1) continue;
+        enum dmserver_cconn_state state = __atomic_load_n(&c->cstate, __ATOMIC_RELAXED);
+        if ((state != DMSERVER_CLIENT_ESTABLISHING) && (state != DMSERVER_CLIENT_ESTABLISHED)) return false;
+
+        info->iloc = c->cloc;
+        info->ifd = c->cfd;
+        info->istate = state;
+        info->itransport = c->ctransport;
+        info->iaddr_family = c->caddr_family;
+        memcpy(&info->iaddr, &c->caddr, sizeof(info->iaddr));
+        info->iupstream = (c->cupstream != NULL);
+        info->iproxied = (c->cproxy != NULL);
+        info->iconnt = c->cconnt;
+        info->ilastt = __atomic_load_n(&c->clastt, __ATOMIC_RELAXED);
+        info->irbytes = __atomic_load_n(&c->crbytes, __ATOMIC_RELAXED);
+        info->iwbytes = __atomic_load_n(&c->cwbytes, __ATOMIC_RELAXED);
+        info->iwq_bytes = __atomic_load_n(&c->cwq_bytes, __ATOMIC_RELAXED);
+
+        // Same sequence after the copy (no rewrite in between):
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&c->cseq, __ATOMIC_RELAXED) == seq) return true;
+    }
+    return false;
+}
+
+
+
+
+// ======== Shared output messages:
+/*
+    @brief Function to create a shared output message with a copy of the data (one reference owned
+    by the caller).
+
+    @param const char * mdata: Message data.
+    @param size_t mlen: Message data length.
+
+    @retval Reference to the new message, NULL on failure.
+*/
+dmserver_cmsg_pt _dmserver_cmsg_new(const char * mdata, size_t mlen){
+    // Reference check:
+    if (!mdata || (mlen == 0)) return NULL;
+
+    // Message with inline payload:
+    dmserver_cmsg_pt m = malloc(sizeof(dmserver_cmsg_t) + mlen);
+    if (!m) return NULL;
+    m->mrefs = 1;
+    m->mkey = 0;
+    m->mtime = time(NULL);
+    m->mbudget = NULL;
+    m->mlen = mlen;
+    memcpy(m->mdata, mdata, mlen);
+    return m;
+}
+
+/*
+    @brief Function to take a reference of a shared output message.
+
+    @param dmserver_cmsg_pt m: Reference to message.
+*/
+void _dmserver_cmsg_ref(dmserver_cmsg_pt m){
+    if (m) __atomic_add_fetch(&m->mrefs, 1, __ATOMIC_RELAXED);
+}
+
+/*
+    @brief Function to release a reference of a shared output message (freed with the last one, and
+    discounted from its output memory counter).
+
+    @param dmserver_cmsg_pt m: Reference to message.
+*/
+void _dmserver_cmsg_unref(dmserver_cmsg_pt m){
+    if (!m || (__atomic_sub_fetch(&m->mrefs, 1, __ATOMIC_ACQ_REL) != 0)) return;
+    if (m->mbudget) __atomic_sub_fetch(m->mbudget, m->mlen, __ATOMIC_RELAXED);
+    free(m);
+}
+
+/*
+    @brief Function to queue a shared message to be written to the client after its write buffer.
+    @note: The client write lock must be held by the caller.
+
+    @param struct dmserver_cliconn * c: Reference to client.
+    @param dmserver_cmsg_pt m: Reference to message (a new reference is taken on success).
+
+    @retval true: Message queued.
+    @retval false: Queue full or not allocated.
+*/
+bool _dmserver_cconn_wqpush(struct dmserver_cliconn * c, dmserver_cmsg_pt m){
+    // References & capacity check:
+    if (!c || !m || !c->cwq) return false;
+    if (c->cwq_count >= c->cwq_size) return false;
+
+    // Push at the ring tail:
+    _dmserver_cmsg_ref(m);
+    c->cwq[(c->cwq_head + c->cwq_count) % c->cwq_size] = m;
+    c->cwq_count++;
+    c->cwq_bytes += m->mlen;
+    return true;
+}
+
+/*
+    @brief Function to consume written bytes from the client messages queue, releasing the messages
+    completely written.
+    @note: The client write lock must be held by the caller.
+
+    @param struct dmserver_cliconn * c: Reference to client.
+    @param size_t n: Bytes written.
+*/
+void _dmserver_cconn_wqconsume(struct dmserver_cliconn * c, size_t n){
+    // Reference check:
+    if (!c) return;
+
+    // Advance the head message offset, popping the completed ones:
+    while ((n > 0) && (c->cwq_count > 0)){
+        dmserver_cmsg_pt m = c->cwq[c->cwq_head];
+        size_t left = m->mlen - c->cwq_off;
+        if (n < left) {
+            c->cwq_off += n;
+            c->cwq_bytes -= n;
+            return;
+        }
+        n -= left;
+        c->cwq_bytes -= left;
+        _dmserver_cmsg_unref(m);
+        c->cwq[c->cwq_head] = NULL;
+        c->cwq_head = (c->cwq_head + 1) % c->cwq_size;
+        c->cwq_count--;
+        c->cwq_off = 0;
+    }
+}
+
+/*
+    @brief Function to release all the messages pending in the client messages queue.
+
+    @param struct dmserver_cliconn * c: Reference to client.
+*/
+void _dmserver_cconn_wqclear(struct dmserver_cliconn * c){
+    // Reference check:
+    if (!c || !c->cwq) return;
+
+    // Release every pending message:
+    while (c->cwq_count > 0){
+        _dmserver_cmsg_unref(c->cwq[c->cwq_head]);
+        c->cwq[c->cwq_head] = NULL;
+        c->cwq_head = (c->cwq_head + 1) % c->cwq_size;
+        c->cwq_count--;
+    }
+    c->cwq_head = 0;
+    c->cwq_off = 0;
+    c->cwq_bytes = 0;
+}
+
+/*
+    @brief Function to drop the oldest message of the client messages queue not written yet (the head
+    one is kept if it is partially written).
+    @note: The client write lock must be held by the caller.
+
+    @param struct dmserver_cliconn * c: Reference to client.
+
+    @retval true: Message dropped.
+    @retval false: No message could be dropped.
+*/
+bool _dmserver_cconn_wqdropold(struct dmserver_cliconn * c){
+    // Reference check & oldest message not started:
+    if (!c || !c->cwq) return false;
+    size_t i = (c->cwq_off > 0) ? 1 : 0;
+    if (i >= c->cwq_count) return false;
+
+    // Drop, the partially written head (if any) moved one position forward:
+    dmserver_cmsg_pt m = c->cwq[(c->cwq_head + i) % c->cwq_size];
+    if (i == 1) c->cwq[(c->cwq_head + 1) % c->cwq_size] = c->cwq[c->cwq_head];
+    c->cwq[c->cwq_head] = NULL;
+    c->cwq_head = (c->cwq_head + 1) % c->cwq_size;
+    c->cwq_count--;
+    c->cwq_bytes -= m->mlen;
+    _dmserver_cmsg_unref(m);
+    return true;
+}
+
+/*
+    @brief Function to replace the pending message of the client queue with the same coalescing key
+    (not written yet) by a newer one, keeping its position.
+    @note: The client write lock must be held by the caller.
+
+    @param struct dmserver_cliconn * c: Reference to client.
+    @param dmserver_cmsg_pt m: Reference to the new message (a new reference is taken on success).
+
+    @retval true: Message coalesced.
+    @retval false: No pending message with the same key.
+*/
+bool _dmserver_cconn_wqreplace(struct dmserver_cliconn * c, dmserver_cmsg_pt m){
+    // References check:
+    if (!c || !m || !c->cwq) return false;
+
+    // Pending message with the same key lookup (newest first, partially written head excluded):
+    size_t first = (c->cwq_off > 0) ? 1 : 0;
+    for (size_t i = c->cwq_count; i > first; i--){
+        size_t index = (c->cwq_head + i - 1) % c->cwq_size;
+        if (c->cwq[index]->mkey != m->mkey) continue;
+
+        // Replacement:
+        c->cwq_bytes = c->cwq_bytes - c->cwq[index]->mlen + m->mlen;
+        _dmserver_cmsg_unref(c->cwq[index]);
+        _dmserver_cmsg_ref(m);
+        c->cwq[index] = m;
+        return true;
+    }
+    return false;
+}
+
+// ======== Zero copy sends:
+/*
+    @brief Function to pin a shared message sent with MSG_ZEROCOPY until the kernel completes its
+    send (next send sequence number of the socket).
+    @note: The client write lock must be held by the caller, only after a send that took bytes.
+
+    @param struct dmserver_cliconn * c: Reference to client.
+    @param dmserver_cmsg_pt m: Reference to message (a new reference is taken on success).
+
+    @retval true: Message pinned.
+    @retval false: Pins ring full or not allocated (the send must not be done without copy).
+*/
+bool _dmserver_cconn_zcpin(struct dmserver_cliconn * c, dmserver_cmsg_pt m){
+    // References & capacity check:
+    if (!c || !m || !c->czc_pins) return false;
+    if (c->czc_count >= c->cwq_size) return false;
+
+    // Pin at the ring tail:
+    _dmserver_cmsg_ref(m);
+    c->czc_pins[(c->czc_head + c->czc_count) % c->cwq_size] = (struct dmserver_zcpin){.pseq=c->czc_seq++, .pmsg=m};
+    c->czc_count++;
     return true;
 }
 
+/*
+    @brief Function to release the messages of a zero copy completion notification (send sequence
+    numbers range, inclusive & wrapping).
+    @note: The client write lock must be held by the caller.
+
+    @param struct dmserver_cliconn * c: Reference to client.
+    @param uint32_t lo: First send completed.
+    @param uint32_t hi: Last send completed.
+
+    @retval Messages released.
+*/
+size_t _dmserver_cconn_zcdone(struct dmserver_cliconn * c, uint32_t lo, uint32_t hi){
+    // Reference check:
+    if (!c || !c->czc_pins) return 0;
+
+    // Pins in the range released (completions may arrive out of order):
+    size_t n = 0;
+    for (size_t i = 0; i < c->czc_count; i++){
+        struct dmserver_zcpin * p = &c->czc_pins[(c->czc_head + i) % c->cwq_size];
+        if (!p->pmsg || ((uint32_t)(p->pseq - lo) > (uint32_t)(hi - lo))) continue;
+        _dmserver_cmsg_unref(p->pmsg);
+        p->pmsg = NULL;
+        n++;
+    }
+
+    // Released pins popped from the head:
+    while ((c->czc_count > 0) && !c->czc_pins[c->czc_head].pmsg){
+        c->czc_head = (c->czc_head + 1) % c->cwq_size;
+        c->czc_count--;
+    }
+    return n;
+}
+
+/*
+    @brief Function to read the zero copy completion notifications of a client (socket error queue)
+    and release the messages pinned by the completed sends.
+    @note: The client write lock must be held by the caller.
+
+    @param struct dmserver_cliconn * c: Reference to the client.
+    @param dmserver_zerocopy_stats_pt zs: Zero copy sends counters (completed & copied sends added).
+
+    @retval Messages released.
+*/
+size_t _dmserver_cconn_zcreap(struct dmserver_cliconn * c, dmserver_zerocopy_stats_pt zs){
+    // Reference check:
+    size_t released = 0;
+    if (!c || !zs) return released;
+#ifdef SO_ZEROCOPY
+    // Notifications until the error queue is empty (a range of sends each, IPv4 or IPv6):
+    char ctrl[CMSG_SPACE(sizeof(struct sock_extended_err) + sizeof(struct sockaddr_in6))];
+    for (;;){
+        struct msghdr msg = {.msg_control=ctrl, .msg_controllen=sizeof(ctrl)};
+        if (recvmsg(c->cfd, &msg, MSG_ERRQUEUE) < 0) break;
+        for (struct cmsghdr * cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)){
+            if (!((cm->cmsg_level == SOL_IP) && (cm->cmsg_type == IP_RECVERR)) && !((cm->cmsg_level == SOL_IPV6) && (cm->cmsg_type == IPV6_RECVERR))) continue;
+            struct sock_extended_err ee;
+            memcpy(&ee, CMSG_DATA(cm), sizeof(ee));
+            if ((ee.ee_errno != 0) || (ee.ee_origin != SO_EE_ORIGIN_ZEROCOPY)) continue;
+
+            // Completed range released (sent with copy when the kernel could not avoid it):
+            size_t nsends = (uint32_t)(ee.ee_data - ee.ee_info) + 1;
+            released += _dmserver_cconn_zcdone(c, ee.ee_info, ee.ee_data);
+            __atomic_add_fetch(&zs->zcompleted, nsends, __ATOMIC_RELAXED);
+            if (ee.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) __atomic_add_fetch(&zs->zcopied, nsends, __ATOMIC_RELAXED);
+        }
+    }
+#endif
+    return released;
+}
+
+/*
+    @brief Function to release every message pinned by zero copy sends (connection closed, the kernel
+    keeps its own references to the pages in flight) & disable them until configured again.
+
+    @param struct dmserver_cliconn * c: Reference to client.
+*/
+void _dmserver_cconn_zcclear(struct dmserver_cliconn * c){
+    // Reference check:
+    if (!c || !c->czc_pins) return;
+
+    // Release every pinned message:
+    while (c->czc_count > 0){
+        struct dmserver_zcpin * p = &c->czc_pins[c->czc_head];
+        if (p->pmsg) _dmserver_cmsg_unref(p->pmsg);
+        p->pmsg = NULL;
+        c->czc_head = (c->czc_head + 1) % c->cwq_size;
+        c->czc_count--;
+    }
+    c->czc_head = 0;
+    c->czc_seq = 0;
+    c->czc_min = 0;
+}
+
+// ======== Ancillary data:
+/*
+    @brief Function to read from a unix domain client together with the file descriptors
+    passed (SCM_RIGHTS), stored in the client received file descriptors.
+
+    @param struct dmserver_cliconn * c: Reference to the client to read.
+
+    @retval Bytes read (same semantics as read, errno preserved).
+*/
+int _dmserver_cconn_recvfds(struct dmserver_cliconn * c){
+    // Control buffer sized to the free received file descriptors slots (the rest are discarded):
+    char ctrl[CMSG_SPACE(sizeof(int) * DEFAULT_CCONN_MAXFDS)];
+    size_t nfree = DEFAULT_CCONN_MAXFDS - c->crfdslen;
+    struct iovec iov = {.iov_base=c->crbuffer, .iov_len=c->crbuffer_size - 1};
+    struct msghdr msg = {
+        .msg_iov = &iov,
+        .msg_iovlen = 1,
+        .msg_control = (nfree > 0) ? ctrl : NULL,
+        .msg_controllen = (nfree > 0) ? CMSG_SPACE(sizeof(int) * nfree) : 0
+    };
+
+    // Read & received file descriptors:
+    int rb = recvmsg(c->cfd, &msg, MSG_CMSG_CLOEXEC);
+    if (rb <= 0) return rb;
+    for (struct cmsghdr * cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)){
+        if ((cm->cmsg_level != SOL_SOCKET) || (cm->cmsg_type != SCM_RIGHTS)) continue;
+        size_t nfds = (cm->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        if (nfds > DEFAULT_CCONN_MAXFDS - c->crfdslen) nfds = DEFAULT_CCONN_MAXFDS - c->crfdslen;
+        memcpy(&c->crfds[c->crfdslen], CMSG_DATA(cm), nfds * sizeof(int));
+        c->crfdslen += nfds;
+    }
+    return rb;
+}
+
+/*
+    @brief Function to read from a client together with the kernel receive timestamp of
+    the data (SO_TIMESTAMPING software one), stored in the client read timestamp.
+
+    @param struct dmserver_cliconn * c: Reference to the client to read.
+
+    @retval Bytes read (same semantics as read, errno preserved).
+*/
+int _dmserver_cconn_recvts(struct dmserver_cliconn * c){
+    char ctrl[CMSG_SPACE(3 * sizeof(struct timespec))];
+    struct iovec iov = {.iov_base=c->crbuffer, .iov_len=c->crbuffer_size - 1};
+    struct msghdr msg = {
+        .msg_iov = &iov,
+        .msg_iovlen = 1,
+        .msg_control = ctrl,
+        .msg_controllen = sizeof(ctrl)
+    };
+
+    // Read & timestamp (software one, first of the three; the latest segment read for streams):
+    int rb = recvmsg(c->cfd, &msg, 0);
+    if (rb <= 0) return rb;
+    c->crts = (struct timespec){0};
+    for (struct cmsghdr * cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)){
+        if ((cm->cmsg_level == SOL_SOCKET) && (cm->cmsg_type == SCM_TIMESTAMPING)) memcpy(&c->crts, CMSG_DATA(cm), sizeof(struct timespec));
+    }
+    return rb;
+}
+
+/*
+    @brief Function to write to a unix domain client together with the file descriptors
+    pending to send (SCM_RIGHTS, attached to the first byte written), closed once sent.
+
+    @param struct dmserver_cliconn * c: Reference to the client to write.
+
+    @retval Bytes written (same semantics as write, errno preserved on failure).
+*/
+int _dmserver_cconn_sendfds(struct dmserver_cliconn * c){
+    // Control message with the pending file descriptors:
+    char ctrl[CMSG_SPACE(sizeof(int) * DEFAULT_CCONN_MAXFDS)];
+    memset(ctrl, 0, sizeof(ctrl));
+    struct iovec iov = {.iov_base=c->cwbuffer, .iov_len=c->cwlen};
+    struct msghdr msg = {
+        .msg_iov = &iov,
+        .msg_iovlen = 1,
+        .msg_control = ctrl,
+        .msg_controllen = CMSG_SPACE(sizeof(int) * c->cwfdslen)
+    };
+    struct cmsghdr * cm = CMSG_FIRSTHDR(&msg);
+    cm->cmsg_level = SOL_SOCKET;
+    cm->cmsg_type = SCM_RIGHTS;
+    cm->cmsg_len = CMSG_LEN(sizeof(int) * c->cwfdslen);
+    memcpy(CMSG_DATA(cm), c->cwfds, sizeof(int) * c->cwfdslen);
+
+    // Write & local copies closed once in flight:
+    int wb = sendmsg(c->cfd, &msg, MSG_NOSIGNAL);
+    if (wb > 0) _dmserver_cconn_closefds(c, false, true);
+    return wb;
+}
+
+/*
+    @brief Function to account the receive latency of the data in the read buffer of a
+    client (kernel receive timestamp to now, right before its reception callback) in a histogram
+    (bucket i up to 2^i usec, the last one the rest; relaxed). Reads without timestamp are not
+    accounted.
+
+    @param struct dmserver_cliconn * c: Reference to the client about to be delivered.
+    @param size_t * hist: Histogram buckets.
+    @param size_t nbuckets: Number of buckets (not 0).
+*/
+void _dmserver_cconn_rxlat(struct dmserver_cliconn * c, size_t * hist, size_t nbuckets){
+    // Reference & timestamp check:
+    if (!c || !hist || !nbuckets || (!c->crts.tv_sec && !c->crts.tv_nsec)) return;
+
+    // Latency in usec (kernel timestamps on the realtime clock, clock steps clamped to 0):
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    long usec = (now.tv_sec - c->crts.tv_sec) * 1000000L + (now.tv_nsec - c->crts.tv_nsec) / 1000;
+    if (usec < 0) usec = 0;
+
+    // Power of two bucket:
+    size_t b = 0;
+    while ((b < nbuckets - 1) && (usec >= (1L << b))) b++;
+    __atomic_add_fetch(&hist[b], 1, __ATOMIC_RELAXED);
+}
+
+// ======== Arena:
+/*
+    @brief Function to allocate memory from the client arena (bumped from the arena block, or from a
+    heap chunk once the block is exhausted), valid until the client slot is reset.
+    @note: Only the client subthread (its callbacks) should use the arena of a client.
+
+    @param dmserver_cliconn_pt c: Reference to client.
+    @param size_t len: Bytes to allocate.
+
+    @retval Reference to the memory (DEFAULT_CCONN_ARENAALIGN aligned), NULL without arena or on failure.
+*/
+void * _dmserver_cconn_arena_alloc(dmserver_cliconn_pt c, size_t len){
+    // References check:
+    if (!c || !c->carena.ablock || (len == 0)) return NULL;
+    dmserver_arena_t * a = &c->carena;
+    size_t alen = (len + DEFAULT_CCONN_ARENAALIGN - 1) & ~(size_t)(DEFAULT_CCONN_ARENAALIGN - 1);
+    if (alen < len) return NULL;
+
+    // Arena block:
+    if (a->asize - a->aused >= alen) {
+        void * p = a->ablock + a->aused;
+        a->aused += alen;
+        return p;
+    }
+
+    // Last heap chunk, or a new one (block length at least):
+    struct dmserver_arenachunk * ch = a->achunks;
+    if (!ch || (ch->csize - ch->cused < alen)) {
+        size_t csize = (alen > a->asize) ? alen : a->asize;
+        ch = malloc(sizeof(struct dmserver_arenachunk) + csize);
+        if (!ch) return NULL;
+        ch->csize = csize;
+        ch->cused = 0;
+        ch->cnext = a->achunks;
+        a->achunks = ch;
+    }
+    void * p = ch->cdata + ch->cused;
+    ch->cused += alen;
+    return p;
+}
+
+/*
+    @brief Function to reset the client arena: every allocation released at once (heap chunks freed).
+
+    @param dmserver_cliconn_pt c: Reference to client.
+*/
+void _dmserver_cconn_arena_reset(dmserver_cliconn_pt c){
+    // References check:
+    if (!c) return;
+
+    while (c->carena.achunks){
+        struct dmserver_arenachunk * ch = c->carena.achunks;
+        c->carena.achunks = ch->cnext;
+        free(ch);
+    }
+    c->carena.aused = 0;
+}
+
+
+
+
 // ======== Configuration:
 /*
     @brief Function to allocate the buffers memory of the client.
@@ -211,6 +858,27 @@ bool __dmserver_cconn_buf_alloc(dmserver_cliconn_pt c){
         __dmserver_cconn_buf_dealloc(c);
         return false;
     }
+
+    c->cwq = calloc(c->cwq_size, sizeof(dmserver_cmsg_pt));
+    if (!c->cwq) {
+        __dmserver_cconn_buf_dealloc(c);
+        return false;
+    }
+
+    c->czc_pins = calloc(c->cwq_size, sizeof(struct dmserver_zcpin));
+    if (!c->czc_pins) {
+        __dmserver_cconn_buf_dealloc(c);
+        return false;
+    }
+
+    // Arena block (only if configured):
+    if (c->carena.asize) {
+        c->carena.ablock = aligned_alloc(DEFAULT_CCONN_ARENAALIGN, (c->carena.asize + DEFAULT_CCONN_ARENAALIGN - 1) & ~(size_t)(DEFAULT_CCONN_ARENAALIGN - 1));
+        if (!c->carena.ablock) {
+            __dmserver_cconn_buf_dealloc(c);
+            return false;
+        }
+    }
     return true;
 }
 
@@ -229,6 +897,19 @@ bool __dmserver_cconn_buf_dealloc(dmserver_cliconn_pt c){
     // Deallocate buffers memory (if previously allocated):
     if (c->crbuffer) free(c->crbuffer);
     if (c->cwbuffer) free(c->cwbuffer);
+    if (c->cwq) {
+        _dmserver_cconn_wqclear(c);
+        free(c->cwq);
+        c->cwq = NULL;
+    }
+    if (c->czc_pins) {
+        _dmserver_cconn_zcclear(c);
+        free(c->czc_pins);
+        c->czc_pins = NULL;
+    }
+    _dmserver_cconn_arena_reset(c);
+    if (c->carena.ablock) free(c->carena.ablock);
+    c->carena.ablock = NULL;
     return true;
 }
 
@@ -240,6 +921,8 @@ bool __dmserver_cconn_buf_dealloc(dmserver_cliconn_pt c){
 void __dmserver_cconn_set_defaults(dmserver_cliconn_pt c){
     c->crbuffer_size = DEFAULT_CCONN_RBUFFERLEN;
     c->cwbuffer_size = DEFAULT_CCONN_WBUFFERLEN;
+    c->cwq_size = DEFAULT_CCONN_WQUEUELEN;
+    c->carena.asize = DEFAULT_CCONN_ARENALEN;
 }
 
 /*
@@ -262,4 +945,49 @@ void __dmserver_cconn_set_creadbuffer(dmserver_cliconn_pt c, size_t crbuf_size){
 */
 void __dmserver_cconn_set_cwritebuffer(dmserver_cliconn_pt c, size_t cwbuf_size){
     c->cwbuffer_size = cwbuf_size;
+}
+
+/*
+    @brief Function to set the capacity of the client shared messages queue.
+    @note: Allocation must be done to these changes take effect (deallocate before a new
+    allocation to avoid memory leaks).
+    
+    @param dmserver_cliconn_pt c: Reference to client structure.
+*/
+void __dmserver_cconn_set_cwritequeue(dmserver_cliconn_pt c, size_t cwqueue_size){
+    c->cwq_size = cwqueue_size;
+}
+
+/*
+    @brief Function to set the length of the client arena block (0 no arena).
+    @note: Allocation must be done to these changes take effect (deallocate before a new
+    allocation to avoid memory leaks).
+    
+    @param dmserver_cliconn_pt c: Reference to client structure.
+*/
+void __dmserver_cconn_set_carena(dmserver_cliconn_pt c, size_t carena_size){
+    c->carena.asize = carena_size;
+}
+
+
+
+
+/* ---- STATIC INTERNAL - Helper functions implementation --------- */
+/*
+    @brief Helper function that opens a rewrite of the client identity (sequence odd, readers retry).
+
+    @param dmserver_cliconn_pt c: Reference to client.
+*/
+static void _dmserver_cconn_helper_seqbegin(dmserver_cliconn_pt c){
+    __atomic_add_fetch(&c->cseq, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+/*
+    @brief Helper function that closes a rewrite of the client identity (sequence even again).
+
+    @param dmserver_cliconn_pt c: Reference to client.
+*/
+static void _dmserver_cconn_helper_seqend(dmserver_cliconn_pt c){
+    __atomic_add_fetch(&c->cseq, 1, __ATOMIC_RELEASE);
 }
\ No newline at end of file
@@ -0,0 +1,490 @@
+/*
+
+*/
+
+/* ---- Library --------------------------------------------------- */
+#include "../inc/_dmserver_dgram.h"
+#include <netinet/udp.h>
+
+/* ---- Helper functions implementation prototypes ---------------- */
+static void _dmserver_dgram_helper_key(struct dmserver_dgram_key * k, const struct sockaddr_storage * addr);
+static void _dmserver_dgram_helper_clikey(struct dmserver_dgram_key * k, dmserver_cliconn_pt c);
+static size_t _dmserver_dgram_helper_hash(const struct dmserver_dgram_key * k, size_t size);
+
+
+
+
+/* ---- INTERNAL - Functions implementation ----------------------- */
+// ======== General use:
+/*
+    @brief Function to initialize the datagram transport of a subordinate thread (batch buffers and
+    sessions table).
+    @note: The socket file descriptor is not owned by this structure (not closed at deinit).
+
+    @param dmserver_dgram_pt d: Reference to datagram structure.
+    @param int dfd: Datagram socket file descriptor of the subthread.
+    @param size_t dslots: Number of client slots of the subthread (sessions capacity).
+
+    @retval true: Initialization succeeded.
+    @retval false: Initialization failed.
+*/
+bool _dmserver_dgram_init(dmserver_dgram_pt d, int dfd, size_t dslots){
+    // Reference check:
+    if (!d || (dfd < 0) || (dslots == 0)) return false;
+    memset(d, 0, sizeof(dmserver_dgram_t));
+    d->devsrc.etype = DMSERVER_EVSRC_DGRAM;
+    d->dfd = dfd;
+
+    // Socket family (v4 peers are addressed as v4-mapped on AF_INET6 sockets):
+    struct sockaddr_storage daddr;
+    socklen_t daddrlen = sizeof(daddr);
+    if (getsockname(dfd, (struct sockaddr *)&daddr, &daddrlen) < 0) return false;
+    d->dfamily = daddr.ss_family;
+
+    // Sessions table (power of two, at least twice the slots to keep probing short):
+    d->dsessions_size = 1;
+    while (d->dsessions_size < 2 * dslots) d->dsessions_size <<= 1;
+    d->dsessions = calloc(d->dsessions_size, sizeof(dmserver_cliconn_pt));
+    if (!d->dsessions) return false;
+    if (pthread_mutex_init(&d->dsessions_lock, NULL)) {
+        free(d->dsessions);
+        d->dsessions = NULL;
+        return false;
+    }
+
+    // Receive and send batches:
+    d->drmsgs = calloc(DEFAULT_DGRAM_BATCH, sizeof(struct mmsghdr));
+    d->driovs = calloc(DEFAULT_DGRAM_BATCH, sizeof(struct iovec));
+    d->draddrs = calloc(DEFAULT_DGRAM_BATCH, sizeof(struct sockaddr_storage));
+    d->drbufs = calloc(DEFAULT_DGRAM_BATCH, DEFAULT_DGRAM_BUFFERLEN);
+    d->drctrls = calloc(DEFAULT_DGRAM_BATCH, DEFAULT_DGRAM_CTRLLEN);
+    d->dsmsgs = calloc(DEFAULT_DGRAM_BATCH, sizeof(struct mmsghdr));
+    d->dsiovs = calloc(DEFAULT_DGRAM_BATCH, sizeof(struct iovec));
+    d->dsaddrs = calloc(DEFAULT_DGRAM_BATCH, sizeof(struct sockaddr_in6));
+    d->dsbufs = calloc(DEFAULT_DGRAM_BATCH, DEFAULT_DGRAM_BUFFERLEN);
+    d->dsclis = calloc(DEFAULT_DGRAM_BATCH, sizeof(dmserver_cliconn_pt));
+    if (!d->drmsgs || !d->driovs || !d->draddrs || !d->drbufs || !d->drctrls || !d->dsmsgs || !d->dsiovs || !d->dsaddrs || !d->dsbufs || !d->dsclis){
+        _dmserver_dgram_deinit(d);
+        return false;
+    }
+
+    // Receive coalesced datagrams (UDP GRO) when available:
+#ifdef UDP_GRO
+    int sopt = true;
+    setsockopt(d->dfd, IPPROTO_UDP, UDP_GRO, &sopt, sizeof(sopt));
+#endif
+
+    return true;
+}
+
+/*
+    @brief Function to deinitialize the datagram transport of a subordinate thread.
+
+    @param dmserver_dgram_pt d: Reference to datagram structure.
+
+    @retval true: Deinitialization succeeded.
+    @retval false: Deinitialization failed.
+*/
+bool _dmserver_dgram_deinit(dmserver_dgram_pt d){
+    // Reference check:
+    if (!d) return false;
+
+    // Sessions table:
+    if (d->dsessions) {
+        free(d->dsessions);
+        pthread_mutex_destroy(&d->dsessions_lock);
+    }
+
+    // Receive and send batches:
+    if (d->drmsgs) free(d->drmsgs);
+    if (d->driovs) free(d->driovs);
+    if (d->draddrs) free(d->draddrs);
+    if (d->drbufs) free(d->drbufs);
+    if (d->drctrls) free(d->drctrls);
+    if (d->dsmsgs) free(d->dsmsgs);
+    if (d->dsiovs) free(d->dsiovs);
+    if (d->dsaddrs) free(d->dsaddrs);
+    if (d->dsbufs) free(d->dsbufs);
+    if (d->dsclis) free(d->dsclis);
+
+    memset(d, 0, sizeof(dmserver_dgram_t));
+    d->dfd = -1;
+    return true;
+}
+
+/*
+    @brief Function to receive a batch of datagrams (one recvmmsg call).
+
+    @param dmserver_dgram_pt d: Reference to datagram structure.
+
+    @retval >0: Number of datagrams received (access them with _dmserver_dgram_msg).
+    @retval 0/-1: No datagrams pending (EAGAIN) or receive error.
+*/
+int _dmserver_dgram_recv(dmserver_dgram_pt d){
+    // Reference check:
+    if (!d || (d->dfd < 0)) return -1;
+
+    // Batch reset (lengths are overwritten by the kernel on each call):
+    for (size_t i = 0; i < DEFAULT_DGRAM_BATCH; i++){
+        d->driovs[i].iov_base = d->drbufs + (i * DEFAULT_DGRAM_BUFFERLEN);
+        d->driovs[i].iov_len = DEFAULT_DGRAM_BUFFERLEN;
+        d->drmsgs[i].msg_hdr = (struct msghdr){
+            .msg_name = &d->draddrs[i],
+            .msg_namelen = sizeof(struct sockaddr_storage),
+            .msg_iov = &d->driovs[i],
+            .msg_iovlen = 1,
+            .msg_control = d->drctrls + (i * DEFAULT_DGRAM_CTRLLEN),
+            .msg_controllen = DEFAULT_DGRAM_CTRLLEN
+        };
+        d->drmsgs[i].msg_len = 0;
+    }
+
+    // Batch receive:
+    return recvmmsg(d->dfd, d->drmsgs, DEFAULT_DGRAM_BATCH, MSG_DONTWAIT, NULL);
+}
+
+/*
+    @brief Function to access a received datagram of the last batch.
+    @note: With UDP GRO a single entry may carry several datagrams of msegsize bytes each (the last
+    one may be shorter), the caller must split the data.
+
+    @param dmserver_dgram_pt d: Reference to datagram structure.
+    @param int index: Datagram index in the last batch.
+    @param struct sockaddr_storage ** maddr: Output reference to the peer address.
+    @param char ** mdata: Output reference to the datagram data.
+    @param size_t * mlen: Output datagram data length.
+    @param size_t * msegsize: Output segment size (equal to mlen when not coalesced).
+    @param struct timespec * mts: Output kernel receive timestamp (zero without receive timestamps).
+
+    @retval true: Datagram available.
+    @retval false: Invalid index or references.
+*/
+bool _dmserver_dgram_msg(dmserver_dgram_pt d, int index, struct sockaddr_storage ** maddr, char ** mdata, size_t * mlen, size_t * msegsize, struct timespec * mts){
+    // References check:
+    if (!d || (index < 0) || (index >= DEFAULT_DGRAM_BATCH) || !maddr || !mdata || !mlen || !msegsize || !mts) return false;
+
+    // Datagram data:
+    struct mmsghdr * m = &d->drmsgs[index];
+    *maddr = &d->draddrs[index];
+    *mdata = d->driovs[index].iov_base;
+    *mlen = m->msg_len;
+    *msegsize = m->msg_len;
+    *mts = (struct timespec){0};
+
+    // Coalesced datagrams segment size & kernel receive timestamp (software one, first of the three):
+    for (struct cmsghdr * cm = CMSG_FIRSTHDR(&m->msg_hdr); cm; cm = CMSG_NXTHDR(&m->msg_hdr, cm)){
+#ifdef UDP_GRO
+        if ((cm->cmsg_level == IPPROTO_UDP) && (cm->cmsg_type == UDP_GRO)) {
+            int gso_size = 0;
+            memcpy(&gso_size, CMSG_DATA(cm), sizeof(gso_size));
+            if (gso_size > 0) *msegsize = gso_size;
+        }
+#endif
+        if ((cm->cmsg_level == SOL_SOCKET) && (cm->cmsg_type == SCM_TIMESTAMPING)) memcpy(mts, CMSG_DATA(cm), sizeof(struct timespec));
+    }
+    return true;
+}
+
+
+
+
+// ======== Sessions table:
+/*
+    @brief Function to find the session (client slot) of a peer address.
+
+    @param dmserver_dgram_pt d: Reference to datagram structure.
+    @param struct sockaddr_storage * addr: Peer address.
+
+    @retval dmserver_cliconn_pt: Client slot of the peer session.
+    @retval NULL: No session for the peer.
+*/
+dmserver_cliconn_pt _dmserver_dgram_lookup(dmserver_dgram_pt d, struct sockaddr_storage * addr){
+    // References check:
+    if (!d || !addr || !d->dsessions) return NULL;
+
+    // Linear probing until an empty bucket:
+    struct dmserver_dgram_key k, ck;
+    _dmserver_dgram_helper_key(&k, addr);
+    dmserver_cliconn_pt c = NULL;
+
+    pthread_mutex_lock(&d->dsessions_lock);
+    for (size_t i = _dmserver_dgram_helper_hash(&k, d->dsessions_size), n = 0; n < d->dsessions_size; i = (i + 1) & (d->dsessions_size - 1), n++){
+        if (!d->dsessions[i]) break;
+        _dmserver_dgram_helper_clikey(&ck, d->dsessions[i]);
+        if (!memcmp(&k, &ck, sizeof(k))) {
+            c = d->dsessions[i];
+            break;
+        }
+    }
+    pthread_mutex_unlock(&d->dsessions_lock);
+
+    return c;
+}
+
+/*
+    @brief Function to insert a session (client slot with the peer address already set).
+
+    @param dmserver_dgram_pt d: Reference to datagram structure.
+    @param dmserver_cliconn_pt c: Client slot of the new session.
+
+    @retval true: Insertion succeeded.
+    @retval false: Insertion failed (table full).
+*/
+bool _dmserver_dgram_insert(dmserver_dgram_pt d, dmserver_cliconn_pt c){
+    // References check:
+    if (!d || !c || !d->dsessions) return false;
+
+    // First empty bucket from the hash position:
+    struct dmserver_dgram_key k;
+    _dmserver_dgram_helper_clikey(&k, c);
+    bool ok = false;
+
+    pthread_mutex_lock(&d->dsessions_lock);
+    for (size_t i = _dmserver_dgram_helper_hash(&k, d->dsessions_size), n = 0; n < d->dsessions_size; i = (i + 1) & (d->dsessions_size - 1), n++){
+        if (d->dsessions[i] && (d->dsessions[i] != c)) continue;
+        d->dsessions[i] = c;
+        ok = true;
+        break;
+    }
+    pthread_mutex_unlock(&d->dsessions_lock);
+
+    return ok;
+}
+
+/*
+    @brief Function to remove a session from the table (backward shift deletion, no tombstones).
+    @note: Must be called before the client slot address is reset.
+
+    @param dmserver_dgram_pt d: Reference to datagram structure.
+    @param dmserver_cliconn_pt c: Client slot of the session.
+
+    @retval true: Removal succeeded.
+    @retval false: Session not found.
+*/
+bool _dmserver_dgram_remove(dmserver_dgram_pt d, dmserver_cliconn_pt c){
+    // References check:
+    if (!d || !c || !d->dsessions) return false;
+    size_t mask = d->dsessions_size - 1;
+    struct dmserver_dgram_key k;
+    bool ok = false;
+
+    pthread_mutex_lock(&d->dsessions_lock);
+
+    // Find the session bucket:
+    _dmserver_dgram_helper_clikey(&k, c);
+    size_t i = _dmserver_dgram_helper_hash(&k, d->dsessions_size);
+    for (size_t n = 0; n < d->dsessions_size; i = (i + 1) & mask, n++){
+        if (!d->dsessions[i]) break;
+        if (d->dsessions[i] == c) {
+            ok = true;
+            break;
+        }
+    }
+
+    // Backward shift of the following entries of the cluster:
+    if (ok) {
+        d->dsessions[i] = NULL;
+        for (size_t j = (i + 1) & mask; d->dsessions[j]; j = (j + 1) & mask){
+            _dmserver_dgram_helper_clikey(&k, d->dsessions[j]);
+            size_t h = _dmserver_dgram_helper_hash(&k, d->dsessions_size);
+            if (((j - h) & mask) >= ((j - i) & mask)) {
+                d->dsessions[i] = d->dsessions[j];
+                d->dsessions[j] = NULL;
+                i = j;
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&d->dsessions_lock);
+    return ok;
+}
+
+
+
+
+// ======== Send batch:
+/*
+    @brief Function to add a datagram to a session to the send batch (payload copied to the batch,
+    truncated to the batch buffer length).
+
+    @param dmserver_dgram_pt d: Reference to datagram structure.
+    @param dmserver_cliconn_pt c: Client slot of the session.
+    @param const char * data: Datagram payload.
+    @param size_t len: Datagram payload length.
+
+    @retval true: Datagram queued.
+    @retval false: Batch full (flush before queueing again).
+*/
+bool _dmserver_dgram_sendq(dmserver_dgram_pt d, dmserver_cliconn_pt c, const char * data, size_t len){
+    // References & capacity check:
+    if (!d || !c || !data) return false;
+    if (d->dscount >= DEFAULT_DGRAM_BATCH) return false;
+
+    // Peer address (v4 peers as v4-mapped on AF_INET6 sockets):
+    size_t i = d->dscount++;
+    socklen_t addrlen = sizeof(struct sockaddr_in6);
+    memset(&d->dsaddrs[i], 0, sizeof(struct sockaddr_in6));
+    if ((c->caddr_family == AF_INET) && (d->dfamily == AF_INET6)){
+        d->dsaddrs[i].sin6_family = AF_INET6;
+        d->dsaddrs[i].sin6_port = c->caddr.c4.sin_port;
+        d->dsaddrs[i].sin6_addr.s6_addr[10] = 0xff;
+        d->dsaddrs[i].sin6_addr.s6_addr[11] = 0xff;
+        memcpy(&d->dsaddrs[i].sin6_addr.s6_addr[12], &c->caddr.c4.sin_addr, 4);
+    } else if (c->caddr_family == AF_INET){
+        memcpy(&d->dsaddrs[i], &c->caddr.c4, sizeof(struct sockaddr_in));
+        addrlen = sizeof(struct sockaddr_in);
+    } else {
+        memcpy(&d->dsaddrs[i], &c->caddr.c6, sizeof(struct sockaddr_in6));
+    }
+
+    // Datagram entry (peer address and payload copy):
+    if (len > DEFAULT_DGRAM_BUFFERLEN) len = DEFAULT_DGRAM_BUFFERLEN;
+    d->dsiovs[i].iov_base = d->dsbufs + (i * DEFAULT_DGRAM_BUFFERLEN);
+    d->dsiovs[i].iov_len = len;
+    memcpy(d->dsiovs[i].iov_base, data, len);
+    d->dsmsgs[i].msg_hdr = (struct msghdr){
+        .msg_name = &d->dsaddrs[i],
+        .msg_namelen = addrlen,
+        .msg_iov = &d->dsiovs[i],
+        .msg_iovlen = 1
+    };
+    d->dsmsgs[i].msg_len = 0;
+    d->dsclis[i] = c;
+    return true;
+}
+
+/*
+    @brief Function to add the pending data of a session to the send batch, the write buffer and every
+    queued message as a datagram each (truncated to the client write buffer length).
+    @note: The client write lock is taken & released here (the send callbacks may write again).
+
+    @param dmserver_dgram_pt d: Reference to datagram structure.
+    @param dmserver_cliconn_pt c: Client slot of the session.
+
+    @retval true: Pending data queued (or nothing pending).
+    @retval false: Batch full (flush & add the rest again).
+*/
+bool _dmserver_dgram_sendcli(dmserver_dgram_pt d, dmserver_cliconn_pt c){
+    // References check:
+    if (!d || !c) return true;
+    size_t maxlen = c->cwbuffer_size - 1;
+
+    // Write lock of client:
+    pthread_mutex_lock(&c->cwlock);
+    while ((c->cwlen > 0) || (c->cwq_count > 0)){
+        // Next datagram, the write buffer first:
+        const char * data = c->cwbuffer;
+        size_t len = c->cwlen;
+        if (len == 0) {
+            dmserver_cmsg_pt m = c->cwq[c->cwq_head];
+            data = m->mdata + c->cwq_off;
+            len = m->mlen - c->cwq_off;
+        }
+
+        // Queue into the send batch:
+        if (!_dmserver_dgram_sendq(d, c, data, (len < maxlen) ? len : maxlen)) {
+            pthread_mutex_unlock(&c->cwlock);
+            return false;
+        }
+
+        // Datagram taken from the write buffer or the queue:
+        if (c->cwlen > 0) {
+            memset(c->cwbuffer, 0, c->cwlen);
+            c->cwlen = 0;
+        } else _dmserver_cconn_wqconsume(c, len);
+    }
+    pthread_mutex_unlock(&c->cwlock);
+    return true;
+}
+
+/*
+    @brief Function to send the whole send batch (sendmmsg calls until sent or error).
+    @note: The batch is emptied in any case (datagrams not sent are dropped).
+
+    @param dmserver_dgram_pt d: Reference to datagram structure.
+
+    @retval Number of datagrams sent (from the batch start).
+*/
+int _dmserver_dgram_sendflush(dmserver_dgram_pt d){
+    // Reference check:
+    if (!d || (d->dscount == 0)) return 0;
+
+    // Batch send:
+    int sent = 0;
+    while ((size_t)sent < d->dscount){
+        int r = sendmmsg(d->dfd, d->dsmsgs + sent, d->dscount - sent, MSG_DONTWAIT);
+        if (r <= 0) {
+            if ((r < 0) && (errno == EINTR)) continue;
+            break;
+        }
+        sent += r;
+    }
+    d->dscount = 0;
+    return sent;
+}
+
+
+
+
+/* ---- STATIC INTERNAL - Helper functions implementation --------- */
+/*
+    @brief Helper function to build the normalized key of a peer address.
+
+    @param struct dmserver_dgram_key * k: Output key.
+    @param const struct sockaddr_storage * addr: Peer address.
+*/
+static void _dmserver_dgram_helper_key(struct dmserver_dgram_key * k, const struct sockaddr_storage * addr){
+    memset(k, 0, sizeof(struct dmserver_dgram_key));
+    if (addr->ss_family == AF_INET){
+        const struct sockaddr_in * a4 = (const struct sockaddr_in *)addr;
+        k->kfamily = AF_INET;
+        k->kport = a4->sin_port;
+        memcpy(k->kaddr, &a4->sin_addr, 4);
+    } else if (addr->ss_family == AF_INET6){
+        const struct sockaddr_in6 * a6 = (const struct sockaddr_in6 *)addr;
+        k->kport = a6->sin6_port;
+        if (IN6_IS_ADDR_V4MAPPED(&a6->sin6_addr)) {
+            k->kfamily = AF_INET;
+            memcpy(k->kaddr, &a6->sin6_addr.s6_addr[12], 4);
+        } else {
+            k->kfamily = AF_INET6;
+            memcpy(k->kaddr, &a6->sin6_addr, 16);
+        }
+    }
+}
+
+/*
+    @brief Helper function to build the normalized key of a session client slot.
+
+    @param struct dmserver_dgram_key * k: Output key.
+    @param dmserver_cliconn_pt c: Client slot.
+*/
+static void _dmserver_dgram_helper_clikey(struct dmserver_dgram_key * k, dmserver_cliconn_pt c){
+    memset(k, 0, sizeof(struct dmserver_dgram_key));
+    k->kfamily = c->caddr_family;
+    if (c->caddr_family == AF_INET){
+        k->kport = c->caddr.c4.sin_port;
+        memcpy(k->kaddr, &c->caddr.c4.sin_addr, 4);
+    } else if (c->caddr_family == AF_INET6){
+        k->kport = c->caddr.c6.sin6_port;
+        memcpy(k->kaddr, &c->caddr.c6.sin6_addr, 16);
+    }
+}
+
+/*
+    @brief Helper function to hash a peer key (FNV-1a) into a table position.
+
+    @param const struct dmserver_dgram_key * k: Peer key.
+    @param size_t size: Table size (power of two).
+
+    @retval Table position.
+*/
+static size_t _dmserver_dgram_helper_hash(const struct dmserver_dgram_key * k, size_t size){
+    const uint8_t * b = (const uint8_t *)k;
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t i = 0; i < sizeof(struct dmserver_dgram_key); i++){
+        h ^= b[i];
+        h *= 1099511628211ULL;
+    }
+    return (size_t)(h & (size - 1));
+}
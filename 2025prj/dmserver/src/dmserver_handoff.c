@@ -0,0 +1,181 @@
+/*
+
+*/
+
+/* ---- Library --------------------------------------------------- */
+#include "../inc/_dmserver_handoff.h"
+#include <poll.h>
+
+/* ---- Helper functions implementation prototypes ---------------- */
+static bool _dmserver_handoff_helper_addr(const char * path, struct sockaddr_un * addr);
+static long _dmserver_handoff_helper_nowms(void);
+
+
+
+
+/* ---- INTERNAL - Functions implementation ----------------------- */
+// ======== Send / Receive:
+/*
+    @brief Function to hand the listening sockets off to the next process: listen on a unix domain
+    socket path, wait for the next process to connect, send the sockets and wait for its
+    acknowledgement. The sockets stay open here (the next process holds its own references).
+
+    @param const char * path: Unix domain socket path (created & removed here).
+    @param const int * fds: Listening sockets.
+    @param size_t nfds: Number of listening sockets.
+    @param size_t wait_ms: Maximum time waiting for the next process (connection & acknowledgement).
+
+    @retval true: Sockets received by the next process.
+    @retval false: Invalid arguments, timeout or transfer failed.
+*/
+bool _dmserver_handoff_send(const char * path, const int * fds, size_t nfds, size_t wait_ms){
+    // References check:
+    struct sockaddr_un addr;
+    if (!fds || !nfds || (nfds > DEFAULT_HANDOFF_MAXFDS) || !_dmserver_handoff_helper_addr(path, &addr)) return false;
+
+    // Handoff socket (stale file of a previous handoff removed):
+    int hfd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (hfd < 0) return false;
+    unlink(path);
+    if ((bind(hfd, (struct sockaddr *)&addr, sizeof(addr)) < 0) || (listen(hfd, 1) < 0)) {
+        close(hfd);
+        unlink(path);
+        return false;
+    }
+
+    // Next process connection:
+    long deadline = _dmserver_handoff_helper_nowms() + (long)wait_ms;
+    struct pollfd pfd = {.fd=hfd, .events=POLLIN};
+    int cfd = -1;
+    if (poll(&pfd, 1, (int)wait_ms) == 1) cfd = accept4(hfd, NULL, NULL, SOCK_CLOEXEC);
+    close(hfd);
+    unlink(path);
+    if (cfd < 0) return false;
+
+    // Header & sockets (SCM_RIGHTS):
+    dmserver_handoff_hdr_t hdr = {.hmagic=DEFAULT_HANDOFF_MAGIC, .hnfds=(uint32_t)nfds};
+    union{
+        char buf[CMSG_SPACE(sizeof(int) * DEFAULT_HANDOFF_MAXFDS)];
+        struct cmsghdr align;
+    }cbuf;
+    memset(&cbuf, 0, sizeof(cbuf));
+    struct iovec iov = {.iov_base=&hdr, .iov_len=sizeof(hdr)};
+    struct msghdr msg = {.msg_iov=&iov, .msg_iovlen=1, .msg_control=cbuf.buf, .msg_controllen=CMSG_SPACE(sizeof(int) * nfds)};
+    struct cmsghdr * cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * nfds);
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * nfds);
+    if (sendmsg(cfd, &msg, MSG_NOSIGNAL) != (ssize_t)sizeof(hdr)) {
+        close(cfd);
+        return false;
+    }
+
+    // Acknowledgement (the next process holds the sockets):
+    long left = deadline - _dmserver_handoff_helper_nowms();
+    pfd = (struct pollfd){.fd=cfd, .events=POLLIN};
+    char ack = 0;
+    bool acked = (left > 0) && (poll(&pfd, 1, (int)left) == 1) && (recv(cfd, &ack, 1, 0) == 1);
+    close(cfd);
+    return acked;
+}
+
+/*
+    @brief Function to take over the listening sockets of the running process: connect to its unix
+    domain socket path (retried until it listens), receive the sockets and acknowledge them.
+
+    @param const char * path: Unix domain socket path of the running process.
+    @param int * fds: Output listening sockets (close at exec()).
+    @param size_t nfds: Number of listening sockets expected.
+    @param size_t wait_ms: Maximum time waiting for the running process.
+
+    @retval true: Sockets received.
+    @retval false: Invalid arguments, timeout, unexpected message or transfer failed (nothing left open).
+*/
+bool _dmserver_handoff_recv(const char * path, int * fds, size_t nfds, size_t wait_ms){
+    // References check:
+    struct sockaddr_un addr;
+    if (!fds || !nfds || (nfds > DEFAULT_HANDOFF_MAXFDS) || !_dmserver_handoff_helper_addr(path, &addr)) return false;
+
+    // Connection to the running process (retried while its handoff socket is not listening yet):
+    long deadline = _dmserver_handoff_helper_nowms() + (long)wait_ms;
+    int hfd = -1;
+    while (true){
+        hfd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (hfd < 0) return false;
+        if (connect(hfd, (struct sockaddr *)&addr, sizeof(addr)) == 0) break;
+        close(hfd);
+        hfd = -1;
+        if (((errno != ENOENT) && (errno != ECONNREFUSED)) || (_dmserver_handoff_helper_nowms() >= deadline)) return false;
+        usleep(DEFAULT_HANDOFF_RETRYMS * 1000);
+    }
+
+    // Header & sockets:
+    long left = deadline - _dmserver_handoff_helper_nowms();
+    struct pollfd pfd = {.fd=hfd, .events=POLLIN};
+    if ((left <= 0) || (poll(&pfd, 1, (int)left) != 1)) {
+        close(hfd);
+        return false;
+    }
+    dmserver_handoff_hdr_t hdr = {0};
+    union{
+        char buf[CMSG_SPACE(sizeof(int) * DEFAULT_HANDOFF_MAXFDS)];
+        struct cmsghdr align;
+    }cbuf;
+    struct iovec iov = {.iov_base=&hdr, .iov_len=sizeof(hdr)};
+    struct msghdr msg = {.msg_iov=&iov, .msg_iovlen=1, .msg_control=cbuf.buf, .msg_controllen=sizeof(cbuf.buf)};
+    ssize_t rb = recvmsg(hfd, &msg, MSG_CMSG_CLOEXEC);
+
+    size_t nrcv = 0;
+    int rcv[DEFAULT_HANDOFF_MAXFDS];
+    for (struct cmsghdr * cmsg = CMSG_FIRSTHDR(&msg); (rb > 0) && cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)){
+        if ((cmsg->cmsg_level != SOL_SOCKET) || (cmsg->cmsg_type != SCM_RIGHTS)) continue;
+        size_t n = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        if (nrcv + n > DEFAULT_HANDOFF_MAXFDS) n = DEFAULT_HANDOFF_MAXFDS - nrcv;
+        memcpy(&rcv[nrcv], CMSG_DATA(cmsg), n * sizeof(int));
+        nrcv += n;
+    }
+
+    // Expected message (sockets number matching the listeners configured), acknowledged:
+    if ((rb != (ssize_t)sizeof(hdr)) || (hdr.hmagic != DEFAULT_HANDOFF_MAGIC) || (hdr.hnfds != nfds) || (nrcv != nfds) ||
+        (send(hfd, "K", 1, MSG_NOSIGNAL) != 1)) {
+        for (size_t i = 0; i < nrcv; i++) close(rcv[i]);
+        close(hfd);
+        return false;
+    }
+    close(hfd);
+    memcpy(fds, rcv, nfds * sizeof(int));
+    return true;
+}
+
+
+
+
+/* ---- STATIC INTERNAL - Helper functions implementation --------- */
+/*
+    @brief Helper function to build the unix domain socket address of a handoff path.
+
+    @param const char * path: Unix domain socket path.
+    @param struct sockaddr_un * addr: Output address.
+
+    @retval true: Address built.
+    @retval false: Invalid or too long path.
+*/
+static bool _dmserver_handoff_helper_addr(const char * path, struct sockaddr_un * addr){
+    if (!path || !path[0] || (strlen(path) >= sizeof(addr->sun_path))) return false;
+    memset(addr, 0, sizeof(struct sockaddr_un));
+    addr->sun_family = AF_UNIX;
+    strcpy(addr->sun_path, path);
+    return true;
+}
+
+/*
+    @brief Helper function to get the monotonic time in msec.
+
+    @retval Monotonic time in msec.
+*/
+static long _dmserver_handoff_helper_nowms(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
\ No newline at end of file
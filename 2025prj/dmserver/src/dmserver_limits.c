@@ -0,0 +1,337 @@
+/*
+
+*/
+
+/* ---- Library --------------------------------------------------- */
+#include "../inc/_dmserver_limits.h"
+#include "../inc/_dmserver_cliconn.h"
+
+/* ---- Helper functions implementation prototypes ---------------- */
+static void _dmserver_limits_helper_rate(struct dmserver_rate * r, size_t rate, size_t burst);
+static long _dmserver_limits_helper_gcra(int64_t * tat, size_t n, struct dmserver_rate * r, long now);
+static sa_family_t _dmserver_limits_helper_ipkey(struct sockaddr_storage * caddr, uint8_t * key);
+static bool _dmserver_limits_helper_table(dmserver_limits_pt l);
+static size_t _dmserver_limits_helper_hash(sa_family_t family, const uint8_t * key, size_t size);
+
+
+
+
+/* ---- INTERNAL - Functions implementation ----------------------- */
+// ======== General use:
+/*
+    @brief Function to initialize the reception limits (all of them disabled).
+
+    @param dmserver_limits_pt l: Reference to limits struct.
+
+    @retval true: Initialization succeeded.
+    @retval false: Initialization failed.
+*/
+bool _dmserver_limits_init(dmserver_limits_pt l){
+    // Reference check:
+    if (!l) return false;
+    memset(l, 0, sizeof(dmserver_limits_t));
+
+    if (pthread_mutex_init(&l->llock, NULL)) return false;
+    return true;
+}
+
+/*
+    @brief Function to deinitialize the reception limits.
+    @note: No client can hold a source IP entry (server closed).
+
+    @param dmserver_limits_pt l: Reference to limits struct.
+
+    @retval true: Deinitialization succeeded.
+    @retval false: Deinitialization failed.
+*/
+bool _dmserver_limits_deinit(dmserver_limits_pt l){
+    // Reference check:
+    if (!l) return false;
+
+    // Source IP table:
+    if (l->liptable) free(l->liptable);
+    l->liptable = NULL;
+    l->liptable_size = 0;
+    l->lenabled = false;
+    pthread_mutex_destroy(&l->llock);
+    return true;
+}
+
+// ======== Source IP entries:
+/*
+    @brief Function to acquire the source IP entry of an accepted connection, created on the first
+    connection of its address (or recycled from an address without connections), enforcing the
+    concurrent connections limit per source IP.
+
+    @param dmserver_limits_pt l: Reference to limits struct.
+    @param struct sockaddr_storage * caddr: Source address (IPv4-mapped IPv6 taken as IPv4).
+    @param dmserver_ipentry_pt * e: Output entry (connections count incremented), NULL without IP 
+    table, non IP address or table full.
+
+    @retval true: Connection admitted.
+    @retval false: Connections limit of the source IP reached.
+*/
+bool _dmserver_limits_ipacquire(dmserver_limits_pt l, struct sockaddr_storage * caddr, dmserver_ipentry_pt * e){
+    // References check:
+    if (!e) return true;
+    *e = NULL;
+    if (!l || !caddr) return true;
+    uint8_t key[16] = {0};
+    sa_family_t family = _dmserver_limits_helper_ipkey(caddr, key);
+    if (family == AF_UNSPEC) return true;
+
+    // IP table check (allocated at runtime by the connections limit, under the lock):
+    pthread_mutex_lock(&l->llock);
+    if (!l->liptable) {
+        pthread_mutex_unlock(&l->llock);
+        return true;
+    }
+
+    // Address lookup until an empty entry, first entry without connections kept to recycle:
+    size_t max_conns = __atomic_load_n(&l->lip_max_conns, __ATOMIC_RELAXED);
+    size_t mask = l->liptable_size - 1;
+    size_t index = _dmserver_limits_helper_hash(family, key, l->liptable_size);
+    dmserver_ipentry_pt reuse = NULL;
+    for (size_t i = 0; i < l->liptable_size; i++){
+        dmserver_ipentry_pt entry = &l->liptable[(index + i) & mask];
+        if (entry->ifamily == AF_UNSPEC) {
+            if (!reuse) reuse = entry;
+            break;
+        }
+        if ((entry->ifamily == family) && !memcmp(entry->iaddr, key, sizeof(key))) {
+            if (max_conns && (__atomic_load_n(&entry->iconns, __ATOMIC_RELAXED) >= max_conns)) {
+                pthread_mutex_unlock(&l->llock);
+                __atomic_add_fetch(&l->lstats.ldenied_conns, 1, __ATOMIC_RELAXED);
+                return false;
+            }
+            __atomic_add_fetch(&entry->iconns, 1, __ATOMIC_RELAXED);
+            pthread_mutex_unlock(&l->llock);
+            *e = entry;
+            return true;
+        }
+        if (!reuse && (__atomic_load_n(&entry->iconns, __ATOMIC_RELAXED) == 0)) reuse = entry;
+    }
+    if (!reuse) {
+        pthread_mutex_unlock(&l->llock);
+        __atomic_add_fetch(&l->lstats.liptable_full, 1, __ATOMIC_RELAXED);
+        return true;
+    }
+
+    // New (or recycled) entry, buckets full:
+    reuse->ifamily = family;
+    memcpy(reuse->iaddr, key, sizeof(key));
+    reuse->imsgs_tat = 0;
+    reuse->ibytes_tat = 0;
+    __atomic_store_n(&reuse->iconns, 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&l->llock);
+    *e = reuse;
+    return true;
+}
+
+/*
+    @brief Function to release the source IP entry of a client (lock-free).
+
+    @param dmserver_ipentry_pt e: Entry (NULL ignored).
+*/
+void _dmserver_limits_iprelease(dmserver_ipentry_pt e){
+    if (e) __atomic_sub_fetch(&e->iconns, 1, __ATOMIC_RELAXED);
+}
+
+// ======== Accounting:
+/*
+    @brief Function to account a read of a client against its own buckets and the ones of its source
+    IP (one message and its bytes). The read is always charged, the caller pauses the client reads
+    for the returned time so the debt is paid before the next read.
+    @note: Called from the client subthread, the source IP buckets are shared lock-free between subthreads.
+
+    @param dmserver_limits_pt l: Reference to limits struct.
+    @param struct dmserver_cliconn * c: Client that read.
+    @param size_t nbytes: Bytes read.
+    @param long now: Monotonic time in ns.
+
+    @retval Pause of the client reads in ns (0 within limits).
+*/
+long _dmserver_limits_charge(dmserver_limits_pt l, struct dmserver_cliconn * c, size_t nbytes, long now){
+    // Limits disabled fast path:
+    if (!l || !c || !l->lenabled) return 0;
+
+    // Client buckets:
+    long cdelay = _dmserver_limits_helper_gcra(&c->cmsgs_tat, 1, &l->lcli_msgs, now);
+    long bdelay = _dmserver_limits_helper_gcra(&c->cbytes_tat, nbytes, &l->lcli_bytes, now);
+    if (bdelay > cdelay) cdelay = bdelay;
+    if (cdelay > 0) __atomic_add_fetch(&l->lstats.lpaused_cli, 1, __ATOMIC_RELAXED);
+
+    // Source IP buckets:
+    long idelay = 0;
+    if (c->cipentry) {
+        idelay = _dmserver_limits_helper_gcra(&c->cipentry->imsgs_tat, 1, &l->lip_msgs, now);
+        bdelay = _dmserver_limits_helper_gcra(&c->cipentry->ibytes_tat, nbytes, &l->lip_bytes, now);
+        if (bdelay > idelay) idelay = bdelay;
+        if (idelay > 0) __atomic_add_fetch(&l->lstats.lpaused_ip, 1, __ATOMIC_RELAXED);
+    }
+
+    return (idelay > cdelay) ? idelay : cdelay;
+}
+
+// ======== Setters:
+/*
+    @brief Function to set the reception limits, allocating the source IP table only when there
+    are IP limits.
+    @note: No client can hold a source IP entry (server closed).
+
+    @param dmserver_limits_pt l: Reference to limits struct.
+    @param dmserver_limits_conf_pt conf: Limits configuration (NULL disables all the limits).
+
+    @retval true: Configuration set.
+    @retval false: Table allocation failed (limits disabled).
+*/
+bool __dmserver_limits_set(dmserver_limits_pt l, dmserver_limits_conf_pt conf){
+    // Reference check & previous table:
+    if (!l) return false;
+    if (l->liptable) free(l->liptable);
+    l->liptable = NULL;
+    l->liptable_size = 0;
+    l->lip_max_conns = 0;
+    l->lenabled = false;
+    if (!conf) return true;
+
+    // Buckets:
+    _dmserver_limits_helper_rate(&l->lcli_msgs, conf->lcli_msgs_sec, conf->lcli_msgs_burst);
+    _dmserver_limits_helper_rate(&l->lcli_bytes, conf->lcli_bytes_sec, conf->lcli_bytes_burst);
+    _dmserver_limits_helper_rate(&l->lip_msgs, conf->lip_msgs_sec, conf->lip_msgs_burst);
+    _dmserver_limits_helper_rate(&l->lip_bytes, conf->lip_bytes_sec, conf->lip_bytes_burst);
+
+    // Source IP table (IP buckets or connections limit):
+    l->liptable_wanted = conf->lip_table_size;
+    l->lip_max_conns = conf->lip_max_conns;
+    if ((conf->lip_msgs_sec || conf->lip_bytes_sec || conf->lip_max_conns) && !_dmserver_limits_helper_table(l)) return false;
+
+    l->lenabled = conf->lcli_msgs_sec || conf->lcli_bytes_sec || conf->lip_msgs_sec || conf->lip_bytes_sec;
+    return true;
+}
+
+/*
+    @brief Function to set the concurrent connections limit per source IP (at any moment, the IP table
+    is allocated on the first limit). Only connections accepted with the table are counted.
+
+    @param dmserver_limits_pt l: Reference to limits struct.
+    @param size_t lip_max_conns: Connections per source IP (0 unlimited).
+
+    @retval true: Limit set.
+    @retval false: Table allocation failed.
+*/
+bool __dmserver_limits_set_maxconns(dmserver_limits_pt l, size_t lip_max_conns){
+    // Reference check:
+    if (!l) return false;
+
+    // IP table allocation under the lock (accepts read it under the lock):
+    pthread_mutex_lock(&l->llock);
+    bool ok = (lip_max_conns == 0) || l->liptable || _dmserver_limits_helper_table(l);
+    if (ok) __atomic_store_n(&l->lip_max_conns, lip_max_conns, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&l->llock);
+    return ok;
+}
+
+
+
+
+/* ---- Helper functions implementation --------------------------- */
+/*
+    @brief Helper function to set a bucket rate and its burst tolerance.
+
+    @param struct dmserver_rate * r: Bucket rate.
+    @param size_t rate: Units per second (0 unlimited).
+    @param size_t burst: Units allowed at once (0 one second of rate).
+*/
+static void _dmserver_limits_helper_rate(struct dmserver_rate * r, size_t rate, size_t burst){
+    r->rrate = rate;
+    if (!burst) burst = rate;
+    r->rtol_ns = rate ? (int64_t)((double)burst * 1e9 / (double)rate) : 0;
+}
+
+/*
+    @brief Helper function that charges n units to a bucket (GCRA, a single arrival time updated with
+    compare and swap, so the bucket can be shared lock-free).
+
+    @param int64_t * tat: Theoretical arrival time of the bucket (ns).
+    @param size_t n: Units to charge.
+    @param struct dmserver_rate * r: Bucket rate.
+    @param long now: Monotonic time in ns.
+
+    @retval Time in ns until the bucket gets back within its burst (0 within it).
+*/
+static long _dmserver_limits_helper_gcra(int64_t * tat, size_t n, struct dmserver_rate * r, long now){
+    // Unlimited bucket:
+    if (!r->rrate) return 0;
+
+    int64_t inc = (int64_t)((double)n * 1e9 / (double)r->rrate);
+    int64_t old = __atomic_load_n(tat, __ATOMIC_RELAXED);
+    int64_t new;
+    do {
+        new = ((old > now) ? old : now) + inc;
+    } while (!__atomic_compare_exchange_n(tat, &old, new, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    int64_t delay = new - now - r->rtol_ns;
+    return (delay > 0) ? (long)delay : 0;
+}
+
+/*
+    @brief Helper function that builds the source IP key of a socket address.
+
+    @param struct sockaddr_storage * caddr: Socket address (IPv4-mapped IPv6 taken as IPv4).
+    @param uint8_t * key: Output key (16 bytes, zero padded).
+
+    @retval Key family (AF_UNSPEC without IP address).
+*/
+static sa_family_t _dmserver_limits_helper_ipkey(struct sockaddr_storage * caddr, uint8_t * key){
+    if (caddr->ss_family == AF_INET) {
+        memcpy(key, &((struct sockaddr_in *)caddr)->sin_addr, 4);
+        return AF_INET;
+    }
+    if (caddr->ss_family == AF_INET6) {
+        struct in6_addr * a6 = &((struct sockaddr_in6 *)caddr)->sin6_addr;
+        if (IN6_IS_ADDR_V4MAPPED(a6)) {
+            memcpy(key, &a6->s6_addr[12], 4);
+            return AF_INET;
+        }
+        memcpy(key, a6, 16);
+        return AF_INET6;
+    }
+    return AF_UNSPEC;
+}
+
+/*
+    @brief Helper function that allocates the source IP table (power of two).
+
+    @param dmserver_limits_pt l: Reference to limits struct.
+
+    @retval true: Table allocated.
+    @retval false: Allocation failed.
+*/
+static bool _dmserver_limits_helper_table(dmserver_limits_pt l){
+    size_t size = 16;
+    size_t wanted = l->liptable_wanted ? l->liptable_wanted : DEFAULT_LIMITS_IPTABLELEN;
+    while (size < wanted) size <<= 1;
+    l->liptable = calloc(size, sizeof(dmserver_ipentry_t));
+    if (!l->liptable) return false;
+    l->liptable_size = size;
+    return true;
+}
+
+/*
+    @brief Helper function that hashes a source IP key (FNV-1a) into the table.
+
+    @param sa_family_t family: Address family.
+    @param const uint8_t * key: Key (16 bytes).
+    @param size_t size: Table size (power of two).
+
+    @retval Table index.
+*/
+static size_t _dmserver_limits_helper_hash(sa_family_t family, const uint8_t * key, size_t size){
+    uint64_t h = 1469598103934665603ULL ^ family;
+    for (size_t i = 0; i < 16; i++){
+        h ^= key[i];
+        h *= 1099511628211ULL;
+    }
+    return (size_t)(h & (size - 1));
+}
\ No newline at end of file
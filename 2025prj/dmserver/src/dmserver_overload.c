@@ -0,0 +1,106 @@
+/*
+
+*/
+
+/* ---- Library --------------------------------------------------- */
+#include "../inc/_dmserver_overload.h"
+
+/* ---- Helper functions implementation prototypes ---------------- */
+static long _dmserver_overload_helper_next(long t, long interval, size_t count);
+
+
+
+
+/* ---- INTERNAL - Functions implementation ----------------------- */
+// ======== Controller:
+/*
+    @brief Function to reset an overload controller (not overloaded).
+
+    @param dmserver_codel_pt c: Reference to controller.
+*/
+void _dmserver_overload_reset(dmserver_codel_pt c){
+    if (!c) return;
+    memset(c, 0, sizeof(dmserver_codel_t));
+}
+
+/*
+    @brief Function to feed a sojourn sample of the end of a round to the overload controller of a
+    subordinate thread, returning the action to take.
+    @note: Called only by the owner subthread, the overloaded state is read by other threads.
+
+    @param dmserver_codel_pt c: Reference to controller.
+    @param long sojourn: Sojourn time of the round in ns.
+    @param long now: Monotonic time in ns.
+    @param long target: Acceptable sojourn time in ns.
+    @param long interval: Time in ns above target to get overloaded (and base time between sheds).
+
+    @retval DMSERVER_OVERLOAD_ENTER: Overloaded from now (shed once).
+    @retval DMSERVER_OVERLOAD_SHED: Still overloaded, shed once more.
+    @retval DMSERVER_OVERLOAD_LEAVE: Not overloaded anymore.
+    @retval DMSERVER_OVERLOAD_NONE: Nothing to do.
+*/
+enum dmserver_overload_action _dmserver_overload_sample(dmserver_codel_pt c, long sojourn, long now, long target, long interval){
+    // Sojourn above target for a whole interval:
+    __atomic_store_n(&c->csojourn, sojourn, __ATOMIC_RELAXED);
+    bool above = false;
+    if (sojourn < target) c->cfirst_above = 0;
+    else if (c->cfirst_above == 0) c->cfirst_above = now + interval;
+    else above = (now >= c->cfirst_above);
+
+    if (c->coverloaded) {
+        // Back under target, overload left:
+        if (!above) {
+            __atomic_store_n(&c->coverloaded, false, __ATOMIC_RELAXED);
+            return DMSERVER_OVERLOAD_LEAVE;
+        }
+
+        // Next shed sooner the more sheds were needed (interval / sqrt(count)):
+        if (now < c->cshed_next) return DMSERVER_OVERLOAD_NONE;
+        c->ccount++;
+        c->cshed_next = _dmserver_overload_helper_next(c->cshed_next, interval, c->ccount);
+        return DMSERVER_OVERLOAD_SHED;
+    }
+    if (!above) return DMSERVER_OVERLOAD_NONE;
+
+    // Overload entered, sheds rate resumed from the last overload if it was recent:
+    c->ccount = ((c->ccount > 2) && ((now - c->cshed_next) < 16 * interval)) ? c->ccount - 2 : 1;
+    c->cshed_next = _dmserver_overload_helper_next(now, interval, c->ccount);
+    __atomic_store_n(&c->coverloaded, true, __ATOMIC_RELAXED);
+    return DMSERVER_OVERLOAD_ENTER;
+}
+
+/*
+    @brief Function to read the overloaded state of a subordinate thread controller (any thread).
+
+    @param dmserver_codel_pt c: Reference to controller.
+
+    @retval true: Subthread overloaded.
+    @retval false: Subthread not overloaded.
+*/
+bool _dmserver_overload_state(dmserver_codel_pt c){
+    return c && __atomic_load_n(&c->coverloaded, __ATOMIC_RELAXED);
+}
+
+
+
+
+/* ---- STATIC INTERNAL - Helper functions implementation --------- */
+/*
+    @brief Helper function of the control law, next shed time (t + interval / sqrt(count)).
+
+    @param long t: Time base in ns.
+    @param long interval: Interval in ns.
+    @param size_t count: Sheds in the current overload.
+
+    @retval Next shed time in ns.
+*/
+static long _dmserver_overload_helper_next(long t, long interval, size_t count){
+    // Integer square root (Newton):
+    size_t r = count;
+    size_t x = (count + 1) / 2;
+    while (x < r) {
+        r = x;
+        x = (x + count / x) / 2;
+    }
+    return t + interval / (long)(r ? r : 1);
+}
\ No newline at end of file
@@ -0,0 +1,330 @@
+/*
+
+*/
+
+/* ---- Library --------------------------------------------------- */
+#include "../inc/_dmserver_proxy.h"
+
+/* ---- Helper functions implementation prototypes ---------------- */
+static enum dmserver_proxy_result _dmserver_proxy_helper_flow(dmserver_proxy_pt p, struct dmserver_proxyflow * f, bool c2u, size_t * moved);
+static ssize_t _dmserver_proxy_helper_read(dmserver_proxy_pt p, struct dmserver_proxyflow * f, bool c2u);
+static ssize_t _dmserver_proxy_helper_write(dmserver_proxy_pt p, struct dmserver_proxyflow * f, bool c2u);
+static void _dmserver_proxy_helper_shut(dmserver_proxy_pt p, bool c2u);
+static bool _dmserver_proxy_helper_flowopen(struct dmserver_proxyflow * f, bool spliced, size_t pipe_size);
+static void _dmserver_proxy_helper_flowclose(struct dmserver_proxyflow * f);
+
+
+
+
+/* ---- INTERNAL - Functions implementation ----------------------- */
+// ======== Proxy pairs:
+/*
+    @brief Function to initialize a proxy pair (closed, no descriptors).
+
+    @param dmserver_proxy_pt p: Reference to proxy pair.
+*/
+void _dmserver_proxy_init(dmserver_proxy_pt p){
+    if (!p) return;
+    memset(p, 0, sizeof(dmserver_proxy_t));
+    p->pevsrc.etype = DMSERVER_EVSRC_PROXY;
+    p->pfd = -1;
+    p->pc2u.fpipe[0] = p->pc2u.fpipe[1] = -1;
+    p->pu2c.fpipe[0] = p->pu2c.fpipe[1] = -1;
+}
+
+/*
+    @brief Function to open the proxy pair of an established client: non-blocking connection to the
+    target started and both flows prepared. Bytes are moved by splice through a pipe per flow when both
+    ends are plain sockets (TLS clients with kernel TLS offload included), and copied through a buffer
+    otherwise (TLS handled by the library). Both ends registered for input & output events in the epoll
+    of the client subthread (the pair itself as event source of the upstream).
+
+    @param dmserver_proxy_pt p: Reference to proxy pair (closed).
+    @param dmserver_cliconn_pt c: Client established.
+    @param dmserver_proxytarget_pt t: Proxy target of the client listener.
+    @param int epfd: Epoll of the client subthread.
+
+    @retval true: Pair opened (upstream connecting).
+    @retval false: Pair could not be opened (pair left closed).
+*/
+bool _dmserver_proxy_open(dmserver_proxy_pt p, dmserver_cliconn_pt c, dmserver_proxytarget_pt t, int epfd){
+    // References check:
+    if (!p || !c || !t || !t->tenabled || (p->pfd >= 0)) return false;
+    p->pcli = c;
+
+    // Kernel TLS offload of the client (both directions & nothing left buffered by the library):
+    p->pktls = c->cssl && BIO_get_ktls_send(SSL_get_wbio(c->cssl)) && BIO_get_ktls_recv(SSL_get_rbio(c->cssl)) && !SSL_has_pending(c->cssl);
+    bool spliced = !c->cssl || p->pktls;
+    if (!spliced) SSL_set_mode(c->cssl, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+    if (!_dmserver_proxy_helper_flowopen(&p->pc2u, spliced, t->tpipe_size) || !_dmserver_proxy_helper_flowopen(&p->pu2c, spliced, t->tpipe_size)) {
+        _dmserver_proxy_close(p);
+        return false;
+    }
+
+    // Upstream connection start (tuned as the accepted sockets of the target connection data):
+    p->pfd = socket(t->tconn.ssafamily, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (p->pfd < 0) {
+        _dmserver_proxy_close(p);
+        return false;
+    }
+    _dmserver_sconn_ccsetopts(&t->tconn, p->pfd);
+    socklen_t addrlen = (t->tconn.ssafamily == AF_INET6) ? sizeof(t->tconn.saddr.s6) : sizeof(t->tconn.saddr.s4);
+    if ((connect(p->pfd, (struct sockaddr *)&t->tconn.saddr, addrlen) < 0) && (errno != EINPROGRESS)) {
+        _dmserver_proxy_close(p);
+        return false;
+    }
+    p->pconnecting = true;
+
+    // Events of both ends (the upstream completes its connection on the first one):
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, p->pfd, &(struct epoll_event){.events=EPOLLIN|EPOLLOUT|EPOLLRDHUP|EPOLLET, .data.ptr=p}) < 0) {
+        _dmserver_proxy_close(p);
+        return false;
+    }
+    epoll_ctl(epfd, EPOLL_CTL_MOD, c->cfd, &(struct epoll_event){.events=EPOLLIN|EPOLLOUT|EPOLLRDHUP|EPOLLET, .data.ptr=c});
+    return true;
+}
+
+/*
+    @brief Function to complete the upstream connection of a proxy pair (first event of its socket).
+
+    @param dmserver_proxy_pt p: Reference to proxy pair.
+
+    @retval true: Upstream connected.
+    @retval false: Upstream connection failed.
+*/
+bool _dmserver_proxy_connected(dmserver_proxy_pt p){
+    if (!p || (p->pfd < 0)) return false;
+    if (!p->pconnecting) return true;
+
+    int err = 0;
+    socklen_t errlen = sizeof(err);
+    if ((getsockopt(p->pfd, SOL_SOCKET, SO_ERROR, &err, &errlen) < 0) || err) return false;
+    p->pconnecting = false;
+    return true;
+}
+
+/*
+    @brief Function to close a proxy pair (upstream socket, pipes & buffers), the client is closed by
+    the caller.
+
+    @param dmserver_proxy_pt p: Reference to proxy pair.
+*/
+void _dmserver_proxy_close(dmserver_proxy_pt p){
+    if (!p) return;
+    if (p->pfd >= 0) close(p->pfd);
+    _dmserver_proxy_helper_flowclose(&p->pc2u);
+    _dmserver_proxy_helper_flowclose(&p->pu2c);
+    _dmserver_proxy_init(p);
+}
+
+// ======== Pump:
+/*
+    @brief Function to move the bytes of both flows of a proxy pair until they block. A flow only reads
+    its source once its destination took all the bytes in flight, so a slow end stops the reads of the 
+    other one (backpressure up to the socket buffers of the sender). The end of stream of a source shuts
+    down the write side of its destination once drained (half-close), the other flow goes on.
+
+    @param dmserver_proxy_pt p: Reference to proxy pair (upstream connected).
+    @param size_t * moved_c2u: Output bytes moved from the client to the upstream.
+    @param size_t * moved_u2c: Output bytes moved from the upstream to the client.
+
+    @retval DMSERVER_PROXY_AGAIN: Both flows blocked (or one done), waiting for events.
+    @retval DMSERVER_PROXY_DONE: Both flows done, the pair can be closed.
+    @retval DMSERVER_PROXY_ERROR: Connection error on any end.
+*/
+enum dmserver_proxy_result _dmserver_proxy_pump(dmserver_proxy_pt p, size_t * moved_c2u, size_t * moved_u2c){
+    // References & state check:
+    if (!p || !moved_c2u || !moved_u2c || (p->pfd < 0)) return DMSERVER_PROXY_ERROR;
+    *moved_c2u = 0;
+    *moved_u2c = 0;
+    if (p->pconnecting) return DMSERVER_PROXY_AGAIN;
+
+    enum dmserver_proxy_result rc2u = _dmserver_proxy_helper_flow(p, &p->pc2u, true, moved_c2u);
+    if (rc2u == DMSERVER_PROXY_ERROR) return DMSERVER_PROXY_ERROR;
+    enum dmserver_proxy_result ru2c = _dmserver_proxy_helper_flow(p, &p->pu2c, false, moved_u2c);
+    if (ru2c == DMSERVER_PROXY_ERROR) return DMSERVER_PROXY_ERROR;
+
+    return ((rc2u == DMSERVER_PROXY_DONE) && (ru2c == DMSERVER_PROXY_DONE)) ? DMSERVER_PROXY_DONE : DMSERVER_PROXY_AGAIN;
+}
+
+// ======== Proxy configuration:
+/*
+    @brief Function to set the proxy target of a listener (resolved now).
+    @note: The host name resolution blocks the caller.
+
+    @param dmserver_proxytarget_pt t: Reference to proxy target.
+    @param dmserver_proxy_conf_pt conf: Proxy configuration (NULL disables the proxy).
+
+    @retval true: Target set (or disabled).
+    @retval false: Invalid configuration or resolution failed (target disabled).
+*/
+bool __dmserver_proxy_set_target(dmserver_proxytarget_pt t, dmserver_proxy_conf_pt conf){
+    // Reference check:
+    if (!t) return false;
+    t->tenabled = false;
+    if (!conf) return true;
+    if (!conf->phost || !conf->phost[0] || (strlen(conf->phost) >= DEFAULT_UPSTREAM_HOSTLEN) || (conf->pport <= 0) || (conf->pport > 65535)) return false;
+
+    // Target endpoint:
+    __dmserver_sconn_set_defaults(&t->tconn);
+    if (!_dmserver_upstream_resolve(&t->tconn, conf->phost, conf->pport)) return false;
+    strcpy(t->thost, conf->phost);
+    t->tpipe_size = conf->ppipe_size ? conf->ppipe_size : DEFAULT_PROXY_PIPESIZE;
+    t->tenabled = true;
+    return true;
+}
+
+
+
+
+/* ---- STATIC INTERNAL - Helper functions implementation --------- */
+/*
+    @brief Helper function that moves the bytes of a flow until it blocks (destination first).
+
+    @param dmserver_proxy_pt p: Proxy pair.
+    @param struct dmserver_proxyflow * f: Flow.
+    @param bool c2u: Flow direction (client to upstream or upstream to client).
+    @param size_t * moved: Output bytes moved (accumulated).
+
+    @retval Flow result (blocked, done or error).
+*/
+static enum dmserver_proxy_result _dmserver_proxy_helper_flow(dmserver_proxy_pt p, struct dmserver_proxyflow * f, bool c2u, size_t * moved){
+    while (true){
+        // Bytes in flight to the destination (the source is not read while they are pending):
+        while (f->fpending){
+            ssize_t n = _dmserver_proxy_helper_write(p, f, c2u);
+            if (n < 0) return (n == -1) ? DMSERVER_PROXY_AGAIN : DMSERVER_PROXY_ERROR;
+            f->fpending -= (size_t)n;
+            f->foff += (size_t)n;
+            f->fbytes += (size_t)n;
+            *moved += (size_t)n;
+        }
+        f->foff = 0;
+
+        // Source end of stream, destination write side shut down once drained:
+        if (f->feof) {
+            if (!f->fshut) _dmserver_proxy_helper_shut(p, c2u);
+            f->fshut = true;
+            return DMSERVER_PROXY_DONE;
+        }
+
+        // Source read into the pipe/buffer:
+        ssize_t n = _dmserver_proxy_helper_read(p, f, c2u);
+        if (n < 0) return (n == -1) ? DMSERVER_PROXY_AGAIN : DMSERVER_PROXY_ERROR;
+        if (n == 0) f->feof = true;
+        f->fpending = (size_t)n;
+    }
+}
+
+/*
+    @brief Helper function that reads the source of a flow into its pipe (splice) or buffer.
+
+    @param dmserver_proxy_pt p: Proxy pair.
+    @param struct dmserver_proxyflow * f: Flow (nothing in flight).
+    @param bool c2u: Flow direction.
+
+    @retval Bytes read (0 end of stream), -1 would block, -2 error.
+*/
+static ssize_t _dmserver_proxy_helper_read(dmserver_proxy_pt p, struct dmserver_proxyflow * f, bool c2u){
+    ssize_t n;
+    if (!f->fbuf) {
+        // Socket to pipe (no user space copy):
+        n = splice(c2u ? p->pcli->cfd : p->pfd, NULL, f->fpipe[1], NULL, DEFAULT_PROXY_SPLICELEN, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    } else if (c2u) {
+        // TLS client to buffer:
+        ERR_clear_error();
+        n = SSL_read(p->pcli->cssl, f->fbuf, DEFAULT_PROXY_COPYBUFLEN);
+        if (n > 0) return n;
+        int err = SSL_get_error(p->pcli->cssl, (int)n);
+        if (err == SSL_ERROR_ZERO_RETURN) return 0;
+        return ((err == SSL_ERROR_WANT_READ) || (err == SSL_ERROR_WANT_WRITE)) ? -1 : -2;
+    } else {
+        // Upstream to buffer:
+        n = read(p->pfd, f->fbuf, DEFAULT_PROXY_COPYBUFLEN);
+    }
+    if (n >= 0) return n;
+    return ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) ? -1 : -2;
+}
+
+/*
+    @brief Helper function that writes the bytes in flight of a flow to its destination.
+
+    @param dmserver_proxy_pt p: Proxy pair.
+    @param struct dmserver_proxyflow * f: Flow (bytes in flight).
+    @param bool c2u: Flow direction.
+
+    @retval Bytes written, -1 would block, -2 error.
+*/
+static ssize_t _dmserver_proxy_helper_write(dmserver_proxy_pt p, struct dmserver_proxyflow * f, bool c2u){
+    ssize_t n;
+    if (!f->fbuf) {
+        // Pipe to socket (no user space copy):
+        n = splice(f->fpipe[0], NULL, c2u ? p->pfd : p->pcli->cfd, NULL, f->fpending, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    } else if (!c2u) {
+        // Buffer to TLS client (partial writes enabled):
+        ERR_clear_error();
+        n = SSL_write(p->pcli->cssl, f->fbuf + f->foff, (int)f->fpending);
+        if (n > 0) return n;
+        int err = SSL_get_error(p->pcli->cssl, (int)n);
+        return ((err == SSL_ERROR_WANT_READ) || (err == SSL_ERROR_WANT_WRITE)) ? -1 : -2;
+    } else {
+        // Buffer to upstream:
+        n = send(p->pfd, f->fbuf + f->foff, f->fpending, MSG_NOSIGNAL);
+    }
+    if (n > 0) return n;
+    if (n == 0) return -2;
+    return ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) ? -1 : -2;
+}
+
+/*
+    @brief Helper function that shuts down the write side of the destination of a flow (TLS clients
+    get the close notify first).
+
+    @param dmserver_proxy_pt p: Proxy pair.
+    @param bool c2u: Flow direction.
+*/
+static void _dmserver_proxy_helper_shut(dmserver_proxy_pt p, bool c2u){
+    if (c2u) {
+        shutdown(p->pfd, SHUT_WR);
+        return;
+    }
+    if (p->pcli->cssl) {
+        ERR_clear_error();
+        SSL_shutdown(p->pcli->cssl);
+    }
+    shutdown(p->pcli->cfd, SHUT_WR);
+}
+
+/*
+    @brief Helper function to prepare a flow: pipe for splice (resized if requested) or copy buffer.
+
+    @param struct dmserver_proxyflow * f: Flow.
+    @param bool spliced: Splice through a pipe (or copy through a buffer).
+    @param size_t pipe_size: Pipe size (0 system default).
+
+    @retval true: Flow prepared.
+    @retval false: Pipe or buffer allocation failed.
+*/
+static bool _dmserver_proxy_helper_flowopen(struct dmserver_proxyflow * f, bool spliced, size_t pipe_size){
+    if (!spliced) {
+        f->fbuf = malloc(DEFAULT_PROXY_COPYBUFLEN);
+        return f->fbuf != NULL;
+    }
+    if (pipe2(f->fpipe, O_NONBLOCK | O_CLOEXEC) < 0) {
+        f->fpipe[0] = f->fpipe[1] = -1;
+        return false;
+    }
+    if (pipe_size) fcntl(f->fpipe[1], F_SETPIPE_SZ, (int)pipe_size);
+    return true;
+}
+
+/*
+    @brief Helper function to release a flow (pipe or copy buffer).
+
+    @param struct dmserver_proxyflow * f: Flow.
+*/
+static void _dmserver_proxy_helper_flowclose(struct dmserver_proxyflow * f){
+    if (f->fpipe[0] >= 0) close(f->fpipe[0]);
+    if (f->fpipe[1] >= 0) close(f->fpipe[1]);
+    if (f->fbuf) free(f->fbuf);
+}
\ No newline at end of file
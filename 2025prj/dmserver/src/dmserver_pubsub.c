@@ -0,0 +1,316 @@
+/*
+
+*/
+
+/* ---- Library --------------------------------------------------- */
+#include "../inc/_dmserver_pubsub.h"
+
+/* ---- Helper functions implementation prototypes ---------------- */
+static uint64_t _dmserver_pubsub_helper_fnv(const char * s);
+static size_t _dmserver_pubsub_helper_hash(const char * topic, size_t size);
+static size_t _dmserver_pubsub_helper_find(dmserver_pubsub_pt p, const char * topic);
+static bool _dmserver_pubsub_helper_grow(dmserver_pubsub_pt p);
+static void _dmserver_pubsub_helper_delete(dmserver_pubsub_pt p, size_t index);
+static bool _dmserver_pubsub_helper_subdel(dmserver_pubsub_pt p, size_t index, dmserver_cliconn_pt c);
+
+
+
+
+/* ---- INTERNAL - Functions implementation ----------------------- */
+// ======== General use:
+/*
+    @brief Function to initialize the topics index of a subordinate thread.
+
+    @param dmserver_pubsub_pt p: Reference to pub/sub index.
+
+    @retval true: Initialization succeeded.
+    @retval false: Initialization failed.
+*/
+bool _dmserver_pubsub_init(dmserver_pubsub_pt p){
+    // Reference check:
+    if (!p) return false;
+    memset(p, 0, sizeof(dmserver_pubsub_t));
+
+    // Topics table (power of two, grown at half load):
+    p->ptopics_size = DEFAULT_PUBSUB_TOPICSLEN;
+    p->ptopics = calloc(p->ptopics_size, sizeof(dmserver_topic_t));
+    if (!p->ptopics) return false;
+    if (pthread_rwlock_init(&p->plock, NULL)) {
+        free(p->ptopics);
+        p->ptopics = NULL;
+        return false;
+    }
+    return true;
+}
+
+/*
+    @brief Function to deinitialize the topics index of a subordinate thread.
+
+    @param dmserver_pubsub_pt p: Reference to pub/sub index.
+
+    @retval true: Deinitialization succeeded.
+    @retval false: Deinitialization failed.
+*/
+bool _dmserver_pubsub_deinit(dmserver_pubsub_pt p){
+    // Reference check:
+    if (!p || !p->ptopics) return false;
+
+    // Topics subscribers and table:
+    for (size_t i = 0; i < p->ptopics_size; i++) if (p->ptopics[i].tsubs) free(p->ptopics[i].tsubs);
+    free(p->ptopics);
+    p->ptopics = NULL;
+    p->ptopics_size = 0;
+    p->ptopics_count = 0;
+    pthread_rwlock_destroy(&p->plock);
+    return true;
+}
+
+// ======== Subscriptions:
+/*
+    @brief Function to subscribe a client to a topic (the topic is created on its first subscriber).
+
+    @param dmserver_pubsub_pt p: Reference to pub/sub index of the client subthread.
+    @param dmserver_cliconn_pt c: Reference to client.
+    @param const char * topic: Topic name (DEFAULT_PUBSUB_TOPICLEN - 1 characters max).
+
+    @retval true: Subscribed (or already subscribed).
+    @retval false: Subscription failed.
+*/
+bool _dmserver_pubsub_subscribe(dmserver_pubsub_pt p, dmserver_cliconn_pt c, const char * topic){
+    // References & topic check:
+    if (!p || !p->ptopics || !c || !topic || !topic[0]) return false;
+    if (strlen(topic) >= DEFAULT_PUBSUB_TOPICLEN) return false;
+
+    pthread_rwlock_wrlock(&p->plock);
+
+    // Topic entry (created if needed, table grown at half load):
+    size_t index = _dmserver_pubsub_helper_find(p, topic);
+    if (!p->ptopics[index].tname[0]) {
+        if ((2 * (p->ptopics_count + 1) > p->ptopics_size)) {
+            if (!_dmserver_pubsub_helper_grow(p)) {
+                pthread_rwlock_unlock(&p->plock);
+                return false;
+            }
+            index = _dmserver_pubsub_helper_find(p, topic);
+        }
+        strcpy(p->ptopics[index].tname, topic);
+        p->ptopics_count++;
+    }
+    dmserver_topic_pt t = &p->ptopics[index];
+
+    // Already subscribed check:
+    for (size_t i = 0; i < t->tsubs_count; i++){if (t->tsubs[i] == c) {
+        pthread_rwlock_unlock(&p->plock);
+        return true;
+    }}
+
+    // Subscribers array grown by doubling:
+    if (t->tsubs_count == t->tsubs_size) {
+        size_t nsize = t->tsubs_size ? 2 * t->tsubs_size : DEFAULT_PUBSUB_SUBSLEN;
+        dmserver_cliconn_pt * nsubs = realloc(t->tsubs, nsize * sizeof(dmserver_cliconn_pt));
+        if (!nsubs) {
+            if (t->tsubs_count == 0) _dmserver_pubsub_helper_delete(p, index);
+            pthread_rwlock_unlock(&p->plock);
+            return false;
+        }
+        t->tsubs = nsubs;
+        t->tsubs_size = nsize;
+    }
+    t->tsubs[t->tsubs_count++] = c;
+    c->csubs++;
+
+    pthread_rwlock_unlock(&p->plock);
+    return true;
+}
+
+/*
+    @brief Function to unsubscribe a client from a topic (the topic is removed with its last subscriber).
+
+    @param dmserver_pubsub_pt p: Reference to pub/sub index of the client subthread.
+    @param dmserver_cliconn_pt c: Reference to client.
+    @param const char * topic: Topic name.
+
+    @retval true: Unsubscribed.
+    @retval false: Client not subscribed to the topic.
+*/
+bool _dmserver_pubsub_unsubscribe(dmserver_pubsub_pt p, dmserver_cliconn_pt c, const char * topic){
+    // References check:
+    if (!p || !p->ptopics || !c || !topic || !topic[0]) return false;
+
+    // Topic lookup & subscriber removal:
+    pthread_rwlock_wrlock(&p->plock);
+    size_t index = _dmserver_pubsub_helper_find(p, topic);
+    bool removed = p->ptopics[index].tname[0] && _dmserver_pubsub_helper_subdel(p, index, c);
+    pthread_rwlock_unlock(&p->plock);
+    return removed;
+}
+
+/*
+    @brief Function to unsubscribe a client from all its topics (client disconnection).
+
+    @param dmserver_pubsub_pt p: Reference to pub/sub index of the client subthread.
+    @param dmserver_cliconn_pt c: Reference to client.
+*/
+void _dmserver_pubsub_unsubscribe_all(dmserver_pubsub_pt p, dmserver_cliconn_pt c){
+    // References & subscriptions check:
+    if (!p || !p->ptopics || !c || (c->csubs == 0)) return;
+
+    // Full index scan (an entry deleted is refilled by backward shift, so it is checked again):
+    pthread_rwlock_wrlock(&p->plock);
+    size_t i = 0;
+    while ((i < p->ptopics_size) && (c->csubs > 0)){
+        if (p->ptopics[i].tname[0] && _dmserver_pubsub_helper_subdel(p, i, c) && !p->ptopics[i].tname[0]) continue;
+        i++;
+    }
+    c->csubs = 0;
+    pthread_rwlock_unlock(&p->plock);
+}
+
+/*
+    @brief Function to look up a topic in the index.
+    @note: The index read (or write) lock must be held by the caller while the topic is in use.
+
+    @param dmserver_pubsub_pt p: Reference to pub/sub index.
+    @param const char * topic: Topic name.
+
+    @retval Reference to the topic entry, NULL if the topic has no subscribers.
+*/
+dmserver_topic_pt _dmserver_pubsub_lookup(dmserver_pubsub_pt p, const char * topic){
+    // References check:
+    if (!p || !p->ptopics || !topic || !topic[0]) return NULL;
+
+    // Topic lookup:
+    size_t index = _dmserver_pubsub_helper_find(p, topic);
+    return p->ptopics[index].tname[0] ? &p->ptopics[index] : NULL;
+}
+
+/*
+    @brief Function to compute the coalescing key of the published messages (messages with the same 
+    key replace each other while pending).
+
+    @param const char * key: Key string (topic name when no specific key is given).
+
+    @retval Key hash.
+*/
+uint64_t _dmserver_pubsub_key(const char * key){
+    return key ? _dmserver_pubsub_helper_fnv(key) : 0;
+}
+
+
+
+
+/* ---- Helper functions implementation --------------------------- */
+/*
+    @brief Helper function to hash a string (FNV-1a).
+
+    @param const char * s: String.
+
+    @retval String hash.
+*/
+static uint64_t _dmserver_pubsub_helper_fnv(const char * s){
+    uint64_t h = 1469598103934665603ULL;
+    for (const unsigned char * c = (const unsigned char *)s; *c; c++){
+        h ^= *c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/*
+    @brief Helper function to hash a topic name into the table.
+
+    @param const char * topic: Topic name.
+    @param size_t size: Table size (power of two).
+
+    @retval Home index of the topic.
+*/
+static size_t _dmserver_pubsub_helper_hash(const char * topic, size_t size){
+    return (size_t)(_dmserver_pubsub_helper_fnv(topic) & (size - 1));
+}
+
+/*
+    @brief Helper function to find the entry of a topic, or the free entry where it would be inserted.
+
+    @param dmserver_pubsub_pt p: Reference to pub/sub index.
+    @param const char * topic: Topic name.
+
+    @retval Index of the topic entry (or free entry).
+*/
+static size_t _dmserver_pubsub_helper_find(dmserver_pubsub_pt p, const char * topic){
+    size_t index = _dmserver_pubsub_helper_hash(topic, p->ptopics_size);
+    while (p->ptopics[index].tname[0] && strcmp(p->ptopics[index].tname, topic)) index = (index + 1) & (p->ptopics_size - 1);
+    return index;
+}
+
+/*
+    @brief Helper function to double the topics table size (entries rehashed, subscribers kept).
+
+    @param dmserver_pubsub_pt p: Reference to pub/sub index.
+
+    @retval true: Table grown.
+    @retval false: Allocation failed (table untouched).
+*/
+static bool _dmserver_pubsub_helper_grow(dmserver_pubsub_pt p){
+    // New table:
+    size_t osize = p->ptopics_size;
+    dmserver_topic_pt otopics = p->ptopics;
+    dmserver_topic_pt ntopics = calloc(2 * osize, sizeof(dmserver_topic_t));
+    if (!ntopics) return false;
+
+    // Rehash of the used entries:
+    p->ptopics = ntopics;
+    p->ptopics_size = 2 * osize;
+    for (size_t i = 0; i < osize; i++){
+        if (!otopics[i].tname[0]) continue;
+        p->ptopics[_dmserver_pubsub_helper_find(p, otopics[i].tname)] = otopics[i];
+    }
+    free(otopics);
+    return true;
+}
+
+/*
+    @brief Helper function to delete a topic entry (backward shift of the following probed entries).
+
+    @param dmserver_pubsub_pt p: Reference to pub/sub index.
+    @param size_t index: Entry to delete.
+*/
+static void _dmserver_pubsub_helper_delete(dmserver_pubsub_pt p, size_t index){
+    // Entry release:
+    size_t mask = p->ptopics_size - 1;
+    if (p->ptopics[index].tsubs) free(p->ptopics[index].tsubs);
+    memset(&p->ptopics[index], 0, sizeof(dmserver_topic_t));
+    p->ptopics_count--;
+
+    // Backward shift, entries whose home is not between the hole and themselves fill the hole:
+    size_t hole = index;
+    for (size_t j = (hole + 1) & mask; p->ptopics[j].tname[0]; j = (j + 1) & mask){
+        size_t home = _dmserver_pubsub_helper_hash(p->ptopics[j].tname, p->ptopics_size);
+        if (((j - home) & mask) < ((j - hole) & mask)) continue;
+        p->ptopics[hole] = p->ptopics[j];
+        memset(&p->ptopics[j], 0, sizeof(dmserver_topic_t));
+        hole = j;
+    }
+}
+
+/*
+    @brief Helper function to remove a subscriber from a topic entry (entry deleted when empty).
+
+    @param dmserver_pubsub_pt p: Reference to pub/sub index.
+    @param size_t index: Topic entry.
+    @param dmserver_cliconn_pt c: Reference to client.
+
+    @retval true: Subscriber removed.
+    @retval false: Client not subscribed to the topic.
+*/
+static bool _dmserver_pubsub_helper_subdel(dmserver_pubsub_pt p, size_t index, dmserver_cliconn_pt c){
+    // Subscriber lookup (swap with the last one):
+    dmserver_topic_pt t = &p->ptopics[index];
+    for (size_t i = 0; i < t->tsubs_count; i++){
+        if (t->tsubs[i] != c) continue;
+        t->tsubs[i] = t->tsubs[--t->tsubs_count];
+        if (c->csubs > 0) c->csubs--;
+        if (t->tsubs_count == 0) _dmserver_pubsub_helper_delete(p, index);
+        return true;
+    }
+    return false;
+}
\ No newline at end of file
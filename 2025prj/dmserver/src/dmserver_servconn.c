@@ -6,6 +6,10 @@
 #include "../inc/_dmserver_servconn.h"
 #include <sys/socket.h>
 
+/* ---- Helper functions implementation prototypes ---------------- */
+static bool _dmserver_sconn_helper_inherit(dmserver_servconn_pt s);
+static SSL_CTX * _dmserver_sconn_helper_sslctx(const SSL_METHOD * method, const char * scert_path, const char * skey_path);
+
 /* ---- INTERNAL - Functions implementation ----------------------- */
 // ======== General use:
 /*
@@ -20,8 +24,11 @@ bool _dmserver_sconn_init(struct dmserver_servconn * s){
     // Reference check:
     if (!s) return false;
 
-    // Socket file descriptor tcp, close at exec() & socket non-blocking:
-    s->sfd = socket(s->ssafamily, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    // Listening socket received from a previous process (already bound and listening):
+    if (s->sinherit_fd >= 0) return _dmserver_sconn_helper_inherit(s);
+
+    // Socket file descriptor tcp/udp, close at exec() & socket non-blocking:
+    s->sfd = socket(s->ssafamily, s->ssocktype | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
     if (s->sfd < 0) return false;
 
     // Socket configuration:
@@ -31,7 +38,24 @@ bool _dmserver_sconn_init(struct dmserver_servconn * s){
         _dmserver_sconn_deinit(s);
         return false;
     }
-    if (setsockopt(s->sfd, SOL_SOCKET, SO_REUSEPORT, &sopt, sizeof(sopt)) < 0){
+    if ((s->ssafamily != AF_UNIX) && (setsockopt(s->sfd, SOL_SOCKET, SO_REUSEPORT, &sopt, sizeof(sopt)) < 0)){
+        _dmserver_sconn_deinit(s);
+        return false;
+    }
+
+    // Socket buffers set on the listener (inherited by accepted sockets, window scale negotiated at SYN):
+    if ((s->ssndbuf > 0) && (setsockopt(s->sfd, SOL_SOCKET, SO_SNDBUF, &s->ssndbuf, sizeof(s->ssndbuf)) < 0)){
+        _dmserver_sconn_deinit(s);
+        return false;
+    }
+    if ((s->srcvbuf > 0) && (setsockopt(s->sfd, SOL_SOCKET, SO_RCVBUF, &s->srcvbuf, sizeof(s->srcvbuf)) < 0)){
+        _dmserver_sconn_deinit(s);
+        return false;
+    }
+
+    // Kernel receive timestamps (inherited by the accepted sockets, data queued before the accept included):
+    int tsflags = DEFAULT_SCONN_RXTSTAMPFLAGS;
+    if (s->srxtstamp && (s->ssafamily != AF_UNIX) && (setsockopt(s->sfd, SOL_SOCKET, SO_TIMESTAMPING, &tsflags, sizeof(tsflags)) < 0)){
         _dmserver_sconn_deinit(s);
         return false;
     }
@@ -63,6 +87,15 @@ bool _dmserver_sconn_init(struct dmserver_servconn * s){
             _dmserver_sconn_deinit(s);
             return false;
         }
+    } else if (s->ssafamily == AF_UNIX){
+        // Stale socket file of a previous run removed before binding:
+        s->saddr.su.sun_family = AF_UNIX;
+        memcpy(s->saddr.su.sun_path, s->sunixpath, sizeof(s->saddr.su.sun_path));
+        unlink(s->sunixpath);
+        if (bind(s->sfd, (struct sockaddr *)&s->saddr.su, sizeof(s->saddr.su)) < 0){
+            _dmserver_sconn_deinit(s);
+            return false;
+        }
     } else {
         _dmserver_sconn_deinit(s);
         return false;
@@ -83,11 +116,13 @@ bool _dmserver_sconn_deinit(struct dmserver_servconn * s){
     // Reference check:
     if (!s) return false;
 
-    // Close server socket:
+    // Close server socket (and remove the unix socket file, unless handed off to a next process):
     if (s->sfd >= 0) {
         close(s->sfd);
         s->sfd = -1;
+        if ((s->ssafamily == AF_UNIX) && !s->shandedoff) unlink(s->sunixpath);
     }
+    s->shandedoff = false;
     return true;
 }
 
@@ -114,32 +149,9 @@ bool _dmserver_sconn_sslinit(struct dmserver_servconn * s){
     // SSL method TLS(bc tcp):
     s->sssl_method = TLS_server_method();
 
-    // SSL context:
-    s->sssl_ctx = SSL_CTX_new(s->sssl_method);
+    // SSL context (server cert. and key validated):
+    s->sssl_ctx = _dmserver_sconn_helper_sslctx(s->sssl_method, s->sssl_certpath, s->sssl_keypath);
     if (!s->sssl_ctx) return false;
-
-    // Only TLS 1.3:
-    SSL_CTX_set_min_proto_version(s->sssl_ctx, TLS1_3_VERSION);
-    SSL_CTX_set_max_proto_version(s->sssl_ctx, TLS1_3_VERSION);
-
-    // Disable renegotiation:
-    SSL_CTX_set_options(s->sssl_ctx, SSL_OP_NO_RENEGOTIATION);
-
-    // SSL server cert. and key & validation:
-    if (SSL_CTX_use_certificate_file(s->sssl_ctx, s->sssl_certpath, SSL_FILETYPE_PEM) <= 0){
-        _dmserver_sconn_ssldeinit(s);
-        return false;
-    }
-
-    if (SSL_CTX_use_PrivateKey_file(s->sssl_ctx, s->sssl_keypath, SSL_FILETYPE_PEM) <= 0){
-        _dmserver_sconn_ssldeinit(s);
-        return false;
-    }
-
-    if (!SSL_CTX_check_private_key(s->sssl_ctx)){
-        _dmserver_sconn_ssldeinit(s);
-        return false;
-    }
     return true;
 }
 
@@ -156,14 +168,62 @@ bool _dmserver_sconn_ssldeinit(struct dmserver_servconn * s){
     if (!s) return false;
     if (!s->sssl_enable) return false;
 
-    // SSL context free:
+    // SSL context free (and a reloaded one not installed yet):
     if(s->sssl_ctx) {
         SSL_CTX_free(s->sssl_ctx);
         s->sssl_ctx = NULL;
     }
+    SSL_CTX * next = __atomic_exchange_n(&s->sssl_ctx_next, NULL, __ATOMIC_ACQ_REL);
+    if (next) SSL_CTX_free(next);
     return true;
 }
 
+/*
+    @brief Function to reload the server certificate and key into a fresh SSL context, left pending
+    until installed by _dmserver_sconn_sslswap (from the thread creating the SSL objects). The
+    connections already established keep the previous context until they close.
+
+    @param struct dmserver_servconn *s: Reference to dmserver sconn struct.
+    @param const char * scert_path: Certificate path (NULL keeps the current one).
+    @param const char * skey_path: Key path (NULL keeps the current one).
+
+    @retval true: Context loaded (paths kept for the next open).
+    @retval false: TLS disabled, invalid paths or certificate/key load failed (current context kept).
+*/
+bool _dmserver_sconn_sslreload(struct dmserver_servconn * s, const char * scert_path, const char * skey_path){
+    // Reference & en check:
+    if (!s || !s->sssl_enable) return false;
+    if (!scert_path) scert_path = s->sssl_certpath;
+    if (!skey_path) skey_path = s->sssl_keypath;
+    if ((strlen(scert_path) >= DEFAULT_SCONN_CERTPATHLEN) || (strlen(skey_path) >= DEFAULT_SCONN_KEYPATHLEN)) return false;
+
+    // Fresh context, the previous pending one (never installed) replaced:
+    SSL_CTX * ctx = _dmserver_sconn_helper_sslctx(s->sssl_method ? s->sssl_method : TLS_server_method(), scert_path, skey_path);
+    if (!ctx) return false;
+    SSL_CTX * prev = __atomic_exchange_n(&s->sssl_ctx_next, ctx, __ATOMIC_ACQ_REL);
+    if (prev) SSL_CTX_free(prev);
+
+    if (scert_path != s->sssl_certpath) __dmserver_sconn_set_certpath(s, scert_path);
+    if (skey_path != s->sssl_keypath) __dmserver_sconn_set_keypath(s, skey_path);
+    return true;
+}
+
+/*
+    @brief Function to install the pending reloaded SSL context (the previous one freed once its
+    connections close, each SSL object holding a reference).
+
+    @param struct dmserver_servconn *s: Reference to dmserver sconn struct.
+*/
+void _dmserver_sconn_sslswap(struct dmserver_servconn * s){
+    // Nothing pending (single atomic load when no reload):
+    if (!s || !__atomic_load_n(&s->sssl_ctx_next, __ATOMIC_ACQUIRE)) return;
+
+    SSL_CTX * next = __atomic_exchange_n(&s->sssl_ctx_next, NULL, __ATOMIC_ACQ_REL);
+    if (!next) return;
+    if (s->sssl_ctx) SSL_CTX_free(s->sssl_ctx);
+    s->sssl_ctx = next;
+}
+
 /*
     @brief Function to put the server socket to listen connections.
 
@@ -177,10 +237,175 @@ bool _dmserver_sconn_listen(struct dmserver_servconn * s){
     if (!s) return false;
 
     // Socket listen:
-    if (listen(s->sfd, SOMAXCONN) < 0) return false;
+    if (listen(s->sfd, s->sbacklog) < 0) return false;
+    return true;
+}
+
+/*
+    @brief Function to open a stream listener: socket, TLS context (if enabled) and listen.
+
+    @param struct dmserver_servconn *s: Reference to dmserver sconn struct.
+
+    @retval true: Open succeeded.
+    @retval false: Open failed (nothing left open).
+*/
+bool _dmserver_sconn_open(struct dmserver_servconn * s){
+    // Reference & socket type check:
+    if (!s || (s->ssocktype != SOCK_STREAM)) return false;
+
+    // Socket, TLS context & listen (undone in reverse order on failure):
+    if (!_dmserver_sconn_init(s)) return false;
+    if (s->sssl_enable && !_dmserver_sconn_sslinit(s)) {
+        _dmserver_sconn_deinit(s);
+        return false;
+    }
+    if (!_dmserver_sconn_listen(s)) {
+        _dmserver_sconn_ssldeinit(s);
+        _dmserver_sconn_deinit(s);
+        return false;
+    }
+    return true;
+}
+
+/*
+    @brief Function to close a stream listener opened with _dmserver_sconn_open.
+
+    @param struct dmserver_servconn *s: Reference to dmserver sconn struct.
+
+    @retval true: Close succeeded.
+    @retval false: Close failed.
+*/
+bool _dmserver_sconn_close(struct dmserver_servconn * s){
+    // Reference check:
+    if (!s) return false;
+
+    _dmserver_sconn_deinit(s);
+    if (s->sssl_enable) _dmserver_sconn_ssldeinit(s);
     return true;
 }
 
+/*
+    @brief Function to get the printable listening address of the server connection.
+
+    @param struct dmserver_servconn *s: Reference to dmserver sconn struct.
+    @param char * str: Output string ("address:port" or unix socket path).
+    @param size_t len: Output string size.
+
+    @retval true: Address written.
+    @retval false: Invalid references.
+*/
+bool _dmserver_sconn_addrstr(struct dmserver_servconn * s, char * str, size_t len){
+    // References check:
+    if (!s || !str || (len == 0)) return false;
+
+    if (s->ssafamily == AF_UNIX) {
+        snprintf(str, len, "%s", s->sunixpath);
+        return true;
+    }
+    char sip_str[INET6_ADDRSTRLEN];
+    const void * addr = (s->ssafamily == AF_INET) ? (void*)&s->saddr.s4.sin_addr : (void*)&s->saddr.s6.sin6_addr;
+    inet_ntop(s->ssafamily, addr, sip_str, sizeof(sip_str));
+    snprintf(str, len, "%s:%d", sip_str, s->sport);
+    return true;
+}
+
+/*
+    @brief Function to open an additional datagram socket bound to the server address (same
+    SO_REUSEPORT group as the server socket, one per subordinate thread).
+    @note: The caller owns the returned socket.
+
+    @param struct dmserver_servconn *s: Reference to dmserver sconn struct.
+
+    @retval >=0: Datagram socket file descriptor.
+    @retval -1: Socket creation failed.
+*/
+int _dmserver_sconn_dgramsocket(struct dmserver_servconn * s){
+    // Reference & socket type check:
+    if (!s || (s->ssocktype != SOCK_DGRAM)) return -1;
+
+    // Same initialization as the server socket, keeping the server socket untouched:
+    int sfd = s->sfd;
+    if (!_dmserver_sconn_init(s)) {
+        s->sfd = sfd;
+        return -1;
+    }
+    int dfd = s->sfd;
+    s->sfd = sfd;
+    return dfd;
+}
+
+/*
+    @brief Function to apply the per-connection socket tuning to an accepted client socket.
+    @note: All the options are tried even if one fails (e.g. SO_BUSY_POLL without CAP_NET_ADMIN), so
+    the caller may keep the connection with the options that succeeded.
+
+    @param struct dmserver_servconn *s: Reference to dmserver sconn struct.
+    @param int cfd: Accepted client socket file descriptor.
+
+    @retval true: All the configured options applied.
+    @retval false: One or more options failed.
+*/
+bool _dmserver_sconn_ccsetopts(struct dmserver_servconn * s, int cfd){
+    // Reference check:
+    if (!s || (cfd < 0)) return false;
+    bool ok = true;
+    int sopt = true;
+
+    // TCP options (latency), not applicable to unix domain sockets:
+    if (s->ssafamily == AF_UNIX) {
+        if ((s->ssndbuf > 0) && (setsockopt(cfd, SOL_SOCKET, SO_SNDBUF, &s->ssndbuf, sizeof(s->ssndbuf)) < 0)) ok = false;
+        if ((s->srcvbuf > 0) && (setsockopt(cfd, SOL_SOCKET, SO_RCVBUF, &s->srcvbuf, sizeof(s->srcvbuf)) < 0)) ok = false;
+        return ok;
+    }
+    if (s->snodelay && (setsockopt(cfd, IPPROTO_TCP, TCP_NODELAY, &sopt, sizeof(sopt)) < 0)) ok = false;
+    if (s->squickack && (setsockopt(cfd, IPPROTO_TCP, TCP_QUICKACK, &sopt, sizeof(sopt)) < 0)) ok = false;
+    if ((s->snotsent_lowat > 0) && (setsockopt(cfd, IPPROTO_TCP, TCP_NOTSENT_LOWAT, &s->snotsent_lowat, sizeof(s->snotsent_lowat)) < 0)) ok = false;
+    if ((s->suser_timeout > 0) && (setsockopt(cfd, IPPROTO_TCP, TCP_USER_TIMEOUT, &s->suser_timeout, sizeof(s->suser_timeout)) < 0)) ok = false;
+
+    // Socket options (buffers & busy polling):
+    if ((s->ssndbuf > 0) && (setsockopt(cfd, SOL_SOCKET, SO_SNDBUF, &s->ssndbuf, sizeof(s->ssndbuf)) < 0)) ok = false;
+    if ((s->srcvbuf > 0) && (setsockopt(cfd, SOL_SOCKET, SO_RCVBUF, &s->srcvbuf, sizeof(s->srcvbuf)) < 0)) ok = false;
+#ifdef SO_BUSY_POLL
+    if ((s->sbusy_poll > 0) && (setsockopt(cfd, SOL_SOCKET, SO_BUSY_POLL, &s->sbusy_poll, sizeof(s->sbusy_poll)) < 0)) ok = false;
+#endif
+
+    // Kernel software receive timestamps (read with every recvmsg):
+    int tsflags = DEFAULT_SCONN_RXTSTAMPFLAGS;
+    if (s->srxtstamp && (setsockopt(cfd, SOL_SOCKET, SO_TIMESTAMPING, &tsflags, sizeof(tsflags)) < 0)) ok = false;
+
+    // Keepalive (enabled when the idle time is configured):
+    if (s->skeepidle > 0) {
+        if (setsockopt(cfd, SOL_SOCKET, SO_KEEPALIVE, &sopt, sizeof(sopt)) < 0) ok = false;
+        if (setsockopt(cfd, IPPROTO_TCP, TCP_KEEPIDLE, &s->skeepidle, sizeof(s->skeepidle)) < 0) ok = false;
+        if ((s->skeepintvl > 0) && (setsockopt(cfd, IPPROTO_TCP, TCP_KEEPINTVL, &s->skeepintvl, sizeof(s->skeepintvl)) < 0)) ok = false;
+        if ((s->skeepcnt > 0) && (setsockopt(cfd, IPPROTO_TCP, TCP_KEEPCNT, &s->skeepcnt, sizeof(s->skeepcnt)) < 0)) ok = false;
+    }
+
+    return ok;
+}
+
+/*
+    @brief Function to enable the zero copy sends (SO_ZEROCOPY) of an accepted connection, only TCP
+    without TLS when configured.
+
+    @param struct dmserver_servconn *s: Reference to dmserver sconn struct (listener that accepted it).
+    @param int cfd: Accepted client socket file descriptor.
+
+    @retval >0: Minimum length of the messages sent without copy.
+    @retval 0: Not configured, not applicable or not supported by the kernel (copied sends).
+*/
+size_t _dmserver_sconn_cczerocopy(struct dmserver_servconn * s, int cfd){
+    // Reference & applicability check:
+    if (!s || (cfd < 0) || !s->szerocopy || s->sssl_enable) return 0;
+    if ((s->ssafamily == AF_UNIX) || (s->ssocktype != SOCK_STREAM)) return 0;
+
+#ifdef SO_ZEROCOPY
+    int sopt = true;
+    if (setsockopt(cfd, SOL_SOCKET, SO_ZEROCOPY, &sopt, sizeof(sopt)) == 0) return s->szerocopy;
+#endif
+    return 0;
+}
+
 
 
 
@@ -197,8 +422,11 @@ bool _dmserver_sconn_listen(struct dmserver_servconn * s){
 void __dmserver_sconn_set_defaults(dmserver_servconn_pt s){
     // Sockets defaults:
     s->sfd = -1;
+    s->sinherit_fd = -1;
+    s->shandedoff = false;
     s->sport = DEFAULT_SCONN_SPORT;
     s->ssafamily = DEFAULT_SCONN_SFAMILY;
+    s->ssocktype = DEFAULT_SCONN_SOCKTYPE;
 
     // SSL Defaults:
     s->sssl_enable = DEFAULT_SCONN_SSLENABLE;
@@ -206,6 +434,28 @@ void __dmserver_sconn_set_defaults(dmserver_servconn_pt s){
     s->sssl_certpath[DEFAULT_SCONN_CERTPATHLEN - 1] = '\0';
     strncpy(s->sssl_keypath, DEFAULT_SCONN_KEYPATHVAL, DEFAULT_SCONN_KEYPATHLEN);
     s->sssl_keypath[DEFAULT_SCONN_KEYPATHLEN - 1] = '\0';
+
+    // Unix domain socket defaults:
+    strncpy(s->sunixpath, DEFAULT_SCONN_UNIXPATHVAL, DEFAULT_SCONN_UNIXPATHLEN);
+    s->sunixpath[DEFAULT_SCONN_UNIXPATHLEN - 1] = '\0';
+    s->sunixpassfd = DEFAULT_SCONN_UNIXPASSFD;
+    s->sunixshm = DEFAULT_SCONN_UNIXSHM;
+    s->sunixshm_ring = 0;
+
+    // Socket tuning defaults (system defaults):
+    s->sbacklog = DEFAULT_SCONN_BACKLOG;
+    s->snodelay = false;
+    s->squickack = false;
+    s->ssndbuf = 0;
+    s->srcvbuf = 0;
+    s->snotsent_lowat = 0;
+    s->sbusy_poll = 0;
+    s->suser_timeout = 0;
+    s->skeepidle = 0;
+    s->skeepintvl = 0;
+    s->skeepcnt = 0;
+    s->srxtstamp = false;
+    s->szerocopy = 0;
 }
 
 /*
@@ -228,6 +478,49 @@ void __dmserver_sconn_set_safamily(dmserver_servconn_pt s, sa_family_t sa_family
     s->ssafamily = sa_family;
 }
 
+/*
+    @brief Function to configure the path of the server unix domain socket.
+
+    @param dmserver_servconn_pt s: Reference to server conn. structure.
+    @param const char * sunix_path: Unix socket path char string reference.
+*/
+void __dmserver_sconn_set_unixpath(dmserver_servconn_pt s, const char * sunix_path){
+    strncpy(s->sunixpath, sunix_path, DEFAULT_SCONN_UNIXPATHLEN);
+    s->sunixpath[DEFAULT_SCONN_UNIXPATHLEN - 1] = '\0';
+}
+
+/*
+    @brief Function to configure the file descriptors passing (SCM_RIGHTS) on unix domain clients.
+
+    @param dmserver_servconn_pt s: Reference to server conn. structure.
+    @param bool sunix_passfd: Flag to enable file descriptors passing.
+*/
+void __dmserver_sconn_set_unixpassfd(dmserver_servconn_pt s, bool sunix_passfd){
+    s->sunixpassfd = sunix_passfd;
+}
+
+/*
+    @brief Function to configure the shared memory rings transport on unix domain clients.
+
+    @param dmserver_servconn_pt s: Reference to server conn. structure.
+    @param bool sunix_shm: Flag to enable the shared memory transport.
+    @param size_t sunix_shm_ring: Bytes of each ring (0 default).
+*/
+void __dmserver_sconn_set_unixshm(dmserver_servconn_pt s, bool sunix_shm, size_t sunix_shm_ring){
+    s->sunixshm = sunix_shm;
+    s->sunixshm_ring = sunix_shm_ring;
+}
+
+/*
+    @brief Function to configure the server socket type (stream for TCP, datagram for UDP).
+    
+    @param dmserver_servconn_pt s: Reference to server conn. structure.
+    @param int socktype: Socket type (SOCK_STREAM or SOCK_DGRAM).
+*/
+void __dmserver_sconn_set_socktype(dmserver_servconn_pt s, int socktype){
+    s->ssocktype = socktype;
+}
+
 /*
     @brief Function to configure the server address ipv6 family only option.
        
@@ -268,4 +561,229 @@ void __dmserver_sconn_set_certpath(dmserver_servconn_pt s, const char * scert_pa
 void __dmserver_sconn_set_keypath(dmserver_servconn_pt s, const char * skey_path){
     strncpy(s->sssl_keypath, skey_path, DEFAULT_SCONN_KEYPATHLEN);
     s->sssl_keypath[DEFAULT_SCONN_KEYPATHLEN - 1] = '\0';
+}
+
+/*
+    @brief Function to configure the listen backlog of the server socket.
+
+    @param dmserver_servconn_pt s: Reference to server conn. structure.
+    @param int sbacklog: Maximum length of the pending connections queue.
+*/
+void __dmserver_sconn_set_backlog(dmserver_servconn_pt s, int sbacklog){
+    s->sbacklog = sbacklog;
+}
+
+/*
+    @brief Function to configure the TCP_NODELAY flag of accepted connections.
+
+    @param dmserver_servconn_pt s: Reference to server conn. structure.
+    @param bool snodelay: Flag to disable Nagle algorithm.
+*/
+void __dmserver_sconn_set_nodelay(dmserver_servconn_pt s, bool snodelay){
+    s->snodelay = snodelay;
+}
+
+/*
+    @brief Function to configure the TCP_QUICKACK flag of accepted connections.
+    @note: The kernel may leave quickack mode later on, it is only set at accept.
+
+    @param dmserver_servconn_pt s: Reference to server conn. structure.
+    @param bool squickack: Flag to enable quick acknowledgements.
+*/
+void __dmserver_sconn_set_quickack(dmserver_servconn_pt s, bool squickack){
+    s->squickack = squickack;
+}
+
+/*
+    @brief Function to configure the socket send/receive buffers size (listener and accepted connections).
+
+    @param dmserver_servconn_pt s: Reference to server conn. structure.
+    @param int ssndbuf: SO_SNDBUF size in bytes (0 for system default).
+    @param int srcvbuf: SO_RCVBUF size in bytes (0 for system default).
+*/
+void __dmserver_sconn_set_sockbufs(dmserver_servconn_pt s, int ssndbuf, int srcvbuf){
+    s->ssndbuf = ssndbuf;
+    s->srcvbuf = srcvbuf;
+}
+
+/*
+    @brief Function to configure the TCP_NOTSENT_LOWAT limit of accepted connections.
+
+    @param dmserver_servconn_pt s: Reference to server conn. structure.
+    @param int snotsent_lowat: Unsent bytes limit (0 for system default).
+*/
+void __dmserver_sconn_set_notsentlowat(dmserver_servconn_pt s, int snotsent_lowat){
+    s->snotsent_lowat = snotsent_lowat;
+}
+
+/*
+    @brief Function to configure the SO_BUSY_POLL time of accepted connections.
+
+    @param dmserver_servconn_pt s: Reference to server conn. structure.
+    @param int sbusy_poll: Busy poll time in microseconds (0 for system default).
+*/
+void __dmserver_sconn_set_busypoll(dmserver_servconn_pt s, int sbusy_poll){
+    s->sbusy_poll = sbusy_poll;
+}
+
+/*
+    @brief Function to configure the TCP_USER_TIMEOUT of accepted connections.
+
+    @param dmserver_servconn_pt s: Reference to server conn. structure.
+    @param unsigned int suser_timeout: Maximum time in milliseconds for unacknowledged data (0 for system default).
+*/
+void __dmserver_sconn_set_usertimeout(dmserver_servconn_pt s, unsigned int suser_timeout){
+    s->suser_timeout = suser_timeout;
+}
+
+/*
+    @brief Function to configure the keepalive probes of accepted connections.
+
+    @param dmserver_servconn_pt s: Reference to server conn. structure.
+    @param int skeepidle: Idle seconds before the first probe (0 to disable keepalive).
+    @param int skeepintvl: Seconds between probes (0 for system default).
+    @param int skeepcnt: Probes before dropping the connection (0 for system default).
+*/
+void __dmserver_sconn_set_keepalive(dmserver_servconn_pt s, int skeepidle, int skeepintvl, int skeepcnt){
+    s->skeepidle = skeepidle;
+    s->skeepintvl = skeepintvl;
+    s->skeepcnt = skeepcnt;
+}
+
+/*
+    @brief Function to configure the kernel software receive timestamps (SO_TIMESTAMPING) of the
+    accepted connections & datagram sockets.
+
+    @param dmserver_servconn_pt s: Reference to server conn. structure.
+    @param bool srxtstamp: Receive timestamps flag.
+*/
+void __dmserver_sconn_set_rxtstamp(dmserver_servconn_pt s, bool srxtstamp){
+    s->srxtstamp = srxtstamp;
+}
+
+/*
+    @brief Function to configure the zero copy sends (MSG_ZEROCOPY) of the accepted connections.
+
+    @param dmserver_servconn_pt s: Reference to server conn. structure.
+    @param size_t szerocopy: Minimum length of the messages sent without copy (0 disabled).
+*/
+void __dmserver_sconn_set_zerocopy(dmserver_servconn_pt s, size_t szerocopy){
+    s->szerocopy = szerocopy;
+}
+
+/*
+    @brief Function to apply a server connection configuration, the invalid values are ignored (the
+    previous value is kept).
+
+    @param dmserver_servconn_pt s: Reference to server conn. structure.
+    @param dmserver_servconn_conf_pt conf: Reference to server connection configuration struct.
+*/
+void __dmserver_sconn_set_conf(dmserver_servconn_pt s, dmserver_servconn_conf_pt conf){
+    // Server connection port configuration:
+    if (conf->sport && (conf->sport >= 1024) && (conf->sport <= 65535)) __dmserver_sconn_set_port(s, conf->sport);
+
+    // Server connection socket address configuration:
+    if (conf->ssa_family && ((conf->ssa_family == AF_INET) || (conf->ssa_family == AF_INET6) || (conf->ssa_family == AF_UNIX))) __dmserver_sconn_set_safamily(s, conf->ssa_family);
+
+    // Server unix domain socket path and file descriptors passing:
+    if (conf->sunix_path && (strlen(conf->sunix_path) < DEFAULT_SCONN_UNIXPATHLEN)) __dmserver_sconn_set_unixpath(s, conf->sunix_path);
+    __dmserver_sconn_set_unixpassfd(s, conf->sunix_passfd);
+
+    // Server unix domain shared memory transport (rings as a power of two of at least a page):
+    if (!conf->sunix_shm_ring || ((conf->sunix_shm_ring >= DEFAULT_SCONN_UNIXSHMRINGMIN) && !(conf->sunix_shm_ring & (conf->sunix_shm_ring - 1)))) __dmserver_sconn_set_unixshm(s, conf->sunix_shm, conf->sunix_shm_ring);
+
+    // Server connection socket type configuration (stream/TCP or datagram/UDP):
+    if (conf->ssock_type && ((conf->ssock_type == SOCK_STREAM) || (conf->ssock_type == SOCK_DGRAM))) __dmserver_sconn_set_socktype(s, conf->ssock_type);
+
+    // Server connection ipv6 only flag configuration:
+    __dmserver_sconn_set_ipv6only(s, conf->sipv6_only);
+    
+    // Server secure socket layer encryption flag:
+    __dmserver_sconn_set_tls(s, conf->stls_enable);
+
+    // Server ssl certification and key path:
+    if (conf->scert_path && (strlen(conf->scert_path) < DEFAULT_SCONN_CERTPATHLEN)) __dmserver_sconn_set_certpath(s, conf->scert_path);
+    if (conf->skey_path && (strlen(conf->skey_path) < DEFAULT_SCONN_KEYPATHLEN)) __dmserver_sconn_set_keypath(s, conf->skey_path);
+
+    // Server listener and accepted connections socket tuning:
+    if (conf->sbacklog > 0) __dmserver_sconn_set_backlog(s, conf->sbacklog);
+    __dmserver_sconn_set_nodelay(s, conf->stcp_nodelay);
+    __dmserver_sconn_set_quickack(s, conf->stcp_quickack);
+    if ((conf->ssndbuf_size >= 0) && (conf->srcvbuf_size >= 0)) __dmserver_sconn_set_sockbufs(s, conf->ssndbuf_size, conf->srcvbuf_size);
+    if (conf->stcp_notsent_lowat >= 0) __dmserver_sconn_set_notsentlowat(s, conf->stcp_notsent_lowat);
+    if (conf->sbusy_poll_usec >= 0) __dmserver_sconn_set_busypoll(s, conf->sbusy_poll_usec);
+    __dmserver_sconn_set_usertimeout(s, conf->stcp_user_timeout_ms);
+    if ((conf->skeepalive_idle_sec >= 0) && (conf->skeepalive_intvl_sec >= 0) && (conf->skeepalive_cnt >= 0)) 
+        __dmserver_sconn_set_keepalive(s, conf->skeepalive_idle_sec, conf->skeepalive_intvl_sec, conf->skeepalive_cnt);
+    __dmserver_sconn_set_rxtstamp(s, conf->srx_timestamps);
+    __dmserver_sconn_set_zerocopy(s, conf->stcp_zerocopy_min);
+}
+
+
+
+
+/* ---- STATIC INTERNAL - Helper functions implementation --------- */
+/*
+    @brief Helper function to take the listening socket received from a previous process as the
+    server socket (checked against the configured family & stream type).
+
+    @param dmserver_servconn_pt s: Reference to server conn. structure.
+
+    @retval true: Socket taken.
+    @retval false: Socket not matching the configuration (closed).
+*/
+static bool _dmserver_sconn_helper_inherit(dmserver_servconn_pt s){
+    int sfd = s->sinherit_fd;
+    s->sinherit_fd = -1;
+
+    // Stream socket listening on the configured family:
+    int stype = 0, slistening = 0;
+    socklen_t optlen = sizeof(int);
+    socklen_t addrlen = sizeof(s->saddr);
+    memset(&s->saddr, 0, sizeof(s->saddr));
+    if ((getsockopt(sfd, SOL_SOCKET, SO_TYPE, &stype, &optlen) < 0) || (stype != SOCK_STREAM) ||
+        (getsockopt(sfd, SOL_SOCKET, SO_ACCEPTCONN, &slistening, &optlen) < 0) || !slistening ||
+        (getsockname(sfd, (struct sockaddr *)&s->saddr, &addrlen) < 0) || (s->saddr.s4.sin_family != s->ssafamily)) {
+        close(sfd);
+        return false;
+    }
+
+    // Close at exec() & non-blocking, as a new server socket:
+    if ((fcntl(sfd, F_SETFD, FD_CLOEXEC) < 0) || (fcntl(sfd, F_SETFL, fcntl(sfd, F_GETFL) | O_NONBLOCK) < 0)) {
+        close(sfd);
+        return false;
+    }
+    s->sfd = sfd;
+    return true;
+}
+
+/*
+    @brief Helper function to create a TLS 1.3 only server context with its certificate and key.
+
+    @param const SSL_METHOD * method: SSL method.
+    @param const char * scert_path: Certificate path (PEM).
+    @param const char * skey_path: Key path (PEM).
+
+    @retval SSL context, NULL on failure.
+*/
+static SSL_CTX * _dmserver_sconn_helper_sslctx(const SSL_METHOD * method, const char * scert_path, const char * skey_path){
+    // SSL context:
+    SSL_CTX * ctx = SSL_CTX_new(method);
+    if (!ctx) return NULL;
+
+    // Only TLS 1.3:
+    SSL_CTX_set_min_proto_version(ctx, TLS1_3_VERSION);
+    SSL_CTX_set_max_proto_version(ctx, TLS1_3_VERSION);
+
+    // Disable renegotiation:
+    SSL_CTX_set_options(ctx, SSL_OP_NO_RENEGOTIATION);
+
+    // SSL server cert. and key & validation:
+    if ((SSL_CTX_use_certificate_file(ctx, scert_path, SSL_FILETYPE_PEM) <= 0) ||
+        (SSL_CTX_use_PrivateKey_file(ctx, skey_path, SSL_FILETYPE_PEM) <= 0) ||
+        !SSL_CTX_check_private_key(ctx)) {
+        SSL_CTX_free(ctx);
+        return NULL;
+    }
+    return ctx;
 }
\ No newline at end of file
@@ -0,0 +1,275 @@
+/*
+
+*/
+
+/* ---- Library --------------------------------------------------- */
+#include "../inc/_dmserver_shards.h"
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+
+/* ---- Helper functions implementation prototypes ---------------- */
+static dmserver_shardmsg_pt _dmserver_shards_helper_slot(dmserver_shards_pt s, size_t shard, size_t pos);
+
+
+
+
+/* ---- INTERNAL - Functions implementation ----------------------- */
+// ======== General use:
+/*
+    @brief Function to create the shards bus: a shared anonymous mapping (inherited by the forked
+    shards) with one inbox ring per shard and its wake up eventfd.
+
+    @param dmserver_shards_pt s: Reference to shards.
+    @param dmserver_shards_conf_pt conf: Shards configuration (2..DEFAULT_SHARDS_MAX shards).
+
+    @retval true: Bus created.
+    @retval false: Invalid configuration or allocation failed.
+*/
+bool _dmserver_shards_create(dmserver_shards_pt s, dmserver_shards_conf_pt conf){
+    // References & configuration check (ring slots as a power of two):
+    if (!s || !conf || (conf->snshards < 2) || (conf->snshards > DEFAULT_SHARDS_MAX)) return false;
+    size_t slots = conf->sring_slots ? conf->sring_slots : DEFAULT_SHARDS_RINGSLOTS;
+    size_t msglen = conf->smsg_len ? conf->smsg_len : DEFAULT_SHARDS_MSGLEN;
+    if ((slots < 2) || (slots & (slots - 1))) return false;
+    memset(s, 0, sizeof(dmserver_shards_t));
+
+    // Layout: rings, then the slots of every ring (cache line strides):
+    s->snshards = conf->snshards;
+    s->sring_slots = slots;
+    s->smsg_len = msglen;
+    s->sstride = (sizeof(dmserver_shardmsg_t) + msglen + 1 + DEFAULT_SHARDS_CACHELINE - 1) & ~(size_t)(DEFAULT_SHARDS_CACHELINE - 1);
+    size_t rings_len = s->snshards * sizeof(struct dmserver_shardring);
+    s->sbus_len = rings_len + s->snshards * slots * s->sstride;
+    s->sbus = mmap(NULL, s->sbus_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (s->sbus == MAP_FAILED) {
+        s->sbus = NULL;
+        return false;
+    }
+    s->srings = (struct dmserver_shardring *)s->sbus;
+    s->sslots = (char *)s->sbus + rings_len;
+
+    // Rings (empty, every slot ready for its first position) & wake up eventfds:
+    for (size_t i = 0; i < s->snshards; i++){
+        s->srings[i].revfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (s->srings[i].revfd < 0) {
+            for (size_t j = 0; j < i; j++) close(s->srings[j].revfd);
+            munmap(s->sbus, s->sbus_len);
+            memset(s, 0, sizeof(dmserver_shards_t));
+            return false;
+        }
+        for (size_t j = 0; j < slots; j++) _dmserver_shards_helper_slot(s, i, j)->mseq = j;
+    }
+    return true;
+}
+
+/*
+    @brief Function to destroy the shards bus mapping of this process (the other shards keep theirs).
+
+    @param dmserver_shards_pt s: Reference to shards.
+
+    @retval true: Bus destroyed.
+    @retval false: No bus.
+*/
+bool _dmserver_shards_destroy(dmserver_shards_pt s){
+    // Reference check:
+    if (!s || !s->sbus) return false;
+
+    for (size_t i = 0; i < s->snshards; i++) close(s->srings[i].revfd);
+    munmap(s->sbus, s->sbus_len);
+    memset(s, 0, sizeof(dmserver_shards_t));
+    return true;
+}
+
+// ======== Processes:
+/*
+    @brief Function to fork the shards processes: the caller becomes shard 0 and its children shards
+    1..n-1 (killed with their parent). Every process returns from here with its own shard index.
+    @note: Only the calling thread exists in the children.
+
+    @param dmserver_shards_pt s: Reference to shards (bus created).
+
+    @retval true: Shards forked (shard index set).
+    @retval false: Fork failed (children already forked killed).
+*/
+bool _dmserver_shards_fork(dmserver_shards_pt s){
+    // Reference check:
+    if (!s || !s->sbus) return false;
+
+    pid_t parent = getpid();
+    for (size_t i = 1; i < s->snshards; i++){
+        pid_t pid = fork();
+        if (pid < 0) {
+            for (size_t j = 1; j < i; j++) {
+                kill(s->spids[j], SIGTERM);
+                waitpid(s->spids[j], NULL, 0);
+            }
+            memset(s->spids, 0, sizeof(s->spids));
+            return false;
+        }
+
+        // Child shard, terminated with its parent (even if gone before the request):
+        if (pid == 0) {
+            memset(s->spids, 0, sizeof(s->spids));
+            s->sshard = i;
+            prctl(PR_SET_PDEATHSIG, SIGTERM);
+            if (getppid() != parent) _exit(1);
+            return true;
+        }
+        s->spids[i] = pid;
+    }
+    s->sshard = 0;
+    return true;
+}
+
+// ======== Producers:
+/*
+    @brief Function to push a message to the inbox ring of another shard (lock-free, the payload copied
+    once into the ring slot) and wake its main thread up if it was idle.
+
+    @param dmserver_shards_pt s: Reference to shards.
+    @param size_t shard: Destination shard (not this one).
+    @param enum dmserver_shardmsg_type type: Message type.
+    @param dmserver_cliloc_pt loc: Client location (unicast only, NULL otherwise).
+    @param const char * data: Payload.
+    @param size_t len: Payload length (up to the message length).
+
+    @retval true: Message pushed.
+    @retval false: Invalid arguments or ring full (dropped).
+*/
+bool _dmserver_shards_push(dmserver_shards_pt s, size_t shard, enum dmserver_shardmsg_type type, dmserver_cliloc_pt loc, const char * data, size_t len){
+    // References & bounds check:
+    if (!s || !s->sbus || !data || (shard >= s->snshards) || (shard == s->sshard) || (len > s->smsg_len)) return false;
+    struct dmserver_shardring * r = &s->srings[shard];
+
+    // Enqueue position claimed when its slot is free (a slot behind means a full ring):
+    size_t pos = __atomic_load_n(&r->rhead, __ATOMIC_RELAXED);
+    dmserver_shardmsg_pt m;
+    while (true){
+        m = _dmserver_shards_helper_slot(s, shard, pos);
+        intptr_t diff = (intptr_t)__atomic_load_n(&m->mseq, __ATOMIC_ACQUIRE) - (intptr_t)pos;
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&r->rhead, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+        }
+        else if (diff < 0) {
+            __atomic_add_fetch(&s->sdropped, 1, __ATOMIC_RELAXED);
+            return false;
+        }
+        else pos = __atomic_load_n(&r->rhead, __ATOMIC_RELAXED);
+    }
+
+    // Slot written & published to the consumer:
+    m->mtype = type;
+    m->msrc = s->sshard;
+    m->mloc = loc ? *loc : (struct dmserver_cliloc){0};
+    m->mlen = len;
+    memcpy(m->mdata, data, len);
+    m->mdata[len] = '\0';
+    __atomic_store_n(&m->mseq, pos + 1, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&s->ssent, 1, __ATOMIC_RELAXED);
+
+    // Consumer woken up only on the first pending message:
+    if (__atomic_fetch_add(&r->rpending, 1, __ATOMIC_SEQ_CST) == 0) eventfd_write(r->revfd, 1);
+    return true;
+}
+
+/*
+    @brief Function to push a broadcast to every other shard.
+
+    @param dmserver_shards_pt s: Reference to shards.
+    @param const char * data: Payload.
+    @param size_t len: Payload length.
+
+    @retval true: Pushed to every other shard.
+    @retval false: Dropped by one or more shards (ring full or payload too long).
+*/
+bool _dmserver_shards_broadcast(dmserver_shards_pt s, const char * data, size_t len){
+    // Reference check:
+    if (!s || !s->sbus) return false;
+
+    bool ok = true;
+    for (size_t i = 0; i < s->snshards; i++){
+        if ((i != s->sshard) && !_dmserver_shards_push(s, i, DMSERVER_SHARDMSG_BROADCAST, NULL, data, len)) ok = false;
+    }
+    return ok;
+}
+
+// ======== Consumer:
+/*
+    @brief Function to get the wake up eventfd of this shard inbox.
+
+    @param dmserver_shards_pt s: Reference to shards.
+
+    @retval Eventfd, -1 without bus.
+*/
+int _dmserver_shards_evfd(dmserver_shards_pt s){
+    if (!s || !s->sbus) return -1;
+    return s->srings[s->sshard].revfd;
+}
+
+/*
+    @brief Function to acknowledge a wake up before draining the inbox (the producers wake it up again
+    for any message pushed after this point).
+
+    @param dmserver_shards_pt s: Reference to shards.
+*/
+void _dmserver_shards_ack(dmserver_shards_pt s){
+    if (!s || !s->sbus) return;
+    struct dmserver_shardring * r = &s->srings[s->sshard];
+
+    eventfd_t evval;
+    eventfd_read(r->revfd, &evval);
+    __atomic_exchange_n(&r->rpending, 0, __ATOMIC_SEQ_CST);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+/*
+    @brief Function to get the next message of this shard inbox, read in place until released.
+
+    @param dmserver_shards_pt s: Reference to shards.
+
+    @retval Next message, NULL when the inbox is empty.
+*/
+dmserver_shardmsg_pt _dmserver_shards_peek(dmserver_shards_pt s){
+    if (!s || !s->sbus) return NULL;
+    struct dmserver_shardring * r = &s->srings[s->sshard];
+
+    size_t pos = __atomic_load_n(&r->rtail, __ATOMIC_RELAXED);
+    dmserver_shardmsg_pt m = _dmserver_shards_helper_slot(s, s->sshard, pos);
+    if (__atomic_load_n(&m->mseq, __ATOMIC_ACQUIRE) != pos + 1) return NULL;
+    return m;
+}
+
+/*
+    @brief Function to release the message got with _dmserver_shards_peek (its slot free for the
+    producers one lap later).
+
+    @param dmserver_shards_pt s: Reference to shards.
+    @param dmserver_shardmsg_pt m: Message.
+*/
+void _dmserver_shards_release(dmserver_shards_pt s, dmserver_shardmsg_pt m){
+    if (!s || !s->sbus || !m) return;
+    struct dmserver_shardring * r = &s->srings[s->sshard];
+
+    size_t pos = __atomic_load_n(&r->rtail, __ATOMIC_RELAXED);
+    __atomic_store_n(&m->mseq, pos + s->sring_slots, __ATOMIC_RELEASE);
+    __atomic_store_n(&r->rtail, pos + 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&s->sreceived, 1, __ATOMIC_RELAXED);
+}
+
+
+
+
+/* ---- STATIC INTERNAL - Helper functions implementation --------- */
+/*
+    @brief Helper function to get the slot of a ring position.
+
+    @param dmserver_shards_pt s: Reference to shards.
+    @param size_t shard: Ring shard.
+    @param size_t pos: Ring position.
+
+    @retval Slot message.
+*/
+static dmserver_shardmsg_pt _dmserver_shards_helper_slot(dmserver_shards_pt s, size_t shard, size_t pos){
+    return (dmserver_shardmsg_pt)(s->sslots + (shard * s->sring_slots + (pos & (s->sring_slots - 1))) * s->sstride);
+}
\ No newline at end of file
@@ -0,0 +1,480 @@
+/*
+
+*/
+
+/* ---- Library --------------------------------------------------- */
+#include "../inc/_dmserver_shm.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <poll.h>
+
+/* ---- Helper functions implementation prototypes ---------------- */
+static dmserver_shmring_pt _dmserver_shm_helper_ring(dmserver_shmconn_pt c, bool out, char ** data);
+static size_t _dmserver_shm_helper_stride(size_t len);
+static bool _dmserver_shm_helper_map(dmserver_shmconn_pt c, int memfd, size_t seg_len);
+
+
+
+
+/* ---- INTERNAL - Functions implementation ----------------------- */
+// ======== General use:
+/*
+    @brief Function to initialize a shared memory connection (nothing mapped, no descriptors).
+
+    @param dmserver_shmconn_pt c: Reference to shared memory connection.
+*/
+void _dmserver_shm_init(dmserver_shmconn_pt c){
+    // Reference check:
+    if (!c) return;
+
+    memset(c, 0, sizeof(dmserver_shmconn_t));
+    c->sevsrc.etype = DMSERVER_EVSRC_SHM;
+    c->smemfd = -1;
+    c->sevfd_srv = -1;
+    c->sevfd_cli = -1;
+    c->ssock = -1;
+}
+
+/*
+    @brief Function to create the server end of a shared memory connection: a sealed memfd (its size
+    can not be changed by the client) mapped with both rings empty & the eventfds of both ends.
+
+    @param dmserver_shmconn_pt c: Reference to shared memory connection (initialized).
+    @param size_t ring_len: Data area of each ring in bytes (power of two, 0 default).
+
+    @retval true: Connection created (memfd kept until offered).
+    @retval false: Invalid length or allocation failed (nothing left open).
+*/
+bool _dmserver_shm_create(dmserver_shmconn_pt c, size_t ring_len){
+    // References & length check:
+    if (!c || c->sseg) return false;
+    if (ring_len == 0) ring_len = DEFAULT_SHM_RINGLEN;
+    if ((ring_len < DEFAULT_SHM_RINGMINLEN) || (ring_len & (ring_len - 1))) return false;
+
+    // Segment (header & both data areas), sealed once sized:
+    size_t seg_len = sizeof(struct dmserver_shmseg) + 2 * ring_len;
+    int memfd = memfd_create("dmserver-shm", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (memfd < 0) return false;
+    if ((ftruncate(memfd, (off_t)seg_len) < 0) || (fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) < 0) || !_dmserver_shm_helper_map(c, memfd, seg_len)) {
+        close(memfd);
+        return false;
+    }
+    c->sseg->smagic = DEFAULT_SHM_MAGIC;
+    c->sseg->sring_len = ring_len;
+    c->sring_len = ring_len;
+
+    // Server taken as sleeping until its first sweep (its subthread may be blocked already):
+    c->sseg->sc2s.rwait = 1;
+    c->smemfd = memfd;
+    c->sserver = true;
+
+    // Eventfds of both ends:
+    c->sevfd_srv = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    c->sevfd_cli = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if ((c->sevfd_srv < 0) || (c->sevfd_cli < 0)) {
+        _dmserver_shm_close(c);
+        return false;
+    }
+    return true;
+}
+
+/*
+    @brief Function to offer the server end of a shared memory connection to its client: the memfd &
+    both eventfds are sent over the accepted unix domain socket (SCM_RIGHTS), the memfd closed here
+    afterwards (the mapping stays).
+    @note: The socket is newly accepted, its send buffer takes the single message right away.
+
+    @param dmserver_shmconn_pt c: Reference to shared memory connection (created).
+    @param int sock: Accepted unix domain socket of the client.
+
+    @retval true: Descriptors sent.
+    @retval false: Send failed.
+*/
+bool _dmserver_shm_offer(dmserver_shmconn_pt c, int sock){
+    // References check:
+    if (!c || !c->sseg || (c->smemfd < 0) || (sock < 0)) return false;
+
+    // Single byte & the descriptors (memfd, server eventfd, client eventfd):
+    int fds[3] = {c->smemfd, c->sevfd_srv, c->sevfd_cli};
+    union{
+        char buf[CMSG_SPACE(sizeof(fds))];
+        struct cmsghdr align;
+    }cbuf;
+    memset(&cbuf, 0, sizeof(cbuf));
+    struct iovec iov = {.iov_base="S", .iov_len=1};
+    struct msghdr msg = {.msg_iov=&iov, .msg_iovlen=1, .msg_control=cbuf.buf, .msg_controllen=sizeof(cbuf.buf)};
+    struct cmsghdr * cm = CMSG_FIRSTHDR(&msg);
+    cm->cmsg_level = SOL_SOCKET;
+    cm->cmsg_type = SCM_RIGHTS;
+    cm->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cm), fds, sizeof(fds));
+    if (sendmsg(sock, &msg, MSG_NOSIGNAL) != 1) return false;
+
+    close(c->smemfd);
+    c->smemfd = -1;
+    return true;
+}
+
+/*
+    @brief Function to serve a shared memory connection to a newly accepted client: server end created,
+    offered through its socket & its eventfd registered in the epoll given (the connection itself as
+    event source).
+
+    @param dmserver_shmconn_pt c: Reference to shared memory connection (initialized).
+    @param int sock: Accepted unix domain socket of the client.
+    @param size_t ring_len: Data area of each ring in bytes (power of two, 0 default).
+    @param int epfd: Epoll of the subthread serving the client.
+
+    @retval true: Connection served.
+    @retval false: Creation, offer or registration failed (nothing left open).
+*/
+bool _dmserver_shm_serve(dmserver_shmconn_pt c, int sock, size_t ring_len, int epfd){
+    // Rings offered to the client:
+    if (!_dmserver_shm_create(c, ring_len) || !_dmserver_shm_offer(c, sock)) {
+        _dmserver_shm_close(c);
+        return false;
+    }
+
+    // Client signals (frames or ring space while the server sleeps):
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, c->sevfd_srv, &(struct epoll_event){.events=EPOLLIN|EPOLLET, .data.ptr=c}) < 0) {
+        _dmserver_shm_close(c);
+        return false;
+    }
+    return true;
+}
+
+/*
+    @brief Function to attach the client end of a shared memory connection: connect to the unix domain
+    listener, wait for the descriptors offered by the server, map & validate the segment.
+
+    @param dmserver_shmconn_pt c: Reference to shared memory connection (initialized).
+    @param const char * path: Unix domain socket path of the listener.
+    @param size_t wait_ms: Maximum time waiting for the server offer.
+
+    @retval true: Connection attached (socket kept as liveness channel).
+    @retval false: Connection refused, timeout, not a shared memory listener or invalid segment.
+*/
+bool _dmserver_shm_attach(dmserver_shmconn_pt c, const char * path, size_t wait_ms){
+    // References check:
+    if (!c || c->sseg || !path || (strlen(path) >= sizeof(((struct sockaddr_un *)0)->sun_path))) return false;
+
+    // Connection to the listener:
+    struct sockaddr_un addr = {.sun_family=AF_UNIX};
+    strcpy(addr.sun_path, path);
+    c->ssock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (c->ssock < 0) return false;
+    if (connect(c->ssock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        _dmserver_shm_close(c);
+        return false;
+    }
+
+    // Server offer (single byte & three descriptors):
+    struct pollfd pfd = {.fd=c->ssock, .events=POLLIN};
+    if (poll(&pfd, 1, (int)wait_ms) != 1) {
+        _dmserver_shm_close(c);
+        return false;
+    }
+    char b = 0;
+    union{
+        char buf[CMSG_SPACE(sizeof(int) * 3)];
+        struct cmsghdr align;
+    }cbuf;
+    struct iovec iov = {.iov_base=&b, .iov_len=1};
+    struct msghdr msg = {.msg_iov=&iov, .msg_iovlen=1, .msg_control=cbuf.buf, .msg_controllen=sizeof(cbuf.buf)};
+    struct cmsghdr * cm = (recvmsg(c->ssock, &msg, MSG_CMSG_CLOEXEC) == 1) ? CMSG_FIRSTHDR(&msg) : NULL;
+    if (!cm || (cm->cmsg_level != SOL_SOCKET) || (cm->cmsg_type != SCM_RIGHTS)) {
+        _dmserver_shm_close(c);
+        return false;
+    }
+    int fds[3] = {-1, -1, -1};
+    size_t nfds = (cm->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+    memcpy(fds, CMSG_DATA(cm), ((nfds < 3) ? nfds : 3) * sizeof(int));
+    c->sevfd_srv = fds[1];
+    c->sevfd_cli = fds[2];
+
+    // Segment mapping & validation (the memfd not needed once mapped):
+    struct stat st;
+    bool ok = (b == 'S') && (nfds == 3) && (fstat(fds[0], &st) == 0) && ((size_t)st.st_size > sizeof(struct dmserver_shmseg)) && _dmserver_shm_helper_map(c, fds[0], (size_t)st.st_size);
+    if (fds[0] >= 0) close(fds[0]);
+    if (ok) {
+        c->sring_len = c->sseg->sring_len;
+        ok = (c->sseg->smagic == DEFAULT_SHM_MAGIC) && (c->sring_len >= DEFAULT_SHM_RINGMINLEN) && !(c->sring_len & (c->sring_len - 1)) && (c->sseg_len == sizeof(struct dmserver_shmseg) + 2 * c->sring_len);
+    }
+    if (!ok) {
+        _dmserver_shm_close(c);
+        return false;
+    }
+    c->sserver = false;
+    return true;
+}
+
+/*
+    @brief Function to close a shared memory connection end (mapping & descriptors, the connection
+    socket included when owned).
+
+    @param dmserver_shmconn_pt c: Reference to shared memory connection.
+*/
+void _dmserver_shm_close(dmserver_shmconn_pt c){
+    // Reference check:
+    if (!c) return;
+
+    if (c->sseg) munmap(c->sseg, c->sseg_len);
+    if (c->smemfd >= 0) close(c->smemfd);
+    if (c->sevfd_srv >= 0) close(c->sevfd_srv);
+    if (c->sevfd_cli >= 0) close(c->sevfd_cli);
+    if (c->ssock >= 0) close(c->ssock);
+    _dmserver_shm_init(c);
+}
+
+// ======== Frames:
+/*
+    @brief Function to get the largest payload of a frame (a frame fits an empty ring whatever its
+    positions are).
+
+    @param dmserver_shmconn_pt c: Reference to shared memory connection.
+
+    @retval Maximum payload length (0 not mapped).
+*/
+size_t _dmserver_shm_maxlen(dmserver_shmconn_pt c){
+    if (!c || !c->sseg) return 0;
+    return c->sring_len / 2 - sizeof(size_t);
+}
+
+/*
+    @brief Function to write a frame to the own output ring (payload copied into the ring, published
+    with the tail). When the ring is full, the producer flags it so that the consumer signals once
+    it frees space.
+    @note: The other end is not signalled here, _dmserver_shm_notify after the batch.
+
+    @param dmserver_shmconn_pt c: Reference to shared memory connection.
+    @param const char * data: Payload.
+    @param size_t len: Payload length (up to the maximum payload length).
+
+    @retval true: Frame written.
+    @retval false: Ring full or payload too long.
+*/
+bool _dmserver_shm_send(dmserver_shmconn_pt c, const char * data, size_t len){
+    // References & length check:
+    if (!c || !c->sseg || (!data && len) || (len > _dmserver_shm_maxlen(c))) return false;
+    char * d = NULL;
+    dmserver_shmring_pt r = _dmserver_shm_helper_ring(c, true, &d);
+    size_t rlen = c->sring_len;
+
+    // Space of the frame (with the end of the data area skipped if it does not fit there):
+    size_t tail = r->rtail;
+    size_t off = tail & (rlen - 1);
+    size_t need = _dmserver_shm_helper_stride(len);
+    size_t skip = (rlen - off < need) ? rlen - off : 0;
+    if (tail + skip + need - __atomic_load_n(&r->rhead, __ATOMIC_ACQUIRE) > rlen) {
+        // Full, flagged and checked again (the consumer may have freed space meanwhile):
+        __atomic_store_n(&r->rspace_wait, 1, __ATOMIC_SEQ_CST);
+        if (tail + skip + need - __atomic_load_n(&r->rhead, __ATOMIC_SEQ_CST) > rlen) return false;
+    }
+
+    // Frame written & published:
+    if (skip) {
+        *(size_t *)(d + off) = DEFAULT_SHM_SKIP;
+        tail += skip;
+        off = 0;
+    }
+    *(size_t *)(d + off) = len;
+    if (len) memcpy(d + off + sizeof(size_t), data, len);
+    __atomic_store_n(&r->rtail, tail + need, __ATOMIC_RELEASE);
+    return true;
+}
+
+/*
+    @brief Function to get the next frame of the own input ring (payload read in place, valid until
+    released).
+
+    @param dmserver_shmconn_pt c: Reference to shared memory connection.
+    @param size_t * len: Output payload length.
+
+    @retval Payload of the frame, NULL if the ring is empty.
+*/
+const char * _dmserver_shm_peek(dmserver_shmconn_pt c, size_t * len){
+    // References check:
+    if (!c || !c->sseg || !len) return NULL;
+    char * d = NULL;
+    dmserver_shmring_pt r = _dmserver_shm_helper_ring(c, false, &d);
+    size_t rlen = c->sring_len;
+
+    size_t head = r->rhead;
+    size_t tail = __atomic_load_n(&r->rtail, __ATOMIC_ACQUIRE);
+    while (head != tail){
+        // End of the data area skipped by the producer:
+        size_t off = head & (rlen - 1);
+        size_t flen = *(size_t *)(d + off);
+        if (flen == DEFAULT_SHM_SKIP) {
+            head += rlen - off;
+            __atomic_store_n(&r->rhead, head, __ATOMIC_RELEASE);
+            continue;
+        }
+
+        // Corrupted frame (written by the other end), the rest of the ring dropped:
+        if ((flen > _dmserver_shm_maxlen(c)) || (off + _dmserver_shm_helper_stride(flen) > rlen)) {
+            __atomic_store_n(&r->rhead, tail, __ATOMIC_RELEASE);
+            return NULL;
+        }
+        *len = flen;
+        return d + off + sizeof(size_t);
+    }
+    return NULL;
+}
+
+/*
+    @brief Function to release the frame returned by the last peek (its space given back to the producer).
+
+    @param dmserver_shmconn_pt c: Reference to shared memory connection.
+*/
+void _dmserver_shm_release(dmserver_shmconn_pt c){
+    // References check:
+    if (!c || !c->sseg) return;
+    char * d = NULL;
+    dmserver_shmring_pt r = _dmserver_shm_helper_ring(c, false, &d);
+
+    size_t head = r->rhead;
+    if (head == __atomic_load_n(&r->rtail, __ATOMIC_ACQUIRE)) return;
+    size_t flen = *(size_t *)(d + (head & (c->sring_len - 1)));
+    __atomic_store_n(&r->rhead, head + _dmserver_shm_helper_stride(flen), __ATOMIC_RELEASE);
+}
+
+// ======== Wake ups:
+/*
+    @brief Function to flag the own input ring before sleeping on the own eventfd, checked again
+    afterwards (a frame published meanwhile would not be signalled).
+
+    @param dmserver_shmconn_pt c: Reference to shared memory connection.
+
+    @retval true: Input ring empty, the other end signals the next frame.
+    @retval false: Frames pending (flag cleared), not to sleep.
+*/
+bool _dmserver_shm_sleep(dmserver_shmconn_pt c){
+    // References check:
+    if (!c || !c->sseg) return true;
+    char * d = NULL;
+    dmserver_shmring_pt r = _dmserver_shm_helper_ring(c, false, &d);
+
+    __atomic_store_n(&r->rwait, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&r->rtail, __ATOMIC_SEQ_CST) == r->rhead) return true;
+    __atomic_store_n(&r->rwait, 0, __ATOMIC_RELAXED);
+    return false;
+}
+
+/*
+    @brief Function to signal the other end after a batch of frames when it is sleeping: frames
+    written to its input ring or space freed in its output ring. Nothing but a fence and two loads
+    while the other end is polling.
+
+    @param dmserver_shmconn_pt c: Reference to shared memory connection.
+*/
+void _dmserver_shm_notify(dmserver_shmconn_pt c){
+    // References check:
+    if (!c || !c->sseg) return;
+    char * d = NULL;
+    dmserver_shmring_pt out = _dmserver_shm_helper_ring(c, true, &d);
+    dmserver_shmring_pt in = _dmserver_shm_helper_ring(c, false, &d);
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    bool wake = false;
+    if (__atomic_load_n(&out->rwait, __ATOMIC_RELAXED) && __atomic_exchange_n(&out->rwait, 0, __ATOMIC_ACQ_REL)) wake = true;
+    if (__atomic_load_n(&in->rspace_wait, __ATOMIC_RELAXED) && __atomic_exchange_n(&in->rspace_wait, 0, __ATOMIC_ACQ_REL)) wake = true;
+    if (wake) eventfd_write(c->sserver ? c->sevfd_cli : c->sevfd_srv, 1);
+}
+
+/*
+    @brief Function to get the eventfd the own end sleeps on.
+
+    @param dmserver_shmconn_pt c: Reference to shared memory connection.
+
+    @retval Eventfd (-1 not created/attached).
+*/
+int _dmserver_shm_evfd(dmserver_shmconn_pt c){
+    if (!c) return -1;
+    return c->sserver ? c->sevfd_srv : c->sevfd_cli;
+}
+
+/*
+    @brief Function to sleep on the own eventfd of the client end until the server signals it, also
+    watching the connection socket (closed by the server when the client is disconnected).
+    @note: The input ring must be flagged before (_dmserver_shm_sleep).
+
+    @param dmserver_shmconn_pt c: Reference to shared memory connection (client end).
+    @param int timeout_ms: Maximum time sleeping (-1 no limit).
+
+    @retval 1: Signalled by the server.
+    @retval 0: Timeout.
+    @retval -1: Server gone (connection closed).
+*/
+int _dmserver_shm_wait(dmserver_shmconn_pt c, int timeout_ms){
+    // References check:
+    if (!c || !c->sseg || (c->ssock < 0)) return -1;
+
+    struct pollfd pfds[2] = {{.fd=c->sevfd_cli, .events=POLLIN}, {.fd=c->ssock, .events=POLLIN}};
+    int n = poll(pfds, 2, timeout_ms);
+    if ((n < 0) && (errno == EINTR)) return 0;
+    if (n < 0) return -1;
+
+    // Connection socket readable, only its end is expected:
+    if (pfds[1].revents) {
+        char b;
+        ssize_t rb = recv(c->ssock, &b, 1, MSG_DONTWAIT);
+        if ((rb == 0) || ((rb < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK))) return -1;
+    }
+    if (pfds[0].revents) {
+        eventfd_t evval;
+        eventfd_read(c->sevfd_cli, &evval);
+        return 1;
+    }
+    return 0;
+}
+
+
+
+
+/* ---- STATIC INTERNAL - Helper functions implementation --------- */
+/*
+    @brief Helper function that returns a ring of a connection end with its data area: the output ring
+    is the server to client one on the server end, the client to server one on the client end.
+
+    @param dmserver_shmconn_pt c: Reference to shared memory connection (mapped).
+    @param bool out: Output ring (true) or input ring (false) of this end.
+    @param char ** data: Output data area of the ring.
+
+    @retval Reference to the ring.
+*/
+static dmserver_shmring_pt _dmserver_shm_helper_ring(dmserver_shmconn_pt c, bool out, char ** data){
+    char * areas = (char *)c->sseg + sizeof(struct dmserver_shmseg);
+    bool c2s = (out != c->sserver);
+    *data = c2s ? areas : areas + c->sring_len;
+    return c2s ? &c->sseg->sc2s : &c->sseg->ss2c;
+}
+
+/*
+    @brief Helper function that returns the ring space of a frame (length header & payload, 8 bytes aligned).
+
+    @param size_t len: Payload length.
+
+    @retval Frame space in bytes.
+*/
+static size_t _dmserver_shm_helper_stride(size_t len){
+    return (sizeof(size_t) + len + 7) & ~(size_t)7;
+}
+
+/*
+    @brief Helper function that maps a shared memory segment.
+
+    @param dmserver_shmconn_pt c: Reference to shared memory connection.
+    @param int memfd: Segment memfd.
+    @param size_t seg_len: Segment length.
+
+    @retval true: Segment mapped.
+    @retval false: Mapping failed.
+*/
+static bool _dmserver_shm_helper_map(dmserver_shmconn_pt c, int memfd, size_t seg_len){
+    void * seg = mmap(NULL, seg_len, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    if (seg == MAP_FAILED) return false;
+    c->sseg = (struct dmserver_shmseg *)seg;
+    c->sseg_len = seg_len;
+    return true;
+}
\ No newline at end of file
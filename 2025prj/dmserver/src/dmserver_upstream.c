@@ -0,0 +1,443 @@
+/*
+
+*/
+
+/* ---- Library --------------------------------------------------- */
+#include "../inc/_dmserver_upstream.h"
+
+/* ---- Helper functions implementation prototypes ---------------- */
+static void _dmserver_upstream_helper_free(dmserver_upstream_pt u);
+static bool _dmserver_upstream_helper_sslinit(dmserver_upstream_pt u);
+
+
+
+
+/* ---- INTERNAL - Functions implementation ----------------------- */
+// ======== Upstreams list:
+/*
+    @brief Function to initialize the upstreams list (empty).
+
+    @param dmserver_upstreams_pt ups: Reference to upstreams list.
+
+    @retval true: Initialization succeeded.
+    @retval false: Initialization failed.
+*/
+bool _dmserver_upstreams_init(dmserver_upstreams_pt ups){
+    // Reference check:
+    if (!ups) return false;
+    memset(ups, 0, sizeof(dmserver_upstreams_t));
+
+    if (pthread_mutex_init(&ups->ulock, NULL)) return false;
+    return true;
+}
+
+/*
+    @brief Function to deinitialize the upstreams list, freeing every upstream.
+    @note: No client can reference the upstreams anymore (worker threads stopped).
+
+    @param dmserver_upstreams_pt ups: Reference to upstreams list.
+
+    @retval true: Deinitialization succeeded.
+    @retval false: Deinitialization failed.
+*/
+bool _dmserver_upstreams_deinit(dmserver_upstreams_pt ups){
+    // Reference check:
+    if (!ups) return false;
+
+    for (size_t i = 0; i < ups->uups_count; i++) _dmserver_upstream_helper_free(ups->uups[i]);
+    if (ups->uups) free(ups->uups);
+    ups->uups = NULL;
+    ups->uups_count = 0;
+    ups->uups_size = 0;
+    pthread_mutex_destroy(&ups->ulock);
+    return true;
+}
+
+/*
+    @brief Function to add an upstream to the list, resolving its endpoint and creating its TLS client
+    context. Its pool members are due to connect right away.
+    @note: The host name resolution blocks the caller.
+
+    @param dmserver_upstreams_pt ups: Reference to upstreams list.
+    @param dmserver_upstream_conf_pt conf: Reference to upstream configuration.
+    @param size_t * upid: Output upstream id.
+
+    @retval true: Upstream added.
+    @retval false: Invalid configuration, resolution or allocation failed.
+*/
+bool _dmserver_upstreams_add(dmserver_upstreams_pt ups, dmserver_upstream_conf_pt conf, size_t * upid){
+    // References check:
+    if (!ups || !conf || !conf->uhost || !conf->uhost[0] || (strlen(conf->uhost) >= DEFAULT_UPSTREAM_HOSTLEN)) return false;
+    if ((conf->uport <= 0) || (conf->uport > 65535)) return false;
+
+    // Upstream connection data (resolved address & TLS client context):
+    dmserver_upstream_pt u = calloc(1, sizeof(dmserver_upstream_t));
+    if (!u) return false;
+    if (pthread_mutex_init(&u->ulock, NULL)) {
+        free(u);
+        return false;
+    }
+    strcpy(u->uhost, conf->uhost);
+    __dmserver_sconn_set_defaults(&u->uconn);
+    __dmserver_sconn_set_tls(&u->uconn, conf->utls);
+    u->uverify = conf->utls_verify;
+    if (!_dmserver_upstream_resolve(&u->uconn, conf->uhost, conf->uport) || (conf->utls && !_dmserver_upstream_helper_sslinit(u))) {
+        _dmserver_upstream_helper_free(u);
+        return false;
+    }
+
+    // Callbacks set (own or the server ones):
+    u->ucallback_own = (conf->ucallback != NULL);
+    if (conf->ucallback) {
+        __dmserver_setcb_onclientconnect(&u->ucallback, conf->ucallback->on_client_connect);
+        __dmserver_setcb_onclientdisconnect(&u->ucallback, conf->ucallback->on_client_disconnect);
+        __dmserver_setcb_onclienttimeout(&u->ucallback, conf->ucallback->on_client_timeout);
+        __dmserver_setcb_onclientrcv(&u->ucallback, conf->ucallback->on_client_rcv);
+        __dmserver_setcb_onclientsnd(&u->ucallback, conf->ucallback->on_client_snd);
+        __dmserver_setcb_onclientrcvbatch(&u->ucallback, conf->ucallback->on_client_rcv_batch);
+    }
+
+    // Pool members (all down, due now):
+    u->upool = conf->upool ? conf->upool : 1;
+    u->ubackoff_min = conf->ubackoff_min_ms ? conf->ubackoff_min_ms : DEFAULT_UPSTREAM_BACKOFFMIN;
+    u->ubackoff_max = (conf->ubackoff_max_ms >= u->ubackoff_min) ? conf->ubackoff_max_ms : DEFAULT_UPSTREAM_BACKOFFMAX;
+    if (u->ubackoff_max < u->ubackoff_min) u->ubackoff_max = u->ubackoff_min;
+    u->umembers = calloc(u->upool, sizeof(struct dmserver_upmember));
+    if (!u->umembers) {
+        _dmserver_upstream_helper_free(u);
+        return false;
+    }
+    for (size_t i = 0; i < u->upool; i++) u->umembers[i].mbackoff = u->ubackoff_min;
+
+    // Append to the list (grown as needed):
+    pthread_mutex_lock(&ups->ulock);
+    if (ups->uups_count == ups->uups_size) {
+        size_t size = ups->uups_size ? 2 * ups->uups_size : DEFAULT_UPSTREAM_LISTLEN;
+        dmserver_upstream_pt * list = realloc(ups->uups, size * sizeof(dmserver_upstream_pt));
+        if (!list) {
+            pthread_mutex_unlock(&ups->ulock);
+            _dmserver_upstream_helper_free(u);
+            return false;
+        }
+        ups->uups = list;
+        ups->uups_size = size;
+    }
+    u->uid = ups->uups_count;
+    ups->uups[ups->uups_count++] = u;
+    pthread_mutex_unlock(&ups->ulock);
+
+    if (upid) *upid = u->uid;
+    return true;
+}
+
+/*
+    @brief Function to get an upstream by its id.
+
+    @param dmserver_upstreams_pt ups: Reference to upstreams list.
+    @param size_t upid: Upstream id.
+
+    @retval Reference to the upstream, NULL if it does not exist.
+*/
+dmserver_upstream_pt _dmserver_upstreams_get(dmserver_upstreams_pt ups, size_t upid){
+    if (!ups) return NULL;
+    pthread_mutex_lock(&ups->ulock);
+    dmserver_upstream_pt u = (upid < ups->uups_count) ? ups->uups[upid] : NULL;
+    pthread_mutex_unlock(&ups->ulock);
+    return u;
+}
+
+/*
+    @brief Function to make every down pool member of the upstreams not closed due right away with
+    the minimum backoff (server run).
+
+    @param dmserver_upstreams_pt ups: Reference to upstreams list.
+*/
+void _dmserver_upstreams_rearm(dmserver_upstreams_pt ups){
+    if (!ups) return;
+    pthread_mutex_lock(&ups->ulock);
+    for (size_t i = 0; i < ups->uups_count; i++){
+        dmserver_upstream_pt u = ups->uups[i];
+        pthread_mutex_lock(&u->ulock);
+        for (size_t j = 0; j < u->upool; j++){
+            if (u->umembers[j].mcli) continue;
+            u->umembers[j].mretry = 0;
+            u->umembers[j].mbackoff = u->ubackoff_min;
+        }
+        pthread_mutex_unlock(&u->ulock);
+    }
+    pthread_mutex_unlock(&ups->ulock);
+}
+
+/*
+    @brief Function that returns the epoll timeout until the next connection attempt of the upstreams.
+
+    @param dmserver_upstreams_pt ups: Reference to upstreams list.
+    @param long now: Monotonic time in ns.
+    @param int ep_timeout: Epoll timeout in ms without attempts pending.
+
+    @retval Epoll timeout in ms.
+*/
+int _dmserver_upstreams_timeout(dmserver_upstreams_pt ups, long now, int ep_timeout){
+    if (!ups) return ep_timeout;
+    pthread_mutex_lock(&ups->ulock);
+    for (size_t i = 0; (i < ups->uups_count) && (ep_timeout > 0); i++){
+        dmserver_upstream_pt u = ups->uups[i];
+        pthread_mutex_lock(&u->ulock);
+        for (size_t j = 0; !u->uclosed && (j < u->upool); j++){
+            if (u->umembers[j].mcli) continue;
+            long wait = u->umembers[j].mretry - now;
+            int wait_ms = (wait <= 0) ? 0 : (int)((wait + 999999) / 1000000);
+            if (wait_ms < ep_timeout) ep_timeout = wait_ms;
+        }
+        pthread_mutex_unlock(&u->ulock);
+    }
+    pthread_mutex_unlock(&ups->ulock);
+    return ep_timeout;
+}
+
+// ======== Endpoints:
+/*
+    @brief Function to resolve a stream endpoint into a connection data (first address found), for the
+    upstreams and the proxy targets.
+    @note: The host name resolution blocks the caller.
+
+    @param dmserver_servconn_pt s: Connection data (address, family & port set).
+    @param const char * host: Host name or address.
+    @param int port: Port.
+
+    @retval true: Endpoint resolved.
+    @retval false: Resolution failed.
+*/
+bool _dmserver_upstream_resolve(dmserver_servconn_pt s, const char * host, int port){
+    // References check:
+    if (!s || !host) return false;
+
+    char port_str[8];
+    snprintf(port_str, sizeof(port_str), "%d", port);
+    struct addrinfo * res = NULL;
+    struct addrinfo hints = {.ai_family=AF_UNSPEC, .ai_socktype=SOCK_STREAM};
+    if (getaddrinfo(host, port_str, &hints, &res) || !res) return false;
+
+    bool resolved = true;
+    if ((res->ai_family == AF_INET) && (res->ai_addrlen <= sizeof(s->saddr.s4))) memcpy(&s->saddr.s4, res->ai_addr, res->ai_addrlen);
+    else if ((res->ai_family == AF_INET6) && (res->ai_addrlen <= sizeof(s->saddr.s6))) memcpy(&s->saddr.s6, res->ai_addr, res->ai_addrlen);
+    else resolved = false;
+    s->ssafamily = res->ai_family;
+    s->sport = port;
+    freeaddrinfo(res);
+    return resolved;
+}
+
+// ======== Pool members:
+/*
+    @brief Function to take the next pool member of an upstream due to connect, scheduling its next
+    attempt after its backoff (doubled for the next one) in case this one fails or gets lost, so a
+    peer closing every connection right away is not retried faster than the backoff.
+
+    @param dmserver_upstream_pt u: Reference to the upstream.
+    @param long now: Monotonic time in ns.
+    @param size_t * member: Output pool member.
+
+    @retval true: Member due to connect.
+    @retval false: No members due (or upstream closed).
+*/
+bool _dmserver_upstream_due(dmserver_upstream_pt u, long now, size_t * member){
+    if (!u || !member) return false;
+
+    pthread_mutex_lock(&u->ulock);
+    for (size_t i = 0; !u->uclosed && (i < u->upool); i++){
+        struct dmserver_upmember * m = &u->umembers[i];
+        if (m->mcli || (m->mretry > now)) continue;
+        m->mretry = now + (long)m->mbackoff * 1000000;
+        m->mbackoff = (2 * m->mbackoff > u->ubackoff_max) ? u->ubackoff_max : 2 * m->mbackoff;
+        *member = i;
+        pthread_mutex_unlock(&u->ulock);
+        return true;
+    }
+    pthread_mutex_unlock(&u->ulock);
+    return false;
+}
+
+/*
+    @brief Function to attach the client slot connecting a pool member to it.
+
+    @param dmserver_upstream_pt u: Reference to the upstream.
+    @param size_t member: Pool member.
+    @param dmserver_cliconn_pt c: Client slot (already set, before adding it to its subthread).
+
+    @retval true: Client attached.
+    @retval false: Upstream closed meanwhile (the caller drops the connection).
+*/
+bool _dmserver_upstream_attach(dmserver_upstream_pt u, size_t member, dmserver_cliconn_pt c){
+    if (!u || !c || (member >= u->upool)) return false;
+
+    pthread_mutex_lock(&u->ulock);
+    bool attached = !u->uclosed;
+    if (attached) {
+        u->umembers[member].mcli = c;
+        c->cupstream = u;
+        c->cupmember = member;
+    }
+    pthread_mutex_unlock(&u->ulock);
+    return attached;
+}
+
+/*
+    @brief Function to mark the pool member of an upstream client as down (connection failed or lost),
+    due again at the attempt scheduled when it connected.
+    @note: Called before the client slot reset, clients not from an upstream are ignored.
+
+    @param dmserver_cliconn_pt c: Reference to the client.
+    @param int wakefd: Event file descriptor of the connecting thread, woken up to schedule the attempt (-1 none).
+*/
+void _dmserver_upstream_lost(dmserver_cliconn_pt c, int wakefd){
+    if (!c || !c->cupstream) return;
+    dmserver_upstream_pt u = c->cupstream;
+
+    pthread_mutex_lock(&u->ulock);
+    struct dmserver_upmember * m = &u->umembers[c->cupmember];
+    if (m->mcli == c) m->mcli = NULL;
+    bool closed = u->uclosed;
+    pthread_mutex_unlock(&u->ulock);
+    c->cupstream = NULL;
+
+    if (!closed && (wakefd >= 0)) eventfd_write(wakefd, 1);
+}
+
+/*
+    @brief Function to mark the pool member of an upstream client as connected (backoff reset).
+
+    @param dmserver_cliconn_pt c: Reference to the client.
+*/
+void _dmserver_upstream_up(dmserver_cliconn_pt c){
+    if (!c || !c->cupstream) return;
+    dmserver_upstream_pt u = c->cupstream;
+
+    pthread_mutex_lock(&u->ulock);
+    if (u->umembers[c->cupmember].mcli == c) u->umembers[c->cupmember].mbackoff = u->ubackoff_min;
+    pthread_mutex_unlock(&u->ulock);
+}
+
+/*
+    @brief Function to close an upstream (no more connection attempts), returning the locations of its
+    pool members connecting or connected to be disconnected by the caller.
+
+    @param dmserver_upstream_pt u: Reference to the upstream.
+    @param dmserver_cliloc_pt locs: Output locations (upool entries).
+
+    @retval Number of locations returned.
+*/
+size_t _dmserver_upstream_close(dmserver_upstream_pt u, dmserver_cliloc_pt locs){
+    if (!u || !locs) return 0;
+
+    size_t n = 0;
+    pthread_mutex_lock(&u->ulock);
+    u->uclosed = true;
+    for (size_t i = 0; i < u->upool; i++){
+        if (u->umembers[i].mcli) locs[n++] = u->umembers[i].mcli->cloc;
+    }
+    pthread_mutex_unlock(&u->ulock);
+    return n;
+}
+
+/*
+    @brief Function to request the close of an upstream to the main thread (server running).
+
+    @param dmserver_upstream_pt u: Reference to the upstream.
+
+    @retval true: Close requested.
+    @retval false: Upstream already closed.
+*/
+bool _dmserver_upstream_qclose(dmserver_upstream_pt u){
+    if (!u) return false;
+
+    pthread_mutex_lock(&u->ulock);
+    bool requested = !u->uclosed;
+    u->uclosing = requested;
+    pthread_mutex_unlock(&u->ulock);
+    return requested;
+}
+
+/*
+    @brief Function to check if an upstream has a close request pending.
+
+    @param dmserver_upstream_pt u: Reference to the upstream.
+
+    @retval true: Close pending.
+    @retval false: No close pending (or already closed).
+*/
+bool _dmserver_upstream_closing(dmserver_upstream_pt u){
+    if (!u) return false;
+
+    pthread_mutex_lock(&u->ulock);
+    bool closing = u->uclosing && !u->uclosed;
+    pthread_mutex_unlock(&u->ulock);
+    return closing;
+}
+
+/*
+    @brief Function to pick a connected pool member of an upstream (round robin).
+
+    @param dmserver_upstream_pt u: Reference to the upstream.
+    @param dmserver_cliloc_pt loc: Output location of the client picked.
+
+    @retval true: Client picked.
+    @retval false: No connected pool members.
+*/
+bool _dmserver_upstream_pick(dmserver_upstream_pt u, dmserver_cliloc_pt loc){
+    if (!u || !loc) return false;
+
+    pthread_mutex_lock(&u->ulock);
+    for (size_t i = 0; i < u->upool; i++){
+        struct dmserver_upmember * m = &u->umembers[(u->unext + i) % u->upool];
+        if (!m->mcli || (m->mcli->cstate != DMSERVER_CLIENT_ESTABLISHED)) continue;
+        *loc = m->mcli->cloc;
+        u->unext = (u->unext + i + 1) % u->upool;
+        pthread_mutex_unlock(&u->ulock);
+        return true;
+    }
+    pthread_mutex_unlock(&u->ulock);
+    return false;
+}
+
+
+
+
+/* ---- STATIC INTERNAL - Helper functions implementation --------- */
+/*
+    @brief Helper function to free an upstream (TLS context included).
+
+    @param dmserver_upstream_pt u: Upstream (NULL ignored).
+*/
+static void _dmserver_upstream_helper_free(dmserver_upstream_pt u){
+    if (!u) return;
+    if (u->uconn.sssl_enable) _dmserver_sconn_ssldeinit(&u->uconn);
+    if (u->umembers) free(u->umembers);
+    pthread_mutex_destroy(&u->ulock);
+    free(u);
+}
+
+/*
+    @brief Helper function to create the TLS client context of an upstream (TLS 1.3 as the server
+    side, peer verification against the system CAs if requested).
+
+    @param dmserver_upstream_pt u: Upstream.
+
+    @retval true: Context created.
+    @retval false: Context creation failed.
+*/
+static bool _dmserver_upstream_helper_sslinit(dmserver_upstream_pt u){
+    u->uconn.sssl_method = TLS_client_method();
+    u->uconn.sssl_ctx = SSL_CTX_new(u->uconn.sssl_method);
+    if (!u->uconn.sssl_ctx) return false;
+
+    SSL_CTX_set_min_proto_version(u->uconn.sssl_ctx, TLS1_3_VERSION);
+    SSL_CTX_set_max_proto_version(u->uconn.sssl_ctx, TLS1_3_VERSION);
+    SSL_CTX_set_options(u->uconn.sssl_ctx, SSL_OP_NO_RENEGOTIATION);
+
+    if (u->uverify) {
+        if (SSL_CTX_set_default_verify_paths(u->uconn.sssl_ctx) != 1) return false;
+        SSL_CTX_set_verify(u->uconn.sssl_ctx, SSL_VERIFY_PEER, NULL);
+    } else SSL_CTX_set_verify(u->uconn.sssl_ctx, SSL_VERIFY_NONE, NULL);
+    return true;
+}
\ No newline at end of file
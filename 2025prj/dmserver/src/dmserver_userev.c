@@ -0,0 +1,258 @@
+/*
+
+*/
+
+/* ---- Library --------------------------------------------------- */
+#include "../inc/_dmserver_userev.h"
+
+/* ---- Helper functions implementation prototypes ---------------- */
+static bool _dmserver_userev_helper_slot(dmserver_userevs_pt s, size_t * id);
+static void _dmserver_userev_helper_free(dmserver_userev_pt u);
+
+
+
+
+/* ---- INTERNAL - Functions implementation ----------------------- */
+// ======== General use:
+/*
+    @brief Function to initialize the user event sources of a subthread (all slots free).
+
+    @param dmserver_userevs_pt s: Reference to user event sources.
+
+    @retval true: Initialization succeeded.
+    @retval false: Initialization failed.
+*/
+bool _dmserver_userevs_init(dmserver_userevs_pt s){
+    // Reference check:
+    if (!s) return false;
+    memset(s, 0, sizeof(dmserver_userevs_t));
+
+    for (size_t i = 0; i < DEFAULT_USEREV_PERSUBTH; i++) _dmserver_userev_helper_free(&s->uevs[i]);
+    if (pthread_mutex_init(&s->ulock, NULL)) return false;
+
+    // Dispatch lock (recursive, the callbacks may remove sources of their own subthread):
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    int err = pthread_mutex_init(&s->udispatch, &attr);
+    pthread_mutexattr_destroy(&attr);
+    if (err) {
+        pthread_mutex_destroy(&s->ulock);
+        return false;
+    }
+    s->uready = true;
+    return true;
+}
+
+/*
+    @brief Function to deinitialize the user event sources of a subthread (timers closed, user fds
+    left open to their owners).
+
+    @param dmserver_userevs_pt s: Reference to user event sources.
+
+    @retval true: Deinitialization succeeded.
+    @retval false: Deinitialization failed.
+*/
+bool _dmserver_userevs_deinit(dmserver_userevs_pt s){
+    // Reference check:
+    if (!s || !s->uready) return false;
+
+    for (size_t i = 0; i < DEFAULT_USEREV_PERSUBTH; i++) _dmserver_userev_helper_free(&s->uevs[i]);
+    pthread_mutex_destroy(&s->ulock);
+    pthread_mutex_destroy(&s->udispatch);
+    s->uready = false;
+    return true;
+}
+
+// ======== Add / Remove:
+/*
+    @brief Function to add a periodic timer to a subthread epoll (first expiration after one interval).
+
+    @param dmserver_userevs_pt s: Reference to user event sources.
+    @param int epfd: Subthread epoll.
+    @param size_t interval_ms: Timer period in msec (not 0).
+    @param void (*cb)(void *, uint64_t): Callback (user argument & expirations since the last call).
+    @param void * arg: User argument of the callback.
+    @param size_t * id: Output source id.
+
+    @retval true: Timer added.
+    @retval false: Invalid arguments, no free slot or timer creation failed.
+*/
+bool _dmserver_userevs_timer(dmserver_userevs_pt s, int epfd, size_t interval_ms, void (*cb)(void *, uint64_t), void * arg, size_t * id){
+    // References check:
+    if (!s || !s->uready || !interval_ms || !cb || !id) return false;
+
+    // Periodic timer (monotonic clock):
+    int tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (tfd < 0) return false;
+    struct timespec period = {.tv_sec=(time_t)(interval_ms / 1000), .tv_nsec=(long)(interval_ms % 1000) * 1000000L};
+    if (timerfd_settime(tfd, 0, &(struct itimerspec){.it_interval=period, .it_value=period}, NULL) < 0) {
+        close(tfd);
+        return false;
+    }
+
+    // Slot & registration (the slot is complete before the first event):
+    pthread_mutex_lock(&s->ulock);
+    if (!_dmserver_userev_helper_slot(s, id)) {
+        pthread_mutex_unlock(&s->ulock);
+        close(tfd);
+        return false;
+    }
+    dmserver_userev_pt u = &s->uevs[*id];
+    *u = (dmserver_userev_t){.uevsrc={DMSERVER_EVSRC_USEREV}, .utype=DMSERVER_USEREV_TIMER, .ufd=tfd, .udeleted=false, .utimer_cb=cb, .ufd_cb=NULL, .uarg=arg};
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, tfd, &(struct epoll_event){.events=EPOLLIN, .data.ptr=u}) < 0) {
+        _dmserver_userev_helper_free(u);
+        pthread_mutex_unlock(&s->ulock);
+        return false;
+    }
+    pthread_mutex_unlock(&s->ulock);
+    return true;
+}
+
+/*
+    @brief Function to add a user file descriptor to a subthread epoll.
+    @note: The file descriptor stays owned by the caller (never closed here), and must be removed
+    before closing it. The events are registered as given (level triggered unless EPOLLET).
+
+    @param dmserver_userevs_pt s: Reference to user event sources.
+    @param int epfd: Subthread epoll.
+    @param int fd: User file descriptor.
+    @param uint32_t events: Epoll events of interest.
+    @param void (*cb)(void *, int, uint32_t): Callback (user argument, file descriptor & events ready).
+    @param void * arg: User argument of the callback.
+    @param size_t * id: Output source id.
+
+    @retval true: File descriptor added.
+    @retval false: Invalid arguments, no free slot or registration failed.
+*/
+bool _dmserver_userevs_fd(dmserver_userevs_pt s, int epfd, int fd, uint32_t events, void (*cb)(void *, int, uint32_t), void * arg, size_t * id){
+    // References check:
+    if (!s || !s->uready || (fd < 0) || !cb || !id) return false;
+
+    // Slot & registration:
+    pthread_mutex_lock(&s->ulock);
+    if (!_dmserver_userev_helper_slot(s, id)) {
+        pthread_mutex_unlock(&s->ulock);
+        return false;
+    }
+    dmserver_userev_pt u = &s->uevs[*id];
+    *u = (dmserver_userev_t){.uevsrc={DMSERVER_EVSRC_USEREV}, .utype=DMSERVER_USEREV_FD, .ufd=fd, .udeleted=false, .utimer_cb=NULL, .ufd_cb=cb, .uarg=arg};
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &(struct epoll_event){.events=events, .data.ptr=u}) < 0) {
+        _dmserver_userev_helper_free(u);
+        pthread_mutex_unlock(&s->ulock);
+        return false;
+    }
+    pthread_mutex_unlock(&s->ulock);
+    return true;
+}
+
+/*
+    @brief Function to remove a user event source from a subthread epoll. No callback of the source
+    is called once this function returns, its slot is freed at the end of the subthread round.
+    @note: From a foreign thread, a callback of the subthread in progress is waited for (the caller
+    must not hold anything that callback takes).
+
+    @param dmserver_userevs_pt s: Reference to user event sources.
+    @param int epfd: Subthread epoll.
+    @param size_t id: Source id.
+
+    @retval true: Source removed.
+    @retval false: Unknown or already removed source.
+*/
+bool _dmserver_userevs_del(dmserver_userevs_pt s, int epfd, size_t id){
+    // References & bounds check:
+    if (!s || !s->uready || (id >= DEFAULT_USEREV_PERSUBTH)) return false;
+
+    // No callback in progress (or the caller is that callback):
+    pthread_mutex_lock(&s->udispatch);
+    pthread_mutex_lock(&s->ulock);
+    dmserver_userev_pt u = &s->uevs[id];
+    if ((u->utype == DMSERVER_USEREV_FREE) || u->udeleted) {
+        pthread_mutex_unlock(&s->ulock);
+        pthread_mutex_unlock(&s->udispatch);
+        return false;
+    }
+    epoll_ctl(epfd, EPOLL_CTL_DEL, u->ufd, NULL);
+    __atomic_store_n(&u->udeleted, true, __ATOMIC_RELEASE);
+    __atomic_store_n(&s->ureap, true, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&s->ulock);
+    pthread_mutex_unlock(&s->udispatch);
+    return true;
+}
+
+// ======== Dispatch:
+/*
+    @brief Function to call the callback of a user event source (timer expirations consumed first),
+    under the dispatch lock (removals from foreign threads wait for it to return).
+
+    @param dmserver_userevs_pt s: Reference to user event sources.
+    @param dmserver_userev_pt u: User event source.
+    @param uint32_t events: Epoll events ready.
+*/
+void _dmserver_userev_dispatch(dmserver_userevs_pt s, dmserver_userev_pt u, uint32_t events){
+    pthread_mutex_lock(&s->udispatch);
+
+    // Removed sources (events already fetched in this round) are ignored:
+    if (__atomic_load_n(&u->udeleted, __ATOMIC_ACQUIRE)) {
+        pthread_mutex_unlock(&s->udispatch);
+        return;
+    }
+
+    if (u->utype == DMSERVER_USEREV_TIMER) {
+        uint64_t expirations = 0;
+        if (read(u->ufd, &expirations, sizeof(expirations)) == sizeof(expirations)) u->utimer_cb(u->uarg, expirations);
+    }
+    else if (u->utype == DMSERVER_USEREV_FD) u->ufd_cb(u->uarg, u->ufd, events);
+    pthread_mutex_unlock(&s->udispatch);
+}
+
+/*
+    @brief Function to free the slots of the removed user event sources (from the subthread, at the
+    end of its round, or with the subthread stopped).
+
+    @param dmserver_userevs_pt s: Reference to user event sources.
+*/
+void _dmserver_userevs_reap(dmserver_userevs_pt s){
+    // Nothing removed since the last reap:
+    if (!s || !__atomic_load_n(&s->ureap, __ATOMIC_ACQUIRE)) return;
+
+    pthread_mutex_lock(&s->ulock);
+    for (size_t i = 0; i < DEFAULT_USEREV_PERSUBTH; i++){
+        if (s->uevs[i].udeleted) _dmserver_userev_helper_free(&s->uevs[i]);
+    }
+    s->ureap = false;
+    pthread_mutex_unlock(&s->ulock);
+}
+
+
+
+
+/* ---- STATIC INTERNAL - Helper functions implementation --------- */
+/*
+    @brief Helper function to find a free slot (called under lock).
+
+    @param dmserver_userevs_pt s: Reference to user event sources.
+    @param size_t * id: Output slot index.
+
+    @retval true: Free slot found.
+    @retval false: Every slot taken.
+*/
+static bool _dmserver_userev_helper_slot(dmserver_userevs_pt s, size_t * id){
+    for (size_t i = 0; i < DEFAULT_USEREV_PERSUBTH; i++){
+        if (s->uevs[i].utype == DMSERVER_USEREV_FREE) {
+            *id = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+    @brief Helper function to free a slot (the timer closed, a user fd left to its owner).
+
+    @param dmserver_userev_pt u: User event source.
+*/
+static void _dmserver_userev_helper_free(dmserver_userev_pt u){
+    if ((u->utype == DMSERVER_USEREV_TIMER) && (u->ufd >= 0)) close(u->ufd);
+    *u = (dmserver_userev_t){.uevsrc={DMSERVER_EVSRC_USEREV}, .utype=DMSERVER_USEREV_FREE, .ufd=-1};
+}
\ No newline at end of file
@@ -7,11 +7,41 @@
 #include "../inc/dmserver.h"
 
 /* ---- Helper functions implementation prototypes ---------------- */
-static void _dmserver_helper_smanager(dmserver_pt dmserver);
+static bool _dmserver_helper_smanager(dmserver_pt dmserver, dmserver_servconn_pt s, dmserver_callback_pt cb, dmserver_proxytarget_pt pt);
+static dmserver_cliconn_pt _dmserver_helper_cslot(dmserver_pt dmserver, dmserver_cliloc_pt cloc, bool * overloaded);
+static void _dmserver_helper_upretry(dmserver_pt dmserver);
+static void _dmserver_helper_upclose(dmserver_pt dmserver);
+static void _dmserver_helper_shards(dmserver_pt dmserver);
+static bool _dmserver_helper_upconnect(dmserver_pt dmserver, dmserver_upstream_pt u, size_t member);
+static bool _dmserver_helper_ccconnect(dmserver_pt dmserver, dmserver_cliconn_pt c);
+static void _dmserver_helper_ccproxy(dmserver_pt dmserver, dmserver_cliconn_pt dmclient, size_t dmthindex, bool upstream_ev);
 static bool _dmserver_helper_csslhandshake(dmserver_pt dmserver, dmserver_cliconn_pt c);
 static bool _dmserver_helper_cctimeout(dmserver_pt dmserver, dmserver_cliconn_pt dmclient);
 static bool _dmserver_helper_ccread(dmserver_pt dmserver, dmserver_cliconn_pt dmclient, size_t dmthindex, struct epoll_event * evs, size_t evindex);
+static bool _dmserver_helper_ccrecv(dmserver_pt dmserver, dmserver_cliconn_pt dmclient, size_t dmthindex);
+static void _dmserver_helper_ccdefer(dmserver_pt dmserver, dmserver_cliconn_pt dmclient, size_t dmthindex, long resume);
+static void _dmserver_helper_ccdeferred(dmserver_pt dmserver, size_t dmthindex);
+static int _dmserver_helper_ccdefertimeout(dmserver_pt dmserver, size_t dmthindex, int ep_timeout);
+static bool _dmserver_helper_ccevents(dmserver_pt dmserver, dmserver_cliconn_pt dmclient, size_t dmthindex);
 static bool _dmserver_helper_ccwrite(dmserver_pt dmserver, dmserver_cliconn_pt dmclient, size_t dmthindex, struct epoll_event * evs, size_t evindex);
+static void _dmserver_helper_ccrcvbatch(dmserver_pt dmserver, size_t dmthindex);
+static bool _dmserver_helper_ccsend(dmserver_pt dmserver, dmserver_cliconn_pt dmclient, size_t dmthindex);
+static size_t _dmserver_helper_ccsendq(dmserver_pt dmserver, dmserver_cliconn_pt dmclient, int * wb, int * wb_err);
+static void _dmserver_helper_ccflush(dmserver_pt dmserver, size_t dmthindex);
+static void _dmserver_helper_ovlsample(dmserver_pt dmserver, size_t dmthindex, long round_start);
+static void _dmserver_helper_ovlshed(dmserver_pt dmserver, size_t dmthindex, long now);
+static long _dmserver_helper_nowns(void);
+static bool _dmserver_helper_slow(dmserver_worker_pt w, dmserver_cliconn_pt c, dmserver_cmsg_pt m, dmserver_slow_conf_pt sc);
+static void _dmserver_helper_dgread(dmserver_pt dmserver, size_t dmthindex);
+static dmserver_cliconn_pt _dmserver_helper_dgsession(dmserver_pt dmserver, size_t dmthindex, struct sockaddr_storage * caddr);
+static void _dmserver_helper_dgdeliver(dmserver_pt dmserver, dmserver_cliconn_pt dmclient, size_t dmthindex, const char * data, size_t len, const struct timespec * ts);
+static void _dmserver_helper_dgsend(dmserver_pt dmserver, dmserver_cliconn_pt dmclient, size_t dmthindex);
+static void _dmserver_helper_dgsendflush(dmserver_pt dmserver, size_t dmthindex);
+static bool _dmserver_helper_shmopen(dmserver_pt dmserver, dmserver_cliconn_pt dmclient);
+static void _dmserver_helper_shmsweep(dmserver_pt dmserver, size_t dmthindex);
+static int _dmserver_helper_shmtimeout(dmserver_pt dmserver, size_t dmthindex, int ep_timeout);
+static void _dmserver_helper_shmsend(dmserver_pt dmserver, dmserver_cliconn_pt dmclient);
+static void _dmserver_helper_injected(dmserver_pt dmserver);
 
 
 
@@ -34,6 +64,21 @@ bool __dmserver_worker_alloc(dmserver_worker_pt w){
     w->wmainepfd = epoll_create1(0);
     if (w->wmainepfd == -1) {__dmserver_worker_dealloc(w); return false;}
 
+    // Main thread wake up event (upstream connection attempts pending, registered as no listener):
+    w->wmainevfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (w->wmainevfd == -1) {__dmserver_worker_dealloc(w); return false;}
+    if (epoll_ctl(w->wmainepfd, EPOLL_CTL_ADD, w->wmainevfd, &(struct epoll_event){.events=EPOLLIN, .data.u64=UINT64_MAX}) < 0) {
+        __dmserver_worker_dealloc(w);
+        return false;
+    }
+
+    // Injected connections pending (taken by the main thread on its wake up event):
+    w->winjectcount = 0;
+    if (pthread_mutex_init(&w->winjectlock, NULL)) {
+        __dmserver_worker_dealloc(w);
+        return false;
+    }
+
     // Allocation for subthreads, subthreads epoll:
     w->wsubth = calloc(w->wth_subthreads, sizeof(pthread_t));
     if (!w->wsubth) {
@@ -45,6 +90,28 @@ bool __dmserver_worker_alloc(dmserver_worker_pt w){
         __dmserver_worker_dealloc(w);
         return false;
     }
+    w->wsubevfd = calloc(w->wth_subthreads, sizeof(int));
+    if (!w->wsubevfd) {
+        __dmserver_worker_dealloc(w);
+        return false;
+    }
+
+    // Allocation for the write flush queues (including counters and locks):
+    w->wflushcount = calloc(w->wth_subthreads, sizeof(size_t));
+    if (!w->wflushcount) {
+        __dmserver_worker_dealloc(w);
+        return false;
+    }
+    w->wflushlock = calloc(w->wth_subthreads, sizeof(pthread_mutex_t));
+    if (!w->wflushlock) {
+        __dmserver_worker_dealloc(w);
+        return false;
+    }
+    w->wflushq = calloc(w->wth_subthreads, sizeof(dmserver_cliconn_pt *));
+    if (!w->wflushq) {
+        __dmserver_worker_dealloc(w);
+        return false;
+    }
 
     // Allocation for clients queue (including counters):
     w->wccount = calloc(w->wth_subthreads, sizeof(size_t));
@@ -58,18 +125,153 @@ bool __dmserver_worker_alloc(dmserver_worker_pt w){
         return false;
     }
 
+    // Allocation for batched reception messages (including counters):
+    w->wrcvcount = calloc(w->wth_subthreads, sizeof(size_t));
+    if (!w->wrcvcount) {
+        __dmserver_worker_dealloc(w);
+        return false;
+    }
+    w->wrcvbatch = calloc(w->wth_subthreads, sizeof(dmserver_rcvmsg_pt));
+    if (!w->wrcvbatch) {
+        __dmserver_worker_dealloc(w);
+        return false;
+    }
+
+    // Allocation for the receive latency histograms:
+    w->wrxlat = calloc(w->wth_subthreads, sizeof(*w->wrxlat));
+    if (!w->wrxlat) {
+        __dmserver_worker_dealloc(w);
+        return false;
+    }
+
+    // Allocation for the timeouts check requests:
+    w->wtocheck = calloc(w->wth_subthreads, sizeof(bool));
+    if (!w->wtocheck) {
+        __dmserver_worker_dealloc(w);
+        return false;
+    }
+
+    // Allocation for the deferred reads lists (including counters):
+    w->wrdefercount = calloc(w->wth_subthreads, sizeof(size_t));
+    if (!w->wrdefercount) {
+        __dmserver_worker_dealloc(w);
+        return false;
+    }
+    w->wrdeferq = calloc(w->wth_subthreads, sizeof(dmserver_cliconn_pt *));
+    if (!w->wrdeferq) {
+        __dmserver_worker_dealloc(w);
+        return false;
+    }
+
+    // Allocation for the overload controllers (including flush queues first enqueue times):
+    w->wsubcodel = calloc(w->wth_subthreads, sizeof(dmserver_codel_t));
+    if (!w->wsubcodel) {
+        __dmserver_worker_dealloc(w);
+        return false;
+    }
+    w->wflushts = calloc(w->wth_subthreads, sizeof(long));
+    if (!w->wflushts) {
+        __dmserver_worker_dealloc(w);
+        return false;
+    }
+
+    // Allocation for the proxy pairs:
+    w->wproxy = calloc(w->wth_subthreads, sizeof(dmserver_proxy_pt));
+    if (!w->wproxy) {
+        __dmserver_worker_dealloc(w);
+        return false;
+    }
+
+    // Allocation for the user event sources:
+    w->wsubuserevs = calloc(w->wth_subthreads, sizeof(dmserver_userevs_t));
+    if (!w->wsubuserevs) {
+        __dmserver_worker_dealloc(w);
+        return false;
+    }
+
+    // Allocation for the shared memory connections (including counters):
+    w->wshmcount = calloc(w->wth_subthreads, sizeof(size_t));
+    if (!w->wshmcount) {
+        __dmserver_worker_dealloc(w);
+        return false;
+    }
+    w->wshm = calloc(w->wth_subthreads, sizeof(dmserver_shmconn_pt));
+    if (!w->wshm) {
+        __dmserver_worker_dealloc(w);
+        return false;
+    }
+
+    // Allocation for the topics indexes:
+    w->wsubtopics = calloc(w->wth_subthreads, sizeof(dmserver_pubsub_t));
+    if (!w->wsubtopics) {
+        __dmserver_worker_dealloc(w);
+        return false;
+    }
+
     for (size_t i = 0; i < w->wth_subthreads; i++){
         w->wcclis[i] = calloc(w->wth_clispersth, sizeof(dmserver_cliconn_t));
         if (!w->wcclis[i]) {
             __dmserver_worker_dealloc(w);
             return false;
         }
+        w->wrcvbatch[i] = calloc(w->wth_clispersth, sizeof(dmserver_rcvmsg_t));
+        if (!w->wrcvbatch[i]) {
+            __dmserver_worker_dealloc(w);
+            return false;
+        }
+        w->wrdeferq[i] = calloc(w->wth_clispersth, sizeof(dmserver_cliconn_pt));
+        if (!w->wrdeferq[i]) {
+            __dmserver_worker_dealloc(w);
+            return false;
+        }
+        w->wproxy[i] = calloc(w->wth_clispersth, sizeof(dmserver_proxy_t));
+        if (!w->wproxy[i]) {
+            __dmserver_worker_dealloc(w);
+            return false;
+        }
+        for (size_t j = 0; j < w->wth_clispersth; j++) _dmserver_proxy_init(&w->wproxy[i][j]);
+        w->wshm[i] = calloc(w->wth_clispersth, sizeof(dmserver_shmconn_t));
+        if (!w->wshm[i]) {
+            __dmserver_worker_dealloc(w);
+            return false;
+        }
+        for (size_t j = 0; j < w->wth_clispersth; j++) _dmserver_shm_init(&w->wshm[i][j]);
         w->wsubepfd[i] = epoll_create1(0);
         if (w->wsubepfd[i] == -1) {
             __dmserver_worker_dealloc(w);
             return false;
         }
 
+        // Wake up event of the subthread (registered without client reference):
+        w->wsubevfd[i] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (w->wsubevfd[i] == -1) {
+            __dmserver_worker_dealloc(w);
+            return false;
+        }
+        if (epoll_ctl(w->wsubepfd[i], EPOLL_CTL_ADD, w->wsubevfd[i], &(struct epoll_event){.events=EPOLLIN, .data.ptr=NULL}) < 0) {
+            __dmserver_worker_dealloc(w);
+            return false;
+        }
+
+        // Write flush queue of the subthread:
+        w->wflushq[i] = calloc(w->wth_clispersth, sizeof(dmserver_cliconn_pt));
+        if (!w->wflushq[i] || pthread_mutex_init(&w->wflushlock[i], NULL)) {
+            __dmserver_worker_dealloc(w);
+            return false;
+        }
+
+        // Topics index of the subthread:
+        if (!_dmserver_pubsub_init(&w->wsubtopics[i])) {
+            __dmserver_worker_dealloc(w);
+            return false;
+        }
+
+        // User event sources of the subthread:
+        if (!_dmserver_userevs_init(&w->wsubuserevs[i])) {
+            __dmserver_worker_dealloc(w);
+            return false;
+        }
+
         for (size_t j = 0; j < w->wth_clispersth; j++){if(!_dmserver_cconn_init(&w->wcclis[i][j])) {
             __dmserver_worker_dealloc(w);
             return false;
@@ -94,19 +296,115 @@ bool __dmserver_worker_dealloc(dmserver_worker_pt w){
             if (!_dmserver_cconn_deinit(&w->wcclis[i][j])) return false;
         }
         if (w->wsubepfd[i] != -1) close(w->wsubepfd[i]);
+        if (w->wsubevfd && (w->wsubevfd[i] > 0)) close(w->wsubevfd[i]);
+        if (w->wflushq && w->wflushq[i]) {
+            free(w->wflushq[i]);
+            pthread_mutex_destroy(&w->wflushlock[i]);
+        }
         if (w->wcclis[i]) free(w->wcclis[i]);
+        if (w->wrcvbatch && w->wrcvbatch[i]) free(w->wrcvbatch[i]);
+        if (w->wrdeferq && w->wrdeferq[i]) free(w->wrdeferq[i]);
+        if (w->wproxy && w->wproxy[i]) free(w->wproxy[i]);
+        if (w->wshm && w->wshm[i]) {
+            for (size_t j = 0; j < w->wth_clispersth; j++) _dmserver_shm_close(&w->wshm[i][j]);
+            free(w->wshm[i]);
+        }
+        if (w->wsubtopics) _dmserver_pubsub_deinit(&w->wsubtopics[i]);
+        if (w->wsubuserevs) _dmserver_userevs_deinit(&w->wsubuserevs[i]);
     }
     if (w->wmainepfd != -1) close(w->wmainepfd);
+    if (w->wmainevfd > 0) {
+        // Injected connections never taken closed:
+        for (size_t i = 0; i < w->winjectcount; i++) close(w->winject[i].ifd);
+        w->winjectcount = 0;
+        pthread_mutex_destroy(&w->winjectlock);
+        close(w->wmainevfd);
+    }
+    w->wmainevfd = -1;
     if (w->wcclis) free(w->wcclis);
     if (w->wccount) free(w->wccount);
+    if (w->wrcvbatch) free(w->wrcvbatch);
+    if (w->wrcvcount) free(w->wrcvcount);
+    if (w->wrxlat) free(w->wrxlat);
+    if (w->wtocheck) free(w->wtocheck);
+    if (w->wrdeferq) free(w->wrdeferq);
+    if (w->wrdefercount) free(w->wrdefercount);
+    if (w->wproxy) free(w->wproxy);
+    if (w->wshm) free(w->wshm);
+    if (w->wshmcount) free(w->wshmcount);
+    if (w->wsubtopics) free(w->wsubtopics);
+    if (w->wsubuserevs) free(w->wsubuserevs);
+    if (w->wsubcodel) free(w->wsubcodel);
+    if (w->wflushts) free(w->wflushts);
 
     // Deallocation of the rest of reserved memory:
     if (w->wsubepfd) free(w->wsubepfd);
+    if (w->wsubevfd) free(w->wsubevfd);
+    if (w->wflushq) free(w->wflushq);
+    if (w->wflushcount) free(w->wflushcount);
+    if (w->wflushlock) free(w->wflushlock);
     if (w->wsubth) free(w->wsubth);
 
     return true;
 }
 
+/*
+    @brief Function to allocate the datagram transport of every subordinate thread, one socket per
+    subthread bound to the server address (SO_REUSEPORT distributes the peers by address hash).
+    @note: The first subthread uses the server socket itself, the rest of sockets are owned by the worker.
+
+    @param dmserver_worker_pt w: Worker struct reference.
+    @param dmserver_servconn_pt s: Server connection (already initialized) reference.
+
+    @retval true: Allocation succeeded.
+    @retval false: Allocation failed.
+*/
+bool __dmserver_worker_dgram_alloc(dmserver_worker_pt w, dmserver_servconn_pt s){
+    // References check:
+    if (!w || !s) return false;
+
+    // Datagram transport per subthread:
+    w->wsubdgram = calloc(w->wth_subthreads, sizeof(dmserver_dgram_t));
+    if (!w->wsubdgram) return false;
+    for (size_t i = 0; i < w->wth_subthreads; i++) w->wsubdgram[i].dfd = -1;
+
+    for (size_t i = 0; i < w->wth_subthreads; i++){
+        int dfd = (i == 0) ? s->sfd : _dmserver_sconn_dgramsocket(s);
+        if ((dfd < 0) || !_dmserver_dgram_init(&w->wsubdgram[i], dfd, w->wth_clispersth)) {
+            if ((i > 0) && (dfd >= 0)) close(dfd);
+            w->wsubdgram[i].dfd = -1;
+            __dmserver_worker_dgram_dealloc(w);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+    @brief Function to deallocate the datagram transport of every subordinate thread.
+
+    @param dmserver_worker_pt w: Worker struct reference.
+
+    @retval true: Deallocation succeeded.
+    @retval false: Deallocation failed.
+*/
+bool __dmserver_worker_dgram_dealloc(dmserver_worker_pt w){
+    // References check:
+    if (!w) return false;
+    if (!w->wsubdgram) return true;
+
+    // Close the worker owned sockets and deinitialize:
+    for (size_t i = 0; i < w->wth_subthreads; i++){
+        if ((i > 0) && (w->wsubdgram[i].dfd >= 0)) close(w->wsubdgram[i].dfd);
+        _dmserver_dgram_deinit(&w->wsubdgram[i]);
+    }
+    free(w->wsubdgram);
+    w->wsubdgram = NULL;
+
+    return true;
+}
+
 // ======== Setters:
 /*
     @brief Function to initialize the worker to its defaults values.
@@ -120,6 +418,20 @@ void __dmserver_worker_set_defaults(dmserver_worker_pt w){
     w->wth_subthreads = DEFAULT_WORKER_SUBTHREADS;
     w->wth_clispersth = DEFAULT_WORKER_CLISPERSTH;
     w->wth_clistimeout = DEFAULT_WORKER_CLITIMEOUT;
+
+    // Set defaults low latency mode (disabled) and no cpu pinning:
+    w->wth_busypoll = DEFAULT_WORKER_BUSYPOLL;
+    w->wth_ncpus = 0;
+
+    // Set defaults slow consumers policy (drop newest, queue full only) and unlimited output memory:
+    w->wslow = (struct dmserver_slow_conf){.spolicy=DMSERVER_SLOW_DROP_NEWEST, .smax_bytes=0, .smax_sec=0};
+    w->wout_budget = DEFAULT_WORKER_OUTBUDGET;
+
+    // Set defaults overload control (disabled):
+    w->wovl_target = DEFAULT_OVERLOAD_TARGET;
+    w->wovl_interval = DEFAULT_OVERLOAD_INTERVAL;
+    w->wovl_shed = false;
+    w->wovl_reject = false;
 }
 
 /*
@@ -158,6 +470,99 @@ void __dmserver_worker_set_clistimeout(dmserver_worker_pt w, size_t wth_clistime
     w->wth_clistimeout = wth_clistimeout;
 }
 
+/*
+    @brief Function to set the low latency (busy poll) mode of the subordinate threads. Each
+    subthread polls its epoll without blocking for up to the spin budget after the last event, 
+    and blocks afterwards (adaptive spin-then-block).
+
+    @param dmserver_worker_t w: Reference to worker structure.
+    @param size_t wth_busypoll: Maximum spin time in microseconds (0 to disable).
+*/
+void __dmserver_worker_set_busypoll(dmserver_worker_pt w, size_t wth_busypoll){
+    w->wth_busypoll = wth_busypoll;
+}
+
+/*
+    @brief Function to set the cpus where the subordinate threads are pinned at launch.
+
+    @param dmserver_worker_t w: Reference to worker structure.
+    @param const int * wth_cpus: Cpus list (subthread i runs on wth_cpus[i % wth_ncpus]).
+    @param size_t wth_ncpus: Number of cpus in the list (0 to disable pinning).
+*/
+void __dmserver_worker_set_cpus(dmserver_worker_pt w, const int * wth_cpus, size_t wth_ncpus){
+    if (!wth_cpus) wth_ncpus = 0;
+    if (wth_ncpus > DEFAULT_WORKER_CPUSLEN) wth_ncpus = DEFAULT_WORKER_CPUSLEN;
+    for (size_t i = 0; i < wth_ncpus; i++) w->wth_cpus[i] = wth_cpus[i];
+    w->wth_ncpus = wth_ncpus;
+}
+
+/*
+    @brief Function to set the default slow consumers policy (broadcast & topics without a specific one).
+
+    @param dmserver_worker_pt w: Worker struct reference.
+    @param enum dmserver_slow_policy policy: Action when a client is behind.
+    @param size_t max_bytes: Pending bytes to consider a client behind (0 disabled).
+    @param size_t max_sec: Age of the oldest pending message to consider a client behind (0 disabled).
+*/
+void __dmserver_worker_set_slow(dmserver_worker_pt w, enum dmserver_slow_policy policy, size_t max_bytes, size_t max_sec){
+    w->wslow.spolicy = policy;
+    w->wslow.smax_bytes = max_bytes;
+    w->wslow.smax_sec = max_sec;
+}
+
+/*
+    @brief Function to set the pending output memory budget (shared messages not written yet).
+
+    @param dmserver_worker_pt w: Worker struct reference.
+    @param size_t wout_budget: Memory budget in bytes (0 unlimited).
+*/
+void __dmserver_worker_set_outbudget(dmserver_worker_pt w, size_t wout_budget){
+    w->wout_budget = wout_budget;
+}
+
+/*
+    @brief Function to set the overload control of the subordinate threads. A subthread gets
+    overloaded when its sojourn time (round processing lag or flush queue wait) stays above the
+    target for a whole interval, and leaves the overload once back under target.
+
+    @param dmserver_worker_pt w: Worker struct reference.
+    @param size_t target: Sojourn target in usec (0 disables the overload control).
+    @param size_t interval: Time in usec above target to get overloaded (0 default).
+    @param bool shed: Reads of the heaviest client paused (one interval) on every shedding.
+    @param bool reject: New connections rejected while every subthread is overloaded.
+*/
+void __dmserver_worker_set_overload(dmserver_worker_pt w, size_t target, size_t interval, bool shed, bool reject){
+    w->wovl_target = target;
+    w->wovl_interval = interval ? interval : DEFAULT_OVERLOAD_INTERVAL;
+    w->wovl_shed = shed;
+    w->wovl_reject = reject;
+}
+
+/*
+    @brief Function to set the slow consumers policy of a specific topic (replaced if already set).
+
+    @param dmserver_worker_pt w: Worker struct reference.
+    @param const char * topic: Topic name.
+    @param dmserver_slow_conf_pt sc: Slow consumers policy of the topic.
+
+    @retval true: Policy set.
+    @retval false: Invalid topic or no room for more topic policies.
+*/
+bool __dmserver_worker_set_topicslow(dmserver_worker_pt w, const char * topic, dmserver_slow_conf_pt sc){
+    // References check:
+    if (!w || !topic || !topic[0] || !sc || (strlen(topic) >= DEFAULT_PUBSUB_TOPICLEN)) return false;
+
+    // Replace or append the topic policy:
+    dmserver_slow_conf_pt tsc = _dmserver_worker_slowconf(w, topic);
+    if (tsc == &w->wslow) {
+        if (w->wtopicslow_count >= DEFAULT_WORKER_TOPICSLOWLEN) return false;
+        strcpy(w->wtopicslow[w->wtopicslow_count].tname, topic);
+        tsc = &w->wtopicslow[w->wtopicslow_count++].tslow;
+    }
+    *tsc = *sc;
+    return true;
+}
+
 
 
 // ======== Threads:
@@ -174,24 +579,73 @@ void * _dmserver_worker_main(void * args){
     if (!args) return NULL;
     dmserver_pt dmserver = (dmserver_pt)args;
 
-    // Prepare the main thread epoll to optimize CPU usage:
-    if (epoll_ctl(dmserver->sworker.wmainepfd, EPOLL_CTL_ADD, dmserver->sconn.sfd, &(struct epoll_event){.events=EPOLLIN|EPOLLET, .data.fd=dmserver->sconn.sfd}) < 0) 
+    // Prepare the main thread epoll to optimize CPU usage, every listener registered with its index as
+    // event data (0 the server connection, nothing to accept on it in datagram mode):
+    if ((dmserver->sconn.ssocktype == SOCK_STREAM) && (epoll_ctl(dmserver->sworker.wmainepfd, EPOLL_CTL_ADD, dmserver->sconn.sfd, &(struct epoll_event){.events=EPOLLIN|EPOLLET, .data.u64=0}) < 0)) 
+        return NULL;
+    for (size_t i = 0; i < dmserver->slisteners_count; i++){
+        if (epoll_ctl(dmserver->sworker.wmainepfd, EPOLL_CTL_ADD, dmserver->slisteners[i].lconn.sfd, &(struct epoll_event){.events=EPOLLIN|EPOLLET, .data.u64=i + 1}) < 0) 
+            return NULL;
+    }
+    // Prefork shards, the own bus inbox registered as well:
+    int shards_evfd = _dmserver_shards_evfd(&dmserver->sshards);
+    if ((shards_evfd >= 0) && (epoll_ctl(dmserver->sworker.wmainepfd, EPOLL_CTL_ADD, shards_evfd, &(struct epoll_event){.events=EPOLLIN, .data.u64=UINT64_MAX - 1}) < 0))
         return NULL;
     struct epoll_event evs[SOMAXCONN];
+    bool accepting = true;
     
     while (dmserver->sstate == DMSERVER_STATE_RUNNING){
-        // Epoll wait for connection:
-        int nfds = epoll_wait(dmserver->sworker.wmainepfd, evs, SOMAXCONN, 4000);
+        // Epoll wait for connection (or the next upstream connection attempt):
+        int ep_timeout = _dmserver_upstreams_timeout(&dmserver->supstreams, _dmserver_helper_nowns(), 4000);
+        int nfds = epoll_wait(dmserver->sworker.wmainepfd, evs, SOMAXCONN, ep_timeout);
         if (nfds < 0  && (errno == EINTR)) continue;
 
+        // Listeners handed off or draining, out of the epoll (left open until close):
+        if (accepting && __atomic_load_n(&dmserver->sdraining, __ATOMIC_ACQUIRE)) {
+            epoll_ctl(dmserver->sworker.wmainepfd, EPOLL_CTL_DEL, dmserver->sconn.sfd, NULL);
+            for (size_t i = 0; i < dmserver->slisteners_count; i++) epoll_ctl(dmserver->sworker.wmainepfd, EPOLL_CTL_DEL, dmserver->slisteners[i].lconn.sfd, NULL);
+            accepting = false;
+        }
+
+        // TLS contexts reloaded, installed before the next accepts:
+        _dmserver_sconn_sslswap(&dmserver->sconn);
+        for (size_t i = 0; i < dmserver->slisteners_count; i++) _dmserver_sconn_sslswap(&dmserver->slisteners[i].lconn);
+
         for (size_t i = 0; i < nfds; i++){
-            // Server client connection manager:
-            _dmserver_helper_smanager(dmserver);
+            // Wake up event (upstream connection attempts or injected connections pending, stop, drain or TLS reload), consume it:
+            if (evs[i].data.u64 == UINT64_MAX) {
+                eventfd_t evval;
+                eventfd_read(dmserver->sworker.wmainevfd, &evval);
+                continue;
+            }
+
+            // Shards bus messages (broadcasts & unicasts from other shards) delivered to the own clients:
+            if (evs[i].data.u64 == UINT64_MAX - 1) {
+                _dmserver_helper_shards(dmserver);
+                continue;
+            }
+            if (!accepting) continue;
+
+            // Listener of the event & its callbacks set:
+            size_t l = evs[i].data.u64;
+            dmserver_servconn_pt s = (l == 0) ? &dmserver->sconn : &dmserver->slisteners[l - 1].lconn;
+            dmserver_callback_pt cb = ((l == 0) || !dmserver->slisteners[l - 1].lcallback_own) ? &dmserver->scallback : &dmserver->slisteners[l - 1].lcallback;
+            dmserver_proxytarget_pt pt = (l == 0) ? &dmserver->sproxy : &dmserver->slisteners[l - 1].lproxy;
+
+            // Server client connection manager (accept until the listener backlog is empty, edge triggered):
+            while (_dmserver_helper_smanager(dmserver, s, cb, pt->tenabled ? pt : NULL));
         }
+
+        // Upstreams closes requested, connection attempts due (pool members down) & injected connections pending:
+        _dmserver_helper_upclose(dmserver);
+        _dmserver_helper_upretry(dmserver);
+        _dmserver_helper_injected(dmserver);
     }
 
-    // Delete the server socket file descriptor from main thread epoll:
+    // Delete the listeners (and shards bus) file descriptors from main thread epoll:
+    if (shards_evfd >= 0) epoll_ctl(dmserver->sworker.wmainepfd, EPOLL_CTL_DEL, shards_evfd, NULL);
     epoll_ctl(dmserver->sworker.wmainepfd, EPOLL_CTL_DEL, dmserver->sconn.sfd, NULL);
+    for (size_t i = 0; i < dmserver->slisteners_count; i++) epoll_ctl(dmserver->sworker.wmainepfd, EPOLL_CTL_DEL, dmserver->slisteners[i].lconn.sfd, NULL);
     return NULL;
 }
 
@@ -214,28 +668,143 @@ void * _dmserver_worker_sub(void * args){
     pthread_t ctimeout_th;
     if (pthread_create(&ctimeout_th, NULL, _dmserver_subworker_timeout, args)) return NULL;
 
+    // Subthread pinned to its cpu (if configured):
+    if (dmserver->sworker.wth_ncpus > 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(dmserver->sworker.wth_cpus[dmthindex % dmserver->sworker.wth_ncpus], &cpus);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus))
+            dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "_dmserver_worker_sub() - Subthread %lu cpu pinning failed.", dmthindex);
+    }
+
     // Prepare the subordinate thread epoll to optimize CPU usage:
     struct epoll_event evs[dmserver->sworker.wth_clispersth];
 
+    // Datagram mode, the subthread socket is registered as an event source:
+    dmserver_dgram_pt dmdgram = (dmserver->sworker.wsubdgram) ? &dmserver->sworker.wsubdgram[dmthindex] : NULL;
+    if (dmdgram && (epoll_ctl(dmserver->sworker.wsubepfd[dmthindex], EPOLL_CTL_ADD, dmdgram->dfd, &(struct epoll_event){.events=EPOLLIN|EPOLLET, .data.ptr=dmdgram}) < 0)) {
+        pthread_cancel(ctimeout_th);
+        pthread_join(ctimeout_th, NULL);
+        return NULL;
+    }
+
+    // Low latency mode, adaptive spin budget (grows when spinning catches events, shrinks when not):
+    long spin_max = (long)dmserver->sworker.wth_busypoll * 1000;
+    long spin_budget = spin_max;
+    long spin_last = _dmserver_helper_nowns();
+
+    // Overload controller of the subthread (fresh on every run):
+    _dmserver_overload_reset(&dmserver->sworker.wsubcodel[dmthindex]);
+
     while (dmserver->sstate == DMSERVER_STATE_RUNNING){
-        // Epoll wait for events:
-        int nfds = epoll_wait(dmserver->sworker.wsubepfd[dmthindex], evs, dmserver->sworker.wth_clispersth, 4000);
-        if ((nfds < 0)  || (errno == EINTR)) continue;
+        // Clients timeouts check requested (disconnections only done by the subthread itself):
+        if (__atomic_exchange_n(&dmserver->sworker.wtocheck[dmthindex], false, __ATOMIC_ACQ_REL)) _dmserver_worker_timeouts(dmserver, dmthindex);
+
+        // Epoll wait for events (non-blocking while inside the spin budget):
+        int ep_timeout = 4000;
+        if (spin_max > 0) {
+            if ((_dmserver_helper_nowns() - spin_last) < spin_budget) ep_timeout = 0;
+            else if (spin_budget > spin_max / 16) spin_budget /= 2;
+        }
+        ep_timeout = _dmserver_helper_ccdefertimeout(dmserver, dmthindex, ep_timeout);
+
+        // Overloaded subthread sampled at least once per interval (to leave the overload once idle):
+        if (_dmserver_overload_state(&dmserver->sworker.wsubcodel[dmthindex]) && (ep_timeout > (int)(dmserver->sworker.wovl_interval / 1000))) ep_timeout = (int)(dmserver->sworker.wovl_interval / 1000);
+
+        // Shared memory clients told to signal the next frame before blocking (none if frames pending):
+        ep_timeout = _dmserver_helper_shmtimeout(dmserver, dmthindex, ep_timeout);
+        int nfds = epoll_wait(dmserver->sworker.wsubepfd[dmthindex], evs, dmserver->sworker.wth_clispersth, ep_timeout);
+        if (nfds < 0) continue;
+        long round_start = (dmserver->sworker.wovl_target) ? _dmserver_helper_nowns() : 0;
+
+        // Spin budget adaptation (events caught while spinning grow it, expired spins shrink it):
+        if ((spin_max > 0) && (nfds > 0)) {
+            if ((ep_timeout == 0) && (spin_budget < spin_max)) spin_budget = (spin_budget * 2 > spin_max) ? spin_max : spin_budget * 2;
+            spin_last = _dmserver_helper_nowns();
+        }
 
         for (size_t i = 0; i < nfds; i++){
+            // Wake up event (pending flush from other threads or stop), consume it:
+            if (!evs[i].data.ptr) {
+                eventfd_t evval;
+                eventfd_read(dmserver->sworker.wsubevfd[dmthindex], &evval);
+                continue;
+            }
+
+            // Event source (tagged on init), every source but the clients handled here:
+            switch (((dmserver_evsrc_pt)evs[i].data.ptr)->etype){
+                // Datagram socket event, receive all the pending datagrams:
+                case DMSERVER_EVSRC_DGRAM:
+                    _dmserver_helper_dgread(dmserver, dmthindex);
+                    continue;
+
+                // User event source (timer or user fd), its callback called here:
+                case DMSERVER_EVSRC_USEREV:
+                    _dmserver_userev_dispatch(&dmserver->sworker.wsubuserevs[dmthindex], evs[i].data.ptr, evs[i].events);
+                    continue;
+
+                // Proxy pair upstream socket event:
+                case DMSERVER_EVSRC_PROXY:
+                    _dmserver_helper_ccproxy(dmserver, ((dmserver_proxy_pt)evs[i].data.ptr)->pcli, dmthindex, true);
+                    continue;
+
+                // Shared memory client signal (frames or ring space while sleeping), consumed here and its
+                // rings swept at the end of the round:
+                case DMSERVER_EVSRC_SHM: {
+                    eventfd_t evval;
+                    eventfd_read(_dmserver_shm_evfd((dmserver_shmconn_pt)evs[i].data.ptr), &evval);
+                    continue;
+                }
+
+                case DMSERVER_EVSRC_CLIENT:
+                    break;
+            }
+
             // Obtain the pointer and check the state of the client that generated the event:
             dmserver_cliconn_pt dmclient = evs[i].data.ptr;
-            if (!dmclient || ((dmclient->cstate != DMSERVER_CLIENT_ESTABLISHED) && (dmclient->cstate != DMSERVER_CLIENT_ESTABLISHING))) continue;
+            if ((dmclient->cstate != DMSERVER_CLIENT_ESTABLISHED) && (dmclient->cstate != DMSERVER_CLIENT_ESTABLISHING)) continue;
 
-            // Connection stages check:
+            // Connection stages check (outbound connect, then TLS handshake):
+            if(!_dmserver_helper_ccconnect(dmserver, dmclient)) continue;
             if(!_dmserver_helper_csslhandshake(dmserver, dmclient)) continue;
 
+            // Proxied client, bytes relayed to/from its upstream (no reception callbacks):
+            if (dmclient->cproxy) {
+                _dmserver_helper_ccproxy(dmserver, dmclient, dmthindex, false);
+                continue;
+            }
+
+            // Zero copy sends completed (error queue notifications), their pinned messages released:
+            if ((evs[i].events & EPOLLERR) && dmclient->czc_min) {
+                pthread_mutex_lock(&dmclient->cwlock);
+                _dmserver_cconn_zcreap(dmclient, &dmserver->sworker.wzcstats);
+                pthread_mutex_unlock(&dmclient->cwlock);
+            }
+
             // Handle read:
             if(!_dmserver_helper_ccread(dmserver, dmclient, dmthindex, evs, i)) continue;
 
             // Handle write:
             if(!_dmserver_helper_ccwrite(dmserver, dmclient, dmthindex, evs, i)) continue;
         }
+
+        // Read the shared memory clients rings (frames written since the last round):
+        _dmserver_helper_shmsweep(dmserver, dmthindex);
+
+        // Read the deferred clients whose time has come (not drained or resumed from a pause):
+        _dmserver_helper_ccdeferred(dmserver, dmthindex);
+
+        // Deliver all the data read in this round (batched reception):
+        _dmserver_helper_ccrcvbatch(dmserver, dmthindex);
+
+        // Overload control sample of the round (before the flush empties its queue):
+        if (round_start) _dmserver_helper_ovlsample(dmserver, dmthindex, round_start);
+
+        // Write all the data queued during this round:
+        _dmserver_helper_ccflush(dmserver, dmthindex);
+
+        // Free the user event sources removed during this round:
+        _dmserver_userevs_reap(&dmserver->sworker.wsubuserevs[dmthindex]);
     }
 
     // Kill the timeout checker thread:
@@ -246,13 +815,14 @@ void * _dmserver_worker_sub(void * args){
     for (size_t i = 0; i < dmserver->sworker.wth_clispersth; i++){
         dmserver_disconnect(dmserver, &(dmserver_cliloc_t){.th_pos=dmthindex, .wc_pos=i});
     }
+    if (dmdgram) epoll_ctl(dmserver->sworker.wsubepfd[dmthindex], EPOLL_CTL_DEL, dmdgram->dfd, NULL);
 
     return NULL;
 }
 
 /*
-    @brief Function that implements the subthread to check clients timeout periodically of the
-    subordinate worker creator.
+    @brief Function that implements the subthread to request the clients timeout check periodically
+    to the subordinate worker creator (the check & disconnections run on the subordinate worker).
     @note: The argument memory liberation happens here.
 
     @param void * args: Reference to the arguments structure.
@@ -270,13 +840,11 @@ void * _dmserver_subworker_timeout(void * args){
     free(args);
 
     while (true){
-        // Check timeout of the subworker clients:
-        for (size_t i = 0; i < dmserver->sworker.wth_clispersth; i++){
-            _dmserver_helper_cctimeout(dmserver, &dmserver->sworker.wcclis[dmthindex][i]); 
-        }
+        // Check timeout of the subworker clients requested to the subthread:
+        _dmserver_worker_qtimeouts(&dmserver->sworker, dmthindex);
 
-        // CPU sleep to avoid overload:
-        sleep(dmserver->sworker.wth_clistimeout / 8);
+        // CPU sleep to avoid overload (every request wakes the subthread, at least a second):
+        sleep((dmserver->sworker.wth_clistimeout >= 8) ? dmserver->sworker.wth_clistimeout / 8 : 1);
     }
 
     return NULL;
@@ -285,63 +853,425 @@ void * _dmserver_subworker_timeout(void * args){
 
 
 
-/* ---- STATIC INTERNAL - Helper functions implementation --------- */
+// ======== Write flush queue:
 /*
-    @brief Helper function that implements the server connection, distribution and management of an
-    incoming client connection.
-    
-    @param dmserver_pt server: Reference to the server struct.
+    @brief Function to queue a client to be written at the end of the current round of its
+    subordinate thread. If the caller is not the subordinate thread itself, the thread is woken up.
+    @note: The output event is only armed by the subordinate thread when the socket is full (EAGAIN).
 
-    @retval None.
-*/
-static void _dmserver_helper_smanager(dmserver_pt dmserver){
-    // Accept TCP connection:
-    int temp_cfd;
-    struct sockaddr_storage temp_caddr;
-    socklen_t temp_caddrlen = sizeof(temp_caddr);
-    temp_cfd = accept4(dmserver->sconn.sfd, (struct sockaddr *)&temp_caddr, &temp_caddrlen, SOCK_NONBLOCK);
-    if (temp_cfd < 0) return;
+    @param dmserver_worker_pt w: Reference to worker structure.
+    @param dmserver_cliconn_pt c: Reference to client with data pending to write.
 
-    // Distribute client to the less populated subordinate thread and the next free slot (just find the location in the client matrix):
-    size_t temp_thindex = 0;
-    for (size_t i = 0; i < dmserver->sworker.wth_subthreads; i++){
-        if (dmserver->sworker.wccount[i] < dmserver->sworker.wccount[temp_thindex]) temp_thindex = i;
-    }
-    size_t temp_cindex = 0;
-    for (size_t i = 0; i < dmserver->sworker.wth_clispersth; i++){
-        if (dmserver->sworker.wcclis[temp_thindex][i].cstate == DMSERVER_CLIENT_STANDBY) {
-            temp_cindex = i;
-            break;
-        }
+    @retval true: Client queued (or already queued).
+    @retval false: Client could not be queued.
+*/
+bool _dmserver_worker_qflush(dmserver_worker_pt w, dmserver_cliconn_pt c){
+    // References check:
+    if (!w || !c) return false;
+    size_t th = c->cloc.th_pos;
+
+    // Queue the client (only once per round):
+    pthread_mutex_lock(&w->wflushlock[th]);
+    if (c->cwqueued) {
+        pthread_mutex_unlock(&w->wflushlock[th]);
+        return true;
     }
-
-    // Check if server capacity is full:
-    dmserver_cliconn_pt dmclient = &dmserver->sworker.wcclis[temp_thindex][temp_cindex];
-    if ((dmclient->cstate == DMSERVER_CLIENT_ESTABLISHING) || (dmclient->cstate == DMSERVER_CLIENT_ESTABLISHED)){
-        close(temp_cfd);
-        return;
+    if (w->wflushcount[th] >= w->wth_clispersth) {
+        pthread_mutex_unlock(&w->wflushlock[th]);
+        return false;
     }
-    dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "_dmserver_worker_main() - Client %d connection stage TCP ok.", temp_cfd);
-    dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "_dmserver_worker_main() - Client %d assigned to point (%lu, %lu).", temp_cfd, temp_thindex, temp_cindex);
+    bool wake = (w->wflushcount[th] == 0);
+    if (wake && w->wovl_target) w->wflushts[th] = _dmserver_helper_nowns();
+    w->wflushq[th][w->wflushcount[th]++] = c;
+    c->cwqueued = true;
+    pthread_mutex_unlock(&w->wflushlock[th]);
+
+    // Wake up the subordinate thread (only on empty queue and from foreign threads):
+    if (wake && !pthread_equal(pthread_self(), w->wsubth[th])) eventfd_write(w->wsubevfd[th], 1);
+    return true;
+}
 
-    // Set the connection data into the selected client slot & add fd to the subthread epoll:
-    if(!_dmserver_cconn_set(dmclient, &(dmserver_cliloc_t){.th_pos=temp_thindex, .wc_pos=temp_cindex}, temp_cfd, &temp_caddr, NULL)) {
-        close(temp_cfd); 
-        return;
-    }
+/*
+    @brief Function to request the disconnection of a client to its subordinate thread, for the
+    disconnections from foreign threads (the client resources are only touched by its subthread).
 
-    // Add the connected client to the subordinate thread:
-    if (dmserver->sconn.sssl_enable) {
-        // TCP + TLS(establishing):
-        dmclient->cstate = DMSERVER_CLIENT_ESTABLISHING;
+    @param dmserver_worker_pt w: Reference to worker structure.
+    @param dmserver_cliconn_pt c: Reference to client to disconnect.
+
+    @retval true: Disconnection requested (done at the end of the subthread round).
+    @retval false: Client could not be queued.
+*/
+bool _dmserver_worker_qdisconnect(dmserver_worker_pt w, dmserver_cliconn_pt c){
+    // References check:
+    if (!w || !c) return false;
+
+    // Flagged (no more messages queued to it) & queued to its subthread flush:
+    pthread_mutex_lock(&c->cwlock);
+    c->cdisreq = true;
+    pthread_mutex_unlock(&c->cwlock);
+    return _dmserver_worker_qflush(w, c);
+}
+
+// ======== Clients timeouts:
+/*
+    @brief Function to request the clients timeout check to a subordinate thread (run at the start
+    of its next round), the subthread is woken up.
+
+    @param dmserver_worker_pt w: Reference to worker structure.
+    @param size_t th: Subthread index.
+*/
+void _dmserver_worker_qtimeouts(dmserver_worker_pt w, size_t th){
+    // References check:
+    if (!w || !w->wtocheck || (th >= w->wth_subthreads)) return;
+
+    __atomic_store_n(&w->wtocheck[th], true, __ATOMIC_RELEASE);
+    eventfd_write(w->wsubevfd[th], 1);
+}
+
+/*
+    @brief Function to check the timeout of every client of a subthread against the worker clock (the
+    timed out ones disconnected).
+    @note: Only the subthread itself (its clients resources are not locked).
+
+    @param void * args: Reference to the dmserver struct.
+    @param size_t dmthindex: Subthread index.
+*/
+void _dmserver_worker_timeouts(void * args, size_t dmthindex){
+    // Reference check and cast:
+    if (!args) return;
+    dmserver_pt dmserver = (dmserver_pt)args;
+
+    for (size_t i = 0; i < dmserver->sworker.wth_clispersth; i++){
+        _dmserver_helper_cctimeout(dmserver, &dmserver->sworker.wcclis[dmthindex][i]); 
+    }
+}
+
+// ======== Shared memory connections:
+/*
+    @brief Function to close the shared memory connection of a client (wake up event out of its
+    subthread epoll, rings unmapped). Clients of other transports are ignored.
+    @note: The client socket is closed by the caller.
+
+    @param dmserver_worker_pt w: Reference to worker structure.
+    @param dmserver_cliconn_pt c: Reference to client.
+*/
+void _dmserver_worker_shmclose(dmserver_worker_pt w, dmserver_cliconn_pt c){
+    // References & transport check:
+    if (!w || !c || (c->ctransport != DMSERVER_TRANSPORT_SHM)) return;
+    dmserver_shmconn_pt shm = &w->wshm[c->cloc.th_pos][c->cloc.wc_pos];
+
+    epoll_ctl(w->wsubepfd[c->cloc.th_pos], EPOLL_CTL_DEL, _dmserver_shm_evfd(shm), NULL);
+    _dmserver_shm_close(shm);
+    _dmserver_cconn_settransport(c, DMSERVER_TRANSPORT_STREAM);
+    __atomic_sub_fetch(&w->wshmcount[c->cloc.th_pos], 1, __ATOMIC_RELAXED);
+}
+
+/*
+    @brief Function to check that a payload fits in one frame of the client shared memory connection
+    (frames are never split), counted as oversized otherwise. Clients of other transports always fit.
+
+    @param dmserver_worker_pt w: Reference to worker structure.
+    @param dmserver_cliconn_pt c: Reference to client.
+    @param size_t len: Payload length.
+
+    @retval true: Payload fits (or not a shared memory client).
+    @retval false: Payload over the largest frame.
+*/
+bool _dmserver_worker_shmfits(dmserver_worker_pt w, dmserver_cliconn_pt c, size_t len){
+    // References & transport check:
+    if (!w || !c || (c->ctransport != DMSERVER_TRANSPORT_SHM)) return true;
+
+    if (len <= _dmserver_shm_maxlen(&w->wshm[c->cloc.th_pos][c->cloc.wc_pos])) return true;
+    __atomic_add_fetch(&w->wslowstats.soversized, 1, __ATOMIC_RELAXED);
+    return false;
+}
+
+// ======== Test transport:
+/*
+    @brief Function to hand a connection to the main thread, which sets it up as a plain client (no
+    TLS, access control nor reception limits by source) on the subthread wanted, as if accepted.
+    @note: Meant for socketpair ends, so the callbacks can be driven without the network stack.
+
+    @param dmserver_worker_pt w: Reference to worker structure.
+    @param int fd: Server end of the connection (owned by the worker from now on).
+    @param size_t th: Subthread wanted (SIZE_MAX the less populated).
+
+    @retval true: Connection handed to the main thread.
+    @retval false: Injected connections pending full.
+*/
+bool _dmserver_worker_inject(dmserver_worker_pt w, int fd, size_t th){
+    // References check:
+    if (!w || (fd < 0)) return false;
+
+    pthread_mutex_lock(&w->winjectlock);
+    if (w->winjectcount == DEFAULT_WORKER_INJECTLEN) {
+        pthread_mutex_unlock(&w->winjectlock);
+        return false;
+    }
+    w->winject[w->winjectcount++] = (struct dmserver_inject){.ifd=fd, .ith=th};
+    pthread_mutex_unlock(&w->winjectlock);
+
+    // Main thread wake up:
+    eventfd_write(w->wmainevfd, 1);
+    return true;
+}
+
+/*
+    @brief Function to get the time of the worker clock (clients activity & timeouts), the virtual
+    clock if set or the wall clock.
+
+    @param dmserver_worker_pt w: Reference to worker structure.
+
+    @retval Current time in seconds.
+*/
+time_t _dmserver_worker_now(dmserver_worker_pt w){
+    time_t now = __atomic_load_n(&w->wvclock, __ATOMIC_RELAXED);
+    return (now) ? now : time(NULL);
+}
+
+
+
+
+// ======== Shared messages output:
+/*
+    @brief Function to create a shared output message accounted in the pending output memory of the
+    worker (while the memory budget is exceeded, clients with pending messages are considered behind).
+
+    @param dmserver_worker_pt w: Worker struct reference.
+    @param const char * mdata: Message data.
+    @param size_t mlen: Message data length.
+    @param const char * mkey: Coalescing key of the message (NULL for none).
+
+    @retval Reference to the new message (one reference owned by the caller), NULL on failure.
+*/
+dmserver_cmsg_pt _dmserver_worker_msgnew(dmserver_worker_pt w, const char * mdata, size_t mlen, const char * mkey){
+    // Reference check:
+    if (!w || !mdata || (mlen == 0)) return NULL;
+
+    // Message creation:
+    dmserver_cmsg_pt m = _dmserver_cmsg_new(mdata, mlen);
+    if (!m) return NULL;
+    m->mkey = _dmserver_pubsub_key(mkey);
+
+    // Pending output memory accounting (released with the message):
+    m->mbudget = &w->wslowstats.sout_bytes;
+    size_t out = __atomic_add_fetch(&w->wslowstats.sout_bytes, mlen, __ATOMIC_RELAXED);
+    if (w->wout_budget && (out > w->wout_budget)) __atomic_add_fetch(&w->wslowstats.sbudget_exceeded, 1, __ATOMIC_RELAXED);
+    return m;
+}
+
+/*
+    @brief Function to queue a shared message to a client applying the slow consumer policy when the
+    client is behind, and to queue the client to be written at the end of its subthread round.
+    @note: Slow consumers disconnection is only requested here, and done by the client subthread.
+    Datagram sessions get one datagram per queued message.
+
+    @param dmserver_worker_pt w: Worker struct reference.
+    @param dmserver_cliconn_pt c: Reference to client.
+    @param dmserver_cmsg_pt m: Reference to message.
+    @param dmserver_slow_conf_pt sc: Slow consumers policy to apply.
+
+    @retval true: Message queued (or coalesced).
+    @retval false: Message not queued (dropped, over the client largest frame or client disconnecting).
+*/
+bool _dmserver_worker_qpush(dmserver_worker_pt w, dmserver_cliconn_pt c, dmserver_cmsg_pt m, dmserver_slow_conf_pt sc){
+    // References & state check:
+    if (!w || !c || !m || !sc) return false;
+    pthread_mutex_lock(&c->cwlock);
+    if ((c->cstate != DMSERVER_CLIENT_ESTABLISHED) || c->cwkick || c->cdisreq) {
+        pthread_mutex_unlock(&c->cwlock);
+        return false;
+    }
+
+    // Shared memory clients, payloads over the largest frame rejected (never written):
+    if (!_dmserver_worker_shmfits(w, c, m->mlen)) {
+        pthread_mutex_unlock(&c->cwlock);
+        return false;
+    }
+
+    // Coalescing with a pending message of the same key:
+    if ((sc->spolicy == DMSERVER_SLOW_COALESCE) && _dmserver_cconn_wqreplace(c, m)) {
+        __atomic_add_fetch(&w->wslowstats.scoalesced, 1, __ATOMIC_RELAXED);
+        pthread_mutex_unlock(&c->cwlock);
+        return _dmserver_worker_qflush(w, c);
+    }
+
+    // Slow consumer policy when the client is behind:
+    bool queued = false;
+    switch (_dmserver_helper_slow(w, c, m, sc) ? sc->spolicy : DMSERVER_SLOW_DROP_NEWEST){
+        case DMSERVER_SLOW_DISCONNECT:
+            // Disconnection requested to the client subthread:
+            c->cwkick = true;
+            __atomic_add_fetch(&w->wslowstats.sdisconnected, 1, __ATOMIC_RELAXED);
+            pthread_mutex_unlock(&c->cwlock);
+            _dmserver_worker_qflush(w, c);
+            return false;
+
+        case DMSERVER_SLOW_DROP_OLDEST:
+        case DMSERVER_SLOW_COALESCE:
+            // Oldest pending messages dropped until the client is no longer behind:
+            while (_dmserver_helper_slow(w, c, m, sc) && _dmserver_cconn_wqdropold(c)) __atomic_add_fetch(&w->wslowstats.sdropped_oldest, 1, __ATOMIC_RELAXED);
+            if (!_dmserver_helper_slow(w, c, m, sc)) queued = _dmserver_cconn_wqpush(c, m);
+            break;
+
+        case DMSERVER_SLOW_DROP_NEWEST:
+        default:
+            // New message queued only if the client is not behind:
+            if (!_dmserver_helper_slow(w, c, m, sc)) queued = _dmserver_cconn_wqpush(c, m);
+            break;
+    }
+    if (!queued) __atomic_add_fetch(&w->wslowstats.sdropped_newest, 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&c->cwlock);
+
+    // Queue the client to be written at the end of its subordinate thread round:
+    return queued && _dmserver_worker_qflush(w, c);
+}
+
+/*
+    @brief Function to get the slow consumers policy of a topic (server default if not specific).
+
+    @param dmserver_worker_pt w: Worker struct reference.
+    @param const char * topic: Topic name (NULL for the server default).
+
+    @retval Reference to the slow consumers policy.
+*/
+dmserver_slow_conf_pt _dmserver_worker_slowconf(dmserver_worker_pt w, const char * topic){
+    for (size_t i = 0; topic && (i < w->wtopicslow_count); i++){
+        if (!strcmp(w->wtopicslow[i].tname, topic)) return &w->wtopicslow[i].tslow;
+    }
+    return &w->wslow;
+}
+
+/*
+    @brief Function to queue a shared payload to every connected client of the worker (copied once,
+    shared by all the clients). Upstream connections and proxied clients are skipped.
+
+    @param dmserver_worker_pt w: Worker struct reference.
+    @param dmserver_cliloc_pt bexclude: Client excluded (NULL none).
+    @param const char * bcdata: Payload.
+    @param size_t bclen: Payload length.
+
+    @retval Number of clients the payload was queued to, -1 on allocation failure.
+*/
+long _dmserver_worker_bcast(dmserver_worker_pt w, dmserver_cliloc_pt bexclude, const char * bcdata, size_t bclen){
+    // Shared payload (broadcaster reference released at the end):
+    dmserver_cmsg_pt m = _dmserver_worker_msgnew(w, bcdata, bclen, NULL);
+    if (!m) return -1;
+
+    long queued = 0;
+    for (size_t i = 0; i < w->wth_subthreads; i++){for (size_t j = 0; j < w->wth_clispersth; j++){
+        // Check client broadcast condition:
+        dmserver_cliconn_pt dmclient = &w->wcclis[i][j];
+        if ((dmclient->cstate != DMSERVER_CLIENT_ESTABLISHED) || dmclient->cupstream || dmclient->cproxy) continue;
+        if (bexclude && (dmclient->cloc.th_pos == bexclude->th_pos) && (dmclient->cloc.wc_pos == bexclude->wc_pos)) continue;
+
+        // Queue the shared payload & the client to be written at the end of its subordinate thread round:
+        if (_dmserver_worker_qpush(w, dmclient, m, &w->wslow)) queued++;
+    }}
+    _dmserver_cmsg_unref(m);
+    return queued;
+}
+
+
+
+
+/* ---- STATIC INTERNAL - Helper functions implementation --------- */
+/*
+    @brief Helper function that implements the server connection, distribution and management of an
+    incoming client connection.
+    
+    @param dmserver_pt server: Reference to the server struct.
+    @param dmserver_servconn_pt s: Listener with the connection pending.
+    @param dmserver_callback_pt cb: Callbacks set of the listener.
+    @param dmserver_proxytarget_pt pt: Proxy target of the listener (NULL not proxied).
+
+    @retval true: Connection accepted (established or refused), there may be more pending.
+    @retval false: Nothing left to accept.
+*/
+static bool _dmserver_helper_smanager(dmserver_pt dmserver, dmserver_servconn_pt s, dmserver_callback_pt cb, dmserver_proxytarget_pt pt){
+    // Accept TCP connection:
+    int temp_cfd;
+    struct sockaddr_storage temp_caddr;
+    socklen_t temp_caddrlen = sizeof(temp_caddr);
+    temp_cfd = accept4(s->sfd, (struct sockaddr *)&temp_caddr, &temp_caddrlen, SOCK_NONBLOCK);
+    if (temp_cfd < 0) return false;
+    DMSERVER_PROBE2(accept, temp_cfd, (int)temp_caddr.ss_family);
+
+    // Access control of the source address (before any allocation): allow/deny rules & connections per IP:
+    dmserver_ipentry_pt temp_ipentry = NULL;
+    if (!_dmserver_acl_check(&dmserver->sacl, &temp_caddr) || !_dmserver_limits_ipacquire(&dmserver->slimits, &temp_caddr, &temp_ipentry)) {
+        dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "_dmserver_worker_main() - Client %d refused by access control.", temp_cfd);
+        close(temp_cfd);
+        return true;
+    }
+
+    // Accepted socket tuning (best effort, the connection is kept with the options that succeeded):
+    if (!_dmserver_sconn_ccsetopts(s, temp_cfd)) 
+        dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "_dmserver_worker_main() - Client %d socket tuning partially applied.", temp_cfd);
+
+    // Distribute client to the less populated subordinate thread not overloaded and the next free slot (just find the location in the client matrix):
+    bool temp_overloaded = true;
+    dmserver_cliloc_t temp_cloc;
+    dmserver_cliconn_pt dmclient = _dmserver_helper_cslot(dmserver, &temp_cloc, &temp_overloaded);
+
+    // Every subthread overloaded, new connection rejected right away (before the TLS handshake):
+    if (temp_overloaded && dmserver->sworker.wovl_reject) {
+        __atomic_add_fetch(&dmserver->sworker.wovlstats.orejected, 1, __ATOMIC_RELAXED);
+        dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "_dmserver_worker_main() - Client %d rejected by overload control.", temp_cfd);
+        _dmserver_limits_iprelease(temp_ipentry);
+        close(temp_cfd);
+        return true;
+    }
+
+    // Check if server capacity is full:
+    if (!dmclient){
+        _dmserver_limits_iprelease(temp_ipentry);
+        close(temp_cfd);
+        return true;
+    }
+    size_t temp_thindex = temp_cloc.th_pos;
+    size_t temp_cindex = temp_cloc.wc_pos;
+    dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "_dmserver_worker_main() - Client %d connection stage TCP ok.", temp_cfd);
+    dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "_dmserver_worker_main() - Client %d assigned to point (%lu, %lu).", temp_cfd, temp_thindex, temp_cindex);
+
+    // Set the connection data into the selected client slot & add fd to the subthread epoll:
+    if(!_dmserver_cconn_set(dmclient, &(dmserver_cliloc_t){.th_pos=temp_thindex, .wc_pos=temp_cindex}, temp_cfd, &temp_caddr, NULL, _dmserver_worker_now(&dmserver->sworker))) {
+        _dmserver_limits_iprelease(temp_ipentry);
+        close(temp_cfd); 
+        return true;
+    }
+
+    // Source IP entry of the client (released with the slot reset), listener that accepted it & its proxy target:
+    dmclient->cipentry = temp_ipentry;
+    dmclient->csconn = s;
+    dmclient->ccallback = cb;
+    dmclient->cproxy = pt;
+
+    // Zero copy sends of the large queued messages (TCP without TLS when configured):
+    if (!pt) dmclient->czc_min = _dmserver_sconn_cczerocopy(s, dmclient->cfd);
+
+    // Shared memory transport (unix domain listeners without TLS nor proxy), rings offered to the client:
+    if (s->sunixshm && (s->ssafamily == AF_UNIX) && !s->sssl_enable && !pt && !_dmserver_helper_shmopen(dmserver, dmclient)) {
+        dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "_dmserver_worker_main() - Client %d shared memory rings not offered.", dmclient->cfd);
+        close(dmclient->cfd);
+        dmclient->cstate = DMSERVER_CLIENT_CLOSED;
+        _dmserver_cconn_reset(dmclient);
+        return true;
+    }
+
+    // Add the connected client to the subordinate thread:
+    if (s->sssl_enable) {
+        // TCP + TLS(establishing):
+        dmclient->cstate = DMSERVER_CLIENT_ESTABLISHING;
 
         // SSL object:
-        dmclient->cssl = SSL_new(dmserver->sconn.sssl_ctx);
+        dmclient->cssl = SSL_new(s->sssl_ctx);
         if (!dmclient->cssl) {
             epoll_ctl(dmserver->sworker.wmainepfd, EPOLL_CTL_DEL, dmclient->cfd, NULL);
             close(dmclient->cfd);
+            dmclient->cstate = DMSERVER_CLIENT_CLOSED;
             _dmserver_cconn_reset(dmclient);
-            return;    
+            return true;
         }
 
         // Create BIO for the socket (non-blocking I/O):
@@ -350,46 +1280,346 @@ static void _dmserver_helper_smanager(dmserver_pt dmserver){
             SSL_free(dmclient->cssl);
             epoll_ctl(dmserver->sworker.wmainepfd, EPOLL_CTL_DEL, dmclient->cfd, NULL);
             close(dmclient->cfd);
+            dmclient->cstate = DMSERVER_CLIENT_CLOSED;
             _dmserver_cconn_reset(dmclient);
-            return;
+            return true;
         }
 
         // Assign BIO to SSL object for both read and write operations:
         SSL_set_bio(dmclient->cssl, dmclient->cbio, dmclient->cbio);
+        SSL_set_accept_state(dmclient->cssl);
+#ifdef SSL_OP_ENABLE_KTLS
+        // Kernel TLS offload requested for the proxied clients (splice between the sockets if enabled):
+        if (pt) SSL_set_options(dmclient->cssl, SSL_OP_ENABLE_KTLS);
+#endif
 
         // Distribute the client to the subordinate thread:
         if (epoll_ctl(dmserver->sworker.wsubepfd[temp_thindex], EPOLL_CTL_ADD, dmclient->cfd, &(struct epoll_event){.events=EPOLLIN | EPOLLOUT | EPOLLET, .data.ptr=dmclient}) < 0){
+            SSL_free(dmclient->cssl);
             close(dmclient->cfd);
-            _dmserver_cconn_reset(dmclient); 
-            return;
+            dmclient->cstate = DMSERVER_CLIENT_CLOSED;
+            _dmserver_cconn_reset(dmclient);
+            return true;
         }
+        DMSERVER_PROBE1(tls_start, dmclient->cfd);
 
     } else {
         // TCP(established):
         dmclient->cstate = DMSERVER_CLIENT_ESTABLISHED;
 
-        // Distribute the client to the subordinate thread:
-        if (epoll_ctl(dmserver->sworker.wsubepfd[temp_thindex], EPOLL_CTL_ADD, dmclient->cfd, &(struct epoll_event){.events=EPOLLIN | EPOLLET, .data.ptr=dmclient}) < 0) {
+        // Distribute the client to the subordinate thread (proxied clients with the output event, their first one opens the pair):
+        if (epoll_ctl(dmserver->sworker.wsubepfd[temp_thindex], EPOLL_CTL_ADD, dmclient->cfd, &(struct epoll_event){.events=EPOLLIN | EPOLLET | (pt ? EPOLLOUT : 0), .data.ptr=dmclient}) < 0) {
+            // Closed before its rings (no longer swept by the subthread):
+            dmclient->cstate = DMSERVER_CLIENT_CLOSED;
+            _dmserver_worker_shmclose(&dmserver->sworker, dmclient);
             close(dmclient->cfd);
             _dmserver_cconn_reset(dmclient);
-            return;
+            return true;
         }
 
         // Log message:
-        char cip_str[INET6_ADDRSTRLEN];
-        const void * addr = (dmclient->caddr_family == AF_INET) ? (void*)&dmclient->caddr.c4.sin_addr : (void*)&dmclient->caddr.c6.sin6_addr;
-        inet_ntop(dmclient->caddr_family, addr, cip_str, sizeof(cip_str));
-        int cport_num = (dmclient->caddr_family == AF_INET) ? ntohs(dmclient->caddr.c4.sin_port) : ntohs(dmclient->caddr.c6.sin6_port);
-        dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "Client %d with address %s:%d connected to server.\n", dmclient->cfd, cip_str, cport_num);
+        char caddr_str[DEFAULT_CCONN_ADDRSTRLEN];
+        _dmserver_cconn_addrstr(dmclient, caddr_str, sizeof(caddr_str));
+        dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "Client %d with address %s connected to server.\n", dmclient->cfd, caddr_str);
 
         // On client connect callback event:
-        if (dmserver->scallback.on_client_connect) dmserver->scallback.on_client_connect(&dmserver->sworker.wcclis[dmclient->cloc.th_pos][dmclient->cloc.wc_pos]);
+        DMSERVER_PROBE2(cb_entry, "connect", dmclient->cfd);
+        if (cb->on_client_connect) cb->on_client_connect(&dmserver->sworker.wcclis[dmclient->cloc.th_pos][dmclient->cloc.wc_pos]);
+        DMSERVER_PROBE2(cb_exit, "connect", dmclient->cfd);
+    }
+    __atomic_add_fetch(&dmserver->sworker.wccount[temp_thindex], 1, __ATOMIC_RELAXED);
+    DMSERVER_PROBE3(slot, dmclient->cfd, (int)temp_cloc.th_pos, (int)temp_cloc.wc_pos);
+    _dmserver_capture_record(&dmserver->scapture, DMSERVER_CAPTURE_CONNECT, dmclient, NULL, 0);
+    return true;
+}
+
+/*
+    @brief Helper function that finds the client slot for a new connection: the next free slot of the
+    less populated subordinate thread not overloaded.
+
+    @param dmserver_pt dmserver: Reference to the server struct.
+    @param dmserver_cliloc_pt cloc: Output location of the slot.
+    @param bool * overloaded: Output, every subthread overloaded.
+
+    @retval Reference to the free slot, NULL if the subthread chosen is full.
+*/
+static dmserver_cliconn_pt _dmserver_helper_cslot(dmserver_pt dmserver, dmserver_cliloc_pt cloc, bool * overloaded){
+    size_t temp_thindex = 0;
+    bool temp_overloaded = true;
+    for (size_t i = 0; i < dmserver->sworker.wth_subthreads; i++){
+        bool ovl = _dmserver_overload_state(&dmserver->sworker.wsubcodel[i]);
+        if ((temp_overloaded && !ovl) || ((temp_overloaded == ovl) && (__atomic_load_n(&dmserver->sworker.wccount[i], __ATOMIC_RELAXED) < __atomic_load_n(&dmserver->sworker.wccount[temp_thindex], __ATOMIC_RELAXED)))) {
+            temp_thindex = i;
+            temp_overloaded = ovl;
+        }
+    }
+    *overloaded = temp_overloaded;
+
+    for (size_t i = 0; i < dmserver->sworker.wth_clispersth; i++){
+        if (dmserver->sworker.wcclis[temp_thindex][i].cstate == DMSERVER_CLIENT_STANDBY) {
+            cloc->th_pos = temp_thindex;
+            cloc->wc_pos = i;
+            return &dmserver->sworker.wcclis[temp_thindex][i];
+        }
+    }
+    return NULL;
+}
+
+/*
+    @brief Helper function that starts the connection attempts due of every upstream (main thread).
+
+    @param dmserver_pt dmserver: Reference to the server struct.
+*/
+static void _dmserver_helper_upretry(dmserver_pt dmserver){
+    long now = _dmserver_helper_nowns();
+    dmserver_upstream_pt u;
+    size_t member;
+    for (size_t i = 0; (u = _dmserver_upstreams_get(&dmserver->supstreams, i)); i++){
+        while (_dmserver_upstream_due(u, now, &member)){
+            if (!_dmserver_helper_upconnect(dmserver, u, member))
+                dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "_dmserver_worker_main() - Upstream %lu (%s) member %lu connection attempt failed.", u->uid, u->uhost, member);
+        }
+    }
+}
+
+/*
+    @brief Helper function to deliver the shards bus messages of the own inbox to the own clients
+    (broadcast payloads copied once into a shared message, read in place from the ring slot).
+
+    @param dmserver_pt dmserver: Reference to the server struct.
+*/
+static void _dmserver_helper_shards(dmserver_pt dmserver){
+    // Wake up acknowledged before draining (messages pushed meanwhile wake it up again):
+    _dmserver_shards_ack(&dmserver->sshards);
+
+    dmserver_shardmsg_pt m;
+    while ((m = _dmserver_shards_peek(&dmserver->sshards))){
+        if (m->mtype == DMSERVER_SHARDMSG_BROADCAST) {
+            if (_dmserver_worker_bcast(&dmserver->sworker, NULL, m->mdata, m->mlen) < 0)
+                dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "_dmserver_helper_shards() - Broadcast from shard %lu not delivered.", m->msrc);
+        }
+        else if (!dmserver_unicast(dmserver, &m->mloc, m->mdata))
+            dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "_dmserver_helper_shards() - Unicast from shard %lu not delivered.", m->msrc);
+        _dmserver_shards_release(&dmserver->sshards, m);
+    }
+}
+
+/*
+    @brief Helper function that closes the upstreams with a close requested (main thread, no pool
+    member is being connected meanwhile), their members disconnection requested to their subthreads.
+
+    @param dmserver_pt dmserver: Reference to the server struct.
+*/
+static void _dmserver_helper_upclose(dmserver_pt dmserver){
+    dmserver_upstream_pt u;
+    for (size_t i = 0; (u = _dmserver_upstreams_get(&dmserver->supstreams, i)); i++){
+        if (!_dmserver_upstream_closing(u)) continue;
+
+        // Requested under the upstream lock (members detached from it before their client slot reset):
+        pthread_mutex_lock(&u->ulock);
+        u->uclosed = true;
+        for (size_t j = 0; j < u->upool; j++){
+            if (u->umembers[j].mcli) _dmserver_worker_qdisconnect(&dmserver->sworker, u->umembers[j].mcli);
+        }
+        pthread_mutex_unlock(&u->ulock);
+        dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "_dmserver_worker_main() - Upstream %lu closed.", u->uid);
+    }
+}
+
+/*
+    @brief Helper function that starts the non-blocking connection of an upstream pool member into a
+    client slot, handed to its subordinate thread (output event) to complete the connection (and the
+    TLS handshake as client) as any accepted client.
+
+    @param dmserver_pt dmserver: Reference to the server struct.
+    @param dmserver_upstream_pt u: Upstream.
+    @param size_t member: Pool member to connect.
+
+    @retval true: Connection in progress (or dropped, upstream closed meanwhile).
+    @retval false: Connection failed (next attempt already scheduled).
+*/
+static bool _dmserver_helper_upconnect(dmserver_pt dmserver, dmserver_upstream_pt u, size_t member){
+    // Client slot (not on an overloaded subthread if avoidable):
+    bool temp_overloaded = true;
+    dmserver_cliloc_t temp_cloc;
+    dmserver_cliconn_pt dmclient = _dmserver_helper_cslot(dmserver, &temp_cloc, &temp_overloaded);
+    if (!dmclient) return false;
+
+    // Non-blocking socket (tuned as the accepted ones) & connection start:
+    int temp_cfd = socket(u->uconn.ssafamily, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (temp_cfd < 0) return false;
+    _dmserver_sconn_ccsetopts(&u->uconn, temp_cfd);
+    socklen_t temp_addrlen = (u->uconn.ssafamily == AF_INET6) ? sizeof(u->uconn.saddr.s6) : sizeof(u->uconn.saddr.s4);
+    if ((connect(temp_cfd, (struct sockaddr *)&u->uconn.saddr, temp_addrlen) < 0) && (errno != EINPROGRESS)) {
+        close(temp_cfd);
+        return false;
+    }
+
+    // Set the connection data into the selected client slot (the upstream as its listener):
+    struct sockaddr_storage temp_caddr;
+    memset(&temp_caddr, 0, sizeof(temp_caddr));
+    memcpy(&temp_caddr, &u->uconn.saddr, temp_addrlen);
+    if (!_dmserver_cconn_set(dmclient, &temp_cloc, temp_cfd, &temp_caddr, NULL, _dmserver_worker_now(&dmserver->sworker))) {
+        close(temp_cfd);
+        return false;
+    }
+    dmclient->csconn = &u->uconn;
+    dmclient->ccallback = (u->ucallback_own) ? &u->ucallback : &dmserver->scallback;
+    dmclient->cconnecting = true;
+    dmclient->cstate = DMSERVER_CLIENT_ESTABLISHING;
+
+    // TLS client side (server name indication for host names & host name verification):
+    if (u->uconn.sssl_enable) {
+        dmclient->cssl = SSL_new(u->uconn.sssl_ctx);
+        dmclient->cbio = (dmclient->cssl) ? BIO_new_socket(dmclient->cfd, BIO_NOCLOSE) : NULL;
+        if (!dmclient->cbio) {
+            if (dmclient->cssl) SSL_free(dmclient->cssl);
+            close(dmclient->cfd);
+            dmclient->cstate = DMSERVER_CLIENT_CLOSED;
+            _dmserver_cconn_reset(dmclient);
+            return false;
+        }
+        SSL_set_bio(dmclient->cssl, dmclient->cbio, dmclient->cbio);
+        SSL_set_connect_state(dmclient->cssl);
+
+        struct in6_addr temp_ip;
+        if ((inet_pton(AF_INET, u->uhost, &temp_ip) != 1) && (inet_pton(AF_INET6, u->uhost, &temp_ip) != 1)) SSL_set_tlsext_host_name(dmclient->cssl, u->uhost);
+        if (u->uverify) SSL_set1_host(dmclient->cssl, u->uhost);
+    }
+
+    // Pool member attached (connection dropped if the upstream got closed meanwhile):
+    if (!_dmserver_upstream_attach(u, member, dmclient)) {
+        if (dmclient->cssl) SSL_free(dmclient->cssl);
+        close(dmclient->cfd);
+        dmclient->cstate = DMSERVER_CLIENT_CLOSED;
+        _dmserver_cconn_reset(dmclient);
+        return true;
+    }
+
+    // Distribute the client to the subordinate thread (output event, connection completed):
+    __atomic_add_fetch(&dmserver->sworker.wccount[temp_cloc.th_pos], 1, __ATOMIC_RELAXED);
+    if (epoll_ctl(dmserver->sworker.wsubepfd[temp_cloc.th_pos], EPOLL_CTL_ADD, dmclient->cfd, &(struct epoll_event){.events=EPOLLIN | EPOLLOUT | EPOLLET, .data.ptr=dmclient}) < 0) {
+        if (dmclient->cssl) SSL_free(dmclient->cssl);
+        close(dmclient->cfd);
+        dmclient->cstate = DMSERVER_CLIENT_CLOSED;
+        __atomic_sub_fetch(&dmserver->sworker.wccount[temp_cloc.th_pos], 1, __ATOMIC_RELAXED);
+        _dmserver_upstream_lost(dmclient, -1);
+        _dmserver_cconn_reset(dmclient);
+        return false;
+    }
+    dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "_dmserver_worker_main() - Upstream %lu member %lu connecting at point (%lu, %lu).", u->uid, member, temp_cloc.th_pos, temp_cloc.wc_pos);
+    return true;
+}
+
+/*
+    @brief Helper function that completes the outbound connection of an upstream client (first event of
+    its socket): plain connections get established, TLS ones go on to the handshake.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param dmserver_cliconn_pt c: Reference to the client.
+
+    @retval false: Connection failed (client slot released).
+    @retval true: Connected (or not an outbound connection in progress).
+*/
+static bool _dmserver_helper_ccconnect(dmserver_pt dmserver, dmserver_cliconn_pt c){
+    // References & state check:
+    if (!dmserver || !c) return false;
+    if (!c->cconnecting || (c->cstate != DMSERVER_CLIENT_ESTABLISHING)) return true;
+
+    // Connection result (pending error of the socket):
+    int err = 0;
+    socklen_t errlen = sizeof(err);
+    if ((getsockopt(c->cfd, SOL_SOCKET, SO_ERROR, &err, &errlen) < 0) || err) {
+        char caddr_str[DEFAULT_CCONN_ADDRSTRLEN];
+        _dmserver_cconn_addrstr(c, caddr_str, sizeof(caddr_str));
+        dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "Client %d connection to upstream %s failed (%s).\n", c->cfd, caddr_str, strerror(err));
+
+        epoll_ctl(dmserver->sworker.wsubepfd[c->cloc.th_pos], EPOLL_CTL_DEL, c->cfd, NULL);
+        if (c->cssl) SSL_free(c->cssl);
+        close(c->cfd);
+        c->cstate = DMSERVER_CLIENT_CLOSED;
+        __atomic_sub_fetch(&dmserver->sworker.wccount[c->cloc.th_pos], 1, __ATOMIC_RELAXED);
+        _dmserver_upstream_lost(c, dmserver->sworker.wmainevfd);
+        _dmserver_cconn_reset(c);
+        return false;
+    }
+    c->cconnecting = false;
+    dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "_dmserver_worker_sub() - Client %d connection stage TCP ok.", c->cfd);
+    if (c->csconn->sssl_enable) return true;
+
+    // TCP(established), output event only armed again on EAGAIN:
+    c->cstate = DMSERVER_CLIENT_ESTABLISHED;
+    epoll_ctl(dmserver->sworker.wsubepfd[c->cloc.th_pos], EPOLL_CTL_MOD, c->cfd, &(struct epoll_event){.events=EPOLLIN|EPOLLET, .data.ptr=c});
+
+    // Log message:
+    char caddr_str[DEFAULT_CCONN_ADDRSTRLEN];
+    _dmserver_cconn_addrstr(c, caddr_str, sizeof(caddr_str));
+    dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "Client %d connected to upstream %s.\n", c->cfd, caddr_str);
+
+    // Upstream pool member connected (backoff reset) & on client connect callback event:
+    _dmserver_upstream_up(c);
+    if (c->ccallback->on_client_connect) c->ccallback->on_client_connect(c);
+    return true;
+}
+
+/*
+    @brief Helper function that relays the bytes of a proxied client and its upstream. The first event
+    of the client established opens its pair (upstream connection), the first event of the upstream
+    completes it, and from then on every event of either end moves both flows until they block.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param dmserver_cliconn_pt dmclient: Reference to the proxied client.
+    @param size_t dmthindex: Caller thread index.
+    @param bool upstream_ev: Event of the upstream socket (or of the client one).
+*/
+static void _dmserver_helper_ccproxy(dmserver_pt dmserver, dmserver_cliconn_pt dmclient, size_t dmthindex, bool upstream_ev){
+    // References & state check (events of pairs already closed ignored):
+    if (!dmserver || !dmclient || !dmclient->cproxy || (dmclient->cstate != DMSERVER_CLIENT_ESTABLISHED)) return;
+    dmserver_proxy_pt p = &dmserver->sworker.wproxy[dmthindex][dmclient->cloc.wc_pos];
+    dmserver_cliloc_t loc = dmclient->cloc;
+
+    // Pair opened on the first event of the client (input & output events of both ends from now on):
+    if (p->pfd < 0) {
+        if (!_dmserver_proxy_open(p, dmclient, dmclient->cproxy, dmserver->sworker.wsubepfd[dmthindex])) {
+            __atomic_add_fetch(&dmserver->sworker.wproxystats.pfailed, 1, __ATOMIC_RELAXED);
+            dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "Client %d proxy to %s:%d could not be opened.\n", dmclient->cfd, dmclient->cproxy->thost, dmclient->cproxy->tconn.sport);
+            dmserver_disconnect(dmserver, &loc);
+            return;
+        }
+        __atomic_add_fetch(&dmserver->sworker.wproxystats.ppairs, 1, __ATOMIC_RELAXED);
+        if (p->pktls) __atomic_add_fetch(&dmserver->sworker.wproxystats.pktls, 1, __ATOMIC_RELAXED);
+        dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "_dmserver_worker_sub() - Client %d proxy pair opened (%s).", dmclient->cfd, p->pktls ? "kernel TLS" : (dmclient->cssl ? "TLS copy" : "splice"));
+        return;
+    }
+
+    // Upstream connection completed on its first event:
+    if (p->pconnecting) {
+        if (!upstream_ev) return;
+        if (!_dmserver_proxy_connected(p)) {
+            __atomic_add_fetch(&dmserver->sworker.wproxystats.pfailed, 1, __ATOMIC_RELAXED);
+            dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "Client %d proxy connection to %s:%d failed.\n", dmclient->cfd, dmclient->cproxy->thost, dmclient->cproxy->tconn.sport);
+            dmserver_disconnect(dmserver, &loc);
+            return;
+        }
+    }
+
+    // Both flows moved until they block, the pair closed once both are done (or on error):
+    size_t moved_c2u, moved_u2c;
+    enum dmserver_proxy_result r = _dmserver_proxy_pump(p, &moved_c2u, &moved_u2c);
+    if (moved_c2u || moved_u2c) {
+        dmclient->clastt = _dmserver_worker_now(&dmserver->sworker);
+        __atomic_add_fetch(&dmserver->sworker.wproxystats.pbytes_c2u, moved_c2u, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&dmserver->sworker.wproxystats.pbytes_u2c, moved_u2c, __ATOMIC_RELAXED);
+    }
+    if (r != DMSERVER_PROXY_AGAIN) {
+        dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "_dmserver_worker_sub() - Client %d proxy pair %s (%lu bytes up, %lu bytes down).", dmclient->cfd, (r == DMSERVER_PROXY_DONE) ? "done" : "failed", p->pc2u.fbytes, p->pu2c.fbytes);
+        dmserver_disconnect(dmserver, &loc);
     }
-    dmserver->sworker.wccount[temp_thindex]++;
 }
 
 /*
-    @brief Helper function that implements the ssl handshake (in pseudo blocking mode - 20 attempts).
+    @brief Helper function that implements the ssl handshake (in pseudo blocking mode - 20 attempts), server
+    side for the accepted clients and client side for the upstream connections.
 
     @param SSL * temp_cssl: Reference to temporal client ssl object.
     @param int * temp_cfd: Reference to temporal client socket file descriptor.
@@ -400,16 +1630,18 @@ static void _dmserver_helper_smanager(dmserver_pt dmserver){
 static bool _dmserver_helper_csslhandshake(dmserver_pt dmserver, dmserver_cliconn_pt c){
     // References check:
     if (!dmserver || !c) return false;
-    if (!dmserver->sconn.sssl_enable || (c->cstate != DMSERVER_CLIENT_ESTABLISHING)) return true;
+    if (!c->csconn->sssl_enable || (c->cstate != DMSERVER_CLIENT_ESTABLISHING)) return true;
 
     // SSL Handshake process:
-    int ssl_code = SSL_accept(c->cssl);
+    ERR_clear_error();
+    int ssl_code = SSL_do_handshake(c->cssl);
     int err = SSL_get_error(c->cssl, ssl_code);
 
     switch(err){
         case SSL_ERROR_NONE:
             // Hanshake completed successfuly:
             c->cstate = DMSERVER_CLIENT_ESTABLISHED;
+            DMSERVER_PROBE2(tls_done, c->cfd, 1);
             dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "_dmserver_worker_main() - Client %d connection stage TLS ok.", c->cfd);
             
             // Modification of events in client epoll fd:
@@ -418,19 +1650,23 @@ static bool _dmserver_helper_csslhandshake(dmserver_pt dmserver, dmserver_clicon
                 SSL_shutdown(c->cssl);
                 SSL_free(c->cssl);
                 close(c->cfd);
+                c->cstate = DMSERVER_CLIENT_CLOSED;
+                __atomic_sub_fetch(&dmserver->sworker.wccount[c->cloc.th_pos], 1, __ATOMIC_RELAXED);
+                _dmserver_upstream_lost(c, dmserver->sworker.wmainevfd);
                 _dmserver_cconn_reset(c);
                 return false;  
             }
 
             // Log message:
-            char cip_str[INET6_ADDRSTRLEN];
-            const void * addr = (c->caddr_family == AF_INET) ? (void*)&c->caddr.c4.sin_addr : (void*)&c->caddr.c6.sin6_addr;
-            inet_ntop(c->caddr_family, addr, cip_str, sizeof(cip_str));
-            int cport_num = (c->caddr_family == AF_INET) ? ntohs(c->caddr.c4.sin_port) : ntohs(c->caddr.c6.sin6_port);
-            dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "Client %d with address %s:%d connected to server.\n", c->cfd, cip_str, cport_num);
-
-            // On client connect callback event:
-            if (dmserver->scallback.on_client_connect) dmserver->scallback.on_client_connect(&dmserver->sworker.wcclis[c->cloc.th_pos][c->cloc.wc_pos]);
+            char caddr_str[DEFAULT_CCONN_ADDRSTRLEN];
+            _dmserver_cconn_addrstr(c, caddr_str, sizeof(caddr_str));
+            dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "Client %d with address %s connected to server.\n", c->cfd, caddr_str);
+
+            // Upstream pool member connected (backoff reset) & on client connect callback event:
+            _dmserver_upstream_up(c);
+            DMSERVER_PROBE2(cb_entry, "connect", c->cfd);
+            if (c->ccallback->on_client_connect) c->ccallback->on_client_connect(&dmserver->sworker.wcclis[c->cloc.th_pos][c->cloc.wc_pos]);
+            DMSERVER_PROBE2(cb_exit, "connect", c->cfd);
             return true;
 
         case SSL_ERROR_WANT_READ:
@@ -443,9 +1679,13 @@ static bool _dmserver_helper_csslhandshake(dmserver_pt dmserver, dmserver_clicon
         case SSL_ERROR_SYSCALL:
         default:
             // Fatal/Unknown error detected, clean client and return:
+            DMSERVER_PROBE2(tls_done, c->cfd, 0);
             SSL_shutdown(c->cssl);
             SSL_free(c->cssl);
             close(c->cfd);
+            c->cstate = DMSERVER_CLIENT_CLOSED;
+            __atomic_sub_fetch(&dmserver->sworker.wccount[c->cloc.th_pos], 1, __ATOMIC_RELAXED);
+            _dmserver_upstream_lost(c, dmserver->sworker.wmainevfd);
             _dmserver_cconn_reset(c);
             return false;
         }      
@@ -468,11 +1708,16 @@ static bool _dmserver_helper_cctimeout(dmserver_pt dmserver, dmserver_cliconn_pt
     if ((dmclient->cstate != DMSERVER_CLIENT_ESTABLISHED) && (dmclient->cstate != DMSERVER_CLIENT_ESTABLISHING)) return false;
 
     // Timeout check and process:
-    if(!_dmserver_cconn_checktimeout(dmclient, dmserver->sworker.wth_clistimeout)){
+    if(!_dmserver_cconn_checktimeout(dmclient, dmserver->sworker.wth_clistimeout, _dmserver_worker_now(&dmserver->sworker))){
         dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "Client %d timedout, closing connection...", dmclient->cfd);
-        dmserver_disconnect(dmserver, &(dmserver_cliloc_t){.th_pos=dmclient->cloc.th_pos, .wc_pos=dmclient->cloc.wc_pos});
+        DMSERVER_PROBE3(timeout, dmclient->cfd, (int)dmclient->cloc.th_pos, (int)dmclient->cloc.wc_pos);
 
-        if (dmserver->scallback.on_client_timeout) dmserver->scallback.on_client_timeout(dmclient);
+        // Timeout user callback before the disconnection (location, user context & arena still valid):
+        DMSERVER_PROBE2(cb_entry, "timeout", dmclient->cfd);
+        if (dmclient->ccallback->on_client_timeout) dmclient->ccallback->on_client_timeout(dmclient);
+        DMSERVER_PROBE2(cb_exit, "timeout", dmclient->cfd);
+
+        dmserver_disconnect(dmserver, &(dmserver_cliloc_t){.th_pos=dmclient->cloc.th_pos, .wc_pos=dmclient->cloc.wc_pos});
         return false;
     }
 
@@ -496,16 +1741,55 @@ static bool _dmserver_helper_ccread(dmserver_pt dmserver, dmserver_cliconn_pt dm
     if (!dmserver || !dmclient || !evs) return false;
 
     // Read process:
-    if (evs[evindex].events & EPOLLIN){
-        // Read lock of client:
-        pthread_mutex_lock(&dmclient->crlock);
+    if (evs[evindex].events & EPOLLIN) return _dmserver_helper_ccrecv(dmserver, dmclient, dmthindex);
+    return true;
+}
 
-        // Read bytes from clients (encrypted/decrypted optional) to client read buffer:
-        int rb = 0;
-        int rb_err = 0;
-        if (dmserver->sconn.sssl_enable){
-            rb = SSL_read(dmclient->cssl, dmclient->crbuffer, dmclient->crbuffer_size-1);
+/*
+    @brief Helper function that reads a client until its socket is drained (edge triggered), a read
+    per round in batched reception and up to DEFAULT_WORKER_READSPERROUND reads otherwise. Clients not
+    drained are deferred to the next round, and clients over their reception limits get their reads
+    paused (input event removed) until their buckets refill.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param struct dmserver_cliconn * dmclient: Reference to the client to read.
+    @param size_t dmthindex: Caller thread index.
+
+    @retval false: If read process lead to client disconnection.
+    @retval true: If read process finished correctly (drained, deferred or paused).
+*/
+static bool _dmserver_helper_ccrecv(dmserver_pt dmserver, dmserver_cliconn_pt dmclient, size_t dmthindex){
+    // References & state check (paused clients are read once resumed):
+    if (!dmserver || !dmclient) return false;
+    if (dmclient->cstate != DMSERVER_CLIENT_ESTABLISHED) return false;
+    if (dmclient->crpaused) return true;
+
+    // Read lock of client:
+    pthread_mutex_lock(&dmclient->crlock);
+
+    bool batched = (dmclient->ccallback->on_client_rcv_batch != NULL);
+    bool tls = dmclient->csconn->sssl_enable;
+    for (size_t nreads = 0; ; nreads++){
+        // Read budget of the round spent (or read buffer still in the round batch), next round:
+        if ((nreads == DEFAULT_WORKER_READSPERROUND) || (batched && (dmclient->crlen > 0))) {
+            _dmserver_helper_ccdefer(dmserver, dmclient, dmthindex, 0);
+            break;
+        }
+
+        // Read bytes from clients (encrypted/decrypted optional) to client read buffer:
+        int rb = 0;
+        int rb_err = 0;
+        if (tls){
+            // Error queue of the thread cleared (errors of other clients would be taken as this read ones):
+            ERR_clear_error();
+            rb = SSL_read(dmclient->cssl, dmclient->crbuffer, dmclient->crbuffer_size-1);
             rb_err = SSL_get_error(dmclient->cssl, rb);
+        } else if (dmclient->csconn->sunixpassfd && (dmclient->caddr_family == AF_UNIX)) {
+            rb = _dmserver_cconn_recvfds(dmclient);
+            rb_err = errno;
+        } else if (dmclient->csconn->srxtstamp && (dmclient->caddr_family != AF_UNIX)) {
+            rb = _dmserver_cconn_recvts(dmclient);
+            rb_err = errno;
         } else {
             rb = read(dmclient->cfd, dmclient->crbuffer, dmclient->crbuffer_size-1);
             rb_err = errno;
@@ -514,39 +1798,261 @@ static bool _dmserver_helper_ccread(dmserver_pt dmserver, dmserver_cliconn_pt dm
 
         if (rb > 0){
             // Data reception case:
-            dmclient->crlen += rb;
+            dmclient->crlen = rb;
+            dmclient->crload += rb;
+            __atomic_add_fetch(&dmclient->crbytes, rb, __ATOMIC_RELAXED);
+            DMSERVER_PROBE2(read, dmclient->cfd, rb);
+            _dmserver_capture_record(&dmserver->scapture, DMSERVER_CAPTURE_IN, dmclient, dmclient->crbuffer, rb);
             dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "Read of %d bytes from client %d.\n", rb, dmclient->cfd);
 
             // Timeout ctl update:
-            dmclient->clastt =  time(NULL);
+            dmclient->clastt = _dmserver_worker_now(&dmserver->sworker);
+
+            // Pending output not armed (TLS record waiting for a read) retried at the end of the round:
+            if (((dmclient->cwlen > 0) || (dmclient->cwq_count > 0)) && !dmclient->cwarmed) _dmserver_worker_qflush(&dmserver->sworker, dmclient);
+
+            // Reception limits accounting (the data read is always delivered, upstream connections exempt):
+            long now = _dmserver_helper_nowns();
+            long rpause = (dmclient->cupstream) ? 0 : _dmserver_limits_charge(&dmserver->slimits, dmclient, rb, now);
+
+            // Socket drained when a plain read did not fill the buffer (TLS records and messages with 
+            // file descriptors may be left behind):
+            bool rmore = tls || dmclient->csconn->sunixpassfd || ((size_t)rb == dmclient->crbuffer_size - 1);
             
-            // User specific data processing of received data and read buffer reset afterwards:
-            if (dmserver->scallback.on_client_rcv) dmserver->scallback.on_client_rcv(dmclient);
-            memset(dmclient->crbuffer, 0, dmclient->crbuffer_size);
+            if (batched){
+                // Batched reception, data kept in the read buffer until the end of the round:
+                dmclient->crbuffer[rb] = '\0';
+                size_t * nmsgs = &dmserver->sworker.wrcvcount[dmthindex];
+                dmserver->sworker.wrcvbatch[dmthindex][(*nmsgs)++] = (dmserver_rcvmsg_t){.cli=dmclient, .data=dmclient->crbuffer, .len=rb, .gen=dmclient->cgen};
+                if (*nmsgs >= dmserver->sworker.wth_clispersth) {
+                    pthread_mutex_unlock(&dmclient->crlock);
+                    _dmserver_helper_ccrcvbatch(dmserver, dmthindex);
+                    pthread_mutex_lock(&dmclient->crlock);
+                }
+            } else {
+                // User specific data processing of received data and read buffer reset afterwards:
+                _dmserver_cconn_rxlat(dmclient, dmserver->sworker.wrxlat[dmthindex], DEFAULT_WORKER_RXLATBUCKETS);
+                DMSERVER_PROBE2(cb_entry, "rcv", dmclient->cfd);
+                if (dmclient->ccallback->on_client_rcv) dmclient->ccallback->on_client_rcv(dmclient);
+                DMSERVER_PROBE2(cb_exit, "rcv", dmclient->cfd);
+                memset(dmclient->crbuffer, 0, dmclient->crbuffer_size);
+                dmclient->crlen = 0;
+                _dmserver_cconn_closefds(dmclient, true, false);
+            }
 
-        } else if ((rb == 0) || ((rb_err == SSL_ERROR_ZERO_RETURN) && dmserver->sconn.sssl_enable)){
+            // Client disconnected by the reception callback:
+            if (dmclient->cstate != DMSERVER_CLIENT_ESTABLISHED) break;
+
+            // Over the reception limits, reads paused until the buckets refill:
+            if (rpause > 0) {
+                dmclient->crpaused = true;
+                if (!_dmserver_helper_ccevents(dmserver, dmclient, dmthindex)) {
+                    pthread_mutex_unlock(&dmclient->crlock);
+                    dmserver_disconnect(dmserver, &(dmserver_cliloc_t){.th_pos=dmclient->cloc.th_pos, .wc_pos=dmclient->cloc.wc_pos});
+                    return false;
+                }
+                _dmserver_helper_ccdefer(dmserver, dmclient, dmthindex, now + rpause);
+                break;
+            }
+            if (!rmore) break;
+
+        } else if ((rb == 0) || ((rb_err == SSL_ERROR_ZERO_RETURN) && tls)){
             // Client disconnect case:
             dmserver_disconnect(dmserver, &(dmserver_cliloc_t){.th_pos=dmclient->cloc.th_pos, .wc_pos=dmclient->cloc.wc_pos});
             pthread_mutex_unlock(&dmclient->crlock);
             return false;
 
-        } else if ((((rb_err != SSL_ERROR_WANT_READ) && (rb_err != SSL_ERROR_WANT_WRITE)) && dmserver->sconn.sssl_enable) || (((rb_err != EAGAIN) && (rb_err != EWOULDBLOCK) && (rb_err != EINTR)) && !dmserver->sconn.sssl_enable)){
+        } else if ((((rb_err != SSL_ERROR_WANT_READ) && (rb_err != SSL_ERROR_WANT_WRITE)) && tls) || (((rb_err != EAGAIN) && (rb_err != EWOULDBLOCK) && (rb_err != EINTR)) && !tls)){
             // Comunication error case:
             dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "Client %d com. failed, forced disconnection.", dmclient->cfd); 
             dmserver_disconnect(dmserver, &(dmserver_cliloc_t){.th_pos=dmclient->cloc.th_pos, .wc_pos=dmclient->cloc.wc_pos});
             pthread_mutex_unlock(&dmclient->crlock);
             return false;
-        }
 
-        // Read unlock of client:
-        pthread_mutex_unlock(&dmclient->crlock);
+        } else {
+            // Socket drained case:
+            break;
+        }
     }
 
+    // Read unlock of client:
+    pthread_mutex_unlock(&dmclient->crlock);
     return true;
 }
 
 /*
-    @brief Helper function that implements the write process.
+    @brief Helper function that defers the reads of a client to a later round of its subthread.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param struct dmserver_cliconn * dmclient: Reference to the client.
+    @param size_t dmthindex: Caller thread index.
+    @param long resume: Monotonic time in ns to read again (0 next round).
+*/
+static void _dmserver_helper_ccdefer(dmserver_pt dmserver, dmserver_cliconn_pt dmclient, size_t dmthindex, long resume){
+    if (resume > dmclient->crresume) dmclient->crresume = resume;
+    if (dmclient->crdeferred) return;
+    dmclient->crdeferred = true;
+    dmclient->crresume = resume;
+    dmserver->sworker.wrdeferq[dmthindex][dmserver->sworker.wrdefercount[dmthindex]++] = dmclient;
+}
+
+/*
+    @brief Helper function that reads the deferred clients of a subthread whose resume time has come
+    (paused clients get their input event back), the rest are kept for later rounds.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param size_t dmthindex: Caller thread index.
+*/
+static void _dmserver_helper_ccdeferred(dmserver_pt dmserver, size_t dmthindex){
+    // Take the deferred clients (clients deferred again while reading go to the list as new):
+    size_t ndefer = dmserver->sworker.wrdefercount[dmthindex];
+    if (ndefer == 0) return;
+    dmserver_cliconn_pt deferq[ndefer];
+    memcpy(deferq, dmserver->sworker.wrdeferq[dmthindex], ndefer * sizeof(dmserver_cliconn_pt));
+    dmserver->sworker.wrdefercount[dmthindex] = 0;
+
+    long now = _dmserver_helper_nowns();
+    for (size_t i = 0; i < ndefer; i++){
+        dmserver_cliconn_pt dmclient = deferq[i];
+
+        // Not yet (kept in the list):
+        if ((dmclient->cstate == DMSERVER_CLIENT_ESTABLISHED) && (dmclient->crresume > now)) {
+            dmserver->sworker.wrdeferq[dmthindex][dmserver->sworker.wrdefercount[dmthindex]++] = dmclient;
+            continue;
+        }
+        dmclient->crdeferred = false;
+        if (dmclient->cstate != DMSERVER_CLIENT_ESTABLISHED) continue;
+
+        // Resume the reads of a paused client (input event back) and read what is pending:
+        if (dmclient->crpaused) {
+            dmclient->crpaused = false;
+            if (!_dmserver_helper_ccevents(dmserver, dmclient, dmthindex)) {
+                dmserver_disconnect(dmserver, &(dmserver_cliloc_t){.th_pos=dmclient->cloc.th_pos, .wc_pos=dmclient->cloc.wc_pos});
+                continue;
+            }
+        }
+        _dmserver_helper_ccrecv(dmserver, dmclient, dmthindex);
+    }
+}
+
+/*
+    @brief Helper function that returns the epoll timeout until the next deferred read of a subthread.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param size_t dmthindex: Caller thread index.
+    @param int ep_timeout: Epoll timeout in ms without deferred reads.
+
+    @retval Epoll timeout in ms.
+*/
+static int _dmserver_helper_ccdefertimeout(dmserver_pt dmserver, size_t dmthindex, int ep_timeout){
+    size_t ndefer = dmserver->sworker.wrdefercount[dmthindex];
+    if (ndefer == 0) return ep_timeout;
+
+    // Closest resume time (rounded up to the next ms):
+    long now = _dmserver_helper_nowns();
+    for (size_t i = 0; (i < ndefer) && (ep_timeout > 0); i++){
+        long wait = dmserver->sworker.wrdeferq[dmthindex][i]->crresume - now;
+        int wait_ms = (wait <= 0) ? 0 : (int)((wait + 999999) / 1000000);
+        if (wait_ms < ep_timeout) ep_timeout = wait_ms;
+    }
+    return ep_timeout;
+}
+
+/*
+    @brief Helper function that feeds the overload controller of a subthread with the sojourn of the
+    round (processing lag of the round events or wait of the oldest client in the flush queue, the
+    larger) and applies its actions: overload state change callback and read shedding.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param size_t dmthindex: Caller thread index.
+    @param long round_start: Monotonic time in ns when the round events were taken.
+*/
+static void _dmserver_helper_ovlsample(dmserver_pt dmserver, size_t dmthindex, long round_start){
+    // Sojourn of the round:
+    long now = _dmserver_helper_nowns();
+    long sojourn = now - round_start;
+    pthread_mutex_lock(&dmserver->sworker.wflushlock[dmthindex]);
+    if ((dmserver->sworker.wflushcount[dmthindex] > 0) && (now - dmserver->sworker.wflushts[dmthindex] > sojourn)) sojourn = now - dmserver->sworker.wflushts[dmthindex];
+    pthread_mutex_unlock(&dmserver->sworker.wflushlock[dmthindex]);
+
+    // Controller actions:
+    dmserver_overload_stats_pt os = &dmserver->sworker.wovlstats;
+    long interval = (long)dmserver->sworker.wovl_interval * 1000;
+    switch (_dmserver_overload_sample(&dmserver->sworker.wsubcodel[dmthindex], sojourn, now, (long)dmserver->sworker.wovl_target * 1000, interval)){
+        case DMSERVER_OVERLOAD_ENTER:
+            __atomic_add_fetch(&os->oentered, 1, __ATOMIC_RELAXED);
+            dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "Subthread %lu overloaded (sojourn %ld usec).\n", dmthindex, sojourn / 1000);
+            if (dmserver->scallback.on_overload) dmserver->scallback.on_overload(dmthindex, true);
+            _dmserver_helper_ovlshed(dmserver, dmthindex, now);
+            break;
+
+        case DMSERVER_OVERLOAD_SHED:
+            _dmserver_helper_ovlshed(dmserver, dmthindex, now);
+            break;
+
+        case DMSERVER_OVERLOAD_LEAVE:
+            dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "Subthread %lu no longer overloaded.\n", dmthindex);
+            if (dmserver->scallback.on_overload) dmserver->scallback.on_overload(dmthindex, false);
+            break;
+
+        default:
+            break;
+    }
+}
+
+/*
+    @brief Helper function that sheds load of an overloaded subthread: the reads of its heaviest client
+    (most bytes read recently) are paused for one interval, the load of every client decays.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param size_t dmthindex: Caller thread index.
+    @param long now: Monotonic time in ns.
+*/
+static void _dmserver_helper_ovlshed(dmserver_pt dmserver, size_t dmthindex, long now){
+    __atomic_add_fetch(&dmserver->sworker.wovlstats.osheds, 1, __ATOMIC_RELAXED);
+    if (!dmserver->sworker.wovl_shed || dmserver->sworker.wsubdgram) return;
+
+    // Heaviest client with reads not paused (loads halved on the way):
+    dmserver_cliconn_pt heaviest = NULL;
+    size_t heaviest_load = 0;
+    for (size_t i = 0; i < dmserver->sworker.wth_clispersth; i++){
+        dmserver_cliconn_pt c = &dmserver->sworker.wcclis[dmthindex][i];
+        if ((c->cstate == DMSERVER_CLIENT_ESTABLISHED) && !c->crpaused && (c->crload > heaviest_load)) {
+            heaviest = c;
+            heaviest_load = c->crload;
+        }
+        c->crload /= 2;
+    }
+    if (!heaviest) return;
+
+    // Reads paused until the next interval (resumed by the deferred reads list):
+    heaviest->crpaused = true;
+    if (!_dmserver_helper_ccevents(dmserver, heaviest, dmthindex)) {
+        dmserver_disconnect(dmserver, &(dmserver_cliloc_t){.th_pos=heaviest->cloc.th_pos, .wc_pos=heaviest->cloc.wc_pos});
+        return;
+    }
+    _dmserver_helper_ccdefer(dmserver, heaviest, dmthindex, now + (long)dmserver->sworker.wovl_interval * 1000);
+}
+
+/*
+    @brief Helper function that sets the epoll events of a client: input unless its reads are paused,
+    output when armed (pending data after an EAGAIN).
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param struct dmserver_cliconn * dmclient: Reference to the client.
+    @param size_t dmthindex: Caller thread index.
+
+    @retval false: Epoll modification failed.
+    @retval true: Events set.
+*/
+static bool _dmserver_helper_ccevents(dmserver_pt dmserver, dmserver_cliconn_pt dmclient, size_t dmthindex){
+    uint32_t cevents = EPOLLET | (dmclient->crpaused ? 0 : EPOLLIN) | (dmclient->cwarmed ? EPOLLOUT : 0);
+    return (epoll_ctl(dmserver->sworker.wsubepfd[dmthindex], EPOLL_CTL_MOD, dmclient->cfd, &(struct epoll_event){.events=cevents, .data.ptr=dmclient}) == 0);
+}
+
+/*
+    @brief Helper function that implements the write process on output events (socket writable
+    again after an EAGAIN).
 
     @param dmserver_pt dmserver: Reference to dmserver struct.
     @param struct dmserver_cliconn * dmclient: Reference to the client to check timeout.
@@ -562,50 +2068,689 @@ static bool _dmserver_helper_ccwrite(dmserver_pt dmserver, dmserver_cliconn_pt d
     if (!dmserver || !dmclient || !evs) return false;
     
     // Write process:
-    if ((evs[evindex].events & EPOLLOUT) && (dmclient->cwlen > 0)){
-        // Write lock of client:
-        pthread_mutex_lock(&dmclient->cwlock);
+    if ((evs[evindex].events & EPOLLOUT) && ((dmclient->cwlen > 0) || (dmclient->cwq_count > 0))) return _dmserver_helper_ccsend(dmserver, dmclient, dmthindex);
+    return true;
+}
+
+/*
+    @brief Helper function that writes the pending data of a client directly to its socket, first the
+    write buffer and then the shared messages queue. The output event is only armed when the socket
+    can not take all the data (EAGAIN or partial write), and disarmed once everything has been written.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param struct dmserver_cliconn * dmclient: Reference to the client to write.
+    @param size_t dmthindex: Caller thread index.
 
-        // Write bytes from clients (encrypted/decrypted optional):
+    @retval false: If write process lead to client disconnection.
+    @retval true: If write process finished correctly (complete or pending).
+*/
+static bool _dmserver_helper_ccsend(dmserver_pt dmserver, dmserver_cliconn_pt dmclient, size_t dmthindex){
+    // References & state check:
+    if (!dmserver || !dmclient) return false;
+    if (dmclient->cstate != DMSERVER_CLIENT_ESTABLISHED) return false;
+
+    // Write lock of client:
+    pthread_mutex_lock(&dmclient->cwlock);
+    if ((dmclient->cwlen == 0) && (dmclient->cwq_count == 0)) {
+        pthread_mutex_unlock(&dmclient->cwlock);
+        return true;
+    }
+
+    // Write until there is no data left or the socket is full:
+    bool tls = dmclient->csconn->sssl_enable;
+    bool wpending = false;
+    while (!wpending && ((dmclient->cwlen > 0) || (dmclient->cwq_count > 0))){
+        // Write bytes from clients (encrypted/decrypted optional), write buffer before queued messages:
         int wb = 0;
         int wb_err = 0;
-        if (dmserver->sconn.sssl_enable){
+        size_t wlen = dmclient->cwlen;
+        if (dmclient->cwlen == 0){
+            wlen = _dmserver_helper_ccsendq(dmserver, dmclient, &wb, &wb_err);
+        } else if (tls){
+            ERR_clear_error();
             wb = SSL_write(dmclient->cssl, dmclient->cwbuffer, dmclient->cwlen);
             wb_err = SSL_get_error(dmclient->cssl, wb);
+        } else if (dmclient->cwfdslen > 0) {
+            wb = _dmserver_cconn_sendfds(dmclient);
+            wb_err = errno;
         } else {
             wb = write(dmclient->cfd, dmclient->cwbuffer, dmclient->cwlen);
             wb_err = errno;
         }
-
-        if (wb > 0){
+        if (wb > 0) __atomic_add_fetch(&dmclient->cwbytes, wb, __ATOMIC_RELAXED);
+        if (wb > 0) DMSERVER_PROBE2(write, dmclient->cfd, wb);
+        if ((wb > 0) && (dmclient->cwlen > 0)) _dmserver_capture_record(&dmserver->scapture, DMSERVER_CAPTURE_OUT, dmclient, dmclient->cwbuffer, wb);
+
+        if ((wb > 0) && ((size_t)wb < wlen)){
+            // Partial write case, keep the remaining data (buffer start or queue head offset):
+            if (dmclient->cwlen > 0) {
+                memmove(dmclient->cwbuffer, dmclient->cwbuffer + wb, dmclient->cwlen - wb);
+                dmclient->cwlen -= wb;
+                dmclient->cwbuffer[dmclient->cwlen] = '\0';
+            } else _dmserver_cconn_wqconsume(dmclient, wb);
+            wpending = true;
+            dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "Write of %d bytes from client %d (partial).\n", wb, dmclient->cfd);
+
+        } else if (wb > 0){
             // Data sent case:
-            dmclient->cwlen = wb;
             dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "Write of %d bytes from client %d.\n", wb, dmclient->cfd);
-
-            // Disable output events:
-            if (epoll_ctl(dmserver->sworker.wsubepfd[dmthindex], EPOLL_CTL_MOD, dmclient->cfd, &(struct epoll_event){.events=EPOLLIN | EPOLLET, .data.ptr=dmclient}) < 0){
-                // All data send error case:
-                dmserver_disconnect(dmserver, &(dmserver_cliloc_t){.th_pos=dmclient->cloc.th_pos, .wc_pos=dmclient->cloc.wc_pos});
-                pthread_mutex_unlock(&dmclient->cwlock); 
-                return false;
+            if (dmclient->cwlen == 0) {
+                _dmserver_cconn_wqconsume(dmclient, wb);
+                continue;
             }
 
             // Write data user callback and reset:
-            if (dmserver->scallback.on_client_snd) dmserver->scallback.on_client_snd(dmclient);
-            memset(dmclient->cwbuffer, 0, dmclient->cwbuffer_size);
+            if (dmclient->ccallback->on_client_snd) dmclient->ccallback->on_client_snd(dmclient);
+            memset(dmclient->cwbuffer, 0, dmclient->cwlen);
             dmclient->cwlen = 0;
-             
-        } else if ((((wb_err != SSL_ERROR_WANT_READ) && (wb_err != SSL_ERROR_WANT_WRITE)) && dmserver->sconn.sssl_enable) || (((wb_err != EAGAIN) && (wb_err != EWOULDBLOCK) && (wb_err != EINTR)) && !dmserver->sconn.sssl_enable)) {
+
+        } else if ((((wb_err == SSL_ERROR_WANT_READ) || (wb_err == SSL_ERROR_WANT_WRITE)) && tls) || (((wb_err == EAGAIN) || (wb_err == EWOULDBLOCK) || (wb_err == EINTR)) && !tls)) {
+            // Socket full case (retry on output event):
+            wpending = true;
+
+        } else {
             // Comunication error case:
             dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "Client %d com. failed, forced disconnection.", dmclient->cfd); 
+            pthread_mutex_unlock(&dmclient->cwlock); 
             dmserver_disconnect(dmserver, &(dmserver_cliloc_t){.th_pos=dmclient->cloc.th_pos, .wc_pos=dmclient->cloc.wc_pos});
+            return false;
+        }
+    }
+
+    // Enable output events when the socket did not take all the data, disable them once all written:
+    if (wpending != dmclient->cwarmed) {
+        dmclient->cwarmed = wpending;
+        if (!_dmserver_helper_ccevents(dmserver, dmclient, dmthindex)){
             pthread_mutex_unlock(&dmclient->cwlock); 
+            dmserver_disconnect(dmserver, &(dmserver_cliloc_t){.th_pos=dmclient->cloc.th_pos, .wc_pos=dmclient->cloc.wc_pos});
             return false;
         }
+    }
 
-        // Write unlock of clients:
-        pthread_mutex_unlock(&dmclient->cwlock);
+    // Write unlock of clients:
+    pthread_mutex_unlock(&dmclient->cwlock);
+    return true;
+}
+
+/*
+    @brief Helper function that writes the shared messages queued to a client, gathered in a single 
+    writev (plain) or the head message (TLS, records can not be gathered). Head messages of at least
+    the zero copy length are sent alone with MSG_ZEROCOPY and pinned until completed (copied when
+    the pins are exhausted or the kernel has no memory to track them).
+    @note: The client write lock must be held by the caller. Written bytes are not consumed here.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param struct dmserver_cliconn * dmclient: Reference to the client to write.
+    @param int * wb: Written bytes (same semantics as write/SSL_write).
+    @param int * wb_err: Error code (errno or SSL error).
+
+    @retval Bytes requested to write.
+*/
+static size_t _dmserver_helper_ccsendq(dmserver_pt dmserver, dmserver_cliconn_pt dmclient, int * wb, int * wb_err){
+    // Head message (offset of the bytes already written):
+    dmserver_cmsg_pt m = dmclient->cwq[dmclient->cwq_head];
+    if (dmclient->csconn->sssl_enable){
+        size_t wlen = m->mlen - dmclient->cwq_off;
+        ERR_clear_error();
+        *wb = SSL_write(dmclient->cssl, m->mdata + dmclient->cwq_off, wlen);
+        *wb_err = SSL_get_error(dmclient->cssl, *wb);
+        if (*wb > 0) _dmserver_capture_record(&dmserver->scapture, DMSERVER_CAPTURE_OUT, dmclient, m->mdata + dmclient->cwq_off, *wb);
+        return wlen;
+    }
+
+#ifdef SO_ZEROCOPY
+    // Zero copy send of a large head message (completions reaped first when every pin is taken):
+    size_t hlen = m->mlen - dmclient->cwq_off;
+    if (dmclient->czc_min && (hlen >= dmclient->czc_min)){
+        if (dmclient->czc_count >= dmclient->cwq_size) _dmserver_cconn_zcreap(dmclient, &dmserver->sworker.wzcstats);
+        if (dmclient->czc_count < dmclient->cwq_size){
+            *wb = send(dmclient->cfd, m->mdata + dmclient->cwq_off, hlen, MSG_ZEROCOPY);
+            *wb_err = errno;
+            if (*wb > 0){
+                _dmserver_cconn_zcpin(dmclient, m);
+                __atomic_add_fetch(&dmserver->sworker.wzcstats.zsends, 1, __ATOMIC_RELAXED);
+                __atomic_add_fetch(&dmserver->sworker.wzcstats.zbytes, *wb, __ATOMIC_RELAXED);
+                _dmserver_capture_record(&dmserver->scapture, DMSERVER_CAPTURE_OUT, dmclient, m->mdata + dmclient->cwq_off, *wb);
+                return hlen;
+            }
+            if (*wb_err != ENOBUFS) return hlen;
+        }
+    }
+#endif
+
+    // Queued messages gathered from the head (up to the next zero copy one):
+    struct iovec iovs[DEFAULT_WORKER_WRITEIOVS];
+    size_t niovs = 0;
+    size_t wlen = 0;
+    for (size_t i = 0; (i < dmclient->cwq_count) && (niovs < DEFAULT_WORKER_WRITEIOVS); i++){
+        m = dmclient->cwq[(dmclient->cwq_head + i) % dmclient->cwq_size];
+        if ((i > 0) && dmclient->czc_min && (m->mlen >= dmclient->czc_min)) break;
+        size_t off = (i == 0) ? dmclient->cwq_off : 0;
+        iovs[niovs++] = (struct iovec){.iov_base=m->mdata + off, .iov_len=m->mlen - off};
+        wlen += m->mlen - off;
+    }
+    *wb = writev(dmclient->cfd, iovs, niovs);
+    *wb_err = errno;
+
+    // Messages written recorded (the written part of each one):
+    size_t left = (*wb > 0) ? (size_t)*wb : 0;
+    for (size_t i = 0; (i < niovs) && (left > 0); i++){
+        size_t n = (iovs[i].iov_len < left) ? iovs[i].iov_len : left;
+        _dmserver_capture_record(&dmserver->scapture, DMSERVER_CAPTURE_OUT, dmclient, iovs[i].iov_base, n);
+        left -= n;
     }
+    return wlen;
+}
+
+/*
+    @brief Helper function that writes all the clients queued during the round of a subordinate
+    thread (end of round flush).
 
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param size_t dmthindex: Caller thread index.
+*/
+static void _dmserver_helper_ccflush(dmserver_pt dmserver, size_t dmthindex){
+    // Reference check:
+    if (!dmserver) return;
+
+    // Take the queued clients (new queued clients during the flush go to the next round):
+    dmserver_cliconn_pt flushq[dmserver->sworker.wth_clispersth];
+    pthread_mutex_lock(&dmserver->sworker.wflushlock[dmthindex]);
+    size_t nflush = dmserver->sworker.wflushcount[dmthindex];
+    for (size_t i = 0; i < nflush; i++){
+        flushq[i] = dmserver->sworker.wflushq[dmthindex][i];
+        flushq[i]->cwqueued = false;
+    }
+    dmserver->sworker.wflushcount[dmthindex] = 0;
+    pthread_mutex_unlock(&dmserver->sworker.wflushlock[dmthindex]);
+
+    // Direct write of every queued client (output event armed only on EAGAIN), datagrams batched:
+    for (size_t i = 0; i < nflush; i++){
+        if (flushq[i]->cwkick || flushq[i]->cdisreq) {
+            // Slow consumer or foreign thread disconnection requested:
+            if (flushq[i]->cwkick) dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "Client %d too slow, forced disconnection.", flushq[i]->cfd);
+            dmserver_disconnect(dmserver, &(dmserver_cliloc_t){.th_pos=flushq[i]->cloc.th_pos, .wc_pos=flushq[i]->cloc.wc_pos});
+            continue;
+        }
+        if (flushq[i]->ctransport == DMSERVER_TRANSPORT_DGRAM) {
+            _dmserver_helper_dgsend(dmserver, flushq[i], dmthindex);
+            continue;
+        }
+        if (flushq[i]->ctransport == DMSERVER_TRANSPORT_SHM) {
+            _dmserver_helper_shmsend(dmserver, flushq[i]);
+            continue;
+        }
+        if (flushq[i]->cwarmed) continue;
+        _dmserver_helper_ccsend(dmserver, flushq[i], dmthindex);
+    }
+    _dmserver_helper_dgsendflush(dmserver, dmthindex);
+}
+
+/*
+    @brief Helper function that delivers the batched reception of a subordinate thread round to the
+    user callback, and resets the read buffers of the clients involved afterwards.
+    @note: Clients disconnected during the round (after their read) are discarded from the batch, also
+    when their slot got a new client meanwhile (slot generation changed).
+    Clients of listeners with different batch callbacks are delivered in one call per callback.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param size_t dmthindex: Caller thread index.
+*/
+static void _dmserver_helper_ccrcvbatch(dmserver_pt dmserver, size_t dmthindex){
+    // References & pending messages check:
+    if (!dmserver) return;
+    dmserver_rcvmsg_pt msgs = dmserver->sworker.wrcvbatch[dmthindex];
+    size_t nmsgs = dmserver->sworker.wrcvcount[dmthindex];
+    if (nmsgs == 0) return;
+
+    // Compact the batch, dropping the clients that are no longer connected (or whose slot got a new
+    // client meanwhile):
+    size_t n = 0;
+    for (size_t i = 0; i < nmsgs; i++){
+        if ((msgs[i].cli->cstate != DMSERVER_CLIENT_ESTABLISHED) || (msgs[i].cli->cgen != msgs[i].gen)) continue;
+        msgs[n++] = msgs[i];
+    }
+
+    // User specific data processing of the whole round (one call per batch callback, the messages
+    // of the callback delivered moved to the front keeping their order):
+    for (size_t first = 0; first < n; ){
+        void (*on_batch)(dmserver_rcvmsg_pt, size_t) = msgs[first].cli->ccallback->on_client_rcv_batch;
+        size_t last = first;
+        for (size_t i = first; i < n; i++){
+            if (msgs[i].cli->ccallback->on_client_rcv_batch != on_batch) continue;
+            dmserver_rcvmsg_t m = msgs[i];
+            memmove(&msgs[last + 1], &msgs[last], (i - last) * sizeof(dmserver_rcvmsg_t));
+            msgs[last++] = m;
+            _dmserver_cconn_rxlat(m.cli, dmserver->sworker.wrxlat[dmthindex], DEFAULT_WORKER_RXLATBUCKETS);
+        }
+        DMSERVER_PROBE2(cb_entry, "rcv_batch", -1);
+        on_batch(&msgs[first], last - first);
+        DMSERVER_PROBE2(cb_exit, "rcv_batch", -1);
+        first = last;
+    }
+
+    // Read buffers reset (terminator and length only, no full memset):
+    for (size_t i = 0; i < n; i++){
+        pthread_mutex_lock(&msgs[i].cli->crlock);
+        msgs[i].cli->crbuffer[0] = '\0';
+        msgs[i].cli->crlen = 0;
+        _dmserver_cconn_closefds(msgs[i].cli, true, false);
+        pthread_mutex_unlock(&msgs[i].cli->crlock);
+    }
+    dmserver->sworker.wrcvcount[dmthindex] = 0;
+}
+
+/*
+    @brief Helper function that returns the monotonic clock in nanoseconds.
+
+    @retval Monotonic time in nanoseconds.
+*/
+static long _dmserver_helper_nowns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+/*
+    @brief Helper function that receives all the pending datagrams of a subordinate thread socket
+    (recvmmsg batches until drained) and delivers them to the sessions of their peers.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param size_t dmthindex: Caller thread index.
+*/
+static void _dmserver_helper_dgread(dmserver_pt dmserver, size_t dmthindex){
+    // Reference check:
+    if (!dmserver || !dmserver->sworker.wsubdgram) return;
+    dmserver_dgram_pt d = &dmserver->sworker.wsubdgram[dmthindex];
+
+    // Drain the socket (edge triggered) by batches:
+    int n = 0;
+    while ((n = _dmserver_dgram_recv(d)) > 0){
+        for (int i = 0; i < n; i++){
+            struct sockaddr_storage * maddr = NULL;
+            char * mdata = NULL;
+            size_t mlen = 0, msegsize = 0;
+            struct timespec mts;
+            if (!_dmserver_dgram_msg(d, i, &maddr, &mdata, &mlen, &msegsize, &mts)) continue;
+
+            // Session of the peer (created on its first datagram):
+            dmserver_cliconn_pt dmclient = _dmserver_dgram_lookup(d, maddr);
+            if (!dmclient) dmclient = _dmserver_helper_dgsession(dmserver, dmthindex, maddr);
+            if (!dmclient) continue;
+
+            // Coalesced datagrams (UDP GRO) delivered one by one:
+            for (size_t off = 0; off < mlen; off += msegsize){
+                _dmserver_helper_dgdeliver(dmserver, dmclient, dmthindex, mdata + off, ((mlen - off) < msegsize) ? (mlen - off) : msegsize, &mts);
+            }
+        }
+        if (n < DEFAULT_DGRAM_BATCH) break;
+    }
+}
+
+/*
+    @brief Helper function that creates the session of a new datagram peer in a free client slot of
+    the subordinate thread.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param size_t dmthindex: Caller thread index.
+    @param struct sockaddr_storage * caddr: Peer address.
+
+    @retval dmserver_cliconn_pt: Client slot of the new session.
+    @retval NULL: No free slots (datagram dropped).
+*/
+static dmserver_cliconn_pt _dmserver_helper_dgsession(dmserver_pt dmserver, size_t dmthindex, struct sockaddr_storage * caddr){
+    // Next free slot of the subthread:
+    dmserver_cliconn_pt dmclient = NULL;
+    size_t temp_cindex = 0;
+    for (size_t i = 0; i < dmserver->sworker.wth_clispersth; i++){
+        if (dmserver->sworker.wcclis[dmthindex][i].cstate == DMSERVER_CLIENT_STANDBY) {
+            dmclient = &dmserver->sworker.wcclis[dmthindex][i];
+            temp_cindex = i;
+            break;
+        }
+    }
+    if (!dmclient) return NULL;
+
+    // Session data (shared subthread socket) & session table insertion:
+    dmserver_dgram_pt d = &dmserver->sworker.wsubdgram[dmthindex];
+    if (!_dmserver_cconn_set(dmclient, &(dmserver_cliloc_t){.th_pos=dmthindex, .wc_pos=temp_cindex}, d->dfd, caddr, NULL, _dmserver_worker_now(&dmserver->sworker))) return NULL;
+    _dmserver_cconn_settransport(dmclient, DMSERVER_TRANSPORT_DGRAM);
+    dmclient->csconn = &dmserver->sconn;
+    dmclient->ccallback = &dmserver->scallback;
+    if (!_dmserver_dgram_insert(d, dmclient)) {
+        dmclient->cstate = DMSERVER_CLIENT_CLOSED;
+        _dmserver_cconn_reset(dmclient);
+        return NULL;
+    }
+    __atomic_add_fetch(&dmserver->sworker.wccount[dmthindex], 1, __ATOMIC_RELAXED);
+    DMSERVER_PROBE3(slot, dmclient->cfd, (int)dmthindex, (int)dmclient->cloc.wc_pos);
+    _dmserver_capture_record(&dmserver->scapture, DMSERVER_CAPTURE_CONNECT, dmclient, NULL, 0);
+
+    // Log message:
+    char caddr_str[DEFAULT_CCONN_ADDRSTRLEN];
+    _dmserver_cconn_addrstr(dmclient, caddr_str, sizeof(caddr_str));
+    dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "Datagram peer %s session opened at (%lu, %lu).\n", caddr_str, dmthindex, temp_cindex);
+
+    // On client connect callback event:
+    if (dmclient->ccallback->on_client_connect) dmclient->ccallback->on_client_connect(dmclient);
+    return dmclient;
+}
+
+/*
+    @brief Helper function that delivers a single datagram to its session, or a single frame to its
+    shared memory client (read buffer and reception callback, batched or not).
+    @note: Datagrams or frames longer than the read buffer are truncated.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param dmserver_cliconn_pt dmclient: Session (or shared memory client) slot.
+    @param size_t dmthindex: Caller thread index.
+    @param const char * data: Datagram (or frame) data.
+    @param size_t len: Datagram (or frame) length.
+    @param const struct timespec * ts: Kernel receive timestamp of the datagram (NULL for frames).
+*/
+static void _dmserver_helper_dgdeliver(dmserver_pt dmserver, dmserver_cliconn_pt dmclient, size_t dmthindex, const char * data, size_t len, const struct timespec * ts){
+    // A session already batched in this round is delivered before reusing its read buffer:
+    if (dmclient->ccallback->on_client_rcv_batch && (dmclient->crlen > 0)) _dmserver_helper_ccrcvbatch(dmserver, dmthindex);
+    if (dmclient->cstate != DMSERVER_CLIENT_ESTABLISHED) return;
+
+    // Read lock of client & datagram copy:
+    pthread_mutex_lock(&dmclient->crlock);
+    size_t rb = (len < dmclient->crbuffer_size - 1) ? len : dmclient->crbuffer_size - 1;
+    memcpy(dmclient->crbuffer, data, rb);
+    dmclient->crbuffer[rb] = '\0';
+    dmclient->crlen = rb;
+    dmclient->crts = (ts) ? *ts : (struct timespec){0};
+    dmclient->clastt = _dmserver_worker_now(&dmserver->sworker);
+    __atomic_add_fetch(&dmclient->crbytes, len, __ATOMIC_RELAXED);
+    DMSERVER_PROBE2(read, dmclient->cfd, (int)rb);
+    _dmserver_capture_record(&dmserver->scapture, DMSERVER_CAPTURE_IN, dmclient, dmclient->crbuffer, rb);
+    dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "Message of %lu bytes from session (%lu, %lu).\n", rb, dmclient->cloc.th_pos, dmclient->cloc.wc_pos);
+
+    if (dmclient->ccallback->on_client_rcv_batch){
+        // Batched reception, data kept in the read buffer until the end of the round:
+        size_t * nmsgs = &dmserver->sworker.wrcvcount[dmthindex];
+        dmserver->sworker.wrcvbatch[dmthindex][(*nmsgs)++] = (dmserver_rcvmsg_t){.cli=dmclient, .data=dmclient->crbuffer, .len=rb};
+        pthread_mutex_unlock(&dmclient->crlock);
+        if (*nmsgs >= dmserver->sworker.wth_clispersth) _dmserver_helper_ccrcvbatch(dmserver, dmthindex);
+        return;
+    }
+
+    // User specific data processing of received data and read buffer reset afterwards:
+    _dmserver_cconn_rxlat(dmclient, dmserver->sworker.wrxlat[dmthindex], DEFAULT_WORKER_RXLATBUCKETS);
+    DMSERVER_PROBE2(cb_entry, "rcv", dmclient->cfd);
+    if (dmclient->ccallback->on_client_rcv) dmclient->ccallback->on_client_rcv(dmclient);
+    DMSERVER_PROBE2(cb_exit, "rcv", dmclient->cfd);
+    dmclient->crbuffer[0] = '\0';
+    dmclient->crlen = 0;
+    pthread_mutex_unlock(&dmclient->crlock);
+}
+
+/*
+    @brief Helper function that adds the pending data of a datagram session to the send batch of the
+    subordinate thread (a full batch sent before adding the rest).
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param dmserver_cliconn_pt dmclient: Session client slot.
+    @param size_t dmthindex: Caller thread index.
+*/
+static void _dmserver_helper_dgsend(dmserver_pt dmserver, dmserver_cliconn_pt dmclient, size_t dmthindex){
+    // References & state check:
+    if (!dmserver || !dmserver->sworker.wsubdgram || !dmclient) return;
+    if (dmclient->cstate != DMSERVER_CLIENT_ESTABLISHED) return;
+
+    while (!_dmserver_dgram_sendcli(&dmserver->sworker.wsubdgram[dmthindex], dmclient)) _dmserver_helper_dgsendflush(dmserver, dmthindex);
+}
+
+/*
+    @brief Helper function that sends the datagram send batch of a subordinate thread (sendmmsg) and
+    finalizes the datagrams sent (counters, capture & send callback of their session).
+    @note: Datagrams that could not be sent are dropped (datagram semantics).
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param size_t dmthindex: Caller thread index.
+*/
+static void _dmserver_helper_dgsendflush(dmserver_pt dmserver, size_t dmthindex){
+    // References check:
+    if (!dmserver || !dmserver->sworker.wsubdgram) return;
+    dmserver_dgram_pt d = &dmserver->sworker.wsubdgram[dmthindex];
+
+    // Batch send:
+    size_t queued = d->dscount;
+    if (queued == 0) return;
+    size_t sent = _dmserver_dgram_sendflush(d);
+    if (sent < queued) dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "Datagram batch of subthread %lu, %lu datagrams dropped.", dmthindex, queued - sent);
+
+    // Datagrams sent finalization:
+    for (size_t i = 0; i < sent; i++){
+        dmserver_cliconn_pt dmclient = d->dsclis[i];
+        size_t len = d->dsiovs[i].iov_len;
+        __atomic_add_fetch(&dmclient->cwbytes, len, __ATOMIC_RELAXED);
+        DMSERVER_PROBE2(write, dmclient->cfd, (int)len);
+        _dmserver_capture_record(&dmserver->scapture, DMSERVER_CAPTURE_OUT, dmclient, d->dsiovs[i].iov_base, len);
+        if ((dmclient->cstate == DMSERVER_CLIENT_ESTABLISHED) && dmclient->ccallback->on_client_snd) dmclient->ccallback->on_client_snd(dmclient);
+    }
+}
+
+/*
+    @brief Helper function that checks if a client is behind to queue a new message (messages queue
+    full, too many bytes pending, oldest pending message too old or pending messages while the output
+    memory budget is exceeded).
+    @note: The client write lock must be held by the caller.
+
+    @param dmserver_worker_pt w: Worker struct reference.
+    @param dmserver_cliconn_pt c: Reference to client.
+    @param dmserver_cmsg_pt m: Reference to the new message.
+    @param dmserver_slow_conf_pt sc: Slow consumers policy.
+
+    @retval true: Client behind.
+    @retval false: Message can be queued.
+*/
+static bool _dmserver_helper_slow(dmserver_worker_pt w, dmserver_cliconn_pt c, dmserver_cmsg_pt m, dmserver_slow_conf_pt sc){
+    if (c->cwq_count >= c->cwq_size) return true;
+    if (w->wout_budget && (c->cwq_count > 0) && (__atomic_load_n(&w->wslowstats.sout_bytes, __ATOMIC_RELAXED) > w->wout_budget)) return true;
+    if (sc->smax_bytes && (c->cwq_bytes + m->mlen > sc->smax_bytes)) return true;
+    if (sc->smax_sec && (c->cwq_count > 0) && ((m->mtime - c->cwq[c->cwq_head]->mtime) > (time_t)sc->smax_sec)) return true;
+    return false;
+}
+
+/*
+    @brief Helper function that opens the shared memory connection of a newly accepted unix domain
+    client: rings created & offered through its socket, wake up event registered in its subthread.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param dmserver_cliconn_pt dmclient: Client slot (set, not yet in its subthread).
+
+    @retval true: Client switched to the shared memory transport.
+    @retval false: Rings not created or not offered (nothing left open but the socket).
+*/
+static bool _dmserver_helper_shmopen(dmserver_pt dmserver, dmserver_cliconn_pt dmclient){
+    size_t th = dmclient->cloc.th_pos;
+    dmserver_shmconn_pt shm = &dmserver->sworker.wshm[th][dmclient->cloc.wc_pos];
+
+    // Rings offered to the client & its signals registered in the subthread:
+    if (!_dmserver_shm_serve(shm, dmclient->cfd, dmclient->csconn->sunixshm_ring, dmserver->sworker.wsubepfd[th])) return false;
+    _dmserver_cconn_settransport(dmclient, DMSERVER_TRANSPORT_SHM);
+    __atomic_add_fetch(&dmserver->sworker.wshmcount[th], 1, __ATOMIC_RELAXED);
     return true;
+}
+
+/*
+    @brief Helper function that reads the rings of the shared memory clients of a subthread: the frames
+    written by each client are delivered as its reads (a frame per round in batched reception and up
+    to DEFAULT_WORKER_READSPERROUND frames otherwise, the rest in the next rounds), the output left on
+    a full ring is written again and the clients waiting are signalled.
+    @note: Nothing but memory accesses while the clients are not sleeping.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param size_t dmthindex: Caller thread index.
+*/
+static void _dmserver_helper_shmsweep(dmserver_pt dmserver, size_t dmthindex){
+    // Shared memory clients check:
+    if (!__atomic_load_n(&dmserver->sworker.wshmcount[dmthindex], __ATOMIC_RELAXED)) return;
+
+    for (size_t i = 0; i < dmserver->sworker.wth_clispersth; i++){
+        dmserver_cliconn_pt dmclient = &dmserver->sworker.wcclis[dmthindex][i];
+        if ((dmclient->ctransport != DMSERVER_TRANSPORT_SHM) || (dmclient->cstate != DMSERVER_CLIENT_ESTABLISHED)) continue;
+        dmserver_shmconn_pt shm = &dmserver->sworker.wshm[dmthindex][i];
+
+        // Output left on a full ring (the client freed space meanwhile or not):
+        if (dmclient->cwarmed) _dmserver_helper_shmsend(dmserver, dmclient);
+
+        // Frames delivered in place (copied to the read buffer) unless the reads are paused:
+        size_t budget = (dmclient->ccallback->on_client_rcv_batch) ? 1 : DEFAULT_WORKER_READSPERROUND;
+        for (size_t n = 0; (n < budget) && !dmclient->crpaused && (dmclient->cstate == DMSERVER_CLIENT_ESTABLISHED); n++){
+            size_t len = 0;
+            const char * data = _dmserver_shm_peek(shm, &len);
+            if (!data) break;
+            dmclient->crload += len;
+            _dmserver_helper_dgdeliver(dmserver, dmclient, dmthindex, data, len, NULL);
+            _dmserver_shm_release(shm);
+        }
+
+        // Client signalled if sleeping (space freed in its output ring):
+        _dmserver_shm_notify(shm);
+    }
+}
+
+/*
+    @brief Helper function that prepares the shared memory clients of a subthread before blocking on
+    its epoll: each client is told to signal its next frame, and the epoll does not block if a client
+    has frames pending already.
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param size_t dmthindex: Caller thread index.
+    @param int ep_timeout: Epoll timeout in ms.
+
+    @retval Epoll timeout in ms (0 with frames pending).
+*/
+static int _dmserver_helper_shmtimeout(dmserver_pt dmserver, size_t dmthindex, int ep_timeout){
+    // Spinning or no shared memory clients, nothing to flag:
+    if ((ep_timeout == 0) || !__atomic_load_n(&dmserver->sworker.wshmcount[dmthindex], __ATOMIC_RELAXED)) return ep_timeout;
+
+    for (size_t i = 0; i < dmserver->sworker.wth_clispersth; i++){
+        dmserver_cliconn_pt dmclient = &dmserver->sworker.wcclis[dmthindex][i];
+        if ((dmclient->ctransport != DMSERVER_TRANSPORT_SHM) || (dmclient->cstate != DMSERVER_CLIENT_ESTABLISHED) || dmclient->crpaused) continue;
+        if (!_dmserver_shm_sleep(&dmserver->sworker.wshm[dmthindex][i])) return 0;
+    }
+    return ep_timeout;
+}
+
+/*
+    @brief Helper function that writes the pending data of a shared memory client to its ring, the
+    write buffer and every queued message as a frame each. The data that does not fit stays pending
+    (the client signals once it frees space) and the client is signalled if sleeping.
+    @note: Payloads longer than the largest frame are rejected when queued (dropped & counted here
+    if the ring got shorter meanwhile).
+
+    @param dmserver_pt dmserver: Reference to dmserver struct.
+    @param dmserver_cliconn_pt dmclient: Reference to the client to write.
+*/
+static void _dmserver_helper_shmsend(dmserver_pt dmserver, dmserver_cliconn_pt dmclient){
+    // References & state check:
+    if (!dmserver || !dmclient) return;
+    if (dmclient->cstate != DMSERVER_CLIENT_ESTABLISHED) return;
+    dmserver_shmconn_pt shm = &dmserver->sworker.wshm[dmclient->cloc.th_pos][dmclient->cloc.wc_pos];
+    size_t maxlen = _dmserver_shm_maxlen(shm);
+
+    // Write lock of client:
+    pthread_mutex_lock(&dmclient->cwlock);
+    bool wpending = false;
+
+    // Write buffer as a frame (send callback once written):
+    if (dmclient->cwlen > maxlen) {
+        dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_INFO, "Client %d write of %lu bytes over the shared memory frame, dropped.", dmclient->cfd, dmclient->cwlen);
+        __atomic_add_fetch(&dmserver->sworker.wslowstats.soversized, 1, __ATOMIC_RELAXED);
+        memset(dmclient->cwbuffer, 0, dmclient->cwlen);
+        dmclient->cwlen = 0;
+    } else if (dmclient->cwlen > 0) {
+        if (_dmserver_shm_send(shm, dmclient->cwbuffer, dmclient->cwlen)) {
+            __atomic_add_fetch(&dmclient->cwbytes, dmclient->cwlen, __ATOMIC_RELAXED);
+            DMSERVER_PROBE2(write, dmclient->cfd, (int)dmclient->cwlen);
+            _dmserver_capture_record(&dmserver->scapture, DMSERVER_CAPTURE_OUT, dmclient, dmclient->cwbuffer, dmclient->cwlen);
+            if (dmclient->ccallback->on_client_snd) dmclient->ccallback->on_client_snd(dmclient);
+            memset(dmclient->cwbuffer, 0, dmclient->cwlen);
+            dmclient->cwlen = 0;
+        } else wpending = true;
+    }
+
+    // Queued messages as a frame each (the unwritten part of the head one if any):
+    while (!wpending && (dmclient->cwq_count > 0)){
+        dmserver_cmsg_pt m = dmclient->cwq[dmclient->cwq_head];
+        size_t mlen = m->mlen - dmclient->cwq_off;
+        if ((mlen <= maxlen) && !_dmserver_shm_send(shm, m->mdata + dmclient->cwq_off, mlen)) {
+            wpending = true;
+            break;
+        }
+        if (mlen > maxlen) __atomic_add_fetch(&dmserver->sworker.wslowstats.soversized, 1, __ATOMIC_RELAXED);
+        if (mlen <= maxlen) __atomic_add_fetch(&dmclient->cwbytes, mlen, __ATOMIC_RELAXED);
+        if (mlen <= maxlen) DMSERVER_PROBE2(write, dmclient->cfd, (int)mlen);
+        if (mlen <= maxlen) _dmserver_capture_record(&dmserver->scapture, DMSERVER_CAPTURE_OUT, dmclient, m->mdata + dmclient->cwq_off, mlen);
+        _dmserver_cconn_wqconsume(dmclient, mlen);
+    }
+    dmclient->cwarmed = wpending;
+
+    // Write unlock of client & client signalled if sleeping:
+    pthread_mutex_unlock(&dmclient->cwlock);
+    _dmserver_shm_notify(shm);
+}
+
+/*
+    @brief Helper function that sets up the injected connections pending (main thread): each one as an
+    established plain client of the worker own connection data, on the subthread wanted. Connections
+    without a free slot are closed (the other end reads the end of file).
+
+    @param dmserver_pt dmserver: Reference to the server struct.
+*/
+static void _dmserver_helper_injected(dmserver_pt dmserver){
+    // Injected connections taken:
+    struct dmserver_inject pending[DEFAULT_WORKER_INJECTLEN];
+    pthread_mutex_lock(&dmserver->sworker.winjectlock);
+    size_t npending = dmserver->sworker.winjectcount;
+    memcpy(pending, dmserver->sworker.winject, npending * sizeof(struct dmserver_inject));
+    dmserver->sworker.winjectcount = 0;
+    pthread_mutex_unlock(&dmserver->sworker.winjectlock);
+
+    for (size_t n = 0; n < npending; n++){
+        // Client slot (next free one of the subthread wanted, or as an accepted client):
+        dmserver_cliconn_pt dmclient = NULL;
+        dmserver_cliloc_t temp_cloc = {0};
+        if (pending[n].ith < dmserver->sworker.wth_subthreads) {
+            for (size_t i = 0; i < dmserver->sworker.wth_clispersth; i++){
+                if (dmserver->sworker.wcclis[pending[n].ith][i].cstate == DMSERVER_CLIENT_STANDBY) {
+                    dmclient = &dmserver->sworker.wcclis[pending[n].ith][i];
+                    temp_cloc = (dmserver_cliloc_t){.th_pos=pending[n].ith, .wc_pos=i};
+                    break;
+                }
+            }
+        } else {
+            bool temp_overloaded = true;
+            dmclient = _dmserver_helper_cslot(dmserver, &temp_cloc, &temp_overloaded);
+        }
+
+        // Connection data (unix domain peer) & listener (own connection data, server callbacks):
+        struct sockaddr_storage temp_caddr = {.ss_family=AF_UNIX};
+        if (!dmclient || !_dmserver_cconn_set(dmclient, &temp_cloc, pending[n].ifd, &temp_caddr, NULL, _dmserver_worker_now(&dmserver->sworker))) {
+            dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "_dmserver_worker_main() - Injected connection %d without slot, closed.", pending[n].ifd);
+            close(pending[n].ifd);
+            continue;
+        }
+        dmclient->csconn = &dmserver->sworker.winjconn;
+        dmclient->ccallback = &dmserver->scallback;
+        dmclient->cstate = DMSERVER_CLIENT_ESTABLISHED;
+
+        // Distribute the client to the subordinate thread:
+        if (epoll_ctl(dmserver->sworker.wsubepfd[temp_cloc.th_pos], EPOLL_CTL_ADD, dmclient->cfd, &(struct epoll_event){.events=EPOLLIN | EPOLLET, .data.ptr=dmclient}) < 0) {
+            close(dmclient->cfd);
+            dmclient->cstate = DMSERVER_CLIENT_CLOSED;
+            _dmserver_cconn_reset(dmclient);
+            continue;
+        }
+        __atomic_add_fetch(&dmserver->sworker.wccount[temp_cloc.th_pos], 1, __ATOMIC_RELAXED);
+        DMSERVER_PROBE3(slot, dmclient->cfd, (int)temp_cloc.th_pos, (int)temp_cloc.wc_pos);
+        _dmserver_capture_record(&dmserver->scapture, DMSERVER_CAPTURE_CONNECT, dmclient, NULL, 0);
+        dmlogger_log(dmserver->slogger, DMLOGGER_LEVEL_DEBUG, "_dmserver_worker_main() - Injected connection %d at point (%lu, %lu).", dmclient->cfd, temp_cloc.th_pos, temp_cloc.wc_pos);
+
+        // On client connect callback event:
+        if (dmclient->ccallback->on_client_connect) dmclient->ccallback->on_client_connect(dmclient);
+    }
 }
\ No newline at end of file